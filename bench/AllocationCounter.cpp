@@ -0,0 +1,94 @@
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+
+namespace
+{
+	// constant initialized, allocations made before main are counted as well
+	std::atomic<uint64_t> allocation_count{ 0 };
+	std::atomic<uint64_t> allocated_bytes{ 0 };
+
+	void* Allocate(std::size_t size, const std::size_t alignment)
+	{
+		size = size ? size : 1;
+		allocation_count.fetch_add(1, std::memory_order_relaxed);
+		allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+
+		void* p = nullptr;
+		if ( alignment <= alignof(std::max_align_t) )
+		{
+			p = std::malloc(size);
+		}
+		else
+		{
+#ifdef _WIN32
+			p = _aligned_malloc(size, alignment);
+#else
+			if ( posix_memalign(&p, alignment, size) != 0 )
+			{
+				p = nullptr;
+			}
+#endif
+		}
+		if ( !p )
+		{
+			throw std::bad_alloc();
+		}
+		return p;
+	}
+
+	void Free(void* p, const std::size_t alignment)
+	{
+#ifdef _WIN32
+		if ( alignment > alignof(std::max_align_t) )
+		{
+			_aligned_free(p);
+			return;
+		}
+#endif
+		(void)alignment;
+		std::free(p);
+	}
+}
+
+
+Anni::ModelLoader::Bench::AllocationCounter::Snapshot Anni::ModelLoader::Bench::AllocationCounter::Read()
+{
+	return { allocation_count.load(std::memory_order_relaxed), allocated_bytes.load(std::memory_order_relaxed) };
+}
+
+
+// the array and nothrow forms forward to these by default
+void* operator new(const std::size_t size)
+{
+	return Allocate(size, 0);
+}
+
+void* operator new(const std::size_t size, const std::align_val_t alignment)
+{
+	return Allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* p) noexcept
+{
+	Free(p, 0);
+}
+
+void operator delete(void* p, const std::align_val_t alignment) noexcept
+{
+	Free(p, static_cast<std::size_t>(alignment));
+}
+
+// replaced as well so every delete pairs with Allocate, -Wsized-deallocation warns about them missing
+void operator delete(void* p, std::size_t) noexcept
+{
+	::operator delete(p);
+}
+
+void operator delete(void* p, std::size_t, const std::align_val_t alignment) noexcept
+{
+	::operator delete(p, alignment);
+}
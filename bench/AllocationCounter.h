@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+
+
+namespace Anni::ModelLoader::Bench
+{
+	// every global operator new of the process goes through the replacements in AllocationCounter.cpp, which count them
+	class AllocationCounter
+	{
+	public:
+		struct Snapshot
+		{
+			uint64_t count;
+			uint64_t bytes;
+		};
+
+		AllocationCounter() = delete;
+
+		// totals since the start of the process, subtract two snapshots to get what happened in between
+		static Snapshot Read();
+	};
+}
@@ -0,0 +1,84 @@
+#include "FactoryBenchmark.h"
+#include "AllocationCounter.h"
+#include "StagedLoad.h"
+
+#include <chrono>
+
+
+Anni::ModelLoader::LoadResult<Anni::ModelLoader::Bench::BenchmarkSample> Anni::ModelLoader::Bench::FactoryBenchmark::Run(const std::filesystem::path& file_path, const LoadOptions& options, uint32_t pre_draw_repeats)
+{
+	pre_draw_repeats = std::max(pre_draw_repeats, 1u);
+
+	BenchmarkSample sample;
+	const auto time_stage = [&sample](const Stage stage, auto&& run)
+	{
+		const AllocationCounter::Snapshot allocations_before = AllocationCounter::Read();
+		const auto start = std::chrono::steady_clock::now();
+		run();
+		const auto end = std::chrono::steady_clock::now();
+		const AllocationCounter::Snapshot allocations_after = AllocationCounter::Read();
+
+		StageSample& stage_sample = sample.stages[static_cast<size_t>(stage)];
+		stage_sample.milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+		stage_sample.allocations = allocations_after.count - allocations_before.count;
+		stage_sample.allocated_bytes = allocations_after.bytes - allocations_before.bytes;
+	};
+
+	// declared first so it outlives the model's arena
+	CountingMemoryResource arena_upstream(options.memory_resource);
+	LoadOptions stage_options = options;
+	stage_options.memory_resource = &arena_upstream;
+
+	// the bench stages up to Animations are the loader's own, in the same order
+	static_assert(static_cast<uint32_t>(Stage::Animations) == static_cast<uint32_t>(LoadStats::Stage::Animations) &&
+		static_cast<uint32_t>(Stage::PreDraw) == static_cast<uint32_t>(LoadStats::Stage::Animations) + 1);
+	LoadedModel::StagedLoad staged_load(file_path, stage_options);
+	for ( uint32_t stage = 0; stage < static_cast<uint32_t>(Stage::PreDraw); ++stage )
+	{
+		LoadResult<void> result;
+		time_stage(static_cast<Stage>(stage), [&]()
+		{
+			result = staged_load.RunStage(static_cast<LoadStats::Stage>(stage));
+		});
+		if ( !result )
+		{
+			return std::unexpected(result.error());
+		}
+	}
+	const LoadedModel& model = staged_load.GetModel();
+
+	// the first call sizes the record array, the rest run on a warm context like a renderer's would
+	DrawContext draw_context;
+	model.PreDrawToContext(glm::mat4(1.f), draw_context);
+	time_stage(Stage::PreDraw, [&]()
+	{
+		for ( uint32_t repeat = 0; repeat < pre_draw_repeats; ++repeat )
+		{
+			draw_context.homo_mat_tris_record.clear();
+			model.PreDrawToContext(glm::mat4(1.f), draw_context);
+		}
+	});
+	StageSample& pre_draw = sample.stages[static_cast<size_t>(Stage::PreDraw)];
+	pre_draw.milliseconds /= pre_draw_repeats;
+	pre_draw.allocations /= pre_draw_repeats;
+	pre_draw.allocated_bytes /= pre_draw_repeats;
+
+	// external .bin buffers are in the list, data URIs and GLB chunks are part of the model file
+	for ( const auto& source_file : model.GetSourceFiles() )
+	{
+		std::error_code error;
+		const uint64_t file_size = std::filesystem::file_size(source_file, error);
+		sample.source_bytes += error ? 0 : file_size;
+	}
+	for ( const auto& mesh_asset : model.GetMeshAssets() )
+	{
+		sample.vertex_count += mesh_asset.vertex_count;
+		sample.index_count += mesh_asset.index_count;
+	}
+	sample.draw_records = draw_context.homo_mat_tris_record.size();
+	sample.memory = model.GetMemoryUsage();
+	sample.arena_blocks = staged_load.GetArenaBlockCount();
+	sample.quantization = model.GetQuantizationReport();
+	sample.arena_upstream_allocations = arena_upstream.GetStats().allocation_count;
+	return sample;
+}
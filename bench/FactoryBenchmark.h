@@ -0,0 +1,73 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+#include "ModelsLoader.h"
+
+
+namespace Anni::ModelLoader::Bench
+{
+	enum class Stage : uint32_t
+	{
+		// parsing, external buffers and the source file list
+		RawParse,
+		// EXT_meshopt_compression buffer views
+		Decompress,
+		Samplers,
+		// texture slots and materials
+		Materials,
+		// decode and post process of every image, waited for before the next stage
+		Textures,
+		// meshes and their post processing
+		Meshes,
+		SceneNodes,
+		// hierarchy, transforms and the flat scene
+		SceneGraph,
+		// skins and animation channels
+		Animations,
+		// one LoadedModel::PreDrawToContext of the whole scene
+		PreDraw,
+		Count,
+	};
+
+	constexpr size_t stage_count = static_cast<size_t>(Stage::Count);
+	// the keys of the JSON report
+	constexpr std::array<std::string_view, stage_count> stage_names{
+		"raw_parse", "decompress", "samplers", "materials", "textures", "meshes", "scene_nodes", "scene_graph", "animations", "pre_draw" };
+
+	struct StageSample
+	{
+		double milliseconds{ 0.0 };
+		// global operator new calls and bytes, from every thread
+		uint64_t allocations{ 0 };
+		uint64_t allocated_bytes{ 0 };
+	};
+
+	struct BenchmarkSample
+	{
+		std::array<StageSample, stage_count> stages{};
+		uint64_t source_bytes{ 0 };
+		uint64_t vertex_count{ 0 };
+		uint64_t index_count{ 0 };
+		uint64_t draw_records{ 0 };
+		ModelMemoryUsage memory{};
+		uint32_t arena_blocks{ 0 };
+		// what the model's arena asked its upstream for
+		uint64_t arena_upstream_allocations{ 0 };
+		// only filled when LoadOptions::vertex_layout quantizes
+		VertexQuantizationReport quantization{};
+	};
+
+	// runs the Factory stages of one glTF/GLB load back to back and times each of them. textures are decoded before the
+	// meshes instead of next to them, so every stage is measured on its own
+	class FactoryBenchmark
+	{
+	public:
+		FactoryBenchmark() = delete;
+
+		// PreDraw is averaged over pre_draw_repeats calls. fails with the error of the first stage that failed
+		static LoadResult<BenchmarkSample> Run(const std::filesystem::path& file_path, const LoadOptions& options, uint32_t pre_draw_repeats);
+	};
+}
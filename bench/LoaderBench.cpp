@@ -0,0 +1,453 @@
+#include "FactoryBenchmark.h"
+#include "SyntheticGltf.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+// ModelsLoaderBench [--iterations N] [--output report.json] [--work-directory dir] [--filter name] [--asset model.gltf]...
+//
+// generates a fixed set of synthetic models, loads each of them iterations times(after one warm up load) and writes the
+// median/min time and the allocations of every load stage as JSON. the report has no timestamps or host info, two runs
+// on the same machine can be diffed directly.
+// with --asset the given glTF/GLB files are loaded instead, with VertexLayout::Quantized, and the report adds their
+// quantization report(bytes saved and worst case error per attribute). scenarios that quantize get it either way.
+// a model that fails to load is reported and left out of the report, the exit code tells if any did
+
+namespace
+{
+	using namespace Anni::ModelLoader;
+	using namespace Anni::ModelLoader::Bench;
+
+	struct Scenario
+	{
+		// model.name names the scenario, the rest of model is unused when asset_path is set
+		SyntheticModelDesc model;
+		std::filesystem::path asset_path;
+		LoadOptions options;
+	};
+
+	struct ScenarioResult
+	{
+		std::string name;
+		std::array<std::vector<StageSample>, stage_count> stage_samples;
+		std::vector<double> total_milliseconds;
+		// of the last iteration, every iteration loads the same data
+		BenchmarkSample last;
+	};
+
+	constexpr uint32_t pre_draw_repeats = 16;
+
+	std::vector<Scenario> MakeScenarios()
+	{
+		std::vector<Scenario> scenarios;
+
+		Scenario single_mesh;
+		single_mesh.model.name = "single_mesh_gltf";
+		single_mesh.model.grid_size = 128;
+		scenarios.push_back(single_mesh);
+
+		Scenario dense_mesh;
+		dense_mesh.model.name = "dense_mesh_glb";
+		dense_mesh.model.grid_size = 512;
+		dense_mesh.model.binary = true;
+		scenarios.push_back(dense_mesh);
+
+		Scenario many_nodes;
+		many_nodes.model.name = "many_nodes_gltf";
+		many_nodes.model.mesh_count = 64;
+		many_nodes.model.grid_size = 16;
+		many_nodes.model.node_count = 8192;
+		scenarios.push_back(many_nodes);
+
+		Scenario position_only;
+		position_only.model.name = "position_only_glb";
+		position_only.model.grid_size = 256;
+		position_only.model.attributes = 0;
+		position_only.model.binary = true;
+		position_only.options.vertex_layout = VertexLayout::PositionOnly();
+		scenarios.push_back(position_only);
+
+		Scenario texture_heavy;
+		texture_heavy.model.name = "texture_heavy_gltf";
+		texture_heavy.model.mesh_count = 32;
+		texture_heavy.model.grid_size = 8;
+		texture_heavy.model.node_count = 32;
+		texture_heavy.model.texture_count = 32;
+		texture_heavy.model.texture_size = 1024;
+		scenarios.push_back(texture_heavy);
+
+		Scenario post_processed;
+		post_processed.model.name = "post_processed_glb";
+		post_processed.model.mesh_count = 8;
+		post_processed.model.grid_size = 128;
+		post_processed.model.node_count = 64;
+		post_processed.model.binary = true;
+		post_processed.options.optimize_meshes = true;
+		post_processed.options.lod_ratios = { 0.5f, 0.25f };
+		post_processed.options.build_meshlets = true;
+		post_processed.options.merge_mesh_buffers = true;
+		scenarios.push_back(post_processed);
+
+		Scenario memory_mapped;
+		memory_mapped.model.name = "memory_mapped_gltf";
+		memory_mapped.model.mesh_count = 16;
+		memory_mapped.model.grid_size = 128;
+		memory_mapped.model.node_count = 16;
+		memory_mapped.model.texture_count = 4;
+		memory_mapped.model.texture_size = 512;
+		memory_mapped.options.memory_mapped_input = true;
+		scenarios.push_back(memory_mapped);
+
+		// the same meshes as floats, quantized and quantized + meshopt compressed, for source bytes against load time
+		Scenario float_vertices;
+		float_vertices.model.name = "float_vertices_glb";
+		float_vertices.model.mesh_count = 16;
+		float_vertices.model.grid_size = 128;
+		float_vertices.model.node_count = 16;
+		float_vertices.model.binary = true;
+		scenarios.push_back(float_vertices);
+
+		Scenario quantized_vertices = float_vertices;
+		quantized_vertices.model.name = "quantized_vertices_glb";
+		quantized_vertices.model.quantized = true;
+		scenarios.push_back(quantized_vertices);
+
+		Scenario meshopt_vertices = quantized_vertices;
+		meshopt_vertices.model.name = "meshopt_vertices_glb";
+		meshopt_vertices.model.meshopt_compression = true;
+		scenarios.push_back(meshopt_vertices);
+
+		return scenarios;
+	}
+
+	// every file once, interleaved attributes in their most compact encoding
+	std::vector<Scenario> MakeAssetScenarios(const std::vector<std::filesystem::path>& asset_paths)
+	{
+		std::vector<Scenario> scenarios;
+		for ( const auto& asset_path : asset_paths )
+		{
+			Scenario asset;
+			asset.model.name = "asset_" + asset_path.stem().string() + "_quantized";
+			asset.asset_path = asset_path;
+			asset.options.vertex_layout = VertexLayout::Quantized(VertexLayout::Interleaved());
+			scenarios.push_back(asset);
+		}
+		return scenarios;
+	}
+
+	double Median(std::vector<double> values)
+	{
+		if ( values.empty() )
+		{
+			return 0.0;
+		}
+		std::sort(values.begin(), values.end());
+		const size_t middle = values.size() / 2;
+		return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) * 0.5;
+	}
+
+	double Min(const std::vector<double>& values)
+	{
+		return values.empty() ? 0.0 : *std::min_element(values.begin(), values.end());
+	}
+
+	// a JSON string literal, quotes included
+	void AppendString(std::string& json, const std::string_view text)
+	{
+		json += '"';
+		for ( const char c : text )
+		{
+			if ( '"' == c || '\\' == c )
+			{
+				json += '\\';
+				json += c;
+			}
+			else if ( static_cast<unsigned char>(c) < 0x20 )
+			{
+				char buffer[8];
+				std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned int>(static_cast<unsigned char>(c)));
+				json += buffer;
+			}
+			else
+			{
+				json += c;
+			}
+		}
+		json += '"';
+	}
+
+	void AppendMilliseconds(std::string& json, const double milliseconds)
+	{
+		char buffer[32];
+		std::snprintf(buffer, sizeof(buffer), "%.3f", milliseconds);
+		json += buffer;
+	}
+
+	void AppendFloat(std::string& json, const char* key, const double value, const bool last = false)
+	{
+		char buffer[32];
+		std::snprintf(buffer, sizeof(buffer), "%.6g", value);
+		json += '"';
+		json += key;
+		json += "\": ";
+		json += buffer;
+		json += last ? "" : ", ";
+	}
+
+	void AppendEntry(std::string& json, const char* key, const uint64_t value, const bool last = false)
+	{
+		json += '"';
+		json += key;
+		json += "\": ";
+		json += std::to_string(value);
+		json += last ? "" : ", ";
+	}
+
+	void AppendTiming(std::string& json, const std::vector<double>& milliseconds)
+	{
+		json += "\"median_ms\": ";
+		AppendMilliseconds(json, Median(milliseconds));
+		json += ", \"min_ms\": ";
+		AppendMilliseconds(json, Min(milliseconds));
+	}
+
+	std::string WriteReport(const std::vector<Scenario>& scenarios, const std::vector<ScenarioResult>& results, const uint32_t iterations)
+	{
+		std::string json;
+		json += "{\n";
+		json += "  \"schema_version\": 2,\n";
+		json += "  \"iterations\": " + std::to_string(iterations) + ",\n";
+		json += "  \"pre_draw_repeats\": " + std::to_string(pre_draw_repeats) + ",\n";
+		json += "  \"scenarios\": [";
+		for ( size_t i = 0; i < results.size(); ++i )
+		{
+			const ScenarioResult& result = results[i];
+			const Scenario& scenario = *std::find_if(scenarios.begin(), scenarios.end(), [&result](const Scenario& s) { return s.model.name == result.name; });
+			const SyntheticModelDesc& model = scenario.model;
+
+			json += i ? ",\n" : "\n";
+			json += "    {\n";
+			json += "      \"name\": ";
+			AppendString(json, result.name);
+			json += ",\n";
+			json += "      \"model\": { ";
+			if ( !scenario.asset_path.empty() )
+			{
+				// generic_string keeps Windows separators out of the path, it is escaped all the same
+				json += "\"path\": ";
+				AppendString(json, scenario.asset_path.generic_string());
+				json += " },\n";
+			}
+			else
+			{
+				AppendEntry(json, "mesh_count", model.mesh_count);
+				AppendEntry(json, "grid_size", model.grid_size);
+				AppendEntry(json, "node_count", model.node_count);
+				AppendEntry(json, "attributes", model.attributes);
+				AppendEntry(json, "texture_count", model.texture_count);
+				AppendEntry(json, "texture_size", model.texture_size);
+				AppendEntry(json, "binary", model.binary);
+				AppendEntry(json, "quantized", model.quantized);
+				AppendEntry(json, "meshopt_compression", model.meshopt_compression);
+				AppendEntry(json, "seed", model.seed, true);
+				json += " },\n";
+			}
+
+			json += "      \"data\": { ";
+			AppendEntry(json, "source_bytes", result.last.source_bytes);
+			AppendEntry(json, "vertex_count", result.last.vertex_count);
+			AppendEntry(json, "index_count", result.last.index_count);
+			AppendEntry(json, "draw_records", result.last.draw_records);
+			AppendEntry(json, "vertex_bytes", result.last.memory.vertex_bytes);
+			AppendEntry(json, "index_bytes", result.last.memory.index_bytes);
+			AppendEntry(json, "texture_bytes", result.last.memory.texture_bytes);
+			AppendEntry(json, "arena_bytes", result.last.memory.arena_bytes);
+			AppendEntry(json, "arena_blocks", result.last.arena_blocks);
+			AppendEntry(json, "arena_upstream_allocations", result.last.arena_upstream_allocations, true);
+			json += " },\n";
+
+			if ( scenario.options.vertex_layout.has_value() && scenario.options.vertex_layout->quantization.IsEnabled() )
+			{
+				const VertexQuantizationReport& quantization = result.last.quantization;
+				json += "      \"quantization\": { ";
+				AppendEntry(json, "vertex_count", quantization.vertex_count);
+				AppendEntry(json, "float_bytes", quantization.float_bytes);
+				AppendEntry(json, "packed_bytes", quantization.packed_bytes);
+				AppendFloat(json, "size_reduction", quantization.float_bytes ? 1.0 - static_cast<double>(quantization.packed_bytes) / static_cast<double>(quantization.float_bytes) : 0.0);
+				AppendFloat(json, "max_position_error", quantization.max_position_error);
+				AppendFloat(json, "max_normal_error_degrees", quantization.max_normal_error_degrees);
+				AppendFloat(json, "max_tangent_error_degrees", quantization.max_tangent_error_degrees);
+				AppendFloat(json, "max_uv_error", quantization.max_uv_error);
+				AppendFloat(json, "max_color_error", quantization.max_color_error);
+				AppendFloat(json, "max_weight_error", quantization.max_weight_error, true);
+				json += " },\n";
+			}
+
+			json += "      \"stages\": {\n";
+			for ( size_t stage = 0; stage < stage_count; ++stage )
+			{
+				const std::vector<StageSample>& samples = result.stage_samples[stage];
+				std::vector<double> milliseconds;
+				milliseconds.reserve(samples.size());
+				for ( const StageSample& sample : samples )
+				{
+					milliseconds.push_back(sample.milliseconds);
+				}
+
+				json += "        \"";
+				json += stage_names[stage];
+				json += "\": { ";
+				AppendTiming(json, milliseconds);
+				json += ", ";
+				// allocations don't vary between iterations, the last one stands for all
+				AppendEntry(json, "allocations", samples.empty() ? 0 : samples.back().allocations);
+				AppendEntry(json, "allocated_bytes", samples.empty() ? 0 : samples.back().allocated_bytes, true);
+				json += stage + 1 < stage_count ? " },\n" : " }\n";
+			}
+			json += "      },\n";
+
+			json += "      \"total\": { ";
+			AppendTiming(json, result.total_milliseconds);
+			json += " }\n";
+			json += "    }";
+		}
+		json += "\n  ]\n}\n";
+		return json;
+	}
+
+	bool ParseUInt(const char* text, uint32_t& value)
+	{
+		char* end = nullptr;
+		const unsigned long parsed = std::strtoul(text, &end, 10);
+		if ( end == text || *end != '\0' || parsed == 0 )
+		{
+			return false;
+		}
+		value = static_cast<uint32_t>(parsed);
+		return true;
+	}
+}
+
+
+int main(int argc, char** argv)
+{
+	uint32_t iterations = 5;
+	std::filesystem::path output_path;
+	std::filesystem::path work_directory = std::filesystem::temp_directory_path() / "ModelsLoaderBench";
+	std::string filter;
+	std::vector<std::filesystem::path> asset_paths;
+
+	for ( int i = 1; i < argc; ++i )
+	{
+		const std::string_view argument = argv[i];
+		const bool has_value = i + 1 < argc;
+		if ( argument == "--iterations" && has_value && ParseUInt(argv[i + 1], iterations) )
+		{
+			++i;
+		}
+		else if ( argument == "--output" && has_value )
+		{
+			output_path = argv[++i];
+		}
+		else if ( argument == "--work-directory" && has_value )
+		{
+			work_directory = argv[++i];
+		}
+		else if ( argument == "--filter" && has_value )
+		{
+			filter = argv[++i];
+		}
+		else if ( argument == "--asset" && has_value )
+		{
+			asset_paths.emplace_back(argv[++i]);
+		}
+		else
+		{
+			std::cerr << "usage: " << argv[0] << " [--iterations N] [--output report.json] [--work-directory dir] [--filter name] [--asset model.gltf]...\n";
+			return EXIT_FAILURE;
+		}
+	}
+
+	// the loader's info logs would end up inside the timings
+	spdlog::set_level(spdlog::level::warn);
+
+	std::error_code error;
+	std::filesystem::create_directories(work_directory, error);
+	if ( error )
+	{
+		SPDLOG_ERROR("Can't create the work directory {}: {}", work_directory.string(), error.message());
+		return EXIT_FAILURE;
+	}
+
+	const std::vector<Scenario> scenarios = asset_paths.empty() ? MakeScenarios() : MakeAssetScenarios(asset_paths);
+	std::vector<ScenarioResult> results;
+	// failed scenarios are left out of the report, the exit code still tells about them
+	size_t failed_scenarios = 0;
+	for ( const Scenario& scenario : scenarios )
+	{
+		if ( !filter.empty() && scenario.model.name.find(filter) == std::string::npos )
+		{
+			continue;
+		}
+
+		const std::filesystem::path model_path = scenario.asset_path.empty() ? SyntheticGltf::Write(scenario.model, work_directory) : scenario.asset_path;
+		std::cerr << "running " << scenario.model.name << '\n';
+
+		// the warm up load fills the page cache and the worker pool
+		if ( LoadResult<BenchmarkSample> warm_up = FactoryBenchmark::Run(model_path, scenario.options, pre_draw_repeats); !warm_up )
+		{
+			SPDLOG_ERROR("Skipping {}, loading {} failed: {}", scenario.model.name, model_path.string(), warm_up.error().message);
+			++failed_scenarios;
+			continue;
+		}
+
+		ScenarioResult& result = results.emplace_back();
+		result.name = scenario.model.name;
+		for ( uint32_t iteration = 0; iteration < iterations; ++iteration )
+		{
+			LoadResult<BenchmarkSample> sample = FactoryBenchmark::Run(model_path, scenario.options, pre_draw_repeats);
+			if ( !sample )
+			{
+				SPDLOG_ERROR("Skipping {}, loading {} failed: {}", scenario.model.name, model_path.string(), sample.error().message);
+				++failed_scenarios;
+				results.pop_back();
+				break;
+			}
+			result.last = std::move(sample.value());
+			double total = 0.0;
+			for ( size_t stage = 0; stage < stage_count; ++stage )
+			{
+				result.stage_samples[stage].push_back(result.last.stages[stage]);
+				total += result.last.stages[stage].milliseconds;
+			}
+			result.total_milliseconds.push_back(total);
+		}
+	}
+
+	const std::string report = WriteReport(scenarios, results, iterations);
+	const int exit_code = failed_scenarios ? EXIT_FAILURE : EXIT_SUCCESS;
+	if ( output_path.empty() )
+	{
+		std::cout << report;
+		return exit_code;
+	}
+
+	std::ofstream output(output_path, std::ios::binary | std::ios::trunc);
+	output.write(report.data(), static_cast<std::streamsize>(report.size()));
+	if ( !output )
+	{
+		SPDLOG_ERROR("Can't write the report to {}", output_path.string());
+		return EXIT_FAILURE;
+	}
+	return exit_code;
+}
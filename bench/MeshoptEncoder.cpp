@@ -0,0 +1,372 @@
+#include "MeshoptEncoder.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+
+namespace
+{
+	//> VERTEX CODEC
+	constexpr size_t vertex_block_size_bytes = 8192;
+	constexpr size_t vertex_block_max_size = 256;
+	constexpr size_t byte_group_size = 16;
+	constexpr size_t tail_max_size = 32;
+
+	// must match the decoder's
+	size_t GetVertexBlockSize(const size_t stride)
+	{
+		const size_t block_size = (vertex_block_size_bytes / stride) & ~(byte_group_size - 1);
+		return std::min(block_size, vertex_block_max_size);
+	}
+
+	uint8_t Zigzag8(const uint8_t value)
+	{
+		return static_cast<uint8_t>((static_cast<int8_t>(value) >> 7) ^ (value << 1));
+	}
+
+	size_t GetEncodedGroupSize(const uint8_t* const group, const uint32_t bits_log2)
+	{
+		if ( bits_log2 == 0 )
+		{
+			return std::all_of(group, group + byte_group_size, [](const uint8_t value) { return value == 0; }) ? 0 : SIZE_MAX;
+		}
+		if ( bits_log2 == 3 )
+		{
+			return byte_group_size;
+		}
+
+		const uint32_t bits = 1u << bits_log2;
+		const uint8_t escape = static_cast<uint8_t>((1u << bits) - 1);
+		const size_t escaped_count = std::count_if(group, group + byte_group_size, [escape](const uint8_t value) { return value >= escape; });
+		return byte_group_size * bits / 8 + escaped_count;
+	}
+
+	void EncodeBytesGroup(std::vector<uint8_t>& output, const uint8_t* const group, const uint32_t bits_log2)
+	{
+		if ( bits_log2 == 0 )
+		{
+			return;
+		}
+		if ( bits_log2 == 3 )
+		{
+			output.insert(output.end(), group, group + byte_group_size);
+			return;
+		}
+
+		// codes first(first value in the high bits), then a full byte for every value that didn't fit
+		const uint32_t bits = 1u << bits_log2;
+		const uint32_t codes_per_byte = 8 / bits;
+		const uint8_t escape = static_cast<uint8_t>((1u << bits) - 1);
+		for ( size_t i = 0; i < byte_group_size; i += codes_per_byte )
+		{
+			uint8_t packed = 0;
+			for ( uint32_t k = 0; k < codes_per_byte; ++k )
+			{
+				packed = static_cast<uint8_t>(packed << bits | std::min(group[i + k], escape));
+			}
+			output.push_back(packed);
+		}
+		for ( size_t i = 0; i < byte_group_size; ++i )
+		{
+			if ( group[i] >= escape )
+			{
+				output.push_back(group[i]);
+			}
+		}
+	}
+
+	void EncodeBytes(std::vector<uint8_t>& output, const uint8_t* const deltas, const size_t size)
+	{
+		const size_t header_offset = output.size();
+		output.resize(output.size() + (size / byte_group_size + 3) / 4, 0);
+		for ( size_t i = 0; i < size; i += byte_group_size )
+		{
+			uint32_t best_bits_log2 = 3;
+			size_t best_size = byte_group_size;
+			for ( uint32_t bits_log2 = 0; bits_log2 < 3; ++bits_log2 )
+			{
+				const size_t group_size = GetEncodedGroupSize(deltas + i, bits_log2);
+				if ( group_size < best_size )
+				{
+					best_bits_log2 = bits_log2;
+					best_size = group_size;
+				}
+			}
+
+			const size_t group_index = i / byte_group_size;
+			output[header_offset + group_index / 4] |= static_cast<uint8_t>(best_bits_log2 << ((group_index % 4) * 2));
+			EncodeBytesGroup(output, deltas + i, best_bits_log2);
+		}
+	}
+
+	//> INDEX CODECS
+	constexpr std::array<uint8_t, 16> codeaux_table{ 0x00, 0x76, 0x87, 0x56, 0x67, 0x78, 0xA9, 0x86, 0x65, 0x89, 0x68, 0x98, 0x01, 0x69, 0x00, 0x00 };
+	constexpr std::array<std::array<uint32_t, 3>, 3> triangle_rotations{ { { 0, 1, 2 }, { 1, 2, 0 }, { 2, 0, 1 } } };
+
+	void EncodeVByte(std::vector<uint8_t>& output, uint32_t value)
+	{
+		do
+		{
+			output.push_back(static_cast<uint8_t>((value & 127) | (value > 127 ? 128 : 0)));
+			value >>= 7;
+		} while ( value );
+	}
+
+	uint32_t Zigzag32(const uint32_t delta)
+	{
+		return (delta << 1) ^ static_cast<uint32_t>(static_cast<int32_t>(delta) >> 31);
+	}
+
+	// the decoder's FIFOs, the encoder looks up what it can refer to instead of spelling out an index
+	struct IndexFifos
+	{
+		std::array<std::array<uint32_t, 2>, 16> edges;
+		std::array<uint32_t, 16> vertices;
+		size_t edge_offset{ 0 };
+		size_t vertex_offset{ 0 };
+
+		IndexFifos()
+		{
+			for ( auto& edge : edges )
+			{
+				edge = { ~0u, ~0u };
+			}
+			vertices.fill(~0u);
+		}
+
+		// (entry << 2) | rotation of the triangle that starts with the stored edge
+		int FindEdge(const uint32_t a, const uint32_t b, const uint32_t c) const
+		{
+			for ( int i = 0; i < 16; ++i )
+			{
+				const auto& edge = edges[(edge_offset - 1 - i) & 15];
+				if ( edge[0] == a && edge[1] == b )
+				{
+					return i << 2;
+				}
+				if ( edge[0] == b && edge[1] == c )
+				{
+					return (i << 2) | 1;
+				}
+				if ( edge[0] == c && edge[1] == a )
+				{
+					return (i << 2) | 2;
+				}
+			}
+			return -1;
+		}
+
+		int FindVertex(const uint32_t v) const
+		{
+			for ( int i = 0; i < 16; ++i )
+			{
+				if ( vertices[(vertex_offset - 1 - i) & 15] == v )
+				{
+					return i;
+				}
+			}
+			return -1;
+		}
+
+		void PushEdge(const uint32_t a, const uint32_t b)
+		{
+			edges[edge_offset] = { a, b };
+			edge_offset = (edge_offset + 1) & 15;
+		}
+
+		void PushVertex(const uint32_t v)
+		{
+			vertices[vertex_offset] = v;
+			vertex_offset = (vertex_offset + 1) & 15;
+		}
+	};
+}
+
+
+std::vector<uint8_t> Anni::ModelLoader::Bench::MeshoptEncoder::EncodeVertexBuffer(const std::span<const uint8_t> vertices, const size_t stride)
+{
+	const size_t count = vertices.size() / stride;
+	std::vector<uint8_t> output{ 0xA0 };
+	output.reserve(vertices.size() / 2);
+
+	// the first vertex goes into the tail and is the baseline of the first block
+	std::array<uint8_t, 256> last_vertex{};
+	if ( count )
+	{
+		memcpy(last_vertex.data(), vertices.data(), stride);
+	}
+	const std::array<uint8_t, 256> first_vertex = last_vertex;
+
+	const size_t block_size = GetVertexBlockSize(stride);
+	std::array<uint8_t, vertex_block_max_size> deltas;
+	for ( size_t block_start = 0; block_start < count; block_start += block_size )
+	{
+		const size_t vertex_count = std::min(block_size, count - block_start);
+		const size_t aligned_count = (vertex_count + byte_group_size - 1) & ~(byte_group_size - 1);
+		const uint8_t* const block = vertices.data() + block_start * stride;
+		for ( size_t k = 0; k < stride; ++k )
+		{
+			deltas.fill(0);
+			uint8_t previous = last_vertex[k];
+			for ( size_t i = 0; i < vertex_count; ++i )
+			{
+				deltas[i] = Zigzag8(static_cast<uint8_t>(block[i * stride + k] - previous));
+				previous = block[i * stride + k];
+			}
+			EncodeBytes(output, deltas.data(), aligned_count);
+		}
+		memcpy(last_vertex.data(), block + (vertex_count - 1) * stride, stride);
+	}
+
+	output.resize(output.size() + (stride < tail_max_size ? tail_max_size - stride : 0), 0);
+	output.insert(output.end(), first_vertex.begin(), first_vertex.begin() + stride);
+	return output;
+}
+
+std::vector<uint8_t> Anni::ModelLoader::Bench::MeshoptEncoder::EncodeIndexBuffer(const std::span<const uint32_t> indices)
+{
+	const size_t triangle_count = indices.size() / 3;
+	// header, one code per triangle, then the data stream
+	std::vector<uint8_t> codes(1 + triangle_count);
+	codes[0] = 0xE1;
+	std::vector<uint8_t> data;
+	data.reserve(triangle_count * 2);
+
+	IndexFifos fifos;
+	uint32_t next = 0;
+	uint32_t last = 0;
+	constexpr int fec_max = 13;
+	const auto encode_index = [&data, &last](const uint32_t index)
+	{
+		EncodeVByte(data, Zigzag32(index - last));
+		last = index;
+	};
+
+	for ( size_t triangle = 0; triangle < triangle_count; ++triangle )
+	{
+		const uint32_t* const triangle_indices = indices.data() + triangle * 3;
+		const int edge_match = fifos.FindEdge(triangle_indices[0], triangle_indices[1], triangle_indices[2]);
+		if ( edge_match >= 0 && (edge_match >> 2) < 15 )
+		{
+			// a and b are a known edge, c is the next new vertex, a recent one or a free index
+			const auto& order = triangle_rotations[edge_match & 3];
+			const uint32_t a = triangle_indices[order[0]];
+			const uint32_t b = triangle_indices[order[1]];
+			const uint32_t c = triangle_indices[order[2]];
+
+			const int fe = edge_match >> 2;
+			const int fc = fifos.FindVertex(c);
+			int fec = 15;
+			if ( fc >= 1 && fc < fec_max )
+			{
+				fec = fc;
+			}
+			else if ( c == next )
+			{
+				fec = 0;
+				++next;
+			}
+			else if ( c + 1 == last )
+			{
+				fec = 13;
+				last = c;
+			}
+			else if ( c == last + 1 )
+			{
+				fec = 14;
+				last = c;
+			}
+
+			codes[1 + triangle] = static_cast<uint8_t>((fe << 4) | fec);
+			if ( fec == 15 )
+			{
+				encode_index(c);
+			}
+			if ( fec == 0 || fec >= fec_max )
+			{
+				fifos.PushVertex(c);
+			}
+			fifos.PushEdge(c, b);
+			fifos.PushEdge(a, c);
+			continue;
+		}
+
+		// three vertices, rotated so that a is the next new one when possible
+		const uint32_t rotation = triangle_indices[1] == next ? 1 : (triangle_indices[2] == next ? 2 : 0);
+		const auto& order = triangle_rotations[rotation];
+		const uint32_t a = triangle_indices[order[0]];
+		const uint32_t b = triangle_indices[order[1]];
+		const uint32_t c = triangle_indices[order[2]];
+
+		const int fb = fifos.FindVertex(b);
+		const int fc = fifos.FindVertex(c);
+		const int fea = a == next ? (++next, 0) : 15;
+		const int feb = fb >= 0 && fb < 14 ? fb + 1 : (b == next ? (++next, 0) : 15);
+		const int fec = fc >= 0 && fc < 14 ? fc + 1 : (c == next ? (++next, 0) : 15);
+
+		const auto codeaux = static_cast<uint8_t>((feb << 4) | fec);
+		const auto table_entry = std::find(codeaux_table.begin(), codeaux_table.begin() + 14, codeaux);
+		// 0xF0 + table index when a is new and the pair is in the table, otherwise 0xFE/0xFF and the full byte
+		if ( fea == 0 && table_entry != codeaux_table.begin() + 14 )
+		{
+			codes[1 + triangle] = static_cast<uint8_t>(0xF0 | (table_entry - codeaux_table.begin()));
+		}
+		else
+		{
+			codes[1 + triangle] = static_cast<uint8_t>(0xFE | (fea == 15 ? 1 : 0));
+			data.push_back(codeaux);
+		}
+
+		if ( fea == 15 )
+		{
+			encode_index(a);
+		}
+		if ( feb == 15 )
+		{
+			encode_index(b);
+		}
+		if ( fec == 15 )
+		{
+			encode_index(c);
+		}
+		if ( fea == 0 || fea == 15 )
+		{
+			fifos.PushVertex(a);
+		}
+		if ( feb == 0 || feb == 15 )
+		{
+			fifos.PushVertex(b);
+		}
+		if ( fec == 0 || fec == 15 )
+		{
+			fifos.PushVertex(c);
+		}
+		fifos.PushEdge(b, a);
+		fifos.PushEdge(c, b);
+		fifos.PushEdge(a, c);
+	}
+
+	// the table doubles as the padding that lets the decoder read a whole triangle without bounds checks
+	codes.insert(codes.end(), data.begin(), data.end());
+	codes.insert(codes.end(), codeaux_table.begin(), codeaux_table.end());
+	return codes;
+}
+
+std::vector<uint8_t> Anni::ModelLoader::Bench::MeshoptEncoder::EncodeIndexSequence(const std::span<const uint32_t> indices)
+{
+	std::vector<uint8_t> output{ 0xD1 };
+	output.reserve(indices.size() + 5);
+	// each index is a delta against whichever of the two baselines is closer
+	std::array<uint32_t, 2> last{};
+	for ( const uint32_t index : indices )
+	{
+		const uint32_t delta0 = Zigzag32(index - last[0]);
+		const uint32_t delta1 = Zigzag32(index - last[1]);
+		const uint32_t baseline = delta1 < delta0 ? 1 : 0;
+		EncodeVByte(output, ((baseline ? delta1 : delta0) << 1) | baseline);
+		last[baseline] = index;
+	}
+	output.resize(output.size() + 4, 0);
+	return output;
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+
+namespace Anni::ModelLoader::Bench
+{
+	// the encoding side of MeshoptDecoder, for the EXT_meshopt_compression variants of the synthetic models. writes the
+	// bitstreams meshoptimizer does, minus its tuning for the last few percent of size
+	class MeshoptEncoder
+	{
+	public:
+		MeshoptEncoder() = delete;
+
+		// vertices holds whole elements of stride bytes, stride a multiple of 4 up to 256
+		static std::vector<uint8_t> EncodeVertexBuffer(std::span<const uint8_t> vertices, size_t stride);
+		// triangle list, index codec version 1
+		static std::vector<uint8_t> EncodeIndexBuffer(std::span<const uint32_t> indices);
+		static std::vector<uint8_t> EncodeIndexSequence(std::span<const uint32_t> indices);
+	};
+}
@@ -0,0 +1,607 @@
+#include "SyntheticGltf.h"
+#include "MeshoptEncoder.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <type_traits>
+
+
+namespace
+{
+	using namespace Anni::ModelLoader;
+	using namespace Anni::ModelLoader::Bench;
+
+	constexpr uint32_t gl_byte = 5120;
+	constexpr uint32_t gl_unsigned_byte = 5121;
+	constexpr uint32_t gl_short = 5122;
+	constexpr uint32_t gl_unsigned_short = 5123;
+	constexpr uint32_t gl_float = 5126;
+	constexpr uint32_t gl_unsigned_int = 5125;
+	constexpr uint32_t gl_array_buffer = 34962;
+	constexpr uint32_t gl_element_array_buffer = 34963;
+
+	// fully specified, the std distributions differ from one standard library to the next
+	class Random
+	{
+	public:
+		explicit Random(const uint64_t seed) :
+			m_state(seed)
+		{
+		}
+
+		// splitmix64
+		uint32_t NextU32()
+		{
+			uint64_t z = (m_state += 0x9E3779B97F4A7C15ull);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			return static_cast<uint32_t>((z ^ (z >> 31)) >> 32);
+		}
+
+		// [0, 1)
+		float NextFloat()
+		{
+			return static_cast<float>(NextU32() >> 8) * (1.f / 16777216.f);
+		}
+
+	private:
+		uint64_t m_state;
+	};
+
+	void AppendFloat(std::string& json, const float value)
+	{
+		std::array<char, 32> buffer{};
+		const auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+		json.append(buffer.data(), result.ptr);
+	}
+
+	void AppendNumber(std::string& json, const uint64_t value)
+	{
+		std::array<char, 24> buffer{};
+		const auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+		json.append(buffer.data(), result.ptr);
+	}
+
+	void AppendVector(std::string& json, const std::span<const float> values)
+	{
+		json += '[';
+		for ( size_t i = 0; i < values.size(); ++i )
+		{
+			if ( i )
+			{
+				json += ',';
+			}
+			AppendFloat(json, values[i]);
+		}
+		json += ']';
+	}
+
+	// comma separated entries of one top level array
+	void AppendEntry(std::string& list, const std::string& entry)
+	{
+		if ( !list.empty() )
+		{
+			list += ',';
+		}
+		list += entry;
+	}
+
+	// one binary buffer, every view starts 4 byte aligned. meshopt compressed views describe their decoded data in a second,
+	// fallback buffer that has a size but no bytes
+	struct BufferBuilder
+	{
+		std::vector<uint8_t> bytes;
+		size_t fallback_size{ 0 };
+		std::string buffer_views;
+		uint32_t view_count{ 0 };
+
+		uint32_t AddView(const void* data, const size_t size, const std::optional<uint32_t> target, const std::optional<uint32_t> byte_stride = std::nullopt)
+		{
+			bytes.resize((bytes.size() + 3) & ~size_t{ 3 }, 0);
+			const size_t offset = bytes.size();
+			bytes.resize(offset + size);
+			memcpy(bytes.data() + offset, data, size);
+
+			std::string view = "{\"buffer\":0,\"byteOffset\":";
+			AppendNumber(view, offset);
+			view += ",\"byteLength\":";
+			AppendNumber(view, size);
+			if ( byte_stride.has_value() )
+			{
+				view += ",\"byteStride\":";
+				AppendNumber(view, byte_stride.value());
+			}
+			if ( target.has_value() )
+			{
+				view += ",\"target\":";
+				AppendNumber(view, target.value());
+			}
+			view += '}';
+			AppendEntry(buffer_views, view);
+			return view_count++;
+		}
+
+		// encoded goes into the binary buffer, the view itself covers count * byte_stride bytes of the fallback buffer
+		uint32_t AddCompressedView(const std::span<const uint8_t> encoded, const size_t count, const uint32_t byte_stride, const uint32_t target)
+		{
+			bytes.resize((bytes.size() + 3) & ~size_t{ 3 }, 0);
+			const size_t offset = bytes.size();
+			bytes.insert(bytes.end(), encoded.begin(), encoded.end());
+			fallback_size = (fallback_size + 3) & ~size_t{ 3 };
+			const size_t fallback_offset = fallback_size;
+			fallback_size += count * byte_stride;
+
+			const bool attributes = target == gl_array_buffer;
+			std::string view = "{\"buffer\":1,\"byteOffset\":";
+			AppendNumber(view, fallback_offset);
+			view += ",\"byteLength\":";
+			AppendNumber(view, count * byte_stride);
+			if ( attributes )
+			{
+				view += ",\"byteStride\":";
+				AppendNumber(view, byte_stride);
+			}
+			view += ",\"target\":";
+			AppendNumber(view, target);
+			view += ",\"extensions\":{\"EXT_meshopt_compression\":{\"buffer\":0,\"byteOffset\":";
+			AppendNumber(view, offset);
+			view += ",\"byteLength\":";
+			AppendNumber(view, encoded.size());
+			view += ",\"byteStride\":";
+			AppendNumber(view, byte_stride);
+			view += ",\"count\":";
+			AppendNumber(view, count);
+			view += attributes ? ",\"mode\":\"ATTRIBUTES\"}}}" : ",\"mode\":\"TRIANGLES\"}}}";
+			AppendEntry(buffer_views, view);
+			return view_count++;
+		}
+	};
+
+	struct AccessorBuilder
+	{
+		std::string accessors;
+		uint32_t accessor_count{ 0 };
+
+		uint32_t Add(const uint32_t buffer_view, const uint32_t component_type, const bool normalized, const size_t count, const char* type, const std::span<const float> min = {}, const std::span<const float> max = {})
+		{
+			std::string accessor = "{\"bufferView\":";
+			AppendNumber(accessor, buffer_view);
+			accessor += ",\"componentType\":";
+			AppendNumber(accessor, component_type);
+			if ( normalized )
+			{
+				accessor += ",\"normalized\":true";
+			}
+			accessor += ",\"count\":";
+			AppendNumber(accessor, count);
+			accessor += ",\"type\":\"";
+			accessor += type;
+			accessor += '"';
+			if ( !min.empty() )
+			{
+				accessor += ",\"min\":";
+				AppendVector(accessor, min);
+				accessor += ",\"max\":";
+				AppendVector(accessor, max);
+			}
+			accessor += '}';
+			AppendEntry(accessors, accessor);
+			return accessor_count++;
+		}
+	};
+
+	// a vertex attribute's view, meshopt compressed or as is. quantized and compressed views give their stride, the float
+	// views of the plain model stay tightly packed without one
+	template <typename T>
+	uint32_t AddVertexView(const SyntheticModelDesc& desc, BufferBuilder& buffer, const std::vector<T>& values)
+	{
+		static_assert(sizeof(T) % 4 == 0);
+		const std::span<const uint8_t> bytes(reinterpret_cast<const uint8_t*>(values.data()), values.size() * sizeof(T));
+		if ( desc.meshopt_compression )
+		{
+			return buffer.AddCompressedView(MeshoptEncoder::EncodeVertexBuffer(bytes, sizeof(T)), values.size(), sizeof(T), gl_array_buffer);
+		}
+		return buffer.AddView(bytes.data(), bytes.size(), gl_array_buffer, desc.quantized ? std::optional<uint32_t>(sizeof(T)) : std::nullopt);
+	}
+
+	// the integer a normalized accessor stores for value, [-1, 1] for signed and [0, 1] for unsigned types
+	template <typename T>
+	T Quantize(const float value)
+	{
+		constexpr float lowest = std::is_signed_v<T> ? -1.f : 0.f;
+		return static_cast<T>(std::lround(std::clamp(value, lowest, 1.f) * static_cast<float>(std::numeric_limits<T>::max())));
+	}
+
+	template <typename T, size_t OutputSize, size_t InputSize>
+	std::vector<std::array<T, OutputSize>> QuantizeAll(const std::vector<std::array<float, InputSize>>& values)
+	{
+		std::vector<std::array<T, OutputSize>> quantized(values.size());
+		for ( size_t v = 0; v < values.size(); ++v )
+		{
+			for ( size_t component = 0; component < InputSize; ++component )
+			{
+				quantized[v][component] = Quantize<T>(values[v][component]);
+			}
+		}
+		return quantized;
+	}
+
+	// a slightly bumpy grid in the xz plane, one primitive
+	std::string WriteMesh(const SyntheticModelDesc& desc, const uint32_t mesh_index, const uint32_t material_index, BufferBuilder& buffer, AccessorBuilder& accessors)
+	{
+		Random random(desc.seed * 7919ull + mesh_index);
+		const uint32_t grid = std::max(desc.grid_size, 1u);
+		const uint32_t side = grid + 1;
+		const size_t vertex_count = static_cast<size_t>(side) * side;
+
+		std::vector<std::array<float, 3>> positions(vertex_count);
+		std::vector<std::array<float, 3>> normals(vertex_count);
+		std::vector<std::array<float, 4>> tangents(vertex_count);
+		std::vector<std::array<float, 2>> uvs(vertex_count);
+		std::vector<std::array<float, 4>> colors(vertex_count);
+		std::array<float, 3> position_min{ 0.f, 0.f, 0.f };
+		std::array<float, 3> position_max{ 0.f, 0.f, 0.f };
+		for ( uint32_t z = 0; z < side; ++z )
+		{
+			for ( uint32_t x = 0; x < side; ++x )
+			{
+				const size_t v = static_cast<size_t>(z) * side + x;
+				const float u = static_cast<float>(x) / static_cast<float>(grid);
+				const float w = static_cast<float>(z) / static_cast<float>(grid);
+				positions[v] = { u * 2.f - 1.f, random.NextFloat() * 0.05f, w * 2.f - 1.f };
+				const float tilt_x = random.NextFloat() * 0.2f - 0.1f;
+				const float tilt_z = random.NextFloat() * 0.2f - 0.1f;
+				const float length = std::sqrt(tilt_x * tilt_x + 1.f + tilt_z * tilt_z);
+				normals[v] = { tilt_x / length, 1.f / length, tilt_z / length };
+				tangents[v] = { 1.f, 0.f, 0.f, 1.f };
+				uvs[v] = { u, w };
+				colors[v] = { random.NextFloat(), random.NextFloat(), random.NextFloat(), 1.f };
+				for ( uint32_t axis = 0; axis < 3; ++axis )
+				{
+					position_min[axis] = v ? std::min(position_min[axis], positions[v][axis]) : positions[v][axis];
+					position_max[axis] = v ? std::max(position_max[axis], positions[v][axis]) : positions[v][axis];
+				}
+			}
+		}
+
+		std::vector<uint32_t> indices;
+		indices.reserve(static_cast<size_t>(grid) * grid * 6);
+		for ( uint32_t z = 0; z < grid; ++z )
+		{
+			for ( uint32_t x = 0; x < grid; ++x )
+			{
+				const uint32_t a = z * side + x;
+				const uint32_t b = a + 1;
+				const uint32_t c = a + side;
+				const uint32_t d = c + 1;
+				indices.insert(indices.end(), { a, c, b, b, c, d });
+			}
+		}
+
+		const uint32_t index_view = desc.meshopt_compression
+			? buffer.AddCompressedView(MeshoptEncoder::EncodeIndexBuffer(indices), indices.size(), sizeof(uint32_t), gl_element_array_buffer)
+			: buffer.AddView(indices.data(), indices.size() * sizeof(uint32_t), gl_element_array_buffer);
+		const uint32_t index_accessor = accessors.Add(index_view, gl_unsigned_int, false, indices.size(), "SCALAR");
+
+		std::string attributes = "\"POSITION\":";
+		const auto add_attribute = [&](const VertexLayout::AttributeBits bit, const char* semantic, const auto& values, const uint32_t component_type, const char* type)
+		{
+			if ( desc.attributes & bit )
+			{
+				attributes += ",\"";
+				attributes += semantic;
+				attributes += "\":";
+				AppendNumber(attributes, accessors.Add(AddVertexView(desc, buffer, values), component_type, component_type != gl_float, values.size(), type));
+			}
+		};
+		if ( desc.quantized )
+		{
+			// positions padded to 8 bytes, normals to 4, as vertex attributes have to be 4 byte aligned
+			const std::vector<std::array<int16_t, 4>> quantized_positions = QuantizeAll<int16_t, 4>(positions);
+			std::array<float, 3> quantized_min{};
+			std::array<float, 3> quantized_max{};
+			for ( uint32_t axis = 0; axis < 3; ++axis )
+			{
+				quantized_min[axis] = static_cast<float>(Quantize<int16_t>(position_min[axis]));
+				quantized_max[axis] = static_cast<float>(Quantize<int16_t>(position_max[axis]));
+			}
+			const uint32_t position_view = AddVertexView(desc, buffer, quantized_positions);
+			AppendNumber(attributes, accessors.Add(position_view, gl_short, true, positions.size(), "VEC3", quantized_min, quantized_max));
+
+			add_attribute(VertexLayout::Normal, "NORMAL", QuantizeAll<int8_t, 4>(normals), gl_byte, "VEC3");
+			add_attribute(VertexLayout::Tangent, "TANGENT", QuantizeAll<int8_t, 4>(tangents), gl_byte, "VEC4");
+			add_attribute(VertexLayout::Uv, "TEXCOORD_0", QuantizeAll<uint16_t, 2>(uvs), gl_unsigned_short, "VEC2");
+			add_attribute(VertexLayout::Color, "COLOR_0", QuantizeAll<uint8_t, 4>(colors), gl_unsigned_byte, "VEC4");
+		}
+		else
+		{
+			const uint32_t position_view = AddVertexView(desc, buffer, positions);
+			AppendNumber(attributes, accessors.Add(position_view, gl_float, false, positions.size(), "VEC3", position_min, position_max));
+
+			add_attribute(VertexLayout::Normal, "NORMAL", normals, gl_float, "VEC3");
+			add_attribute(VertexLayout::Tangent, "TANGENT", tangents, gl_float, "VEC4");
+			add_attribute(VertexLayout::Uv, "TEXCOORD_0", uvs, gl_float, "VEC2");
+			add_attribute(VertexLayout::Color, "COLOR_0", colors, gl_float, "VEC4");
+		}
+
+		std::string mesh = "{\"name\":\"mesh_";
+		AppendNumber(mesh, mesh_index);
+		mesh += "\",\"primitives\":[{\"attributes\":{";
+		mesh += attributes;
+		mesh += "},\"indices\":";
+		AppendNumber(mesh, index_accessor);
+		mesh += ",\"material\":";
+		AppendNumber(mesh, material_index);
+		mesh += "}]}";
+		return mesh;
+	}
+
+	// checker board over a gradient with a little noise, so the png isn't trivially uniform
+	std::vector<uint8_t> MakeTexturePixels(const SyntheticModelDesc& desc, const uint32_t texture_index)
+	{
+		Random random(desc.seed * 104729ull + texture_index);
+		const uint32_t size = std::max(desc.texture_size, 1u);
+		std::vector<uint8_t> rgba(static_cast<size_t>(size) * size * 4);
+		for ( uint32_t y = 0; y < size; ++y )
+		{
+			for ( uint32_t x = 0; x < size; ++x )
+			{
+				const bool checker = ((x / 8) + (y / 8) + texture_index) % 2 == 0;
+				const uint32_t noise = random.NextU32() & 15;
+				uint8_t* pixel = rgba.data() + (static_cast<size_t>(y) * size + x) * 4;
+				pixel[0] = static_cast<uint8_t>((checker ? 192 : 64) + noise);
+				pixel[1] = static_cast<uint8_t>(x * 255 / size);
+				pixel[2] = static_cast<uint8_t>(y * 255 / size);
+				pixel[3] = 255;
+			}
+		}
+		return rgba;
+	}
+
+	std::array<uint32_t, 256> MakeCrcTable()
+	{
+		std::array<uint32_t, 256> table{};
+		for ( uint32_t n = 0; n < 256; ++n )
+		{
+			uint32_t c = n;
+			for ( int k = 0; k < 8; ++k )
+			{
+				c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			}
+			table[n] = c;
+		}
+		return table;
+	}
+
+	uint32_t Crc32(const std::span<const uint8_t> bytes)
+	{
+		static const std::array<uint32_t, 256> table = MakeCrcTable();
+		uint32_t crc = 0xFFFFFFFFu;
+		for ( const uint8_t byte : bytes )
+		{
+			crc = table[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+		}
+		return crc ^ 0xFFFFFFFFu;
+	}
+
+	void AppendBigEndian(std::vector<uint8_t>& bytes, const uint32_t value)
+	{
+		bytes.insert(bytes.end(), { static_cast<uint8_t>(value >> 24), static_cast<uint8_t>(value >> 16), static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value) });
+	}
+
+	void AppendLittleEndian(std::vector<uint8_t>& bytes, const uint32_t value)
+	{
+		bytes.insert(bytes.end(), { static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value >> 16), static_cast<uint8_t>(value >> 24) });
+	}
+
+	void AppendPngChunk(std::vector<uint8_t>& png, const char (&type)[5], const std::span<const uint8_t> data)
+	{
+		AppendBigEndian(png, static_cast<uint32_t>(data.size()));
+		const size_t type_offset = png.size();
+		png.insert(png.end(), type, type + 4);
+		png.insert(png.end(), data.begin(), data.end());
+		AppendBigEndian(png, Crc32(std::span<const uint8_t>(png).subspan(type_offset)));
+	}
+
+	void WriteFile(const std::filesystem::path& path, const std::span<const uint8_t> bytes)
+	{
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+		if ( !file )
+		{
+			SPDLOG_ERROR("Failed to write synthetic model file: {}", path.string());
+			std::exit(EXIT_FAILURE); // or std::exit(1);
+		}
+	}
+}
+
+
+std::filesystem::path Anni::ModelLoader::Bench::SyntheticGltf::Write(const SyntheticModelDesc& desc, const std::filesystem::path& directory)
+{
+	std::filesystem::create_directories(directory);
+
+	BufferBuilder buffer;
+	AccessorBuilder accessors;
+
+	//> MESHES
+	const uint32_t material_count = std::max(desc.texture_count, 1u);
+	std::string meshes;
+	for ( uint32_t mesh_index = 0; mesh_index < desc.mesh_count; ++mesh_index )
+	{
+		AppendEntry(meshes, WriteMesh(desc, mesh_index, mesh_index % material_count, buffer, accessors));
+	}
+
+	//> IMAGES, TEXTURES AND MATERIALS
+	std::string images;
+	std::string textures;
+	std::string materials;
+	for ( uint32_t texture_index = 0; texture_index < desc.texture_count; ++texture_index )
+	{
+		const uint32_t size = std::max(desc.texture_size, 1u);
+		const std::vector<uint8_t> png = SyntheticGltf::EncodePng(size, size, MakeTexturePixels(desc, texture_index));
+		std::string image;
+		if ( desc.binary )
+		{
+			image = "{\"bufferView\":";
+			AppendNumber(image, buffer.AddView(png.data(), png.size(), std::nullopt));
+			image += ",\"mimeType\":\"image/png\"}";
+		}
+		else
+		{
+			const std::string image_name = desc.name + "_texture_" + std::to_string(texture_index) + ".png";
+			WriteFile(directory / image_name, png);
+			image = "{\"uri\":\"" + image_name + "\"}";
+		}
+		AppendEntry(images, image);
+		AppendEntry(textures, "{\"sampler\":0,\"source\":" + std::to_string(texture_index) + "}");
+		AppendEntry(materials, "{\"pbrMetallicRoughness\":{\"baseColorTexture\":{\"index\":" + std::to_string(texture_index) + "},\"metallicFactor\":0,\"roughnessFactor\":1}}");
+	}
+	if ( materials.empty() )
+	{
+		materials = "{\"pbrMetallicRoughness\":{\"baseColorFactor\":[1,1,1,1]}}";
+	}
+
+	//> NODES
+	// a tree with up to 4 children per node, node 0 is the root
+	Random random(desc.seed * 15485863ull);
+	const uint32_t node_count = std::max(desc.node_count, 1u);
+	std::string nodes;
+	for ( uint32_t node_index = 0; node_index < node_count; ++node_index )
+	{
+		std::string node = "{\"mesh\":";
+		AppendNumber(node, desc.mesh_count ? node_index % desc.mesh_count : 0);
+		const std::array<float, 3> translation{ random.NextFloat() * 20.f - 10.f, random.NextFloat() * 2.f - 1.f, random.NextFloat() * 20.f - 10.f };
+		node += ",\"translation\":";
+		AppendVector(node, translation);
+		std::string children;
+		for ( uint64_t child = node_index * 4ull + 1; child <= node_index * 4ull + 4 && child < node_count; ++child )
+		{
+			AppendEntry(children, std::to_string(child));
+		}
+		if ( !children.empty() )
+		{
+			node += ",\"children\":[" + children + "]";
+		}
+		node += '}';
+		AppendEntry(nodes, node);
+	}
+
+	//> DOCUMENT
+	buffer.bytes.resize((buffer.bytes.size() + 3) & ~size_t{ 3 }, 0);
+	const std::filesystem::path file_path = directory / (desc.name + (desc.binary ? ".glb" : ".gltf"));
+	const std::string bin_name = desc.name + ".bin";
+
+	std::string json = "{\"asset\":{\"version\":\"2.0\",\"generator\":\"ModelsLoaderBench\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}]";
+	json += ",\"nodes\":[" + nodes + "]";
+	if ( desc.mesh_count )
+	{
+		json += ",\"meshes\":[" + meshes + "]";
+	}
+	json += ",\"materials\":[" + materials + "]";
+	if ( desc.texture_count )
+	{
+		json += ",\"samplers\":[{\"magFilter\":9729,\"minFilter\":9987,\"wrapS\":10497,\"wrapT\":10497}]";
+		json += ",\"images\":[" + images + "]";
+		json += ",\"textures\":[" + textures + "]";
+	}
+	json += ",\"accessors\":[" + accessors.accessors + "]";
+	json += ",\"bufferViews\":[" + buffer.buffer_views + "]";
+	json += ",\"buffers\":[{\"byteLength\":" + std::to_string(buffer.bytes.size());
+	json += desc.binary ? std::string("}") : ",\"uri\":\"" + bin_name + "\"}";
+	if ( buffer.fallback_size )
+	{
+		json += ",{\"byteLength\":" + std::to_string(buffer.fallback_size) + ",\"extensions\":{\"EXT_meshopt_compression\":{\"fallback\":true}}}";
+	}
+	json += ']';
+	std::string extensions;
+	if ( desc.quantized && desc.mesh_count )
+	{
+		AppendEntry(extensions, "\"KHR_mesh_quantization\"");
+	}
+	if ( buffer.fallback_size )
+	{
+		AppendEntry(extensions, "\"EXT_meshopt_compression\"");
+	}
+	if ( !extensions.empty() )
+	{
+		json += ",\"extensionsUsed\":[" + extensions + "],\"extensionsRequired\":[" + extensions + "]";
+	}
+	json += '}';
+
+	if ( !desc.binary )
+	{
+		WriteFile(directory / bin_name, buffer.bytes);
+		WriteFile(file_path, std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(json.data()), json.size()));
+		return file_path;
+	}
+
+	// header, JSON chunk padded with spaces, BIN chunk padded with zeros
+	json.resize((json.size() + 3) & ~size_t{ 3 }, ' ');
+	std::vector<uint8_t> glb;
+	glb.reserve(12 + 8 + json.size() + 8 + buffer.bytes.size());
+	AppendLittleEndian(glb, 0x46546C67u);
+	AppendLittleEndian(glb, 2);
+	AppendLittleEndian(glb, static_cast<uint32_t>(12 + 8 + json.size() + 8 + buffer.bytes.size()));
+	AppendLittleEndian(glb, static_cast<uint32_t>(json.size()));
+	AppendLittleEndian(glb, 0x4E4F534Au);
+	glb.insert(glb.end(), json.begin(), json.end());
+	AppendLittleEndian(glb, static_cast<uint32_t>(buffer.bytes.size()));
+	AppendLittleEndian(glb, 0x004E4942u);
+	glb.insert(glb.end(), buffer.bytes.begin(), buffer.bytes.end());
+	WriteFile(file_path, glb);
+	return file_path;
+}
+
+std::vector<uint8_t> Anni::ModelLoader::Bench::SyntheticGltf::EncodePng(const uint32_t width, const uint32_t height, const std::span<const uint8_t> rgba)
+{
+	// every row starts with filter type 0
+	const size_t row_size = static_cast<size_t>(width) * 4;
+	std::vector<uint8_t> scanlines;
+	scanlines.reserve((row_size + 1) * height);
+	for ( uint32_t y = 0; y < height; ++y )
+	{
+		scanlines.push_back(0);
+		scanlines.insert(scanlines.end(), rgba.begin() + y * row_size, rgba.begin() + (y + 1) * row_size);
+	}
+
+	// zlib stream of stored blocks
+	std::vector<uint8_t> zlib{ 0x78, 0x01 };
+	constexpr size_t max_block_size = 65535;
+	size_t offset = 0;
+	do
+	{
+		const size_t block_size = std::min(max_block_size, scanlines.size() - offset);
+		const bool last_block = offset + block_size == scanlines.size();
+		zlib.push_back(last_block ? 1 : 0);
+		zlib.insert(zlib.end(), { static_cast<uint8_t>(block_size), static_cast<uint8_t>(block_size >> 8),
+			static_cast<uint8_t>(~block_size), static_cast<uint8_t>(~block_size >> 8) });
+		zlib.insert(zlib.end(), scanlines.begin() + offset, scanlines.begin() + offset + block_size);
+		offset += block_size;
+	} while ( offset < scanlines.size() );
+
+	uint32_t adler_a = 1;
+	uint32_t adler_b = 0;
+	for ( const uint8_t byte : scanlines )
+	{
+		adler_a = (adler_a + byte) % 65521;
+		adler_b = (adler_b + adler_a) % 65521;
+	}
+	AppendBigEndian(zlib, (adler_b << 16) | adler_a);
+
+	std::vector<uint8_t> png{ 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	std::vector<uint8_t> header;
+	AppendBigEndian(header, width);
+	AppendBigEndian(header, height);
+	// 8 bit RGBA, deflate, adaptive filtering, no interlace
+	header.insert(header.end(), { 8, 6, 0, 0, 0 });
+	AppendPngChunk(png, "IHDR", header);
+	AppendPngChunk(png, "IDAT", zlib);
+	AppendPngChunk(png, "IEND", {});
+	return png;
+}
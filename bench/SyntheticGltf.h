@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "ModelsLoader.h"
+
+
+namespace Anni::ModelLoader::Bench
+{
+	// everything a synthetic model varies. the same description always produces the same bytes
+	struct SyntheticModelDesc
+	{
+		std::string name{ "synthetic" };
+		uint32_t mesh_count{ 1 };
+		// quads per side of every mesh's grid, a mesh has (grid_size + 1)^2 vertices and 2 * grid_size^2 triangles
+		uint32_t grid_size{ 64 };
+		// meshes are handed out to the nodes round robin, the nodes form a tree with up to 4 children each
+		uint32_t node_count{ 1 };
+		// VertexLayout::AttributeBits written besides the position
+		uint32_t attributes{ VertexLayout::All };
+		// one material per texture(at least one), used as its base color
+		uint32_t texture_count{ 0 };
+		uint32_t texture_size{ 256 };
+		// .glb with the buffer and the images embedded, instead of .gltf + .bin + .png files
+		bool binary{ false };
+		// KHR_mesh_quantization: normalized 16 bit positions and texture coordinates, 8 bit normals, tangents and colors
+		bool quantized{ false };
+		// EXT_meshopt_compression on every vertex and index buffer view
+		bool meshopt_compression{ false };
+		uint32_t seed{ 1 };
+	};
+
+	class SyntheticGltf
+	{
+	public:
+		SyntheticGltf() = delete;
+
+		// writes the model and its side files into directory, returns the path of the .gltf/.glb
+		static std::filesystem::path Write(const SyntheticModelDesc& desc, const std::filesystem::path& directory);
+
+		// RGBA8 png with stored(uncompressed) deflate blocks, the decoder still goes through inflate and unfiltering
+		static std::vector<uint8_t> EncodePng(uint32_t width, uint32_t height, std::span<const uint8_t> rgba);
+	};
+}
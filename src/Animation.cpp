@@ -0,0 +1,671 @@
+#include "Animation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <unordered_map>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define ANNI_MODELS_LOADER_SSE 1
+#endif
+
+
+namespace
+{
+	using namespace Anni::ModelLoader;
+
+	// linear keys a cubic spline segment is resampled into
+	constexpr uint32_t cubic_spline_steps = 4;
+
+	//> KEY LOOKUP
+	// the two keys around a time, relative to the channel's first key
+	struct KeySegment
+	{
+		uint32_t from;
+		uint32_t to;
+		float t;
+	};
+
+	KeySegment FindSegment(const LoadedAnimation& animation, const AnimationChannel& channel, const float time)
+	{
+		const float* const times = animation.times.data() + channel.first_key;
+		const uint32_t last_key = channel.key_count - 1;
+		if ( channel.key_count <= 1 || time <= times[0] )
+		{
+			return { 0, 0, 0.f };
+		}
+		if ( time >= times[last_key] )
+		{
+			return { last_key, last_key, 0.f };
+		}
+
+		const auto to = static_cast<uint32_t>(std::upper_bound(times, times + channel.key_count, time) - times);
+		const uint32_t from = to - 1;
+		if ( channel.interpolation == AnimationChannel::Interpolation::Step )
+		{
+			return { from, from, 0.f };
+		}
+		const float key_distance = times[to] - times[from];
+		return { from, to, key_distance > 0.f ? (time - times[from]) / key_distance : 0.f };
+	}
+
+	const float* GetKeyValues(const LoadedAnimation& animation, const AnimationChannel& channel, const uint32_t key)
+	{
+		return animation.values.data() + channel.first_value + static_cast<size_t>(key) * channel.component_count;
+	}
+
+	//> BATCHED INTERPOLATION
+	// up to four channels of the same kind, component major so every component of the four is one SSE register.
+	// unused lanes hold an identity quaternion, normalizing them stays finite
+	template <typename Target>
+	struct ChannelBatch
+	{
+		alignas(16) std::array<std::array<float, 4>, 4> from;
+		alignas(16) std::array<std::array<float, 4>, 4> to;
+		alignas(16) std::array<float, 4> t;
+		std::array<Target*, 4> targets;
+		uint32_t count;
+
+		ChannelBatch()
+		{
+			Reset();
+		}
+
+		void Reset()
+		{
+			for ( uint32_t component = 0; component < 4; ++component )
+			{
+				from[component].fill(component == 3 ? 1.f : 0.f);
+				to[component].fill(component == 3 ? 1.f : 0.f);
+			}
+			t.fill(0.f);
+			count = 0;
+		}
+
+		// true once the batch is full
+		bool Add(const float* from_values, const float* to_values, const float lane_t, Target* target, const uint32_t component_count)
+		{
+			for ( uint32_t component = 0; component < component_count; ++component )
+			{
+				from[component][count] = from_values[component];
+				to[component][count] = to_values[component];
+			}
+			t[count] = lane_t;
+			targets[count] = target;
+			return ++count == AnimationSampler::batch_size;
+		}
+	};
+
+	void InterpolateVectors(ChannelBatch<glm::vec3>& batch)
+	{
+#if defined(ANNI_MODELS_LOADER_SSE)
+		const __m128 t = _mm_load_ps(batch.t.data());
+		for ( uint32_t component = 0; component < 3; ++component )
+		{
+			const __m128 from = _mm_load_ps(batch.from[component].data());
+			const __m128 to = _mm_load_ps(batch.to[component].data());
+			_mm_store_ps(batch.from[component].data(), _mm_add_ps(from, _mm_mul_ps(_mm_sub_ps(to, from), t)));
+		}
+#else
+		for ( uint32_t component = 0; component < 3; ++component )
+		{
+			for ( uint32_t lane = 0; lane < 4; ++lane )
+			{
+				batch.from[component][lane] += (batch.to[component][lane] - batch.from[component][lane]) * batch.t[lane];
+			}
+		}
+#endif
+		for ( uint32_t lane = 0; lane < batch.count; ++lane )
+		{
+			*batch.targets[lane] = glm::vec3(batch.from[0][lane], batch.from[1][lane], batch.from[2][lane]);
+		}
+		batch.Reset();
+	}
+
+	// nlerp along the shorter arc with the parameter bent towards constant angular speed, the polynomial fit from
+	// https://zeux.io/2015/07/23/approximating-slerp/. no acos/sin per channel and branch free across the lanes
+	void InterpolateRotations(ChannelBatch<glm::quat>& batch)
+	{
+#if defined(ANNI_MODELS_LOADER_SSE)
+		const __m128 t = _mm_load_ps(batch.t.data());
+		__m128 from[4];
+		__m128 to[4];
+		for ( uint32_t component = 0; component < 4; ++component )
+		{
+			from[component] = _mm_load_ps(batch.from[component].data());
+			to[component] = _mm_load_ps(batch.to[component].data());
+		}
+
+		__m128 cos_angle = _mm_mul_ps(from[0], to[0]);
+		for ( uint32_t component = 1; component < 4; ++component )
+		{
+			cos_angle = _mm_add_ps(cos_angle, _mm_mul_ps(from[component], to[component]));
+		}
+		// q and -q are the same rotation, flipping the target by the sign of the dot product takes the shorter way
+		const __m128 sign_mask = _mm_set1_ps(-0.f);
+		const __m128 flip = _mm_and_ps(cos_angle, sign_mask);
+		const __m128 d = _mm_andnot_ps(sign_mask, cos_angle);
+
+		const __m128 a = _mm_add_ps(_mm_set1_ps(1.0904f), _mm_mul_ps(d, _mm_add_ps(_mm_set1_ps(-3.2452f), _mm_mul_ps(d, _mm_sub_ps(_mm_set1_ps(3.55645f), _mm_mul_ps(d, _mm_set1_ps(1.43519f)))))));
+		const __m128 b = _mm_add_ps(_mm_set1_ps(0.848013f), _mm_mul_ps(d, _mm_add_ps(_mm_set1_ps(-1.06021f), _mm_mul_ps(d, _mm_set1_ps(0.215638f)))));
+		const __m128 t_centered = _mm_sub_ps(t, _mm_set1_ps(0.5f));
+		const __m128 k = _mm_add_ps(_mm_mul_ps(a, _mm_mul_ps(t_centered, t_centered)), b);
+		const __m128 corrected_t = _mm_add_ps(t, _mm_mul_ps(_mm_mul_ps(t, t_centered), _mm_mul_ps(_mm_sub_ps(t, _mm_set1_ps(1.f)), k)));
+
+		__m128 result[4];
+		__m128 length_squared = _mm_setzero_ps();
+		for ( uint32_t component = 0; component < 4; ++component )
+		{
+			const __m128 target = _mm_xor_ps(to[component], flip);
+			result[component] = _mm_add_ps(from[component], _mm_mul_ps(_mm_sub_ps(target, from[component]), corrected_t));
+			length_squared = _mm_add_ps(length_squared, _mm_mul_ps(result[component], result[component]));
+		}
+		const __m128 inverse_length = _mm_div_ps(_mm_set1_ps(1.f), _mm_sqrt_ps(length_squared));
+		for ( uint32_t component = 0; component < 4; ++component )
+		{
+			_mm_store_ps(batch.from[component].data(), _mm_mul_ps(result[component], inverse_length));
+		}
+#else
+		for ( uint32_t lane = 0; lane < 4; ++lane )
+		{
+			float cos_angle = 0.f;
+			for ( uint32_t component = 0; component < 4; ++component )
+			{
+				cos_angle += batch.from[component][lane] * batch.to[component][lane];
+			}
+			const float flip = cos_angle < 0.f ? -1.f : 1.f;
+			const float d = std::abs(cos_angle);
+
+			const float a = 1.0904f + d * (-3.2452f + d * (3.55645f - d * 1.43519f));
+			const float b = 0.848013f + d * (-1.06021f + d * 0.215638f);
+			const float t = batch.t[lane];
+			const float k = a * (t - 0.5f) * (t - 0.5f) + b;
+			const float corrected_t = t + t * (t - 0.5f) * (t - 1.f) * k;
+
+			float length_squared = 0.f;
+			for ( uint32_t component = 0; component < 4; ++component )
+			{
+				float& value = batch.from[component][lane];
+				value += (batch.to[component][lane] * flip - value) * corrected_t;
+				length_squared += value * value;
+			}
+			const float inverse_length = 1.f / std::sqrt(length_squared);
+			for ( uint32_t component = 0; component < 4; ++component )
+			{
+				batch.from[component][lane] *= inverse_length;
+			}
+		}
+#endif
+		for ( uint32_t lane = 0; lane < batch.count; ++lane )
+		{
+			*batch.targets[lane] = glm::quat(batch.from[3][lane], batch.from[0][lane], batch.from[1][lane], batch.from[2][lane]);
+		}
+		batch.Reset();
+	}
+
+	//> LOADING HELPERS
+	// every component of every element, normalized integers(e.g. quantized rotations) come out as [-1, 1] or [0, 1] floats
+	std::vector<float> ReadAccessorFloats(const fastgltf::Asset& gltf_asset, const fastgltf::Accessor& accessor, const uint32_t component_count)
+	{
+		std::vector<float> values(accessor.count * component_count);
+		switch ( component_count )
+		{
+			case 1:
+				fastgltf::iterateAccessorWithIndex<float>(gltf_asset, accessor, [&](const float v, const size_t index)
+				{
+					values[index] = v;
+				});
+				break;
+			case 3:
+				fastgltf::iterateAccessorWithIndex<fastgltf::math::vec<float, 3>>(gltf_asset, accessor, [&](const fastgltf::math::vec<float, 3> v, const size_t index)
+				{
+					for ( uint32_t component = 0; component < 3; ++component )
+					{
+						values[index * 3 + component] = v[component];
+					}
+				});
+				break;
+			case 4:
+				fastgltf::iterateAccessorWithIndex<fastgltf::math::vec<float, 4>>(gltf_asset, accessor, [&](const fastgltf::math::vec<float, 4> v, const size_t index)
+				{
+					for ( uint32_t component = 0; component < 4; ++component )
+					{
+						values[index * 4 + component] = v[component];
+					}
+				});
+				break;
+			default:
+				values.clear();
+				break;
+		}
+		return values;
+	}
+
+	AnimationChannel::Path ToChannelPath(const fastgltf::AnimationPath path)
+	{
+		switch ( path )
+		{
+			case fastgltf::AnimationPath::Rotation:
+				return AnimationChannel::Path::Rotation;
+			case fastgltf::AnimationPath::Scale:
+				return AnimationChannel::Path::Scale;
+			case fastgltf::AnimationPath::Weights:
+				return AnimationChannel::Path::Weights;
+			default:
+				return AnimationChannel::Path::Translation;
+		}
+	}
+
+	// cubic spline outputs are [in tangent, value, out tangent] per key. every segment becomes cubic_spline_steps linear ones,
+	// close enough for playback and it keeps the sampler down to step and linear keys
+	void ResampleCubicSpline(std::span<const float> times, std::span<const float> values, const uint32_t component_count, const bool normalize,
+		std::vector<float>& resampled_times, std::vector<float>& resampled_values)
+	{
+		const size_t key_count = times.size();
+		const auto key_value = [&](const size_t key, const size_t part, const uint32_t component)
+		{
+			return values[(key * 3 + part) * component_count + component];
+		};
+
+		resampled_times.clear();
+		resampled_values.clear();
+		resampled_times.reserve((key_count - 1) * cubic_spline_steps + 1);
+		resampled_values.reserve(((key_count - 1) * cubic_spline_steps + 1) * component_count);
+		for ( size_t key = 0; key < key_count; ++key )
+		{
+			const uint32_t steps = key + 1 < key_count ? cubic_spline_steps : 1;
+			const float key_distance = key + 1 < key_count ? times[key + 1] - times[key] : 0.f;
+			for ( uint32_t step = 0; step < steps; ++step )
+			{
+				const float s = static_cast<float>(step) / static_cast<float>(steps);
+				const float s2 = s * s;
+				const float s3 = s2 * s;
+				const float h00 = 2.f * s3 - 3.f * s2 + 1.f;
+				const float h10 = s3 - 2.f * s2 + s;
+				const float h01 = -2.f * s3 + 3.f * s2;
+				const float h11 = s3 - s2;
+
+				resampled_times.push_back(times[key] + key_distance * s);
+				const size_t first_value = resampled_values.size();
+				float length_squared = 0.f;
+				for ( uint32_t component = 0; component < component_count; ++component )
+				{
+					float value = h00 * key_value(key, 1, component);
+					if ( step > 0 )
+					{
+						value += h10 * key_distance * key_value(key, 2, component) + h01 * key_value(key + 1, 1, component) + h11 * key_distance * key_value(key + 1, 0, component);
+					}
+					resampled_values.push_back(value);
+					length_squared += value * value;
+				}
+				if ( normalize && length_squared > 0.f )
+				{
+					const float inverse_length = 1.f / std::sqrt(length_squared);
+					for ( uint32_t component = 0; component < component_count; ++component )
+					{
+						resampled_values[first_value + component] *= inverse_length;
+					}
+				}
+			}
+		}
+	}
+
+	// nodes whose weights are animated without defaults in the file start at 0
+	void ReserveMorphWeights(AnimationPose& pose, const uint32_t node_index, const uint32_t weight_count)
+	{
+		const uint32_t first_weight = pose.first_morph_weights[node_index];
+		const uint32_t current_count = pose.first_morph_weights[node_index + 1] - first_weight;
+		if ( current_count >= weight_count )
+		{
+			return;
+		}
+		const uint32_t added_count = weight_count - current_count;
+		pose.morph_weights.insert(pose.morph_weights.begin() + first_weight + current_count, added_count, 0.f);
+		for ( size_t i = node_index + 1; i < pose.first_morph_weights.size(); ++i )
+		{
+			pose.first_morph_weights[i] += added_count;
+		}
+	}
+}
+
+
+namespace Anni::ModelLoader
+{
+	LoadResult<void> LoadedModel::Factory::LoadSkins(const fastgltf::Asset& gltf_asset, std::unique_ptr<LoadedModel>& loading_result)
+	{
+		const size_t node_count = gltf_asset.nodes.size();
+		loading_result->m_skins.reserve(gltf_asset.skins.size());
+		for ( auto [skin_index, skin] : std::ranges::views::enumerate(gltf_asset.skins) )
+		{
+			LoadedSkin& loaded_skin = loading_result->m_skins.emplace_back();
+			loaded_skin.name = std::string(skin.name);
+
+			loaded_skin.joint_nodes.reserve(skin.joints.size());
+			for ( const size_t joint : skin.joints )
+			{
+				if ( joint >= node_count )
+				{
+					return std::unexpected(LoadError{ LoadError::Code::InvalidAnimation, "Skin " + std::to_string(skin_index) + " references a missing joint node." });
+				}
+				loaded_skin.joint_nodes.push_back(static_cast<uint32_t>(joint));
+			}
+			if ( skin.skeleton.has_value() )
+			{
+				if ( skin.skeleton.value() >= node_count )
+				{
+					return std::unexpected(LoadError{ LoadError::Code::InvalidAnimation, "Skin " + std::to_string(skin_index) + " references a missing skeleton node." });
+				}
+				loaded_skin.skeleton_node = static_cast<uint32_t>(skin.skeleton.value());
+			}
+
+			loaded_skin.inverse_bind_matrices.assign(skin.joints.size(), glm::mat4(1.f));
+			if ( skin.inverseBindMatrices.has_value() )
+			{
+				const fastgltf::Accessor& accessor = gltf_asset.accessors[skin.inverseBindMatrices.value()];
+				if ( accessor.count < skin.joints.size() )
+				{
+					return std::unexpected(LoadError{ LoadError::Code::InvalidAnimation, "Skin " + std::to_string(skin_index) + " has fewer inverse bind matrices than joints." });
+				}
+				fastgltf::iterateAccessorWithIndex<fastgltf::math::fmat4x4>(gltf_asset, accessor, [&](const fastgltf::math::fmat4x4& matrix, const size_t index)
+				{
+					if ( index < loaded_skin.inverse_bind_matrices.size() )
+					{
+						memcpy(&loaded_skin.inverse_bind_matrices[index], matrix.data(), sizeof(matrix));
+					}
+				});
+			}
+		}
+		return {};
+	}
+
+	LoadResult<void> LoadedModel::Factory::LoadAnimations(const fastgltf::Asset& gltf_asset, std::unique_ptr<LoadedModel>& loading_result)
+	{
+		const size_t node_count = gltf_asset.nodes.size();
+		std::vector<float> resampled_times;
+		std::vector<float> resampled_values;
+
+		loading_result->m_animations.reserve(gltf_asset.animations.size());
+		for ( auto [animation_index, animation] : std::ranges::views::enumerate(gltf_asset.animations) )
+		{
+			LoadedAnimation& loaded_animation = loading_result->m_animations.emplace_back();
+			loaded_animation.name = std::string(animation.name);
+			const auto invalid_channel = [animation_index](const size_t channel_index, const std::string& reason)
+			{
+				return std::unexpected(LoadError{ LoadError::Code::InvalidAnimation,
+					"Channel " + std::to_string(channel_index) + " of animation " + std::to_string(animation_index) + " " + reason });
+			};
+
+			// the keys of every input accessor go in once, keyed by accessor index * 2 + 1 for resampled cubic splines
+			std::unordered_map<size_t, uint32_t> shared_keys;
+			loaded_animation.channels.reserve(animation.channels.size());
+			for ( auto [channel_index, channel] : std::ranges::views::enumerate(animation.channels) )
+			{
+				// targets outside of the node hierarchy(e.g. KHR_animation_pointer) are not supported
+				if ( !channel.nodeIndex.has_value() )
+				{
+					continue;
+				}
+				if ( channel.nodeIndex.value() >= node_count || channel.samplerIndex >= animation.samplers.size() )
+				{
+					return invalid_channel(channel_index, "references a missing node or sampler.");
+				}
+
+				const fastgltf::AnimationSampler& sampler = animation.samplers[channel.samplerIndex];
+				const fastgltf::Accessor& input = gltf_asset.accessors[sampler.inputAccessor];
+				const fastgltf::Accessor& output = gltf_asset.accessors[sampler.outputAccessor];
+				const bool cubic = sampler.interpolation == fastgltf::AnimationInterpolation::CubicSpline;
+				const size_t values_per_key = cubic ? 3 : 1;
+
+				AnimationChannel loaded_channel{};
+				loaded_channel.target_node = static_cast<uint32_t>(channel.nodeIndex.value());
+				loaded_channel.path = ToChannelPath(channel.path);
+				loaded_channel.interpolation = sampler.interpolation == fastgltf::AnimationInterpolation::Step ? AnimationChannel::Interpolation::Step : AnimationChannel::Interpolation::Linear;
+				switch ( loaded_channel.path )
+				{
+					case AnimationChannel::Path::Rotation:
+						loaded_channel.component_count = 4;
+						break;
+					case AnimationChannel::Path::Weights:
+						// scalar outputs, one per morph target and key
+						loaded_channel.component_count = input.count ? static_cast<uint16_t>(output.count / (input.count * values_per_key)) : 0;
+						break;
+					default:
+						loaded_channel.component_count = 3;
+						break;
+				}
+
+				const size_t output_elements = loaded_channel.path == AnimationChannel::Path::Weights ? input.count * values_per_key * loaded_channel.component_count : input.count * values_per_key;
+				if ( input.count == 0 || loaded_channel.component_count == 0 || output.count != output_elements )
+				{
+					return invalid_channel(channel_index, "has mismatching key and value counts.");
+				}
+
+				std::vector<float> times = ReadAccessorFloats(gltf_asset, input, 1);
+				if ( !std::ranges::is_sorted(times) )
+				{
+					return invalid_channel(channel_index, "has keys out of order.");
+				}
+				std::vector<float> values = ReadAccessorFloats(gltf_asset, output, loaded_channel.path == AnimationChannel::Path::Weights ? 1 : loaded_channel.component_count);
+				if ( cubic )
+				{
+					ResampleCubicSpline(times, values, loaded_channel.component_count, loaded_channel.path == AnimationChannel::Path::Rotation, resampled_times, resampled_values);
+					times.swap(resampled_times);
+					values.swap(resampled_values);
+				}
+				else if ( loaded_channel.path == AnimationChannel::Path::Rotation )
+				{
+					for ( size_t key = 0; key < times.size(); ++key )
+					{
+						float* const rotation = values.data() + key * 4;
+						const float length = std::sqrt(rotation[0] * rotation[0] + rotation[1] * rotation[1] + rotation[2] * rotation[2] + rotation[3] * rotation[3]);
+						if ( length > 0.f )
+						{
+							std::transform(rotation, rotation + 4, rotation, [length](const float value) { return value / length; });
+						}
+					}
+				}
+
+				const size_t key_id = sampler.inputAccessor * 2 + (cubic ? 1 : 0);
+				const auto [shared_key, inserted] = shared_keys.try_emplace(key_id, static_cast<uint32_t>(loaded_animation.times.size()));
+				if ( inserted )
+				{
+					loaded_animation.times.insert(loaded_animation.times.end(), times.begin(), times.end());
+				}
+				loaded_channel.first_key = shared_key->second;
+				loaded_channel.key_count = static_cast<uint32_t>(times.size());
+				loaded_channel.first_value = static_cast<uint32_t>(loaded_animation.values.size());
+				loaded_animation.values.insert(loaded_animation.values.end(), values.begin(), values.end());
+				loaded_animation.duration = std::max(loaded_animation.duration, times.back());
+
+				if ( loaded_channel.path == AnimationChannel::Path::Weights )
+				{
+					ReserveMorphWeights(loading_result->m_rest_pose, loaded_channel.target_node, loaded_channel.component_count);
+				}
+				loaded_animation.channels.push_back(loaded_channel);
+			}
+
+			std::ranges::stable_sort(loaded_animation.channels, [](const AnimationChannel& lhs, const AnimationChannel& rhs)
+			{
+				return std::tie(lhs.path, lhs.target_node) < std::tie(rhs.path, rhs.target_node);
+			});
+			for ( const AnimationChannel& loaded_channel : loaded_animation.channels )
+			{
+				loaded_animation.target_nodes.push_back(loaded_channel.target_node);
+			}
+			std::ranges::sort(loaded_animation.target_nodes);
+			const auto [first_duplicate, last_duplicate] = std::ranges::unique(loaded_animation.target_nodes);
+			loaded_animation.target_nodes.erase(first_duplicate, last_duplicate);
+		}
+		return {};
+	}
+}
+
+
+//> POSE
+size_t Anni::ModelLoader::AnimationPose::GetNodeCount() const
+{
+	return translations.size();
+}
+
+glm::mat4 Anni::ModelLoader::AnimationPose::GetLocalTransform(const uint32_t node_index) const
+{
+	// translate * rotate * scale without the two full matrix products
+	glm::mat4 transform = glm::mat4_cast(rotations[node_index]);
+	transform[0] *= scales[node_index].x;
+	transform[1] *= scales[node_index].y;
+	transform[2] *= scales[node_index].z;
+	transform[3] = glm::vec4(translations[node_index], 1.f);
+	return transform;
+}
+
+
+//> SAMPLER
+void Anni::ModelLoader::AnimationSampler::Sample(const LoadedAnimation& animation, const float time, AnimationPose& pose)
+{
+	ChannelBatch<glm::vec3> vector_batch;
+	ChannelBatch<glm::quat> rotation_batch;
+	const size_t node_count = pose.GetNodeCount();
+	for ( const AnimationChannel& channel : animation.channels )
+	{
+		if ( channel.target_node >= node_count )
+		{
+			continue;
+		}
+
+		const KeySegment segment = FindSegment(animation, channel, time);
+		const float* const from = GetKeyValues(animation, channel, segment.from);
+		const float* const to = GetKeyValues(animation, channel, segment.to);
+		switch ( channel.path )
+		{
+			case AnimationChannel::Path::Translation:
+				if ( vector_batch.Add(from, to, segment.t, &pose.translations[channel.target_node], 3) )
+				{
+					InterpolateVectors(vector_batch);
+				}
+				break;
+			case AnimationChannel::Path::Scale:
+				if ( vector_batch.Add(from, to, segment.t, &pose.scales[channel.target_node], 3) )
+				{
+					InterpolateVectors(vector_batch);
+				}
+				break;
+			case AnimationChannel::Path::Rotation:
+				if ( rotation_batch.Add(from, to, segment.t, &pose.rotations[channel.target_node], 4) )
+				{
+					InterpolateRotations(rotation_batch);
+				}
+				break;
+			case AnimationChannel::Path::Weights:
+			{
+				// few and of any length, not worth batching
+				if ( channel.target_node + 1 >= pose.first_morph_weights.size() )
+				{
+					break;
+				}
+				const uint32_t first_weight = pose.first_morph_weights[channel.target_node];
+				const uint32_t weight_count = std::min<uint32_t>(pose.first_morph_weights[channel.target_node + 1] - first_weight, channel.component_count);
+				for ( uint32_t i = 0; i < weight_count; ++i )
+				{
+					pose.morph_weights[first_weight + i] = from[i] + (to[i] - from[i]) * segment.t;
+				}
+				break;
+			}
+		}
+	}
+
+	if ( vector_batch.count )
+	{
+		InterpolateVectors(vector_batch);
+	}
+	if ( rotation_batch.count )
+	{
+		InterpolateRotations(rotation_batch);
+	}
+}
+
+void Anni::ModelLoader::AnimationSampler::SampleChannel(const LoadedAnimation& animation, const AnimationChannel& channel, const float time, const std::span<float> output)
+{
+	const KeySegment segment = FindSegment(animation, channel, time);
+	const float* const from = GetKeyValues(animation, channel, segment.from);
+	const float* const to = GetKeyValues(animation, channel, segment.to);
+	if ( channel.path == AnimationChannel::Path::Rotation && output.size() >= 4 )
+	{
+		// glm::slerp takes the shorter arc as well
+		const glm::quat rotation = glm::slerp(glm::quat(from[3], from[0], from[1], from[2]), glm::quat(to[3], to[0], to[1], to[2]), segment.t);
+		output[0] = rotation.x;
+		output[1] = rotation.y;
+		output[2] = rotation.z;
+		output[3] = rotation.w;
+		return;
+	}
+
+	const size_t component_count = std::min<size_t>(output.size(), channel.component_count);
+	for ( size_t component = 0; component < component_count; ++component )
+	{
+		output[component] = from[component] + (to[component] - from[component]) * segment.t;
+	}
+}
+
+void Anni::ModelLoader::AnimationSampler::ApplyPose(const LoadedAnimation& animation, const AnimationPose& pose, FlatScene& scene)
+{
+	for ( const uint32_t node_index : animation.target_nodes )
+	{
+		if ( node_index < scene.flat_node_indices.size() && node_index < pose.GetNodeCount() )
+		{
+			scene.SetLocalTransform(scene.flat_node_indices[node_index], pose.GetLocalTransform(node_index));
+		}
+	}
+}
+
+
+//> SKINNING
+void Anni::ModelLoader::Skinning::ComputeJointMatrices(const LoadedSkin& skin, const FlatScene& scene, const uint32_t flat_node_index, const std::span<glm::mat4> joint_matrices)
+{
+	const glm::mat4 inverse_node_transform = glm::inverse(scene.world_transforms[flat_node_index]);
+	const size_t joint_count = std::min(joint_matrices.size(), skin.joint_nodes.size());
+	for ( size_t joint = 0; joint < joint_count; ++joint )
+	{
+		const glm::mat4& joint_transform = scene.world_transforms[scene.flat_node_indices[skin.joint_nodes[joint]]];
+		joint_matrices[joint] = inverse_node_transform * joint_transform * skin.inverse_bind_matrices[joint];
+	}
+}
+
+void Anni::ModelLoader::Skinning::SkinVertices(const std::span<const LoadedVertex> vertices, const std::span<const LoadedSkinVertex> skin_vertices, const std::span<const glm::mat4> joint_matrices, const std::span<LoadedVertex> skinned_vertices)
+{
+	const size_t vertex_count = std::min(vertices.size(), skinned_vertices.size());
+	// a mesh without skin vertices has nothing to move
+	const size_t skinned_count = std::min(vertex_count, skin_vertices.size());
+	std::ranges::copy(vertices.subspan(skinned_count, vertex_count - skinned_count), skinned_vertices.begin() + skinned_count);
+	for ( size_t vertex_index = 0; vertex_index < skinned_count; ++vertex_index )
+	{
+		const LoadedVertex& vertex = vertices[vertex_index];
+		const LoadedSkinVertex& skin_vertex = skin_vertices[vertex_index];
+		LoadedVertex& skinned_vertex = skinned_vertices[vertex_index];
+		skinned_vertex = vertex;
+
+		glm::mat4 skin_matrix(0.f);
+		float weight_sum = 0.f;
+		for ( uint32_t influence = 0; influence < 4; ++influence )
+		{
+			const float weight = skin_vertex.weights[influence];
+			if ( weight > 0.f && skin_vertex.joints[influence] < joint_matrices.size() )
+			{
+				skin_matrix += joint_matrices[skin_vertex.joints[influence]] * weight;
+				weight_sum += weight;
+			}
+		}
+		// unskinned vertices stay where they are
+		if ( weight_sum <= 0.f )
+		{
+			continue;
+		}
+
+		// the blended matrix is used for normals as is, like most skinning shaders do. fine as long as the joints scale uniformly
+		const glm::mat3 basis(skin_matrix);
+		skinned_vertex.position = glm::vec3(skin_matrix * glm::vec4(vertex.position, 1.f));
+		skinned_vertex.normal = glm::normalize(basis * vertex.normal);
+		const glm::vec3 tangent = glm::normalize(basis * glm::vec3(vertex.tangent));
+		skinned_vertex.tangent = glm::vec4(tangent, vertex.tangent.w);
+	}
+}
@@ -0,0 +1,180 @@
+#include "AssetRegistry.h"
+
+#include <unordered_set>
+
+
+Anni::ModelLoader::ModelInstance::ModelInstance(std::shared_ptr<const LoadedModel> model, const glm::mat4& transform) :
+	m_model(std::move(model)),
+	m_transform(transform)
+{
+}
+
+bool Anni::ModelLoader::ModelInstance::IsValid() const
+{
+	return m_model != nullptr;
+}
+
+const Anni::ModelLoader::LoadedModel* Anni::ModelLoader::ModelInstance::GetModel() const
+{
+	return m_model.get();
+}
+
+const glm::mat4& Anni::ModelLoader::ModelInstance::GetTransform() const
+{
+	return m_transform;
+}
+
+void Anni::ModelLoader::ModelInstance::SetTransform(const glm::mat4& transform)
+{
+	m_transform = transform;
+}
+
+void Anni::ModelLoader::ModelInstance::PreDrawToContext(DrawContext& ctx, const glm::mat4* const view_projection) const
+{
+	if ( !m_model )
+	{
+		return;
+	}
+	if ( view_projection )
+	{
+		// the shared scene is in model space, the frustum has to be brought there per instance
+		const Frustum frustum = Frustum::FromMatrix(*view_projection * m_transform);
+		m_model->PreDrawToContext(m_transform, ctx, &frustum);
+		return;
+	}
+	m_model->PreDrawToContext(m_transform, ctx);
+}
+
+Anni::ModelLoader::AssetRegistry::AssetRegistry(LoadOptions options) :
+	m_options(std::move(options))
+{
+}
+
+Anni::ModelLoader::LoadResult<std::shared_ptr<const Anni::ModelLoader::LoadedModel>> Anni::ModelLoader::AssetRegistry::Acquire(const std::filesystem::path& file_path)
+{
+	const std::string asset_key = GetAssetKey(file_path);
+	std::promise<LoadResult<std::shared_ptr<const LoadedModel>>> loaded_promise;
+	{
+		std::unique_lock lock(m_mutex);
+		if ( const auto asset = m_assets.find(asset_key); asset != m_assets.end() )
+		{
+			// may still be loading on another thread
+			std::shared_future<LoadResult<std::shared_ptr<const LoadedModel>>> model = asset->second.model;
+			lock.unlock();
+			return model.get();
+		}
+		m_assets.emplace(asset_key, Asset{ file_path, loaded_promise.get_future().share(), {} });
+	}
+
+	// the entry goes before the promise is set, so the registry never holds a failed load
+	const auto erase_asset = [this, &asset_key]
+	{
+		std::scoped_lock lock(m_mutex);
+		m_assets.erase(asset_key);
+	};
+	LoadResult<std::unique_ptr<LoadedModel>> loading_result;
+	try
+	{
+		loading_result = LoadedModel::factory.TryLoadFromFile(file_path, m_options);
+	}
+	catch ( ... )
+	{
+		// the callers waiting on this load get the exception as well
+		erase_asset();
+		loaded_promise.set_exception(std::current_exception());
+		throw;
+	}
+	if ( !loading_result )
+	{
+		SPDLOG_ERROR("Failed to register asset {}: {}", file_path.string(), loading_result.error().message);
+		erase_asset();
+		loaded_promise.set_value(std::unexpected(loading_result.error()));
+		return std::unexpected(loading_result.error());
+	}
+
+	std::shared_ptr<const LoadedModel> model = std::move(loading_result.value());
+	const ModelMemoryUsage memory = model->GetMemoryUsage();
+	SPDLOG_INFO("Registered asset {}: {} bytes owned, {} bytes of shared textures.", file_path.string(), memory.GetOwnedBytes(), memory.shared_texture_bytes);
+	{
+		std::scoped_lock lock(m_mutex);
+		m_assets.at(asset_key).memory = memory;
+	}
+	loaded_promise.set_value(model);
+	return model;
+}
+
+Anni::ModelLoader::ModelInstance Anni::ModelLoader::AssetRegistry::Instantiate(const std::filesystem::path& file_path, const glm::mat4& transform)
+{
+	LoadResult<std::shared_ptr<const LoadedModel>> model = Acquire(file_path);
+	return model ? ModelInstance(std::move(model.value()), transform) : ModelInstance{};
+}
+
+bool Anni::ModelLoader::AssetRegistry::Contains(const std::filesystem::path& file_path) const
+{
+	const std::string asset_key = GetAssetKey(file_path);
+	std::scoped_lock lock(m_mutex);
+	return m_assets.contains(asset_key);
+}
+
+size_t Anni::ModelLoader::AssetRegistry::ReleaseUnused()
+{
+	std::scoped_lock lock(m_mutex);
+	return std::erase_if(m_assets, [](const auto& key_and_asset)
+	{
+		const auto& model = key_and_asset.second.model;
+		// loads in flight are kept, their callers are about to get the model
+		return model.wait_for(std::chrono::seconds(0)) == std::future_status::ready && model.get().value().use_count() == 1;
+	});
+}
+
+std::vector<Anni::ModelLoader::AssetRegistry::AssetInfo> Anni::ModelLoader::AssetRegistry::GetAssets() const
+{
+	std::scoped_lock lock(m_mutex);
+	std::vector<AssetInfo> assets;
+	assets.reserve(m_assets.size());
+	for ( const auto& asset : m_assets | std::views::values )
+	{
+		if ( asset.model.wait_for(std::chrono::seconds(0)) != std::future_status::ready )
+		{
+			continue;
+		}
+		assets.push_back({ asset.file_path, static_cast<size_t>(asset.model.get().value().use_count() - 1), asset.memory });
+	}
+	return assets;
+}
+
+Anni::ModelLoader::ModelMemoryUsage Anni::ModelLoader::AssetRegistry::GetMemoryUsage() const
+{
+	std::scoped_lock lock(m_mutex);
+	ModelMemoryUsage total;
+	// shared pixels are told apart by where they start
+	std::unordered_set<const uint8_t*> counted_shared_textures;
+	for ( const auto& asset : m_assets | std::views::values )
+	{
+		if ( asset.model.wait_for(std::chrono::seconds(0)) != std::future_status::ready )
+		{
+			continue;
+		}
+		total.texture_bytes += asset.memory.texture_bytes;
+		total.vertex_bytes += asset.memory.vertex_bytes;
+		total.index_bytes += asset.memory.index_bytes;
+		total.meshlet_bytes += asset.memory.meshlet_bytes;
+		total.scene_bytes += asset.memory.scene_bytes;
+		total.arena_bytes += asset.memory.arena_bytes;
+		for ( const LoadedImage& texture : asset.model.get().value()->GetTextures() )
+		{
+			if ( texture.external_owner && counted_shared_textures.insert(texture.external_data.data()).second )
+			{
+				total.shared_texture_bytes += texture.external_data.size();
+			}
+		}
+	}
+	return total;
+}
+
+std::string Anni::ModelLoader::AssetRegistry::GetAssetKey(const std::filesystem::path& file_path)
+{
+	std::error_code canonical_error;
+	const std::filesystem::path canonical_path = std::filesystem::weakly_canonical(file_path, canonical_error);
+	return (canonical_error ? std::filesystem::absolute(file_path) : canonical_path).generic_string();
+}
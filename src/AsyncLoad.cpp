@@ -0,0 +1,344 @@
+#include "ModelsLoader.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <cctype>
+
+
+namespace Anni::ModelLoader
+{
+	//> ASYNC MODEL LOAD HANDLE
+	AsyncModelLoad::AsyncModelLoad(AsyncLoadCallbacks callbacks, const ThreadPool::Priority priority) :
+		m_priority(priority),
+		m_callbacks(std::move(callbacks))
+	{
+	}
+
+	LoadStage AsyncModelLoad::GetStage() const
+	{
+		std::scoped_lock lock(m_mutex);
+		return m_stage;
+	}
+
+	LoadStage AsyncModelLoad::Wait(const LoadStage stage) const
+	{
+		std::unique_lock lock(m_mutex);
+		m_stage_cv.wait(lock, [this, stage]() { return m_stage >= stage; });
+		return m_stage;
+	}
+
+	const LoadedModel* AsyncModelLoad::GetModel() const
+	{
+		std::scoped_lock lock(m_mutex);
+		return m_model.get();
+	}
+
+	std::unique_ptr<LoadedModel> AsyncModelLoad::TakeModel()
+	{
+		std::scoped_lock lock(m_mutex);
+		if ( LoadStage::Complete != m_stage )
+		{
+			return nullptr;
+		}
+		return std::move(m_model);
+	}
+
+	uint32_t AsyncModelLoad::GetTextureCount() const
+	{
+		return m_texture_count.load(std::memory_order_acquire);
+	}
+
+	uint32_t AsyncModelLoad::GetReadyTextureCount() const
+	{
+		return m_ready_texture_count.load(std::memory_order_acquire);
+	}
+
+	bool AsyncModelLoad::IsTextureReady(const uint32_t texture_index) const
+	{
+		// the acquire pairs with the release in MarkTextureReady, the decoded pixels are visible once this is true
+		return texture_index < GetTextureCount() && m_texture_ready[texture_index].load(std::memory_order_acquire);
+	}
+
+	void AsyncModelLoad::Cancel()
+	{
+		m_stop_source.request_stop();
+	}
+
+	bool AsyncModelLoad::IsCancelled() const
+	{
+		return m_stop_source.stop_requested();
+	}
+
+	void AsyncModelLoad::SetPriority(const ThreadPool::Priority priority)
+	{
+		m_priority.store(priority);
+	}
+
+	ThreadPool::Priority AsyncModelLoad::GetPriority() const
+	{
+		return m_priority.load();
+	}
+
+	void AsyncModelLoad::SetStage(const LoadStage stage)
+	{
+		{
+			std::scoped_lock lock(m_mutex);
+			if ( m_stage >= LoadStage::Complete )
+			{
+				return;
+			}
+			m_stage = stage;
+		}
+		m_stage_cv.notify_all();
+
+		if ( m_callbacks.on_stage_changed )
+		{
+			m_callbacks.on_stage_changed(stage);
+		}
+	}
+
+	void AsyncModelLoad::SetModel(std::unique_ptr<LoadedModel> model)
+	{
+		const auto texture_count = static_cast<uint32_t>(model->GetTextures().size());
+		m_texture_ready = std::make_unique<std::atomic<bool>[]>(texture_count);
+		{
+			std::scoped_lock lock(m_mutex);
+			m_model = std::move(model);
+		}
+		m_texture_count.store(texture_count, std::memory_order_release);
+	}
+
+	void AsyncModelLoad::MarkTextureReady(const uint32_t texture_index)
+	{
+		m_texture_ready[texture_index].store(true, std::memory_order_release);
+		m_ready_texture_count.fetch_add(1, std::memory_order_acq_rel);
+
+		if ( m_callbacks.on_texture_ready )
+		{
+			m_callbacks.on_texture_ready(texture_index);
+		}
+	}
+
+
+	//> FACTORY
+	struct LoadedModel::Factory::AsyncTextureFeed
+	{
+		std::shared_ptr<AsyncModelLoad> async_load;
+		// owned by async_load, it can't be taken before the feed finishes
+		LoadedModel* model{ nullptr };
+		std::filesystem::path file_path;
+		std::filesystem::path cooked_path;
+		LoadOptions options;
+
+		// declared first so they are released last, buffers of gltf_asset may point into any of them
+		std::vector<std::shared_ptr<MappedFile>> source_mappings;
+		std::unique_ptr<fastgltf::GltfDataGetter> data;
+		fastgltf::Asset gltf_asset{};
+		// see FindUnusedBasisuImages, written before the first texture job
+		std::vector<uint8_t> unused_basisu_images;
+
+		std::mutex mutex;
+		uint32_t next_image{ 0 };
+		uint32_t in_flight{ 0 };
+		bool failed{ false };
+		bool finished{ false };
+		// the first texture that failed, logged when the load ends
+		std::string failure_message;
+	};
+
+	std::shared_ptr<AsyncModelLoad> LoadedModel::Factory::LoadFromFileAsync(std::filesystem::path file_path, const LoadOptions& options, AsyncLoadCallbacks callbacks, const ThreadPool::Priority priority)
+	{
+		std::shared_ptr<AsyncModelLoad> async_load(new AsyncModelLoad(std::move(callbacks), priority));
+
+		SPDLOG_INFO("Loading file asynchronously from the file path: {}", file_path.string());
+		ThreadPool::Shared().Submit([async_load, file_path = std::move(file_path), options]()
+		{
+			RunAsyncLoad(async_load, file_path, options);
+		}, priority);
+
+		return async_load;
+	}
+
+	void LoadedModel::Factory::RunAsyncLoad(const std::shared_ptr<AsyncModelLoad>& async_load, const std::filesystem::path& file_path, const LoadOptions& options)
+	{
+		if ( async_load->IsCancelled() )
+		{
+			async_load->SetStage(LoadStage::Cancelled);
+			return;
+		}
+
+		std::string extension = file_path.extension().string();
+		std::ranges::transform(extension, extension.begin(), [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		if ( ".gltf" != extension && ".glb" != extension )
+		{
+			SPDLOG_ERROR("Unsupported model file extension: {}", extension);
+			async_load->SetStage(LoadStage::Failed);
+			return;
+		}
+
+		std::filesystem::path cooked_path;
+		if ( options.cooked_cache_directory.has_value() )
+		{
+			cooked_path = GetCookedModelPath(options.cooked_cache_directory.value(), file_path);
+			if ( std::unique_ptr<LoadedModel> cooked_result = LoadCookedModel(cooked_path, file_path, options) )
+			{
+				// the textures come out of the cooked file already decoded
+				SPDLOG_INFO("Loaded cooked model from: {}", cooked_path.string());
+				const auto texture_count = static_cast<uint32_t>(cooked_result->m_textures.size());
+				async_load->SetModel(std::move(cooked_result));
+				async_load->SetStage(LoadStage::GeometryReady);
+				for ( uint32_t texture_index = 0; texture_index < texture_count; ++texture_index )
+				{
+					async_load->MarkTextureReady(texture_index);
+				}
+				async_load->SetStage(LoadStage::Complete);
+				return;
+			}
+		}
+
+		auto feed = std::make_shared<AsyncTextureFeed>();
+		feed->async_load = async_load;
+		feed->file_path = file_path;
+		feed->cooked_path = cooked_path;
+		feed->options = options;
+
+		std::unique_ptr<LoadedModel> loading_result(new LoadedModel(file_path, options.memory_resource));
+		fastgltf::Parser gltf_parser{ supported_extensions };
+		LoadResult<void> result = LoadRawGltf(feed->data, feed->gltf_asset, file_path, gltf_parser, options);
+		if ( result )
+		{
+			CollectSourceFiles(feed->gltf_asset, file_path, loading_result);
+			result = LoadExternalBuffers(feed->gltf_asset, file_path, options, feed->source_mappings);
+		}
+		if ( result )
+		{
+			result = DecodeCompressedBufferViews(feed->gltf_asset);
+		}
+		if ( !result )
+		{
+			SPDLOG_ERROR("{}", result.error().message);
+			async_load->SetStage(LoadStage::Failed);
+			return;
+		}
+		if ( async_load->IsCancelled() )
+		{
+			async_load->SetStage(LoadStage::Cancelled);
+			return;
+		}
+
+		// same steps as LoadGltf, minus the textures which are only decoded once the geometry is out
+		LoadSamplers(feed->gltf_asset, loading_result);
+		CreateTextureSlots(feed->gltf_asset, loading_result);
+		LoadMaterials(feed->gltf_asset, file_path, loading_result);
+		result = LoadMeshes(feed->gltf_asset, options, loading_result);
+		if ( result )
+		{
+			result = LoadSceneNodes(feed->gltf_asset, loading_result);
+		}
+		if ( result )
+		{
+			result = LoadSceneGraph(feed->gltf_asset, loading_result);
+		}
+		if ( result )
+		{
+			result = LoadSkins(feed->gltf_asset, loading_result);
+		}
+		if ( result )
+		{
+			result = LoadAnimations(feed->gltf_asset, loading_result);
+		}
+		if ( !result )
+		{
+			SPDLOG_ERROR("{}", result.error().message);
+			async_load->SetStage(LoadStage::Failed);
+			return;
+		}
+
+		feed->model = loading_result.get();
+		feed->unused_basisu_images = FindUnusedBasisuImages(feed->gltf_asset);
+		async_load->SetModel(std::move(loading_result));
+		async_load->SetStage(LoadStage::GeometryReady);
+
+		FeedTextureJobs(feed);
+	}
+
+	void LoadedModel::Factory::FeedTextureJobs(const std::shared_ptr<AsyncTextureFeed>& feed)
+	{
+		ThreadPool& pool = ThreadPool::Shared();
+		// only a pool's worth in flight, a cancel or priority change reaches everything still waiting here
+		const uint32_t max_in_flight = std::max(1u, pool.GetWorkerCount());
+		const auto image_count = static_cast<uint32_t>(feed->gltf_asset.images.size());
+		{
+			std::scoped_lock lock(feed->mutex);
+			const bool stopped = feed->failed || feed->async_load->IsCancelled();
+			while ( !stopped && feed->next_image < image_count && feed->in_flight < max_in_flight )
+			{
+				const uint32_t image_index = feed->next_image++;
+				++feed->in_flight;
+				pool.Submit([feed, image_index]()
+				{
+					LoadResult<void> decoded;
+					// an unused KHR_texture_basisu image counts as ready with an empty slot
+					if ( feed->unused_basisu_images[image_index] )
+					{
+						feed->async_load->MarkTextureReady(image_index);
+					}
+					else if ( !feed->async_load->IsCancelled() )
+					{
+						LoadedImage& loaded_image = feed->model->m_textures[image_index];
+						decoded = LoadTextureImage(feed->gltf_asset, feed->gltf_asset.images[image_index], feed->file_path, feed->options, loaded_image);
+						if ( decoded )
+						{
+							feed->async_load->MarkTextureReady(image_index);
+						}
+					}
+					{
+						std::scoped_lock job_lock(feed->mutex);
+						--feed->in_flight;
+						if ( !decoded && !feed->failed )
+						{
+							feed->failed = true;
+							feed->failure_message = std::move(decoded.error().message);
+						}
+					}
+					FeedTextureJobs(feed);
+				}, feed->async_load->GetPriority());
+			}
+
+			const bool drained = stopped || feed->next_image == image_count;
+			if ( feed->finished || feed->in_flight != 0 || !drained )
+			{
+				return;
+			}
+			feed->finished = true;
+		}
+
+		FinishAsyncLoad(*feed);
+	}
+
+	void LoadedModel::Factory::FinishAsyncLoad(AsyncTextureFeed& feed)
+	{
+		AsyncModelLoad& async_load = *feed.async_load;
+		if ( async_load.IsCancelled() )
+		{
+			async_load.SetStage(LoadStage::Cancelled);
+			return;
+		}
+		if ( feed.failed )
+		{
+			SPDLOG_ERROR("{}", feed.failure_message);
+			async_load.SetStage(LoadStage::Failed);
+			return;
+		}
+
+		if ( !feed.cooked_path.empty() )
+		{
+			feed.model->m_load_stats.saved_to_cooked_cache = SaveCookedModel(*feed.model, feed.cooked_path, feed.options);
+			if ( !feed.model->m_load_stats.saved_to_cooked_cache )
+			{
+				SPDLOG_WARN("Failed to write cooked model to: {}", feed.cooked_path.string());
+			}
+		}
+		async_load.SetStage(LoadStage::Complete);
+	}
+}
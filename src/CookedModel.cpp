@@ -0,0 +1,1337 @@
+#include "ModelsLoader.h"
+#include "MappedFile.h"
+
+#include <fstream>
+#include <unordered_map>
+
+//> COOKED MODEL FORMAT
+// [CookedHeader][CookedSection * section_count][section payloads, each aligned to cooked_alignment]
+// every section records its element size, so a reader built with different struct layouts rejects the file instead of misreading it.
+// pixel data is referenced straight from the mapping on a warm load, everything else is a single bulk copy per array.
+
+namespace
+{
+	using namespace Anni::ModelLoader;
+
+	constexpr std::array<char, 4> cooked_magic{ 'A', 'N', 'M', 'C' };
+	constexpr uint32_t cooked_version = 8;
+	constexpr uint32_t cooked_endian_tag = 0x01020304;
+	constexpr uint64_t cooked_alignment = 16;
+	constexpr uint32_t cooked_invalid_index = std::numeric_limits<uint32_t>::max();
+
+	constexpr uint32_t MakeSectionTag(const char (&tag)[5])
+	{
+		return static_cast<uint32_t>(static_cast<uint8_t>(tag[0])) |
+			static_cast<uint32_t>(static_cast<uint8_t>(tag[1])) << 8 |
+			static_cast<uint32_t>(static_cast<uint8_t>(tag[2])) << 16 |
+			static_cast<uint32_t>(static_cast<uint8_t>(tag[3])) << 24;
+	}
+
+	enum class CookedSectionTag : uint32_t
+	{
+		Strings = MakeSectionTag("STRS"),
+		Dependencies = MakeSectionTag("DEPS"),
+		Samplers = MakeSectionTag("SMPL"),
+		Images = MakeSectionTag("IMGS"),
+		Pixels = MakeSectionTag("PIXL"),
+		Materials = MakeSectionTag("MATS"),
+		Meshes = MakeSectionTag("MESH"),
+		HomoMatTris = MakeSectionTag("HMTR"),
+		Vertices = MakeSectionTag("VERT"),
+		SkinVertices = MakeSectionTag("SKVX"),
+		Indices = MakeSectionTag("INDX"),
+		VertexStreams = MakeSectionTag("VSTR"),
+		VertexStreamData = MakeSectionTag("VSDT"),
+		Nodes = MakeSectionTag("NODE"),
+		Children = MakeSectionTag("CHLD"),
+		Lods = MakeSectionTag("LODS"),
+		Meshlets = MakeSectionTag("MSHL"),
+		MeshletVertices = MakeSectionTag("MLVX"),
+		MeshletTriangles = MakeSectionTag("MLTR"),
+		MipLevels = MakeSectionTag("MIPS"),
+		MorphWeights = MakeSectionTag("MRPH"),
+		Skins = MakeSectionTag("SKIN"),
+		SkinJoints = MakeSectionTag("SKJN"),
+		InverseBindMatrices = MakeSectionTag("SKIB"),
+		Animations = MakeSectionTag("ANIM"),
+		AnimationChannels = MakeSectionTag("ANCH"),
+		AnimationTargets = MakeSectionTag("ANTG"),
+		AnimationTimes = MakeSectionTag("ANTM"),
+		AnimationValues = MakeSectionTag("ANVL"),
+	};
+
+	struct CookedHeader
+	{
+		std::array<char, 4> magic;
+		uint32_t version;
+		uint32_t endian_tag;
+		uint32_t section_count;
+		uint64_t options_fingerprint;
+		uint64_t file_size;
+	};
+
+	struct CookedSection
+	{
+		uint32_t tag;
+		uint32_t element_size;
+		uint64_t element_count;
+		uint64_t offset;
+		uint64_t byte_size;
+	};
+
+	struct CookedString
+	{
+		uint32_t offset;
+		uint32_t length;
+	};
+
+	struct CookedDependency
+	{
+		CookedString path;
+		uint64_t file_size;
+		int64_t write_time;
+	};
+
+	struct CookedImage
+	{
+		enum PresentBits : uint32_t
+		{
+			FileName = 1u << 0,
+			Width = 1u << 1,
+			Height = 1u << 2,
+			ArraySize = 1u << 3,
+			MipmapSize = 1u << 4,
+			NumChannels = 1u << 5,
+		};
+
+		CookedString file_name;
+		uint32_t present_mask;
+		uint32_t width;
+		uint32_t height;
+		uint32_t array_size;
+		uint32_t mipmap_size;
+		uint32_t num_channels;
+		uint32_t usage;
+		uint32_t format;
+		// LoadedImage::MipLevel entries in the MIPS section
+		uint32_t first_mip_level;
+		uint32_t mip_level_count;
+		// relative to the start of the pixel section
+		uint64_t data_offset;
+		uint64_t data_size;
+	};
+
+	struct CookedMaterial
+	{
+		uint32_t alpha_mode;
+		float metallic_factor;
+		float roughness_factor;
+		float alpha_cutoff;
+		uint32_t has_alpha_cutoff;
+		std::array<float, 4> base_color_factors;
+		// albedo, metal_roughness, normal, emissive, occlusion: {image, sampler} pairs, cooked_invalid_index if absent
+		std::array<uint32_t, 10> texture_indices;
+	};
+
+	// box min, box max, sphere center, sphere radius
+	using CookedBounds = std::array<float, 10>;
+
+	struct CookedHomoMatTris
+	{
+		uint32_t start_index;
+		uint32_t count;
+		uint32_t material_index;
+		CookedBounds bounds;
+	};
+
+	struct CookedMesh
+	{
+		CookedString name;
+		uint32_t first_homo_mat_tris;
+		uint32_t homo_mat_tris_count;
+		uint32_t present_attributes;
+		uint32_t first_stream;
+		uint32_t stream_count;
+		uint32_t quantization_flags;
+		uint64_t first_vertex;
+		uint64_t vertex_count;
+		// 0 or vertex_count
+		uint64_t first_skin_vertex;
+		uint64_t skin_vertex_count;
+		uint64_t first_index;
+		uint64_t index_count;
+		// position scale, position offset, uv scale, uv offset
+		std::array<float, 10> dequantization;
+		CookedBounds bounds;
+		uint32_t first_lod;
+		uint32_t lod_count;
+		uint64_t first_meshlet;
+		uint64_t meshlet_count;
+		uint64_t first_meshlet_vertex;
+		uint64_t meshlet_vertex_count;
+		uint64_t first_meshlet_triangle;
+		uint64_t meshlet_triangle_count;
+	};
+
+	// the homo mat tris of a level follow the mesh's full detail ones in the HMTR section
+	struct CookedLod
+	{
+		float error;
+		uint32_t first_homo_mat_tris;
+		uint32_t homo_mat_tris_count;
+	};
+
+	enum CookedQuantizationBits : uint32_t
+	{
+		QuantizedPositions = 1u << 0,
+		OctahedralNormals = 1u << 1,
+		Unorm8Colors = 1u << 2,
+		Unorm16Weights = 1u << 3,
+		// VertexLayout::Quantization::UvFormat lives in bits 8..15
+		UvFormatShift = 8,
+	};
+
+	uint32_t ToCookedQuantization(const VertexLayout::Quantization& quantization)
+	{
+		uint32_t flags = static_cast<uint32_t>(quantization.uvs) << UvFormatShift;
+		flags |= quantization.positions ? QuantizedPositions : 0u;
+		flags |= quantization.octahedral_normals ? OctahedralNormals : 0u;
+		flags |= quantization.unorm8_colors ? Unorm8Colors : 0u;
+		flags |= quantization.unorm16_weights ? Unorm16Weights : 0u;
+		return flags;
+	}
+
+	VertexLayout::Quantization FromCookedQuantization(const uint32_t flags)
+	{
+		VertexLayout::Quantization quantization{};
+		quantization.positions = flags & QuantizedPositions;
+		quantization.octahedral_normals = flags & OctahedralNormals;
+		quantization.unorm8_colors = flags & Unorm8Colors;
+		quantization.unorm16_weights = flags & Unorm16Weights;
+		quantization.uvs = static_cast<VertexLayout::Quantization::UvFormat>((flags >> UvFormatShift) & 0xff);
+		return quantization;
+	}
+
+	struct CookedVertexStream
+	{
+		uint32_t attributes;
+		uint32_t stride;
+		// relative to the start of the stream data section
+		uint64_t data_offset;
+		uint64_t data_size;
+	};
+
+	struct CookedNode
+	{
+		uint32_t mesh_index;
+		uint32_t first_child;
+		uint32_t child_count;
+		uint32_t skin_index;
+		std::array<float, 16> local_transform;
+		// rest pose, kept next to the matrix so animations start from the file's own values
+		std::array<float, 3> translation;
+		// xyzw
+		std::array<float, 4> rotation;
+		std::array<float, 3> scale;
+		uint32_t first_morph_weight;
+		uint32_t morph_weight_count;
+	};
+
+	// joints and inverse bind matrices share their range
+	struct CookedSkin
+	{
+		CookedString name;
+		uint32_t first_joint;
+		uint32_t joint_count;
+		uint32_t skeleton_node;
+	};
+
+	// channel key and value offsets stay relative to the animation's own ranges
+	struct CookedAnimation
+	{
+		CookedString name;
+		float duration;
+		uint32_t first_channel;
+		uint32_t channel_count;
+		uint32_t first_target;
+		uint32_t target_count;
+		uint32_t first_time;
+		uint32_t time_count;
+		uint32_t first_value;
+		uint32_t value_count;
+	};
+
+	bool IsValidChannel(const AnimationChannel& channel, const LoadedAnimation& animation, const size_t node_count)
+	{
+		switch ( channel.path )
+		{
+			case AnimationChannel::Path::Translation:
+			case AnimationChannel::Path::Scale:
+				if ( channel.component_count != 3 )
+				{
+					return false;
+				}
+				break;
+			case AnimationChannel::Path::Rotation:
+				if ( channel.component_count != 4 )
+				{
+					return false;
+				}
+				break;
+			case AnimationChannel::Path::Weights:
+				break;
+			default:
+				return false;
+		}
+		const uint64_t value_count = static_cast<uint64_t>(channel.key_count) * channel.component_count;
+		return channel.target_node < node_count && channel.interpolation <= AnimationChannel::Interpolation::Linear && channel.key_count > 0 &&
+			channel.first_key <= animation.times.size() && channel.key_count <= animation.times.size() - channel.first_key &&
+			channel.first_value <= animation.values.size() && value_count <= animation.values.size() - channel.first_value;
+	}
+
+	uint64_t AlignUp(const uint64_t value, const uint64_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	uint64_t HashBytes(const void* bytes, const size_t size, uint64_t hash = 14695981039346656037ull)
+	{
+		// FNV-1a
+		const auto* data = static_cast<const uint8_t*>(bytes);
+		for ( size_t i = 0; i < size; ++i )
+		{
+			hash ^= data[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	uint32_t ToCookedIndex(const std::optional<uint32_t>& index)
+	{
+		return index.value_or(cooked_invalid_index);
+	}
+
+	std::optional<uint32_t> FromCookedIndex(const uint32_t index)
+	{
+		if ( index == cooked_invalid_index )
+		{
+			return std::nullopt;
+		}
+		return index;
+	}
+
+	CookedBounds ToCookedBounds(const BoundingBox& box, const BoundingSphere& sphere)
+	{
+		return {
+			box.min.x, box.min.y, box.min.z,
+			box.max.x, box.max.y, box.max.z,
+			sphere.center.x, sphere.center.y, sphere.center.z,
+			sphere.radius,
+		};
+	}
+
+	void FromCookedBounds(const CookedBounds& bounds, BoundingBox& box, BoundingSphere& sphere)
+	{
+		box.min = { bounds[0], bounds[1], bounds[2] };
+		box.max = { bounds[3], bounds[4], bounds[5] };
+		sphere.center = { bounds[6], bounds[7], bounds[8] };
+		sphere.radius = bounds[9];
+	}
+
+	std::optional<CookedDependency> StatDependency(const std::filesystem::path& path)
+	{
+		std::error_code error;
+		const uint64_t file_size = std::filesystem::file_size(path, error);
+		if ( error )
+		{
+			return std::nullopt;
+		}
+		const auto write_time = std::filesystem::last_write_time(path, error);
+		if ( error )
+		{
+			return std::nullopt;
+		}
+
+		CookedDependency dependency{};
+		dependency.file_size = file_size;
+		dependency.write_time = static_cast<int64_t>(write_time.time_since_epoch().count());
+		return dependency;
+	}
+
+	class CookedWriter
+	{
+	public:
+		CookedString AddString(const std::string_view str)
+		{
+			const CookedString cooked_string{ static_cast<uint32_t>(m_strings.size()), static_cast<uint32_t>(str.size()) };
+			m_strings.insert(m_strings.end(), str.begin(), str.end());
+			return cooked_string;
+		}
+
+		template <typename T>
+		void AddSection(const CookedSectionTag tag, const std::span<const T> elements)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			PendingSection section;
+			section.tag = static_cast<uint32_t>(tag);
+			section.element_size = sizeof(T);
+			section.element_count = elements.size();
+			section.bytes.resize(elements.size_bytes());
+			if ( !elements.empty() )
+			{
+				memcpy(section.bytes.data(), elements.data(), elements.size_bytes());
+			}
+			m_sections.push_back(std::move(section));
+		}
+
+		std::vector<uint8_t> Finish(const uint64_t options_fingerprint)
+		{
+			AddSection(CookedSectionTag::Strings, std::span<const char>(m_strings));
+
+			const uint64_t table_offset = sizeof(CookedHeader);
+			uint64_t payload_offset = AlignUp(table_offset + m_sections.size() * sizeof(CookedSection), cooked_alignment);
+
+			std::vector<CookedSection> table;
+			table.reserve(m_sections.size());
+			for ( const auto& pending : m_sections )
+			{
+				CookedSection section{};
+				section.tag = pending.tag;
+				section.element_size = pending.element_size;
+				section.element_count = pending.element_count;
+				section.offset = payload_offset;
+				section.byte_size = pending.bytes.size();
+				table.push_back(section);
+				payload_offset = AlignUp(payload_offset + section.byte_size, cooked_alignment);
+			}
+
+			CookedHeader header{};
+			header.magic = cooked_magic;
+			header.version = cooked_version;
+			header.endian_tag = cooked_endian_tag;
+			header.section_count = static_cast<uint32_t>(table.size());
+			header.options_fingerprint = options_fingerprint;
+			header.file_size = payload_offset;
+
+			std::vector<uint8_t> blob(payload_offset, 0);
+			memcpy(blob.data(), &header, sizeof(header));
+			memcpy(blob.data() + table_offset, table.data(), table.size() * sizeof(CookedSection));
+			for ( auto [section_index, pending] : std::ranges::views::enumerate(m_sections) )
+			{
+				if ( !pending.bytes.empty() )
+				{
+					memcpy(blob.data() + table[section_index].offset, pending.bytes.data(), pending.bytes.size());
+				}
+			}
+			return blob;
+		}
+
+	private:
+		struct PendingSection
+		{
+			uint32_t tag;
+			uint32_t element_size;
+			uint64_t element_count;
+			std::vector<uint8_t> bytes;
+		};
+
+		std::vector<char> m_strings;
+		std::vector<PendingSection> m_sections;
+	};
+
+	class CookedReader
+	{
+	public:
+		explicit CookedReader(std::shared_ptr<MappedFile> mapped_file) :
+			m_mapped_file(std::move(mapped_file)),
+			m_bytes(m_mapped_file->GetBytes())
+		{
+		}
+
+		bool Validate(const uint64_t options_fingerprint)
+		{
+			if ( m_bytes.size() < sizeof(CookedHeader) )
+			{
+				return false;
+			}
+
+			CookedHeader header{};
+			memcpy(&header, m_bytes.data(), sizeof(header));
+			if ( header.magic != cooked_magic || header.version != cooked_version || header.endian_tag != cooked_endian_tag )
+			{
+				return false;
+			}
+			if ( header.options_fingerprint != options_fingerprint || header.file_size != m_bytes.size() )
+			{
+				return false;
+			}
+
+			const uint64_t table_end = sizeof(CookedHeader) + static_cast<uint64_t>(header.section_count) * sizeof(CookedSection);
+			if ( table_end > m_bytes.size() )
+			{
+				return false;
+			}
+
+			m_sections.resize(header.section_count);
+			memcpy(m_sections.data(), m_bytes.data() + sizeof(CookedHeader), m_sections.size() * sizeof(CookedSection));
+			for ( const auto& section : m_sections )
+			{
+				if ( section.offset % cooked_alignment != 0 || section.offset > m_bytes.size() || section.byte_size > m_bytes.size() - section.offset )
+				{
+					return false;
+				}
+				if ( section.element_size == 0 || section.byte_size != section.element_count * section.element_size )
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		const CookedSection* FindSection(const CookedSectionTag tag, const uint32_t element_size) const
+		{
+			for ( const auto& section : m_sections )
+			{
+				if ( section.tag == static_cast<uint32_t>(tag) )
+				{
+					return section.element_size == element_size ? &section : nullptr;
+				}
+			}
+			return nullptr;
+		}
+
+		template <typename T>
+		std::optional<std::vector<T>> ReadArray(const CookedSectionTag tag) const
+		{
+			const CookedSection* section = FindSection(tag, sizeof(T));
+			if ( !section )
+			{
+				return std::nullopt;
+			}
+			std::vector<T> elements(section->element_count);
+			if ( !elements.empty() )
+			{
+				memcpy(elements.data(), m_bytes.data() + section->offset, section->byte_size);
+			}
+			return elements;
+		}
+
+		std::span<const uint8_t> GetSectionBytes(const CookedSectionTag tag) const
+		{
+			const CookedSection* section = FindSection(tag, 1);
+			if ( !section )
+			{
+				return {};
+			}
+			return m_bytes.subspan(section->offset, section->byte_size);
+		}
+
+		template <typename T, typename Allocator>
+		bool CopyElements(const CookedSectionTag tag, const uint64_t first, const uint64_t count, std::vector<T, Allocator>& destination) const
+		{
+			const CookedSection* section = FindSection(tag, sizeof(T));
+			if ( !section || first > section->element_count || count > section->element_count - first )
+			{
+				return false;
+			}
+			destination.resize(count);
+			if ( count )
+			{
+				memcpy(destination.data(), m_bytes.data() + section->offset + first * sizeof(T), count * sizeof(T));
+			}
+			return true;
+		}
+
+		std::optional<std::string> ReadString(const CookedString cooked_string) const
+		{
+			const std::span<const uint8_t> strings = GetSectionBytes(CookedSectionTag::Strings);
+			if ( cooked_string.offset > strings.size() || cooked_string.length > strings.size() - cooked_string.offset )
+			{
+				return std::nullopt;
+			}
+			return std::string(reinterpret_cast<const char*>(strings.data()) + cooked_string.offset, cooked_string.length);
+		}
+
+		const std::shared_ptr<MappedFile>& GetMappedFile() const
+		{
+			return m_mapped_file;
+		}
+
+	private:
+		std::shared_ptr<MappedFile> m_mapped_file;
+		std::span<const uint8_t> m_bytes;
+		std::vector<CookedSection> m_sections;
+	};
+}
+
+
+namespace Anni::ModelLoader
+{
+	std::filesystem::path LoadedModel::Factory::GetCookedModelPath(const std::filesystem::path& cache_directory, const std::filesystem::path& file_path)
+	{
+		// the stem keeps the cache browsable, the hash of the absolute path keeps same-named models apart
+		const std::string absolute_path = std::filesystem::absolute(file_path).generic_string();
+		const uint64_t path_hash = HashBytes(absolute_path.data(), absolute_path.size());
+		std::string cooked_name = file_path.stem().string() + "-";
+		for ( int shift = 60; shift >= 0; shift -= 4 )
+		{
+			cooked_name.push_back("0123456789abcdef"[(path_hash >> shift) & 0xf]);
+		}
+		return cache_directory / (cooked_name + ".anmc");
+	}
+
+	uint64_t LoadedModel::Factory::ComputeOptionsFingerprint(const LoadOptions& options)
+	{
+		// only options that change the produced data belong in here
+		uint64_t fingerprint = HashBytes(&cooked_version, sizeof(cooked_version));
+		if ( options.vertex_layout.has_value() )
+		{
+			const VertexLayout& layout = options.vertex_layout.value();
+			fingerprint = HashBytes(&layout.stream_count, sizeof(layout.stream_count), fingerprint);
+			fingerprint = HashBytes(layout.stream_attributes.data(), sizeof(uint32_t) * layout.stream_count, fingerprint);
+			const uint32_t quantization = ToCookedQuantization(layout.quantization);
+			fingerprint = HashBytes(&quantization, sizeof(quantization), fingerprint);
+		}
+		const uint8_t optimize_meshes = options.optimize_meshes ? 1 : 0;
+		fingerprint = HashBytes(&optimize_meshes, sizeof(optimize_meshes), fingerprint);
+		fingerprint = HashBytes(options.lod_ratios.data(), options.lod_ratios.size() * sizeof(float), fingerprint);
+		const std::array<uint32_t, 3> meshlet_options{ options.build_meshlets ? 1u : 0u, options.meshlet_max_vertices, options.meshlet_max_triangles };
+		fingerprint = HashBytes(meshlet_options.data(), sizeof(meshlet_options), fingerprint);
+		const std::array<uint8_t, 2> texture_options{ static_cast<uint8_t>(options.generate_mipmaps ? 1 : 0), static_cast<uint8_t>(options.texture_compression) };
+		fingerprint = HashBytes(texture_options.data(), sizeof(texture_options), fingerprint);
+		// merging itself is redone on load, but it changes which attributes the packed streams keep
+		const uint8_t merge_mesh_buffers = options.merge_mesh_buffers ? 1 : 0;
+		fingerprint = HashBytes(&merge_mesh_buffers, sizeof(merge_mesh_buffers), fingerprint);
+		return fingerprint;
+	}
+
+	bool LoadedModel::Factory::SaveCookedModel(const LoadedModel& model, const std::filesystem::path& cooked_path, const LoadOptions& options)
+	{
+		CookedWriter writer;
+
+		//> DEPENDENCIES
+		std::vector<CookedDependency> dependencies;
+		for ( const auto& source_file : model.m_source_files )
+		{
+			std::optional<CookedDependency> dependency = StatDependency(source_file);
+			if ( !dependency )
+			{
+				return false;
+			}
+			dependency->path = writer.AddString(std::filesystem::absolute(source_file).generic_string());
+			dependencies.push_back(dependency.value());
+		}
+		writer.AddSection(CookedSectionTag::Dependencies, std::span<const CookedDependency>(dependencies));
+
+		//> SAMPLERS
+		writer.AddSection(CookedSectionTag::Samplers, std::span<const LoadedSampler>(model.m_samplers));
+
+		//> IMAGES
+		std::vector<CookedImage> images;
+		std::vector<LoadedImage::MipLevel> mip_levels;
+		std::vector<uint8_t> pixels;
+		images.reserve(model.m_textures.size());
+		for ( const auto& texture : model.m_textures )
+		{
+			CookedImage image{};
+			if ( texture.file_name.has_value() )
+			{
+				image.present_mask |= CookedImage::FileName;
+				image.file_name = writer.AddString(texture.file_name.value());
+			}
+			const auto store_optional = [&image](const std::optional<uint32_t>& value, uint32_t& destination, const CookedImage::PresentBits bit)
+			{
+				if ( value.has_value() )
+				{
+					image.present_mask |= bit;
+					destination = value.value();
+				}
+			};
+			store_optional(texture.width, image.width, CookedImage::Width);
+			store_optional(texture.height, image.height, CookedImage::Height);
+			store_optional(texture.array_size, image.array_size, CookedImage::ArraySize);
+			store_optional(texture.mipmap_size, image.mipmap_size, CookedImage::MipmapSize);
+			store_optional(texture.num_channels, image.num_channels, CookedImage::NumChannels);
+			image.usage = texture.usage;
+			image.format = static_cast<uint32_t>(texture.format);
+			image.first_mip_level = static_cast<uint32_t>(mip_levels.size());
+			image.mip_level_count = static_cast<uint32_t>(texture.mip_levels.size());
+			mip_levels.insert(mip_levels.end(), texture.mip_levels.begin(), texture.mip_levels.end());
+
+			const std::span<const uint8_t> texture_data = texture.GetData();
+			image.data_offset = AlignUp(pixels.size(), cooked_alignment);
+			image.data_size = texture_data.size();
+			pixels.resize(image.data_offset + image.data_size, 0);
+			if ( !texture_data.empty() )
+			{
+				memcpy(pixels.data() + image.data_offset, texture_data.data(), texture_data.size());
+			}
+			images.push_back(image);
+		}
+		writer.AddSection(CookedSectionTag::Images, std::span<const CookedImage>(images));
+		writer.AddSection(CookedSectionTag::MipLevels, std::span<const LoadedImage::MipLevel>(mip_levels));
+		writer.AddSection(CookedSectionTag::Pixels, std::span<const uint8_t>(pixels));
+
+		//> MATERIALS
+		std::vector<CookedMaterial> materials;
+		materials.reserve(model.m_materials.size());
+		for ( const auto& material : model.m_materials )
+		{
+			CookedMaterial cooked_material{};
+			cooked_material.alpha_mode = static_cast<uint32_t>(material.alpha_mode);
+			cooked_material.metallic_factor = material.metallic_factor;
+			cooked_material.roughness_factor = material.roughness_factor;
+			cooked_material.has_alpha_cutoff = material.alpha_cutoff.has_value();
+			cooked_material.alpha_cutoff = material.alpha_cutoff.value_or(0.f);
+			cooked_material.base_color_factors = material.base_color_factors;
+			cooked_material.texture_indices = {
+				ToCookedIndex(material.albedo_index), ToCookedIndex(material.albedo_sampler_index),
+				ToCookedIndex(material.metal_roughness_index), ToCookedIndex(material.metal_roughness_sampler_index),
+				ToCookedIndex(material.normal_index), ToCookedIndex(material.normal_sampler_index),
+				ToCookedIndex(material.emissive_index), ToCookedIndex(material.emissive_sampler_index),
+				ToCookedIndex(material.occlusion_index), ToCookedIndex(material.occlusion_sampler_index),
+			};
+			materials.push_back(cooked_material);
+		}
+		writer.AddSection(CookedSectionTag::Materials, std::span<const CookedMaterial>(materials));
+
+		//> MESHES
+		std::vector<CookedMesh> meshes;
+		std::vector<CookedHomoMatTris> homo_mat_tris_array;
+		std::vector<LoadedVertex> vertices;
+		std::vector<LoadedSkinVertex> skin_vertices;
+		std::vector<uint32_t> indices;
+		std::vector<CookedVertexStream> streams;
+		std::vector<uint8_t> stream_data;
+		std::vector<CookedLod> lods;
+		std::vector<LoadedMeshAsset::Meshlet> meshlets;
+		std::vector<uint32_t> meshlet_vertices;
+		std::vector<uint8_t> meshlet_triangles;
+		const auto add_homo_mat_tris = [&homo_mat_tris_array](const std::span<const LoadedMeshAsset::HomoMatTris> source)
+		{
+			for ( const auto& homo_mat_tris : source )
+			{
+				homo_mat_tris_array.push_back({ homo_mat_tris.start_index, homo_mat_tris.count, ToCookedIndex(homo_mat_tris.material_index), ToCookedBounds(homo_mat_tris.bounds, homo_mat_tris.bounding_sphere) });
+			}
+		};
+		meshes.reserve(model.m_mesh_assets.size());
+		for ( const auto& mesh_asset : model.m_mesh_assets )
+		{
+			// meshes are stored unmerged, first_index and vertex_offset are 0 when buffer_in_one is the mesh's own
+			const LoadedMeshAsset::MeshBuffer& buffer = options.merge_mesh_buffers ? model.m_merged_buffer : mesh_asset.buffer_in_one;
+			const std::span<const uint32_t> mesh_indices = std::span<const uint32_t>(buffer.indices).subspan(mesh_asset.first_index, mesh_asset.index_count);
+			const std::span<const LoadedVertex> mesh_vertices = buffer.vertices.empty() ? std::span<const LoadedVertex>() :
+				std::span<const LoadedVertex>(buffer.vertices).subspan(mesh_asset.vertex_offset, mesh_asset.vertex_count);
+			// a merged buffer has skin vertices for every mesh once any of them is skinned, only the skinned ones keep theirs
+			const bool skinned = !buffer.skin_vertices.empty() && (mesh_asset.present_attributes & VertexLayout::Skin);
+			const std::span<const LoadedSkinVertex> mesh_skin_vertices = skinned ?
+				std::span<const LoadedSkinVertex>(buffer.skin_vertices).subspan(mesh_asset.vertex_offset, mesh_asset.vertex_count) : std::span<const LoadedSkinVertex>();
+
+			CookedMesh mesh{};
+			mesh.name = writer.AddString(mesh_asset.name);
+			mesh.first_homo_mat_tris = static_cast<uint32_t>(homo_mat_tris_array.size());
+			mesh.homo_mat_tris_count = static_cast<uint32_t>(mesh_asset.homo_mat_tris_array.size());
+			mesh.first_vertex = vertices.size();
+			mesh.vertex_count = mesh_vertices.size();
+			mesh.first_skin_vertex = skin_vertices.size();
+			mesh.skin_vertex_count = mesh_skin_vertices.size();
+			mesh.first_index = indices.size();
+			mesh.index_count = mesh_indices.size();
+			mesh.present_attributes = mesh_asset.present_attributes;
+			mesh.first_stream = static_cast<uint32_t>(streams.size());
+			mesh.stream_count = static_cast<uint32_t>(buffer.streams.size());
+			mesh.quantization_flags = ToCookedQuantization(mesh_asset.quantization);
+			const LoadedMeshAsset::Dequantization& dequantization = mesh_asset.dequantization;
+			mesh.dequantization = {
+				dequantization.position_scale.x, dequantization.position_scale.y, dequantization.position_scale.z,
+				dequantization.position_offset.x, dequantization.position_offset.y, dequantization.position_offset.z,
+				dequantization.uv_scale.x, dequantization.uv_scale.y,
+				dequantization.uv_offset.x, dequantization.uv_offset.y,
+			};
+			mesh.bounds = ToCookedBounds(mesh_asset.bounds, mesh_asset.bounding_sphere);
+
+			for ( const auto& stream : buffer.streams )
+			{
+				const std::span<const uint8_t> stream_bytes = std::span<const uint8_t>(stream.data).subspan(static_cast<size_t>(mesh_asset.vertex_offset) * stream.stride, static_cast<size_t>(mesh_asset.vertex_count) * stream.stride);
+				CookedVertexStream cooked_stream{};
+				cooked_stream.attributes = stream.attributes;
+				cooked_stream.stride = stream.stride;
+				cooked_stream.data_offset = AlignUp(stream_data.size(), cooked_alignment);
+				cooked_stream.data_size = stream_bytes.size();
+				stream_data.resize(cooked_stream.data_offset + cooked_stream.data_size, 0);
+				if ( !stream_bytes.empty() )
+				{
+					memcpy(stream_data.data() + cooked_stream.data_offset, stream_bytes.data(), stream_bytes.size());
+				}
+				streams.push_back(cooked_stream);
+			}
+
+			add_homo_mat_tris(mesh_asset.homo_mat_tris_array);
+			mesh.first_lod = static_cast<uint32_t>(lods.size());
+			mesh.lod_count = static_cast<uint32_t>(mesh_asset.lods.size());
+			for ( const auto& lod : mesh_asset.lods )
+			{
+				lods.push_back({ lod.error, static_cast<uint32_t>(homo_mat_tris_array.size()), static_cast<uint32_t>(lod.homo_mat_tris_array.size()) });
+				add_homo_mat_tris(lod.homo_mat_tris_array);
+			}
+
+			mesh.first_meshlet = meshlets.size();
+			mesh.meshlet_count = mesh_asset.meshlets.size();
+			mesh.first_meshlet_vertex = meshlet_vertices.size();
+			mesh.meshlet_vertex_count = mesh_asset.meshlet_vertices.size();
+			mesh.first_meshlet_triangle = meshlet_triangles.size();
+			mesh.meshlet_triangle_count = mesh_asset.meshlet_triangles.size();
+			meshlets.insert(meshlets.end(), mesh_asset.meshlets.begin(), mesh_asset.meshlets.end());
+			meshlet_vertices.insert(meshlet_vertices.end(), mesh_asset.meshlet_vertices.begin(), mesh_asset.meshlet_vertices.end());
+			meshlet_triangles.insert(meshlet_triangles.end(), mesh_asset.meshlet_triangles.begin(), mesh_asset.meshlet_triangles.end());
+
+			vertices.insert(vertices.end(), mesh_vertices.begin(), mesh_vertices.end());
+			skin_vertices.insert(skin_vertices.end(), mesh_skin_vertices.begin(), mesh_skin_vertices.end());
+			indices.insert(indices.end(), mesh_indices.begin(), mesh_indices.end());
+			meshes.push_back(mesh);
+		}
+		writer.AddSection(CookedSectionTag::Meshes, std::span<const CookedMesh>(meshes));
+		writer.AddSection(CookedSectionTag::HomoMatTris, std::span<const CookedHomoMatTris>(homo_mat_tris_array));
+		writer.AddSection(CookedSectionTag::Vertices, std::span<const LoadedVertex>(vertices));
+		writer.AddSection(CookedSectionTag::SkinVertices, std::span<const LoadedSkinVertex>(skin_vertices));
+		writer.AddSection(CookedSectionTag::Indices, std::span<const uint32_t>(indices));
+		writer.AddSection(CookedSectionTag::VertexStreams, std::span<const CookedVertexStream>(streams));
+		writer.AddSection(CookedSectionTag::VertexStreamData, std::span<const uint8_t>(stream_data));
+		writer.AddSection(CookedSectionTag::Lods, std::span<const CookedLod>(lods));
+		writer.AddSection(CookedSectionTag::Meshlets, std::span<const LoadedMeshAsset::Meshlet>(meshlets));
+		writer.AddSection(CookedSectionTag::MeshletVertices, std::span<const uint32_t>(meshlet_vertices));
+		writer.AddSection(CookedSectionTag::MeshletTriangles, std::span<const uint8_t>(meshlet_triangles));
+
+		//> NODES
+		std::unordered_map<const Node*, uint32_t> node_indices;
+		for ( auto [node_index, node] : std::ranges::views::enumerate(model.m_scene_nodes) )
+		{
+			node_indices.emplace(node.get(), static_cast<uint32_t>(node_index));
+		}
+
+		std::vector<CookedNode> nodes;
+		std::vector<uint32_t> children;
+		const AnimationPose& rest_pose = model.m_rest_pose;
+		nodes.reserve(model.m_scene_nodes.size());
+		for ( auto [node_index, node] : std::ranges::views::enumerate(model.m_scene_nodes) )
+		{
+			CookedNode cooked_node{};
+			cooked_node.mesh_index = cooked_invalid_index;
+			cooked_node.skin_index = ToCookedIndex(node->skin_index);
+			if ( const auto* mesh_node = dynamic_cast<const MeshNode*>(node.get()) )
+			{
+				cooked_node.mesh_index = static_cast<uint32_t>(mesh_node->GetMeshAsset() - model.m_mesh_assets.data());
+			}
+			cooked_node.first_child = static_cast<uint32_t>(children.size());
+			cooked_node.child_count = static_cast<uint32_t>(node->children.size());
+			for ( const auto& child : node->children )
+			{
+				children.push_back(node_indices.at(child.get()));
+			}
+			memcpy(cooked_node.local_transform.data(), &node->local_transform, sizeof(cooked_node.local_transform));
+
+			const glm::vec3& translation = rest_pose.translations[node_index];
+			const glm::quat& rotation = rest_pose.rotations[node_index];
+			const glm::vec3& scale = rest_pose.scales[node_index];
+			cooked_node.translation = { translation.x, translation.y, translation.z };
+			cooked_node.rotation = { rotation.x, rotation.y, rotation.z, rotation.w };
+			cooked_node.scale = { scale.x, scale.y, scale.z };
+			cooked_node.first_morph_weight = rest_pose.first_morph_weights[node_index];
+			cooked_node.morph_weight_count = rest_pose.first_morph_weights[node_index + 1] - rest_pose.first_morph_weights[node_index];
+			nodes.push_back(cooked_node);
+		}
+		writer.AddSection(CookedSectionTag::Nodes, std::span<const CookedNode>(nodes));
+		writer.AddSection(CookedSectionTag::Children, std::span<const uint32_t>(children));
+		writer.AddSection(CookedSectionTag::MorphWeights, std::span<const float>(rest_pose.morph_weights));
+
+		//> SKINS
+		std::vector<CookedSkin> skins;
+		std::vector<uint32_t> skin_joints;
+		std::vector<glm::mat4> inverse_bind_matrices;
+		skins.reserve(model.m_skins.size());
+		for ( const auto& skin : model.m_skins )
+		{
+			CookedSkin cooked_skin{};
+			cooked_skin.name = writer.AddString(skin.name);
+			cooked_skin.first_joint = static_cast<uint32_t>(skin_joints.size());
+			cooked_skin.joint_count = static_cast<uint32_t>(skin.joint_nodes.size());
+			cooked_skin.skeleton_node = ToCookedIndex(skin.skeleton_node);
+			skin_joints.insert(skin_joints.end(), skin.joint_nodes.begin(), skin.joint_nodes.end());
+			inverse_bind_matrices.insert(inverse_bind_matrices.end(), skin.inverse_bind_matrices.begin(), skin.inverse_bind_matrices.end());
+			skins.push_back(cooked_skin);
+		}
+		writer.AddSection(CookedSectionTag::Skins, std::span<const CookedSkin>(skins));
+		writer.AddSection(CookedSectionTag::SkinJoints, std::span<const uint32_t>(skin_joints));
+		writer.AddSection(CookedSectionTag::InverseBindMatrices, std::span<const glm::mat4>(inverse_bind_matrices));
+
+		//> ANIMATIONS
+		std::vector<CookedAnimation> animations;
+		std::vector<AnimationChannel> animation_channels;
+		std::vector<uint32_t> animation_targets;
+		std::vector<float> animation_times;
+		std::vector<float> animation_values;
+		animations.reserve(model.m_animations.size());
+		for ( const auto& animation : model.m_animations )
+		{
+			CookedAnimation cooked_animation{};
+			cooked_animation.name = writer.AddString(animation.name);
+			cooked_animation.duration = animation.duration;
+			cooked_animation.first_channel = static_cast<uint32_t>(animation_channels.size());
+			cooked_animation.channel_count = static_cast<uint32_t>(animation.channels.size());
+			cooked_animation.first_target = static_cast<uint32_t>(animation_targets.size());
+			cooked_animation.target_count = static_cast<uint32_t>(animation.target_nodes.size());
+			cooked_animation.first_time = static_cast<uint32_t>(animation_times.size());
+			cooked_animation.time_count = static_cast<uint32_t>(animation.times.size());
+			cooked_animation.first_value = static_cast<uint32_t>(animation_values.size());
+			cooked_animation.value_count = static_cast<uint32_t>(animation.values.size());
+			animation_channels.insert(animation_channels.end(), animation.channels.begin(), animation.channels.end());
+			animation_targets.insert(animation_targets.end(), animation.target_nodes.begin(), animation.target_nodes.end());
+			animation_times.insert(animation_times.end(), animation.times.begin(), animation.times.end());
+			animation_values.insert(animation_values.end(), animation.values.begin(), animation.values.end());
+			animations.push_back(cooked_animation);
+		}
+		writer.AddSection(CookedSectionTag::Animations, std::span<const CookedAnimation>(animations));
+		writer.AddSection(CookedSectionTag::AnimationChannels, std::span<const AnimationChannel>(animation_channels));
+		writer.AddSection(CookedSectionTag::AnimationTargets, std::span<const uint32_t>(animation_targets));
+		writer.AddSection(CookedSectionTag::AnimationTimes, std::span<const float>(animation_times));
+		writer.AddSection(CookedSectionTag::AnimationValues, std::span<const float>(animation_values));
+
+		const std::vector<uint8_t> blob = writer.Finish(ComputeOptionsFingerprint(options));
+
+		// write next to the target and rename, so a concurrent reader never maps a half written file
+		std::error_code error;
+		std::filesystem::create_directories(cooked_path.parent_path(), error);
+		std::filesystem::path temp_path = cooked_path;
+		temp_path += ".tmp";
+		{
+			std::ofstream cooked_file(temp_path, std::ios::binary | std::ios::trunc);
+			if ( !cooked_file )
+			{
+				return false;
+			}
+			cooked_file.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+			if ( !cooked_file )
+			{
+				return false;
+			}
+		}
+		std::filesystem::rename(temp_path, cooked_path, error);
+		if ( error )
+		{
+			std::filesystem::remove(temp_path, error);
+			return false;
+		}
+		return true;
+	}
+
+	std::unique_ptr<LoadedModel> LoadedModel::Factory::LoadCookedModel(const std::filesystem::path& cooked_path, const std::filesystem::path& file_path, const LoadOptions& options)
+	{
+		std::error_code error;
+		if ( !std::filesystem::exists(cooked_path, error) )
+		{
+			return nullptr;
+		}
+
+		std::shared_ptr<MappedFile> mapped_file = MappedFile::Open(cooked_path);
+		if ( !mapped_file )
+		{
+			return nullptr;
+		}
+
+		CookedReader reader(std::move(mapped_file));
+		if ( !reader.Validate(ComputeOptionsFingerprint(options)) )
+		{
+			SPDLOG_INFO("Cooked model is outdated or invalid: {}", cooked_path.string());
+			return nullptr;
+		}
+
+		//> DEPENDENCIES
+		// any changed source file invalidates the whole cooked model
+		const auto dependencies = reader.ReadArray<CookedDependency>(CookedSectionTag::Dependencies);
+		if ( !dependencies || dependencies->empty() )
+		{
+			return nullptr;
+		}
+		for ( const auto& dependency : dependencies.value() )
+		{
+			const std::optional<std::string> dependency_path = reader.ReadString(dependency.path);
+			if ( !dependency_path )
+			{
+				return nullptr;
+			}
+			const std::optional<CookedDependency> current = StatDependency(dependency_path.value());
+			if ( !current || current->file_size != dependency.file_size || current->write_time != dependency.write_time )
+			{
+				SPDLOG_INFO("Cooked model is stale, source changed: {}", dependency_path.value());
+				return nullptr;
+			}
+		}
+
+		auto samplers = reader.ReadArray<LoadedSampler>(CookedSectionTag::Samplers);
+		auto images = reader.ReadArray<CookedImage>(CookedSectionTag::Images);
+		auto materials = reader.ReadArray<CookedMaterial>(CookedSectionTag::Materials);
+		auto meshes = reader.ReadArray<CookedMesh>(CookedSectionTag::Meshes);
+		auto homo_mat_tris_array = reader.ReadArray<CookedHomoMatTris>(CookedSectionTag::HomoMatTris);
+		auto nodes = reader.ReadArray<CookedNode>(CookedSectionTag::Nodes);
+		auto children = reader.ReadArray<uint32_t>(CookedSectionTag::Children);
+		auto streams = reader.ReadArray<CookedVertexStream>(CookedSectionTag::VertexStreams);
+		auto lods = reader.ReadArray<CookedLod>(CookedSectionTag::Lods);
+		auto skins = reader.ReadArray<CookedSkin>(CookedSectionTag::Skins);
+		auto animations = reader.ReadArray<CookedAnimation>(CookedSectionTag::Animations);
+		auto morph_weights = reader.ReadArray<float>(CookedSectionTag::MorphWeights);
+		if ( !samplers || !images || !materials || !meshes || !homo_mat_tris_array || !nodes || !children || !streams || !lods || !skins || !animations || !morph_weights )
+		{
+			return nullptr;
+		}
+
+		std::unique_ptr<LoadedModel> loading_result(new LoadedModel(file_path, options.memory_resource));
+		for ( const auto& dependency : dependencies.value() )
+		{
+			loading_result->m_source_files.emplace_back(reader.ReadString(dependency.path).value());
+		}
+
+		loading_result->m_samplers = std::move(samplers.value());
+
+		//> IMAGES
+		// pixels are not copied, every image points into the mapping and keeps it alive
+		const std::span<const uint8_t> pixels = reader.GetSectionBytes(CookedSectionTag::Pixels);
+		loading_result->m_textures.reserve(images->size());
+		for ( const auto& image : images.value() )
+		{
+			if ( image.data_offset > pixels.size() || image.data_size > pixels.size() - image.data_offset )
+			{
+				return nullptr;
+			}
+
+			std::optional<std::string> file_name = reader.ReadString(image.file_name);
+			if ( !file_name )
+			{
+				return nullptr;
+			}
+			LoadedImage& loaded_image = loading_result->m_textures.emplace_back(std::move(file_name.value()));
+			if ( !(image.present_mask & CookedImage::FileName) )
+			{
+				loaded_image.file_name.reset();
+			}
+			const auto load_optional = [&image](std::optional<uint32_t>& destination, const uint32_t value, const CookedImage::PresentBits bit)
+			{
+				if ( image.present_mask & bit )
+				{
+					destination = value;
+				}
+			};
+			load_optional(loaded_image.width, image.width, CookedImage::Width);
+			load_optional(loaded_image.height, image.height, CookedImage::Height);
+			load_optional(loaded_image.array_size, image.array_size, CookedImage::ArraySize);
+			load_optional(loaded_image.mipmap_size, image.mipmap_size, CookedImage::MipmapSize);
+			load_optional(loaded_image.num_channels, image.num_channels, CookedImage::NumChannels);
+			if ( image.format > static_cast<uint32_t>(LoadedImage::Format::Bc7Srgb) ||
+				!reader.CopyElements(CookedSectionTag::MipLevels, image.first_mip_level, image.mip_level_count, loaded_image.mip_levels) )
+			{
+				return nullptr;
+			}
+			loaded_image.usage = image.usage;
+			loaded_image.format = static_cast<LoadedImage::Format>(image.format);
+
+			loaded_image.external_owner = reader.GetMappedFile();
+			loaded_image.external_data = pixels.subspan(image.data_offset, image.data_size);
+		}
+
+		//> MATERIALS
+		loading_result->m_materials.reserve(materials->size());
+		for ( const auto& cooked_material : materials.value() )
+		{
+			if ( cooked_material.alpha_mode > static_cast<uint32_t>(LoadedMaterialConstant::AlphaMode::Blend) )
+			{
+				return nullptr;
+			}
+			LoadedMaterialConstant constants{};
+			constants.alpha_mode = static_cast<LoadedMaterialConstant::AlphaMode>(cooked_material.alpha_mode);
+			constants.metallic_factor = cooked_material.metallic_factor;
+			constants.roughness_factor = cooked_material.roughness_factor;
+			if ( cooked_material.has_alpha_cutoff )
+			{
+				constants.alpha_cutoff = cooked_material.alpha_cutoff;
+			}
+			constants.base_color_factors = cooked_material.base_color_factors;
+
+			const auto& texture_indices = cooked_material.texture_indices;
+			constants.albedo_index = FromCookedIndex(texture_indices[0]);
+			constants.albedo_sampler_index = FromCookedIndex(texture_indices[1]);
+			constants.metal_roughness_index = FromCookedIndex(texture_indices[2]);
+			constants.metal_roughness_sampler_index = FromCookedIndex(texture_indices[3]);
+			constants.normal_index = FromCookedIndex(texture_indices[4]);
+			constants.normal_sampler_index = FromCookedIndex(texture_indices[5]);
+			constants.emissive_index = FromCookedIndex(texture_indices[6]);
+			constants.emissive_sampler_index = FromCookedIndex(texture_indices[7]);
+			constants.occlusion_index = FromCookedIndex(texture_indices[8]);
+			constants.occlusion_sampler_index = FromCookedIndex(texture_indices[9]);
+			loading_result->m_materials.push_back(constants);
+		}
+
+		//> MESHES
+		const std::span<const uint8_t> stream_data = reader.GetSectionBytes(CookedSectionTag::VertexStreamData);
+		const size_t material_count = loading_result->m_materials.size();
+		const auto read_homo_mat_tris = [&homo_mat_tris_array, material_count]<typename Allocator>(const uint32_t first, const uint32_t count, std::vector<LoadedMeshAsset::HomoMatTris, Allocator>& destination)
+		{
+			if ( first > homo_mat_tris_array->size() || count > homo_mat_tris_array->size() - first )
+			{
+				return false;
+			}
+			destination.reserve(count);
+			for ( uint32_t i = 0; i < count; ++i )
+			{
+				const CookedHomoMatTris& cooked_homo_mat_tris = (*homo_mat_tris_array)[first + i];
+				// the draw list indexes the materials with it
+				if ( cooked_homo_mat_tris.material_index != cooked_invalid_index && cooked_homo_mat_tris.material_index >= material_count )
+				{
+					return false;
+				}
+				LoadedMeshAsset::HomoMatTris homo_mat_tris;
+				homo_mat_tris.start_index = cooked_homo_mat_tris.start_index;
+				homo_mat_tris.count = cooked_homo_mat_tris.count;
+				homo_mat_tris.material_index = FromCookedIndex(cooked_homo_mat_tris.material_index);
+				FromCookedBounds(cooked_homo_mat_tris.bounds, homo_mat_tris.bounds, homo_mat_tris.bounding_sphere);
+				destination.push_back(homo_mat_tris);
+			}
+			return true;
+		};
+		// same memory resources as LoadMeshes, merged buffers are rebuilt from the stored meshes
+		std::pmr::memory_resource* const arena = &loading_result->m_arena;
+		std::pmr::memory_resource* const buffer_resource = options.merge_mesh_buffers ? std::pmr::get_default_resource() : arena;
+		loading_result->m_mesh_assets.reserve(meshes->size());
+		for ( size_t mesh_index = 0; mesh_index < meshes->size(); ++mesh_index )
+		{
+			loading_result->m_mesh_assets.emplace_back(arena, buffer_resource, buffer_resource);
+		}
+		for ( auto [mesh_index, cooked_mesh] : std::ranges::views::enumerate(meshes.value()) )
+		{
+			LoadedMeshAsset& mesh_asset = loading_result->m_mesh_assets[mesh_index];
+
+			std::optional<std::string> mesh_name = reader.ReadString(cooked_mesh.name);
+			if ( !mesh_name )
+			{
+				return nullptr;
+			}
+			mesh_asset.name = std::move(mesh_name.value());
+			mesh_asset.present_attributes = cooked_mesh.present_attributes;
+			mesh_asset.quantization = FromCookedQuantization(cooked_mesh.quantization_flags);
+			const auto& dequantization = cooked_mesh.dequantization;
+			mesh_asset.dequantization.position_scale = { dequantization[0], dequantization[1], dequantization[2] };
+			mesh_asset.dequantization.position_offset = { dequantization[3], dequantization[4], dequantization[5] };
+			mesh_asset.dequantization.uv_scale = { dequantization[6], dequantization[7] };
+			mesh_asset.dequantization.uv_offset = { dequantization[8], dequantization[9] };
+			FromCookedBounds(cooked_mesh.bounds, mesh_asset.bounds, mesh_asset.bounding_sphere);
+
+			if ( !read_homo_mat_tris(cooked_mesh.first_homo_mat_tris, cooked_mesh.homo_mat_tris_count, mesh_asset.homo_mat_tris_array) )
+			{
+				return nullptr;
+			}
+
+			if ( cooked_mesh.first_lod > lods->size() || cooked_mesh.lod_count > lods->size() - cooked_mesh.first_lod )
+			{
+				return nullptr;
+			}
+			mesh_asset.lods.resize(cooked_mesh.lod_count);
+			for ( uint32_t i = 0; i < cooked_mesh.lod_count; ++i )
+			{
+				const CookedLod& cooked_lod = (*lods)[cooked_mesh.first_lod + i];
+				mesh_asset.lods[i].error = cooked_lod.error;
+				if ( !read_homo_mat_tris(cooked_lod.first_homo_mat_tris, cooked_lod.homo_mat_tris_count, mesh_asset.lods[i].homo_mat_tris_array) )
+				{
+					return nullptr;
+				}
+			}
+
+			if ( !reader.CopyElements(CookedSectionTag::Vertices, cooked_mesh.first_vertex, cooked_mesh.vertex_count, mesh_asset.buffer_in_one.vertices) ||
+				!reader.CopyElements(CookedSectionTag::SkinVertices, cooked_mesh.first_skin_vertex, cooked_mesh.skin_vertex_count, mesh_asset.buffer_in_one.skin_vertices) ||
+				!reader.CopyElements(CookedSectionTag::Indices, cooked_mesh.first_index, cooked_mesh.index_count, mesh_asset.buffer_in_one.indices) ||
+				!reader.CopyElements(CookedSectionTag::Meshlets, cooked_mesh.first_meshlet, cooked_mesh.meshlet_count, mesh_asset.meshlets) ||
+				!reader.CopyElements(CookedSectionTag::MeshletVertices, cooked_mesh.first_meshlet_vertex, cooked_mesh.meshlet_vertex_count, mesh_asset.meshlet_vertices) ||
+				!reader.CopyElements(CookedSectionTag::MeshletTriangles, cooked_mesh.first_meshlet_triangle, cooked_mesh.meshlet_triangle_count, mesh_asset.meshlet_triangles) )
+			{
+				return nullptr;
+			}
+
+			if ( cooked_mesh.first_stream > streams->size() || cooked_mesh.stream_count > streams->size() - cooked_mesh.first_stream )
+			{
+				return nullptr;
+			}
+			// every stream holds the same whole number of vertices, the same as the LoadedVertex array when that is kept
+			uint64_t mesh_vertex_count = cooked_mesh.vertex_count;
+			mesh_asset.buffer_in_one.streams.reserve(cooked_mesh.stream_count);
+			for ( uint32_t i = 0; i < cooked_mesh.stream_count; ++i )
+			{
+				const CookedVertexStream& cooked_stream = (*streams)[cooked_mesh.first_stream + i];
+				if ( cooked_stream.data_offset > stream_data.size() || cooked_stream.data_size > stream_data.size() - cooked_stream.data_offset )
+				{
+					return nullptr;
+				}
+				if ( 0 == cooked_stream.stride || cooked_stream.data_size % cooked_stream.stride != 0 )
+				{
+					return nullptr;
+				}
+				const uint64_t stream_vertex_count = cooked_stream.data_size / cooked_stream.stride;
+				if ( (cooked_mesh.vertex_count != 0 || i != 0) && stream_vertex_count != mesh_vertex_count )
+				{
+					return nullptr;
+				}
+				mesh_vertex_count = stream_vertex_count;
+				LoadedMeshAsset::VertexStream stream;
+				stream.attributes = cooked_stream.attributes;
+				stream.stride = cooked_stream.stride;
+				const std::span<const uint8_t> bytes = stream_data.subspan(cooked_stream.data_offset, cooked_stream.data_size);
+				stream.data.assign(bytes.begin(), bytes.end());
+				mesh_asset.buffer_in_one.streams.push_back(std::move(stream));
+			}
+			if ( cooked_mesh.skin_vertex_count != 0 && cooked_mesh.skin_vertex_count != mesh_vertex_count )
+			{
+				return nullptr;
+			}
+		}
+		if ( !SetMeshBufferRanges(options, loading_result) )
+		{
+			return nullptr;
+		}
+
+		//> NODES
+		const size_t node_count = nodes->size();
+		AnimationPose& rest_pose = loading_result->m_rest_pose;
+		rest_pose.translations.reserve(node_count);
+		rest_pose.rotations.reserve(node_count);
+		rest_pose.scales.reserve(node_count);
+		rest_pose.first_morph_weights.reserve(node_count + 1);
+		// the morph weights are stored in node order, every node's range starts where the previous one ended
+		uint32_t next_morph_weight = 0;
+		loading_result->m_scene_nodes.reserve(node_count);
+		for ( const auto& cooked_node : nodes.value() )
+		{
+			std::shared_ptr<Node> new_node;
+			if ( cooked_node.mesh_index != cooked_invalid_index )
+			{
+				if ( cooked_node.mesh_index >= loading_result->m_mesh_assets.size() )
+				{
+					return nullptr;
+				}
+				new_node = std::allocate_shared<MeshNode>(std::pmr::polymorphic_allocator<MeshNode>(&loading_result->m_arena), &loading_result->m_mesh_assets[cooked_node.mesh_index]);
+			}
+			else
+			{
+				new_node = std::allocate_shared<Node>(std::pmr::polymorphic_allocator<Node>(&loading_result->m_arena));
+			}
+			memcpy(&new_node->local_transform, cooked_node.local_transform.data(), sizeof(cooked_node.local_transform));
+			if ( cooked_node.skin_index != cooked_invalid_index && cooked_node.skin_index >= skins->size() )
+			{
+				return nullptr;
+			}
+			new_node->skin_index = FromCookedIndex(cooked_node.skin_index);
+			loading_result->m_scene_nodes.push_back(std::move(new_node));
+
+			if ( cooked_node.first_morph_weight != next_morph_weight || cooked_node.morph_weight_count > morph_weights->size() - next_morph_weight )
+			{
+				return nullptr;
+			}
+			next_morph_weight += cooked_node.morph_weight_count;
+			rest_pose.translations.emplace_back(cooked_node.translation[0], cooked_node.translation[1], cooked_node.translation[2]);
+			rest_pose.rotations.emplace_back(cooked_node.rotation[3], cooked_node.rotation[0], cooked_node.rotation[1], cooked_node.rotation[2]);
+			rest_pose.scales.emplace_back(cooked_node.scale[0], cooked_node.scale[1], cooked_node.scale[2]);
+			rest_pose.first_morph_weights.push_back(cooked_node.first_morph_weight);
+		}
+		if ( next_morph_weight != morph_weights->size() )
+		{
+			return nullptr;
+		}
+		rest_pose.first_morph_weights.push_back(next_morph_weight);
+		rest_pose.morph_weights = std::move(morph_weights.value());
+
+		//> SCENE GRAPH
+		// the same checks as a glTF load, a shared child or a cycle would send RefreshTransform around forever
+		std::vector<std::pair<size_t, size_t>> links;
+		for ( auto [node_index, cooked_node] : std::ranges::views::enumerate(nodes.value()) )
+		{
+			if ( cooked_node.first_child > children->size() || cooked_node.child_count > children->size() - cooked_node.first_child )
+			{
+				return nullptr;
+			}
+			for ( uint32_t i = 0; i < cooked_node.child_count; ++i )
+			{
+				links.emplace_back(static_cast<size_t>(node_index), (*children)[cooked_node.first_child + i]);
+			}
+		}
+		if ( !ValidateHierarchy(node_count, links) )
+		{
+			return nullptr;
+		}
+		for ( const auto& [parent_index, child_index] : links )
+		{
+			const std::shared_ptr<Node>& parent_node = loading_result->m_scene_nodes[parent_index];
+			parent_node->children.push_back(loading_result->m_scene_nodes[child_index]);
+			loading_result->m_scene_nodes[child_index]->parent = parent_node;
+		}
+
+		for ( auto& node : loading_result->m_scene_nodes )
+		{
+			if ( !node->parent.lock() )
+			{
+				loading_result->m_top_nodes.push_back(node);
+				node->RefreshTransform(glm::mat4{ 1.f });
+			}
+		}
+		BuildFlatScene(loading_result);
+
+		//> SKINS
+		const auto valid_node = [node_count](const uint32_t node_index)
+		{
+			return node_index < node_count;
+		};
+		loading_result->m_skins.reserve(skins->size());
+		for ( const auto& cooked_skin : skins.value() )
+		{
+			std::optional<std::string> skin_name = reader.ReadString(cooked_skin.name);
+			if ( !skin_name || (cooked_skin.skeleton_node != cooked_invalid_index && !valid_node(cooked_skin.skeleton_node)) )
+			{
+				return nullptr;
+			}
+			LoadedSkin& skin = loading_result->m_skins.emplace_back();
+			skin.name = std::move(skin_name.value());
+			skin.skeleton_node = FromCookedIndex(cooked_skin.skeleton_node);
+			if ( !reader.CopyElements(CookedSectionTag::SkinJoints, cooked_skin.first_joint, cooked_skin.joint_count, skin.joint_nodes) ||
+				!reader.CopyElements(CookedSectionTag::InverseBindMatrices, cooked_skin.first_joint, cooked_skin.joint_count, skin.inverse_bind_matrices) ||
+				!std::ranges::all_of(skin.joint_nodes, valid_node) )
+			{
+				return nullptr;
+			}
+		}
+
+		//> ANIMATIONS
+		loading_result->m_animations.reserve(animations->size());
+		for ( const auto& cooked_animation : animations.value() )
+		{
+			std::optional<std::string> animation_name = reader.ReadString(cooked_animation.name);
+			if ( !animation_name )
+			{
+				return nullptr;
+			}
+			LoadedAnimation& animation = loading_result->m_animations.emplace_back();
+			animation.name = std::move(animation_name.value());
+			animation.duration = cooked_animation.duration;
+			if ( !reader.CopyElements(CookedSectionTag::AnimationChannels, cooked_animation.first_channel, cooked_animation.channel_count, animation.channels) ||
+				!reader.CopyElements(CookedSectionTag::AnimationTargets, cooked_animation.first_target, cooked_animation.target_count, animation.target_nodes) ||
+				!reader.CopyElements(CookedSectionTag::AnimationTimes, cooked_animation.first_time, cooked_animation.time_count, animation.times) ||
+				!reader.CopyElements(CookedSectionTag::AnimationValues, cooked_animation.first_value, cooked_animation.value_count, animation.values) ||
+				!std::ranges::all_of(animation.target_nodes, valid_node) )
+			{
+				return nullptr;
+			}
+			for ( const AnimationChannel& channel : animation.channels )
+			{
+				if ( !IsValidChannel(channel, animation, node_count) )
+				{
+					return nullptr;
+				}
+			}
+		}
+
+		return loading_result;
+	}
+}
@@ -0,0 +1,398 @@
+#include "Ktx2Decoder.h"
+#include "TextureProcessor.h"
+#include "ThreadPool.h"
+#include "stb_image.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#if defined(ANNI_MODELS_LOADER_BASISU)
+#include <mutex>
+
+#include "basisu_transcoder.h"
+#include "zstd.h"
+#endif
+
+
+namespace
+{
+	using namespace Anni::ModelLoader;
+
+	constexpr std::array<uint8_t, 12> ktx2_identifier{ 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+	// identifier, 9 header words and the index of the data format descriptor, key/value and supercompression global data
+	constexpr size_t ktx2_header_size = 80;
+	constexpr size_t ktx2_level_entry_size = 24;
+
+	enum class SupercompressionScheme : uint32_t
+	{
+		None = 0,
+		BasisLz = 1,
+		Zstandard = 2,
+		Zlib = 3,
+	};
+
+	// VkFormat values of the formats LoadedImage stores
+	constexpr uint32_t vk_format_undefined = 0;
+	constexpr uint32_t vk_format_r8g8b8a8_unorm = 37;
+	constexpr uint32_t vk_format_r8g8b8a8_srgb = 43;
+	constexpr uint32_t vk_format_bc1_rgb_unorm = 131;
+	constexpr uint32_t vk_format_bc1_rgb_srgb = 132;
+	constexpr uint32_t vk_format_bc1_rgba_unorm = 133;
+	constexpr uint32_t vk_format_bc1_rgba_srgb = 134;
+	constexpr uint32_t vk_format_bc3_unorm = 137;
+	constexpr uint32_t vk_format_bc3_srgb = 138;
+	constexpr uint32_t vk_format_bc4_unorm = 139;
+	constexpr uint32_t vk_format_bc5_unorm = 141;
+	constexpr uint32_t vk_format_bc7_unorm = 145;
+	constexpr uint32_t vk_format_bc7_srgb = 146;
+
+	struct Ktx2Header
+	{
+		uint32_t vk_format;
+		uint32_t pixel_width;
+		uint32_t pixel_height;
+		uint32_t pixel_depth;
+		uint32_t layer_count;
+		uint32_t face_count;
+		uint32_t level_count;
+		SupercompressionScheme supercompression;
+	};
+
+	struct Ktx2Level
+	{
+		uint64_t byte_offset;
+		uint64_t byte_length;
+		uint64_t uncompressed_byte_length;
+	};
+
+	std::unexpected<LoadError> DecodeError(std::string message)
+	{
+		return std::unexpected(LoadError{ LoadError::Code::TextureDecodeFailed, std::move(message) });
+	}
+
+	// a valid file this build can't decode, as opposed to a broken one
+	std::unexpected<LoadError> UnsupportedError(std::string message)
+	{
+		return std::unexpected(LoadError{ LoadError::Code::UnsupportedTexture, std::move(message) });
+	}
+
+	template <typename T>
+	T ReadLittleEndian(const std::span<const uint8_t> bytes, const size_t offset)
+	{
+		static_assert(std::endian::native == std::endian::little);
+		T value;
+		memcpy(&value, bytes.data() + offset, sizeof(T));
+		return value;
+	}
+
+	// vk_format with its channel count, false for formats LoadedImage has no counterpart of
+	bool GetImageFormat(const uint32_t vk_format, LoadedImage::Format& format, uint32_t& num_channels)
+	{
+		switch ( vk_format )
+		{
+			case vk_format_r8g8b8a8_unorm: format = LoadedImage::Format::Rgba8Unorm; num_channels = 4; return true;
+			case vk_format_r8g8b8a8_srgb: format = LoadedImage::Format::Rgba8Srgb; num_channels = 4; return true;
+			case vk_format_bc1_rgb_unorm: format = LoadedImage::Format::Bc1Unorm; num_channels = 3; return true;
+			case vk_format_bc1_rgb_srgb: format = LoadedImage::Format::Bc1Srgb; num_channels = 3; return true;
+			// same blocks, the alpha bit only matters to how they were encoded
+			case vk_format_bc1_rgba_unorm: format = LoadedImage::Format::Bc1Unorm; num_channels = 4; return true;
+			case vk_format_bc1_rgba_srgb: format = LoadedImage::Format::Bc1Srgb; num_channels = 4; return true;
+			case vk_format_bc3_unorm: format = LoadedImage::Format::Bc3Unorm; num_channels = 4; return true;
+			case vk_format_bc3_srgb: format = LoadedImage::Format::Bc3Srgb; num_channels = 4; return true;
+			case vk_format_bc4_unorm: format = LoadedImage::Format::Bc4Unorm; num_channels = 1; return true;
+			case vk_format_bc5_unorm: format = LoadedImage::Format::Bc5Unorm; num_channels = 2; return true;
+			case vk_format_bc7_unorm: format = LoadedImage::Format::Bc7Unorm; num_channels = 4; return true;
+			case vk_format_bc7_srgb: format = LoadedImage::Format::Bc7Srgb; num_channels = 4; return true;
+			default: return false;
+		}
+	}
+
+	// stored levels of a non Basis texture, straight into their place in raw_data
+	LoadResult<void> DecodeStoredLevels(const std::span<const uint8_t> bytes, const Ktx2Header& header, const std::span<const Ktx2Level> levels, LoadedImage& image)
+	{
+		LoadedImage::Format format{};
+		uint32_t num_channels = 0;
+		if ( !GetImageFormat(header.vk_format, format, num_channels) )
+		{
+			return UnsupportedError("Unsupported KTX2 format: VkFormat " + std::to_string(header.vk_format) + ".");
+		}
+		const uint32_t layer_count = std::max(header.layer_count, 1u);
+
+		//> LEVEL LAYOUT
+		std::vector<LoadedImage::MipLevel> mip_levels;
+		mip_levels.reserve(levels.size());
+		uint64_t data_size = 0;
+		for ( size_t level = 0; level < levels.size(); ++level )
+		{
+			const uint32_t level_width = std::max(1u, header.pixel_width >> level);
+			const uint32_t level_height = std::max(1u, header.pixel_height >> level);
+			const uint64_t level_size = TextureProcessor::GetLevelSize(format, level_width, level_height) * layer_count;
+
+			const Ktx2Level& stored = levels[level];
+			const bool supercompressed = SupercompressionScheme::None != header.supercompression;
+			if ( stored.byte_offset > bytes.size() || stored.byte_length > bytes.size() - stored.byte_offset ||
+				stored.uncompressed_byte_length != level_size || (!supercompressed && stored.byte_length != level_size) )
+			{
+				return DecodeError("KTX2 level " + std::to_string(level) + " is truncated or doesn't match its format.");
+			}
+			mip_levels.push_back({ level_width, level_height, data_size, level_size });
+			data_size += level_size;
+		}
+
+		std::vector<uint8_t> data(data_size);
+		std::atomic<bool> all_decoded{ true };
+		ThreadPool::Shared().ParallelFor(levels.size(), [&](const size_t level)
+		{
+			const std::span<const uint8_t> source = bytes.subspan(levels[level].byte_offset, levels[level].byte_length);
+			uint8_t* const destination = data.data() + mip_levels[level].offset;
+			const uint64_t destination_size = mip_levels[level].size;
+			bool decoded = false;
+			switch ( header.supercompression )
+			{
+				case SupercompressionScheme::None:
+					memcpy(destination, source.data(), destination_size);
+					decoded = true;
+					break;
+				case SupercompressionScheme::Zlib:
+					if ( source.size() <= static_cast<size_t>(std::numeric_limits<int>::max()) && destination_size <= static_cast<uint64_t>(std::numeric_limits<int>::max()) )
+					{
+						const int decoded_size = stbi_zlib_decode_buffer(reinterpret_cast<char*>(destination), static_cast<int>(destination_size),
+							reinterpret_cast<const char*>(source.data()), static_cast<int>(source.size()));
+						decoded = decoded_size >= 0 && static_cast<uint64_t>(decoded_size) == destination_size;
+					}
+					break;
+#if defined(ANNI_MODELS_LOADER_BASISU)
+				case SupercompressionScheme::Zstandard:
+				{
+					const size_t decoded_size = ZSTD_decompress(destination, destination_size, source.data(), source.size());
+					decoded = !ZSTD_isError(decoded_size) && decoded_size == destination_size;
+					break;
+				}
+#endif
+				default:
+					break;
+			}
+			if ( !decoded )
+			{
+				all_decoded.store(false, std::memory_order_relaxed);
+			}
+		});
+		if ( !all_decoded.load(std::memory_order_relaxed) )
+		{
+			return DecodeError("Failed to decode KTX2 levels(supercompression scheme " + std::to_string(static_cast<uint32_t>(header.supercompression)) + ").");
+		}
+
+		image.width = header.pixel_width;
+		image.height = header.pixel_height;
+		image.array_size = layer_count;
+		image.mipmap_size = static_cast<uint32_t>(mip_levels.size());
+		image.num_channels = num_channels;
+		image.format = format;
+		image.raw_data = std::move(data);
+		image.mip_levels = std::move(mip_levels);
+		return {};
+	}
+
+#if defined(ANNI_MODELS_LOADER_BASISU)
+	basist::transcoder_texture_format GetTranscoderFormat(const LoadedImage::Format format)
+	{
+		switch ( format )
+		{
+			case LoadedImage::Format::Bc1Unorm:
+			case LoadedImage::Format::Bc1Srgb:
+				return basist::transcoder_texture_format::cTFBC1_RGB;
+			case LoadedImage::Format::Bc3Unorm:
+			case LoadedImage::Format::Bc3Srgb:
+				return basist::transcoder_texture_format::cTFBC3_RGBA;
+			case LoadedImage::Format::Bc4Unorm:
+				return basist::transcoder_texture_format::cTFBC4_R;
+			case LoadedImage::Format::Bc5Unorm:
+				return basist::transcoder_texture_format::cTFBC5_RG;
+			case LoadedImage::Format::Bc7Unorm:
+			case LoadedImage::Format::Bc7Srgb:
+				return basist::transcoder_texture_format::cTFBC7_RGBA;
+			default:
+				return basist::transcoder_texture_format::cTFRGBA32;
+		}
+	}
+
+	// channels of what GetTranscoderFormat transcodes to, BC1 is transcoded without alpha
+	uint32_t GetChannelCount(const LoadedImage::Format format)
+	{
+		switch ( format )
+		{
+			case LoadedImage::Format::Bc1Unorm:
+			case LoadedImage::Format::Bc1Srgb:
+				return 3;
+			case LoadedImage::Format::Bc4Unorm:
+				return 1;
+			case LoadedImage::Format::Bc5Unorm:
+				return 2;
+			default:
+				return 4;
+		}
+	}
+
+	// ETC1S/BasisLZ or UASTC into the format the material usage asks for, one job per level and layer
+	LoadResult<void> TranscodeBasisLevels(const std::span<const uint8_t> bytes, const TextureCompression compression, LoadedImage& image)
+	{
+		static std::once_flag transcoder_initialized;
+		std::call_once(transcoder_initialized, []() { basist::basisu_transcoder_init(); });
+
+		basist::ktx2_transcoder transcoder;
+		if ( bytes.size() > std::numeric_limits<uint32_t>::max() || !transcoder.init(bytes.data(), static_cast<uint32_t>(bytes.size())) ||
+			!transcoder.start_transcoding() )
+		{
+			return DecodeError("Failed to start transcoding a Basis Universal KTX2 texture.");
+		}
+
+		const bool has_alpha = transcoder.get_has_alpha();
+		const LoadedImage::Format format = TextureProcessor::ChooseFormat(image.usage, has_alpha, compression);
+		const basist::transcoder_texture_format transcoder_format = GetTranscoderFormat(format);
+		const bool block_format = TextureProcessor::GetBlockSize(format) != 0;
+		const uint32_t level_count = std::max(transcoder.get_levels(), 1u);
+		const uint32_t layer_count = std::max(transcoder.get_layers(), 1u);
+
+		//> LEVEL LAYOUT
+		// layers of one level back to back, like the stored levels
+		std::vector<LoadedImage::MipLevel> mip_levels;
+		mip_levels.reserve(level_count);
+		std::vector<uint64_t> layer_sizes;
+		layer_sizes.reserve(level_count);
+		uint64_t data_size = 0;
+		for ( uint32_t level = 0; level < level_count; ++level )
+		{
+			basist::ktx2_image_level_info level_info{};
+			if ( !transcoder.get_image_level_info(level_info, level, 0, 0) )
+			{
+				return DecodeError("Basis Universal KTX2 level " + std::to_string(level) + " is missing.");
+			}
+			const uint64_t layer_size = TextureProcessor::GetLevelSize(format, level_info.m_orig_width, level_info.m_orig_height);
+			mip_levels.push_back({ level_info.m_orig_width, level_info.m_orig_height, data_size, layer_size * layer_count });
+			layer_sizes.push_back(layer_size);
+			data_size += layer_size * layer_count;
+		}
+
+		std::vector<uint8_t> data(data_size);
+		std::atomic<bool> all_transcoded{ true };
+		ThreadPool::Shared().ParallelFor(static_cast<size_t>(level_count) * layer_count, [&](const size_t item)
+		{
+			const auto level = static_cast<uint32_t>(item / layer_count);
+			const auto layer = static_cast<uint32_t>(item % layer_count);
+			const LoadedImage::MipLevel& mip_level = mip_levels[level];
+			// blocks for the block formats, pixels for RGBA32
+			const uint32_t output_size = block_format
+				? ((mip_level.width + 3) / 4) * ((mip_level.height + 3) / 4)
+				: mip_level.width * mip_level.height;
+			// the transcoder is only safe to share between threads with a state per job
+			basist::ktx2_transcoder_state state;
+			if ( !transcoder.transcode_image_level(level, layer, 0, data.data() + mip_level.offset + layer * layer_sizes[level], output_size,
+				transcoder_format, 0, 0, 0, -1, -1, &state) )
+			{
+				all_transcoded.store(false, std::memory_order_relaxed);
+			}
+		});
+		if ( !all_transcoded.load(std::memory_order_relaxed) )
+		{
+			return DecodeError("Failed to transcode a Basis Universal KTX2 texture.");
+		}
+
+		image.width = transcoder.get_width();
+		image.height = transcoder.get_height();
+		image.array_size = layer_count;
+		image.mipmap_size = level_count;
+		image.num_channels = GetChannelCount(format);
+		image.format = format;
+		image.raw_data = std::move(data);
+		image.mip_levels = std::move(mip_levels);
+		return {};
+	}
+#endif
+}
+
+
+bool Anni::ModelLoader::Ktx2Decoder::IsKtx2(const std::span<const uint8_t> bytes)
+{
+	return bytes.size() >= ktx2_identifier.size() && std::equal(ktx2_identifier.begin(), ktx2_identifier.end(), bytes.begin());
+}
+
+bool Anni::ModelLoader::Ktx2Decoder::CanTranscodeBasis()
+{
+#if defined(ANNI_MODELS_LOADER_BASISU)
+	return true;
+#else
+	return false;
+#endif
+}
+
+Anni::ModelLoader::LoadResult<void> Anni::ModelLoader::Ktx2Decoder::Decode(const std::span<const uint8_t> bytes, [[maybe_unused]] const TextureCompression compression, LoadedImage& image)
+{
+	//> HEADER
+	if ( !IsKtx2(bytes) || bytes.size() < ktx2_header_size )
+	{
+		return DecodeError("Not a KTX2 file.");
+	}
+	Ktx2Header header{};
+	header.vk_format = ReadLittleEndian<uint32_t>(bytes, 12);
+	header.pixel_width = ReadLittleEndian<uint32_t>(bytes, 20);
+	header.pixel_height = ReadLittleEndian<uint32_t>(bytes, 24);
+	header.pixel_depth = ReadLittleEndian<uint32_t>(bytes, 28);
+	header.layer_count = ReadLittleEndian<uint32_t>(bytes, 32);
+	header.face_count = ReadLittleEndian<uint32_t>(bytes, 36);
+	header.level_count = ReadLittleEndian<uint32_t>(bytes, 40);
+	header.supercompression = static_cast<SupercompressionScheme>(ReadLittleEndian<uint32_t>(bytes, 44));
+
+	if ( 0 == header.pixel_width || 0 == header.pixel_height || 0 != header.pixel_depth || 1 != header.face_count )
+	{
+		return UnsupportedError("Only 2D KTX2 textures are supported.");
+	}
+	// 0 asks the loader to build the chain, which isn't possible for block compressed data, only the top level is used
+	const uint32_t level_count = std::max(header.level_count, 1u);
+	if ( level_count > static_cast<uint32_t>(std::bit_width(std::max(header.pixel_width, header.pixel_height))) ||
+		ktx2_header_size + static_cast<size_t>(level_count) * ktx2_level_entry_size > bytes.size() )
+	{
+		return DecodeError("KTX2 level index is invalid.");
+	}
+
+	if ( vk_format_undefined == header.vk_format )
+	{
+#if defined(ANNI_MODELS_LOADER_BASISU)
+		return TranscodeBasisLevels(bytes, compression, image);
+#else
+		return UnsupportedError("Basis Universal KTX2 textures need a build with MODELS_LOADER_WITH_BASISU.");
+#endif
+	}
+
+	// stored levels: no supercompression or zlib everywhere, zstd only with the basisu library(which brings zstd along)
+	switch ( header.supercompression )
+	{
+		case SupercompressionScheme::None:
+		case SupercompressionScheme::Zlib:
+			break;
+		case SupercompressionScheme::Zstandard:
+			if ( !CanTranscodeBasis() )
+			{
+				return UnsupportedError("Zstandard supercompressed KTX2 textures need a build with MODELS_LOADER_WITH_BASISU.");
+			}
+			break;
+		default:
+			return UnsupportedError("KTX2 supercompression scheme " + std::to_string(static_cast<uint32_t>(header.supercompression)) + " isn't supported for VkFormat " +
+				std::to_string(header.vk_format) + ".");
+	}
+
+	std::vector<Ktx2Level> levels(level_count);
+	for ( uint32_t level = 0; level < level_count; ++level )
+	{
+		const size_t entry_offset = ktx2_header_size + static_cast<size_t>(level) * ktx2_level_entry_size;
+		levels[level].byte_offset = ReadLittleEndian<uint64_t>(bytes, entry_offset);
+		levels[level].byte_length = ReadLittleEndian<uint64_t>(bytes, entry_offset + 8);
+		levels[level].uncompressed_byte_length = ReadLittleEndian<uint64_t>(bytes, entry_offset + 16);
+	}
+	return DecodeStoredLevels(bytes, header, levels, image);
+}
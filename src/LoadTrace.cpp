@@ -0,0 +1,120 @@
+#include "LoadTrace.h"
+
+#include <fstream>
+
+
+namespace
+{
+	void AppendEscaped(std::string& json, const std::string_view text)
+	{
+		for ( const char c : text )
+		{
+			switch ( c )
+			{
+				case '"':
+					json += "\\\"";
+					break;
+				case '\\':
+					json += "\\\\";
+					break;
+				case '\n':
+					json += "\\n";
+					break;
+				default:
+					// the rest of the control characters are dropped, names come from file paths and glTF names
+					if ( static_cast<unsigned char>(c) >= 0x20 )
+					{
+						json += c;
+					}
+					break;
+			}
+		}
+	}
+}
+
+
+//> RECORDER
+Anni::ModelLoader::TraceRecorder::TraceRecorder() :
+	m_epoch(std::chrono::steady_clock::now())
+{
+}
+
+void Anni::ModelLoader::TraceRecorder::Record(std::string name, const std::string_view category, const std::chrono::steady_clock::time_point start, const std::chrono::steady_clock::time_point end)
+{
+	Event event;
+	event.name = std::move(name);
+	event.category = category;
+	event.start_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(start - m_epoch).count());
+	event.duration_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+
+	std::scoped_lock lock(m_mutex);
+	const auto [thread_id, inserted] = m_thread_ids.try_emplace(std::this_thread::get_id(), static_cast<uint32_t>(m_thread_ids.size()));
+	event.thread_id = thread_id->second;
+	m_events.push_back(std::move(event));
+}
+
+void Anni::ModelLoader::TraceRecorder::Clear()
+{
+	std::scoped_lock lock(m_mutex);
+	m_events.clear();
+}
+
+std::vector<Anni::ModelLoader::TraceRecorder::Event> Anni::ModelLoader::TraceRecorder::GetEvents() const
+{
+	std::scoped_lock lock(m_mutex);
+	return m_events;
+}
+
+std::string Anni::ModelLoader::TraceRecorder::ToChromeJson() const
+{
+	const std::vector<Event> events = GetEvents();
+
+	std::string json = "{\"traceEvents\":[";
+	for ( size_t i = 0; i < events.size(); ++i )
+	{
+		const Event& event = events[i];
+		json += i ? ",\n" : "\n";
+		json += "{\"name\":\"";
+		AppendEscaped(json, event.name);
+		json += "\",\"cat\":\"";
+		AppendEscaped(json, event.category);
+		json += "\",\"ph\":\"X\",\"ts\":";
+		json += std::to_string(event.start_us);
+		json += ",\"dur\":";
+		json += std::to_string(event.duration_us);
+		json += ",\"pid\":1,\"tid\":";
+		json += std::to_string(event.thread_id);
+		json += '}';
+	}
+	json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+	return json;
+}
+
+bool Anni::ModelLoader::TraceRecorder::WriteChromeJson(const std::filesystem::path& file_path) const
+{
+	const std::string json = ToChromeJson();
+	std::ofstream output(file_path, std::ios::binary | std::ios::trunc);
+	output.write(json.data(), static_cast<std::streamsize>(json.size()));
+	return static_cast<bool>(output);
+}
+
+
+//> SPAN
+Anni::ModelLoader::TraceSpan::TraceSpan(TraceRecorder* recorder, std::string name, const std::string_view category) :
+	m_recorder(recorder),
+	m_category(category)
+{
+	if ( m_recorder )
+	{
+		m_name = std::move(name);
+		m_start = std::chrono::steady_clock::now();
+	}
+}
+
+Anni::ModelLoader::TraceSpan::~TraceSpan()
+{
+	if ( m_recorder )
+	{
+		m_recorder->Record(std::move(m_name), m_category, m_start, std::chrono::steady_clock::now());
+	}
+}
@@ -0,0 +1,109 @@
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+Anni::ModelLoader::MappedFile::~MappedFile()
+{
+#if defined(_WIN32)
+	if ( m_data )
+	{
+		UnmapViewOfFile(m_data);
+	}
+	if ( m_mapping_handle )
+	{
+		CloseHandle(m_mapping_handle);
+	}
+	if ( m_file_handle )
+	{
+		CloseHandle(m_file_handle);
+	}
+#else
+	if ( m_data )
+	{
+		munmap(const_cast<uint8_t*>(m_data), m_size);
+	}
+#endif
+}
+
+std::shared_ptr<Anni::ModelLoader::MappedFile> Anni::ModelLoader::MappedFile::Open(const std::filesystem::path& file_path)
+{
+	std::shared_ptr<MappedFile> mapped_file(new MappedFile());
+
+#if defined(_WIN32)
+	const HANDLE file_handle = CreateFileW(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if ( file_handle == INVALID_HANDLE_VALUE )
+	{
+		return nullptr;
+	}
+	mapped_file->m_file_handle = file_handle;
+
+	LARGE_INTEGER file_size{};
+	if ( !GetFileSizeEx(file_handle, &file_size) )
+	{
+		return nullptr;
+	}
+	mapped_file->m_size = static_cast<size_t>(file_size.QuadPart);
+	if ( mapped_file->m_size == 0 )
+	{
+		// empty files can't be mapped, an empty span is all there is to read
+		return mapped_file;
+	}
+
+	mapped_file->m_mapping_handle = CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if ( !mapped_file->m_mapping_handle )
+	{
+		return nullptr;
+	}
+
+	mapped_file->m_data = static_cast<const uint8_t*>(MapViewOfFile(mapped_file->m_mapping_handle, FILE_MAP_READ, 0, 0, 0));
+	if ( !mapped_file->m_data )
+	{
+		return nullptr;
+	}
+#else
+	const int file_descriptor = open(file_path.c_str(), O_RDONLY);
+	if ( file_descriptor < 0 )
+	{
+		return nullptr;
+	}
+
+	struct stat file_stat{};
+	if ( fstat(file_descriptor, &file_stat) != 0 )
+	{
+		close(file_descriptor);
+		return nullptr;
+	}
+	mapped_file->m_size = static_cast<size_t>(file_stat.st_size);
+	if ( mapped_file->m_size == 0 )
+	{
+		close(file_descriptor);
+		return mapped_file;
+	}
+
+	void* const mapping = mmap(nullptr, mapped_file->m_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+	// the mapping keeps its own reference to the file
+	close(file_descriptor);
+	if ( mapping == MAP_FAILED )
+	{
+		mapped_file->m_size = 0;
+		return nullptr;
+	}
+	mapped_file->m_data = static_cast<const uint8_t*>(mapping);
+#endif
+
+	return mapped_file;
+}
+
+std::span<const uint8_t> Anni::ModelLoader::MappedFile::GetBytes() const
+{
+	return { m_data, m_size };
+}
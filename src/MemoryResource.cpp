@@ -0,0 +1,193 @@
+#include "MemoryResource.h"
+
+#include <algorithm>
+
+
+namespace
+{
+	std::byte* AlignUp(std::byte* p, const size_t alignment)
+	{
+		const auto address = reinterpret_cast<uintptr_t>(p);
+		return p + ((alignment - address % alignment) % alignment);
+	}
+
+	size_t AlignUp(const size_t size, const size_t alignment)
+	{
+		return (size + alignment - 1) / alignment * alignment;
+	}
+}
+
+
+//> ARENA
+Anni::ModelLoader::ArenaMemoryResource::ArenaMemoryResource(std::pmr::memory_resource* upstream, const size_t block_size) :
+	m_upstream(upstream ? upstream : std::pmr::get_default_resource()),
+	m_block_size(std::max<size_t>(block_size, 4096))
+{
+}
+
+Anni::ModelLoader::ArenaMemoryResource::~ArenaMemoryResource()
+{
+	Release();
+}
+
+void Anni::ModelLoader::ArenaMemoryResource::Release()
+{
+	std::scoped_lock lock(m_mutex);
+	while ( m_blocks )
+	{
+		Block* const previous = m_blocks->previous;
+		m_upstream->deallocate(m_blocks, m_blocks->size, m_blocks->alignment);
+		m_blocks = previous;
+	}
+	m_cursor = nullptr;
+	m_end = nullptr;
+	m_last_allocation = nullptr;
+	m_reserved_bytes = 0;
+	m_used_bytes = 0;
+	m_block_count = 0;
+}
+
+std::pmr::memory_resource* Anni::ModelLoader::ArenaMemoryResource::GetUpstream() const
+{
+	return m_upstream;
+}
+
+uint64_t Anni::ModelLoader::ArenaMemoryResource::GetReservedBytes() const
+{
+	std::scoped_lock lock(m_mutex);
+	return m_reserved_bytes;
+}
+
+uint64_t Anni::ModelLoader::ArenaMemoryResource::GetUsedBytes() const
+{
+	std::scoped_lock lock(m_mutex);
+	return m_used_bytes;
+}
+
+uint32_t Anni::ModelLoader::ArenaMemoryResource::GetBlockCount() const
+{
+	std::scoped_lock lock(m_mutex);
+	return m_block_count;
+}
+
+void* Anni::ModelLoader::ArenaMemoryResource::do_allocate(const size_t bytes, const size_t alignment)
+{
+	std::scoped_lock lock(m_mutex);
+	m_used_bytes += bytes;
+
+	if ( m_cursor )
+	{
+		std::byte* const p = AlignUp(m_cursor, alignment);
+		if ( p <= m_end && bytes <= static_cast<size_t>(m_end - p) )
+		{
+			m_cursor = p + bytes;
+			m_last_allocation = p;
+			return p;
+		}
+	}
+
+	// large allocations get a block of their own behind the current one, the rest of the current block stays in use
+	if ( bytes + alignment > m_block_size / 4 )
+	{
+		const size_t block_alignment = std::max(alignment, alignof(Block));
+		const size_t payload_offset = AlignUp(sizeof(Block), block_alignment);
+		Block* const block = AllocateBlock(payload_offset + bytes, block_alignment);
+		if ( m_blocks )
+		{
+			block->previous = m_blocks->previous;
+			m_blocks->previous = block;
+		}
+		else
+		{
+			block->previous = nullptr;
+			m_blocks = block;
+		}
+		return reinterpret_cast<std::byte*>(block) + payload_offset;
+	}
+
+	Block* const block = AllocateBlock(m_block_size, alignof(std::max_align_t));
+	block->previous = m_blocks;
+	m_blocks = block;
+	std::byte* const p = AlignUp(reinterpret_cast<std::byte*>(block) + sizeof(Block), alignment);
+	m_cursor = p + bytes;
+	m_end = reinterpret_cast<std::byte*>(block) + m_block_size;
+	m_last_allocation = p;
+	return p;
+}
+
+void Anni::ModelLoader::ArenaMemoryResource::do_deallocate(void* p, const size_t bytes, size_t)
+{
+	std::scoped_lock lock(m_mutex);
+	if ( p == m_last_allocation && static_cast<std::byte*>(p) + bytes == m_cursor )
+	{
+		m_cursor = m_last_allocation;
+		m_last_allocation = nullptr;
+		m_used_bytes -= bytes;
+	}
+}
+
+bool Anni::ModelLoader::ArenaMemoryResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+	return this == &other;
+}
+
+Anni::ModelLoader::ArenaMemoryResource::Block* Anni::ModelLoader::ArenaMemoryResource::AllocateBlock(const size_t size, const size_t alignment)
+{
+	auto* const block = static_cast<Block*>(m_upstream->allocate(size, alignment));
+	block->size = size;
+	block->alignment = alignment;
+	m_reserved_bytes += size;
+	++m_block_count;
+	return block;
+}
+
+
+//> COUNTING
+Anni::ModelLoader::CountingMemoryResource::CountingMemoryResource(std::pmr::memory_resource* upstream) :
+	m_upstream(upstream ? upstream : std::pmr::get_default_resource())
+{
+}
+
+Anni::ModelLoader::CountingMemoryResource::Stats Anni::ModelLoader::CountingMemoryResource::GetStats() const
+{
+	Stats stats;
+	stats.allocation_count = m_allocation_count.load(std::memory_order_relaxed);
+	stats.deallocation_count = m_deallocation_count.load(std::memory_order_relaxed);
+	stats.allocated_bytes = m_allocated_bytes.load(std::memory_order_relaxed);
+	stats.live_bytes = m_live_bytes.load(std::memory_order_relaxed);
+	stats.peak_live_bytes = m_peak_live_bytes.load(std::memory_order_relaxed);
+	return stats;
+}
+
+void Anni::ModelLoader::CountingMemoryResource::ResetStats()
+{
+	m_allocation_count.store(0, std::memory_order_relaxed);
+	m_deallocation_count.store(0, std::memory_order_relaxed);
+	m_allocated_bytes.store(0, std::memory_order_relaxed);
+	m_peak_live_bytes.store(m_live_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void* Anni::ModelLoader::CountingMemoryResource::do_allocate(const size_t bytes, const size_t alignment)
+{
+	void* const p = m_upstream->allocate(bytes, alignment);
+	m_allocation_count.fetch_add(1, std::memory_order_relaxed);
+	m_allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+	const uint64_t live_bytes = m_live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+	uint64_t peak_live_bytes = m_peak_live_bytes.load(std::memory_order_relaxed);
+	while ( peak_live_bytes < live_bytes && !m_peak_live_bytes.compare_exchange_weak(peak_live_bytes, live_bytes, std::memory_order_relaxed) )
+	{
+	}
+	return p;
+}
+
+void Anni::ModelLoader::CountingMemoryResource::do_deallocate(void* p, const size_t bytes, const size_t alignment)
+{
+	m_upstream->deallocate(p, bytes, alignment);
+	m_deallocation_count.fetch_add(1, std::memory_order_relaxed);
+	m_live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+bool Anni::ModelLoader::CountingMemoryResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+	return this == &other;
+}
@@ -0,0 +1,673 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+
+namespace
+{
+	using namespace Anni::ModelLoader;
+
+	constexpr uint32_t invalid_index = std::numeric_limits<uint32_t>::max();
+	constexpr uint32_t max_simplify_passes = 128;
+
+	// sum of squared distances to a set of planes, weighted by triangle area
+	struct Quadric
+	{
+		double a00{ 0. }, a01{ 0. }, a02{ 0. }, a11{ 0. }, a12{ 0. }, a22{ 0. };
+		double b0{ 0. }, b1{ 0. }, b2{ 0. };
+		double c{ 0. };
+		double weight{ 0. };
+
+		void AddPlane(const glm::vec3& normal, const double distance, const double plane_weight)
+		{
+			a00 += plane_weight * normal.x * normal.x;
+			a01 += plane_weight * normal.x * normal.y;
+			a02 += plane_weight * normal.x * normal.z;
+			a11 += plane_weight * normal.y * normal.y;
+			a12 += plane_weight * normal.y * normal.z;
+			a22 += plane_weight * normal.z * normal.z;
+			b0 += plane_weight * normal.x * distance;
+			b1 += plane_weight * normal.y * distance;
+			b2 += plane_weight * normal.z * distance;
+			c += plane_weight * distance * distance;
+			weight += plane_weight;
+		}
+
+		void Add(const Quadric& other)
+		{
+			a00 += other.a00;
+			a01 += other.a01;
+			a02 += other.a02;
+			a11 += other.a11;
+			a12 += other.a12;
+			a22 += other.a22;
+			b0 += other.b0;
+			b1 += other.b1;
+			b2 += other.b2;
+			c += other.c;
+			weight += other.weight;
+		}
+
+		// p^T A p + 2 b.p + c
+		[[nodiscard]] double Evaluate(const glm::vec3& p) const
+		{
+			const double x = p.x;
+			const double y = p.y;
+			const double z = p.z;
+			const double result =
+				a00 * x * x + a11 * y * y + a22 * z * z +
+				2. * (a01 * x * y + a02 * x * z + a12 * y * z) +
+				2. * (b0 * x + b1 * y + b2 * z) + c;
+			return std::max(result, 0.);
+		}
+	};
+
+	struct Collapse
+	{
+		double cost;
+		uint32_t from;
+		uint32_t to;
+	};
+
+	// first vertex with the same bytes(key_size bytes from the start of key_offset), used to weld by position and by full vertex
+	std::vector<uint32_t> BuildWeldMap(const std::span<const LoadedVertex> vertices, const size_t key_offset, const size_t key_size)
+	{
+		const size_t table_size = std::bit_ceil(std::max<size_t>(vertices.size() * 2, 16));
+		const size_t table_mask = table_size - 1;
+		std::vector<uint32_t> table(table_size, invalid_index);
+		std::vector<uint32_t> weld(vertices.size());
+		for ( size_t v = 0; v < vertices.size(); ++v )
+		{
+			const auto* key = reinterpret_cast<const uint8_t*>(&vertices[v]) + key_offset;
+			uint64_t hash = 14695981039346656037ull;
+			for ( size_t i = 0; i < key_size; ++i )
+			{
+				hash = (hash ^ key[i]) * 1099511628211ull;
+			}
+
+			for ( size_t slot = hash & table_mask;; slot = (slot + 1) & table_mask )
+			{
+				const uint32_t entry = table[slot];
+				if ( entry == invalid_index )
+				{
+					table[slot] = static_cast<uint32_t>(v);
+					weld[v] = static_cast<uint32_t>(v);
+					break;
+				}
+				if ( memcmp(reinterpret_cast<const uint8_t*>(&vertices[entry]) + key_offset, key, key_size) == 0 )
+				{
+					weld[v] = entry;
+					break;
+				}
+			}
+		}
+		return weld;
+	}
+
+	glm::vec3 TriangleNormal(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2)
+	{
+		return glm::cross(p1 - p0, p2 - p0);
+	}
+}
+
+std::span<const Anni::ModelLoader::LoadedMeshAsset::HomoMatTris> Anni::ModelLoader::LoadedMeshAsset::GetLodHomoMatTris(const uint32_t lod_level) const
+{
+	if ( lod_level == 0 || lods.empty() )
+	{
+		return homo_mat_tris_array;
+	}
+	return lods[std::min<size_t>(lod_level, lods.size()) - 1].homo_mat_tris_array;
+}
+
+uint32_t Anni::ModelLoader::LodSelection::SelectLevel(const LoadedMeshAsset& mesh_asset, const glm::mat4& world_transform) const
+{
+	if ( mesh_asset.lods.empty() )
+	{
+		return 0;
+	}
+
+	// the largest axis scale bounds how much the transform can stretch the mesh space error
+	const float scale = std::sqrt(std::max({
+		glm::dot(glm::vec3(world_transform[0]), glm::vec3(world_transform[0])),
+		glm::dot(glm::vec3(world_transform[1]), glm::vec3(world_transform[1])),
+		glm::dot(glm::vec3(world_transform[2]), glm::vec3(world_transform[2])) }));
+	const glm::vec3 center = glm::vec3(world_transform * glm::vec4(mesh_asset.bounding_sphere.center, 1.f));
+	const float distance = glm::length(center - camera_position) - mesh_asset.bounding_sphere.radius * scale;
+	if ( distance <= 0.f )
+	{
+		return 0;
+	}
+
+	uint32_t level = 0;
+	for ( const auto& lod : mesh_asset.lods )
+	{
+		if ( lod.error * scale / distance * projection_scale > max_pixel_error )
+		{
+			break;
+		}
+		++level;
+	}
+	return level;
+}
+
+void Anni::ModelLoader::MeshOptimizer::BuildLodChain(LoadedMeshAsset& mesh_asset, const std::span<const float> lod_ratios)
+{
+	std::vector<float> ratios;
+	std::ranges::copy_if(lod_ratios, std::back_inserter(ratios), [](const float ratio) { return ratio > 0.f && ratio < 1.f; });
+	std::ranges::sort(ratios, std::ranges::greater{});
+	mesh_asset.lods.clear();
+	if ( ratios.empty() )
+	{
+		return;
+	}
+	mesh_asset.lods.resize(ratios.size(), { 0.f, {} });
+
+	std::pmr::vector<uint32_t>& indices = mesh_asset.buffer_in_one.indices;
+	const std::pmr::vector<LoadedVertex>& vertices = mesh_asset.buffer_in_one.vertices;
+	// simplified ranges are gathered here and appended to indices in one go, growing indices bit by bit would waste its arena
+	std::vector<uint32_t> lod_indices;
+
+	// every homo mat tris range is simplified on its own compact copy
+	std::vector<uint32_t> local_indices;
+	std::vector<uint32_t> local_to_mesh;
+	std::vector<LoadedVertex> local_vertices;
+	std::vector<uint32_t> mesh_to_local(vertices.size(), invalid_index);
+	std::vector<size_t> target_index_counts(ratios.size());
+	std::vector<std::vector<uint32_t>> levels;
+	for ( const auto& homo_mat_tris : mesh_asset.homo_mat_tris_array )
+	{
+		if ( homo_mat_tris.count % 3 != 0 || homo_mat_tris.start_index + static_cast<size_t>(homo_mat_tris.count) > indices.size() )
+		{
+			// not a triangle list, every level draws the full range
+			for ( auto& lod : mesh_asset.lods )
+			{
+				lod.homo_mat_tris_array.push_back(homo_mat_tris);
+			}
+			continue;
+		}
+
+		local_indices.clear();
+		local_to_mesh.clear();
+		local_vertices.clear();
+		for ( uint32_t i = homo_mat_tris.start_index; i < homo_mat_tris.start_index + homo_mat_tris.count; ++i )
+		{
+			const uint32_t index = indices[i];
+			if ( mesh_to_local[index] == invalid_index )
+			{
+				mesh_to_local[index] = static_cast<uint32_t>(local_to_mesh.size());
+				local_to_mesh.push_back(index);
+				local_vertices.push_back(vertices[index]);
+			}
+			local_indices.push_back(mesh_to_local[index]);
+		}
+		for ( const uint32_t index : local_to_mesh )
+		{
+			mesh_to_local[index] = invalid_index;
+		}
+
+		for ( size_t level = 0; level < ratios.size(); ++level )
+		{
+			target_index_counts[level] = static_cast<size_t>(static_cast<float>(homo_mat_tris.count / 3) * ratios[level]) * 3;
+		}
+		const std::vector<float> errors = SimplifyIndices(local_indices, local_vertices, target_index_counts, levels);
+
+		LoadedMeshAsset::HomoMatTris previous = homo_mat_tris;
+		for ( size_t level = 0; level < ratios.size(); ++level )
+		{
+			LoadedMeshAsset::LodLevel& lod = mesh_asset.lods[level];
+			lod.error = std::max(lod.error, errors[level]);
+
+			// a level that didn't get any smaller reuses the previous range
+			LoadedMeshAsset::HomoMatTris lod_homo_mat_tris = homo_mat_tris;
+			if ( levels[level].size() < previous.count )
+			{
+				OptimizeVertexCache(levels[level], local_vertices.size());
+				lod_homo_mat_tris.start_index = static_cast<uint32_t>(indices.size() + lod_indices.size());
+				lod_homo_mat_tris.count = static_cast<uint32_t>(levels[level].size());
+				for ( const uint32_t local_index : levels[level] )
+				{
+					lod_indices.push_back(local_to_mesh[local_index]);
+				}
+			}
+			else
+			{
+				lod_homo_mat_tris.start_index = previous.start_index;
+				lod_homo_mat_tris.count = previous.count;
+			}
+			lod.homo_mat_tris_array.push_back(lod_homo_mat_tris);
+			previous = lod_homo_mat_tris;
+		}
+	}
+	indices.reserve(indices.size() + lod_indices.size());
+	indices.insert(indices.end(), lod_indices.begin(), lod_indices.end());
+
+	// coarser levels never claim to be more accurate than finer ones
+	for ( size_t level = 1; level < mesh_asset.lods.size(); ++level )
+	{
+		mesh_asset.lods[level].error = std::max(mesh_asset.lods[level].error, mesh_asset.lods[level - 1].error);
+	}
+}
+
+std::vector<float> Anni::ModelLoader::MeshOptimizer::SimplifyIndices(const std::span<const uint32_t> indices, const std::span<const LoadedVertex> vertices, const std::span<const size_t> target_index_counts, std::vector<std::vector<uint32_t>>& output_levels)
+{
+	const size_t vertex_count = vertices.size();
+	std::vector<float> errors(target_index_counts.size(), 0.f);
+	output_levels.assign(target_index_counts.size(), {});
+	std::vector<uint8_t> level_written(target_index_counts.size(), 0);
+
+	//> WELDING
+	// topology works on positions so attribute seams don't look like borders, a position with several distinct vertices is a seam
+	const std::vector<uint32_t> position_weld = BuildWeldMap(vertices, offsetof(LoadedVertex, position), sizeof(glm::vec3));
+	const std::vector<uint32_t> vertex_weld = BuildWeldMap(vertices, 0, sizeof(LoadedVertex));
+	std::vector<uint32_t> wedge_counts(vertex_count, 0);
+	for ( size_t v = 0; v < vertex_count; ++v )
+	{
+		if ( vertex_weld[v] == v )
+		{
+			++wedge_counts[position_weld[v]];
+		}
+	}
+
+	// current triangles as vertex indices for the output and as welded positions(also vertex indices) for everything else
+	std::vector<uint32_t> triangles;
+	std::vector<uint32_t> triangle_nodes;
+	triangles.reserve(indices.size());
+	triangle_nodes.reserve(indices.size());
+	for ( size_t i = 0; i + 2 < indices.size(); i += 3 )
+	{
+		const uint32_t a = position_weld[indices[i]];
+		const uint32_t b = position_weld[indices[i + 1]];
+		const uint32_t c = position_weld[indices[i + 2]];
+		if ( a != b && b != c && a != c )
+		{
+			triangles.insert(triangles.end(), { indices[i], indices[i + 1], indices[i + 2] });
+			triangle_nodes.insert(triangle_nodes.end(), { a, b, c });
+		}
+	}
+
+	//> LOCKED VERTICES
+	// open borders, non manifold edges and seams stay where they are
+	std::vector<uint8_t> locked(vertex_count, 0);
+	for ( size_t v = 0; v < vertex_count; ++v )
+	{
+		locked[v] = wedge_counts[position_weld[v]] > 1;
+	}
+	{
+		std::vector<uint64_t> edges;
+		edges.reserve(triangle_nodes.size());
+		for ( size_t t = 0; t < triangle_nodes.size(); t += 3 )
+		{
+			for ( size_t corner = 0; corner < 3; ++corner )
+			{
+				const uint64_t a = triangle_nodes[t + corner];
+				const uint64_t b = triangle_nodes[t + (corner + 1) % 3];
+				edges.push_back(std::min(a, b) << 32 | std::max(a, b));
+			}
+		}
+		std::ranges::sort(edges);
+		for ( size_t begin = 0; begin < edges.size(); )
+		{
+			size_t end = begin + 1;
+			while ( end < edges.size() && edges[end] == edges[begin] )
+			{
+				++end;
+			}
+			if ( end - begin != 2 )
+			{
+				locked[edges[begin] >> 32] = 1;
+				locked[edges[begin] & 0xffffffffull] = 1;
+			}
+			begin = end;
+		}
+	}
+
+	//> QUADRICS
+	std::vector<Quadric> quadrics(vertex_count);
+	for ( size_t t = 0; t < triangle_nodes.size(); t += 3 )
+	{
+		const glm::vec3& p0 = vertices[triangle_nodes[t]].position;
+		const glm::vec3 normal = TriangleNormal(p0, vertices[triangle_nodes[t + 1]].position, vertices[triangle_nodes[t + 2]].position);
+		const float double_area = glm::length(normal);
+		if ( double_area <= 0.f )
+		{
+			continue;
+		}
+		const glm::vec3 unit_normal = normal / double_area;
+		const double distance = -glm::dot(unit_normal, p0);
+		for ( size_t corner = 0; corner < 3; ++corner )
+		{
+			quadrics[triangle_nodes[t + corner]].AddPlane(unit_normal, distance, double_area * 0.5);
+		}
+	}
+
+	//> EDGE COLLAPSES
+	// every pass collapses the cheapest independent edges, then rebuilds the triangle list
+	std::vector<uint32_t> collapse_targets(vertex_count);
+	for ( size_t v = 0; v < vertex_count; ++v )
+	{
+		collapse_targets[v] = static_cast<uint32_t>(v);
+	}
+	std::vector<uint32_t> adjacency_offsets(vertex_count + 1);
+	std::vector<uint32_t> adjacency;
+	std::vector<Collapse> collapses;
+	std::vector<uint8_t> touched(vertex_count);
+	double max_cost = 0.;
+
+	const auto write_levels = [&]()
+	{
+		for ( size_t level = 0; level < target_index_counts.size(); ++level )
+		{
+			if ( !level_written[level] && triangle_nodes.size() <= target_index_counts[level] )
+			{
+				output_levels[level] = triangles;
+				errors[level] = static_cast<float>(std::sqrt(max_cost));
+				level_written[level] = 1;
+			}
+		}
+	};
+
+	for ( uint32_t pass = 0; pass < max_simplify_passes; ++pass )
+	{
+		write_levels();
+		const auto next_level = std::ranges::find(level_written, 0);
+		if ( next_level == level_written.end() )
+		{
+			break;
+		}
+		const size_t target_index_count = target_index_counts[next_level - level_written.begin()];
+
+		// triangles around every vertex
+		std::ranges::fill(adjacency_offsets, 0);
+		for ( const uint32_t v : triangle_nodes )
+		{
+			++adjacency_offsets[v + 1];
+		}
+		for ( size_t v = 0; v < vertex_count; ++v )
+		{
+			adjacency_offsets[v + 1] += adjacency_offsets[v];
+		}
+		adjacency.resize(triangle_nodes.size());
+		{
+			std::vector<uint32_t> cursors(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+			for ( size_t i = 0; i < triangle_nodes.size(); ++i )
+			{
+				adjacency[cursors[triangle_nodes[i]]++] = static_cast<uint32_t>(i / 3);
+			}
+		}
+
+		// candidates, an edge is collapsed onto one of its ends so no new vertices are made
+		collapses.clear();
+		for ( size_t t = 0; t < triangle_nodes.size(); t += 3 )
+		{
+			for ( size_t corner = 0; corner < 3; ++corner )
+			{
+				const uint32_t a = triangle_nodes[t + corner];
+				const uint32_t b = triangle_nodes[t + (corner + 1) % 3];
+				for ( const auto& [from, to] : { std::pair{ a, b }, std::pair{ b, a } } )
+				{
+					if ( locked[from] || wedge_counts[to] > 1 )
+					{
+						continue;
+					}
+					Quadric merged = quadrics[from];
+					merged.Add(quadrics[to]);
+					const double cost = merged.weight > 0. ? merged.Evaluate(vertices[to].position) / merged.weight : 0.;
+					collapses.push_back({ cost, from, to });
+				}
+			}
+		}
+		std::ranges::sort(collapses, [](const Collapse& lhs, const Collapse& rhs) { return lhs.cost < rhs.cost; });
+
+		// a collapse removes two triangles on a closed surface
+		const size_t triangles_to_remove = (triangle_nodes.size() - std::min(triangle_nodes.size(), target_index_count)) / 3;
+		size_t removed_triangles = 0;
+		std::ranges::fill(touched, 0);
+		for ( const Collapse& collapse : collapses )
+		{
+			if ( removed_triangles >= triangles_to_remove )
+			{
+				break;
+			}
+			if ( touched[collapse.from] || touched[collapse.to] )
+			{
+				continue;
+			}
+
+			// moving from onto to must not flip any remaining triangle
+			bool flips = false;
+			size_t collapsed_triangles = 0;
+			for ( uint32_t a = adjacency_offsets[collapse.from]; a < adjacency_offsets[collapse.from + 1] && !flips; ++a )
+			{
+				const size_t t = adjacency[a] * 3;
+				std::array<glm::vec3, 3> corners;
+				bool contains_target = false;
+				for ( size_t corner = 0; corner < 3; ++corner )
+				{
+					corners[corner] = vertices[triangle_nodes[t + corner]].position;
+					contains_target |= triangle_nodes[t + corner] == collapse.to;
+				}
+				if ( contains_target )
+				{
+					++collapsed_triangles;
+					continue;
+				}
+
+				const glm::vec3 old_normal = TriangleNormal(corners[0], corners[1], corners[2]);
+				for ( size_t corner = 0; corner < 3; ++corner )
+				{
+					if ( triangle_nodes[t + corner] == collapse.from )
+					{
+						corners[corner] = vertices[collapse.to].position;
+					}
+				}
+				flips = glm::dot(old_normal, TriangleNormal(corners[0], corners[1], corners[2])) <= 0.f;
+			}
+			if ( flips )
+			{
+				continue;
+			}
+
+			collapse_targets[collapse.from] = collapse.to;
+			quadrics[collapse.to].Add(quadrics[collapse.from]);
+			max_cost = std::max(max_cost, collapse.cost);
+			removed_triangles += collapsed_triangles;
+
+			// the whole one ring changes shape, later collapses this pass would be judged on stale triangles
+			for ( uint32_t a = adjacency_offsets[collapse.from]; a < adjacency_offsets[collapse.from + 1]; ++a )
+			{
+				const size_t t = adjacency[a] * 3;
+				touched[triangle_nodes[t]] = touched[triangle_nodes[t + 1]] = touched[triangle_nodes[t + 2]] = 1;
+			}
+		}
+
+		if ( removed_triangles == 0 )
+		{
+			break;
+		}
+
+		// a vertex is collapsed at most once per pass and never onto one collapsed in the same pass, one hop resolves it.
+		// a moved corner takes the target's vertex, both positions have one distinct vertex so no attributes get mixed up
+		size_t write = 0;
+		for ( size_t t = 0; t < triangle_nodes.size(); t += 3 )
+		{
+			std::array<uint32_t, 3> corners{ triangles[t], triangles[t + 1], triangles[t + 2] };
+			std::array<uint32_t, 3> corner_nodes{ triangle_nodes[t], triangle_nodes[t + 1], triangle_nodes[t + 2] };
+			for ( size_t corner = 0; corner < 3; ++corner )
+			{
+				if ( collapse_targets[corner_nodes[corner]] != corner_nodes[corner] )
+				{
+					corner_nodes[corner] = collapse_targets[corner_nodes[corner]];
+					corners[corner] = corner_nodes[corner];
+				}
+			}
+			if ( corner_nodes[0] != corner_nodes[1] && corner_nodes[1] != corner_nodes[2] && corner_nodes[0] != corner_nodes[2] )
+			{
+				for ( size_t corner = 0; corner < 3; ++corner )
+				{
+					triangles[write] = corners[corner];
+					triangle_nodes[write++] = corner_nodes[corner];
+				}
+			}
+		}
+		triangles.resize(write);
+		triangle_nodes.resize(write);
+	}
+
+	// levels the simplifier couldn't reach get the smallest result
+	for ( size_t level = 0; level < target_index_counts.size(); ++level )
+	{
+		if ( !level_written[level] )
+		{
+			output_levels[level] = triangles;
+			errors[level] = static_cast<float>(std::sqrt(max_cost));
+		}
+	}
+	return errors;
+}
+
+void Anni::ModelLoader::MeshOptimizer::BuildMeshlets(LoadedMeshAsset& mesh_asset, uint32_t max_vertices, uint32_t max_triangles)
+{
+	max_vertices = std::clamp(max_vertices, 3u, meshlet_vertex_limit);
+	max_triangles = std::max(max_triangles, 1u);
+
+	const std::pmr::vector<uint32_t>& indices = mesh_asset.buffer_in_one.indices;
+	const std::pmr::vector<LoadedVertex>& vertices = mesh_asset.buffer_in_one.vertices;
+	mesh_asset.meshlets.clear();
+	mesh_asset.meshlet_vertices.clear();
+	mesh_asset.meshlet_triangles.clear();
+
+	std::vector<uint32_t> local_indices(vertices.size(), invalid_index);
+
+	const auto finish_meshlet = [&](LoadedMeshAsset::Meshlet& meshlet)
+	{
+		const std::span<const uint32_t> meshlet_vertices = std::span<const uint32_t>(mesh_asset.meshlet_vertices).subspan(meshlet.vertex_offset, meshlet.vertex_count);
+		const std::span<const uint8_t> meshlet_triangles = std::span<const uint8_t>(mesh_asset.meshlet_triangles).subspan(meshlet.triangle_offset, meshlet.triangle_count * 3);
+
+		//> BOUNDS
+		BoundingBox box;
+		for ( const uint32_t v : meshlet_vertices )
+		{
+			box.min = glm::min(box.min, vertices[v].position);
+			box.max = glm::max(box.max, vertices[v].position);
+			local_indices[v] = invalid_index;
+		}
+		meshlet.bounding_sphere.center = box.GetCenter();
+		float max_distance_squared = 0.f;
+		for ( const uint32_t v : meshlet_vertices )
+		{
+			const glm::vec3 offset = vertices[v].position - meshlet.bounding_sphere.center;
+			max_distance_squared = std::max(max_distance_squared, glm::dot(offset, offset));
+		}
+		meshlet.bounding_sphere.radius = std::sqrt(max_distance_squared);
+
+		//> NORMAL CONE
+		// axis is the average face normal, the cutoff comes from the normal furthest away from it
+		glm::vec3 axis{ 0.f };
+		for ( size_t t = 0; t < meshlet_triangles.size(); t += 3 )
+		{
+			const glm::vec3 normal = TriangleNormal(
+				vertices[meshlet_vertices[meshlet_triangles[t]]].position,
+				vertices[meshlet_vertices[meshlet_triangles[t + 1]]].position,
+				vertices[meshlet_vertices[meshlet_triangles[t + 2]]].position);
+			const float length = glm::length(normal);
+			axis += length > 0.f ? normal / length : glm::vec3{ 0.f };
+		}
+
+		meshlet.cone_apex = meshlet.bounding_sphere.center;
+		meshlet.cone_axis = glm::vec3{ 0.f };
+		meshlet.cone_cutoff = 1.f;
+		const float axis_length = glm::length(axis);
+		if ( axis_length <= 0.f )
+		{
+			return;
+		}
+		axis /= axis_length;
+
+		float min_dot = 1.f;
+		float max_t = 0.f;
+		for ( size_t t = 0; t < meshlet_triangles.size(); t += 3 )
+		{
+			const glm::vec3& p0 = vertices[meshlet_vertices[meshlet_triangles[t]]].position;
+			glm::vec3 normal = TriangleNormal(p0,
+				vertices[meshlet_vertices[meshlet_triangles[t + 1]]].position,
+				vertices[meshlet_vertices[meshlet_triangles[t + 2]]].position);
+			const float length = glm::length(normal);
+			if ( length <= 0.f )
+			{
+				continue;
+			}
+			normal /= length;
+
+			const float normal_dot = glm::dot(normal, axis);
+			min_dot = std::min(min_dot, normal_dot);
+			if ( normal_dot > 0.f )
+			{
+				// the apex sits far enough behind the center to be behind every triangle plane
+				max_t = std::max(max_t, glm::dot(meshlet.bounding_sphere.center - p0, normal) / normal_dot);
+			}
+		}
+
+		// a cone wider than ~84 degrees culls too rarely to be worth testing
+		if ( min_dot <= 0.1f )
+		{
+			return;
+		}
+		meshlet.cone_axis = axis;
+		meshlet.cone_apex = meshlet.bounding_sphere.center - axis * max_t;
+		meshlet.cone_cutoff = std::sqrt(1.f - min_dot * min_dot);
+	};
+
+	for ( auto [homo_mat_tris_index, homo_mat_tris] : std::ranges::views::enumerate(mesh_asset.homo_mat_tris_array) )
+	{
+		if ( homo_mat_tris.count % 3 != 0 || homo_mat_tris.start_index + static_cast<size_t>(homo_mat_tris.count) > indices.size() )
+		{
+			continue;
+		}
+
+		// greedy scan, the index order is already cache friendly so neighbouring triangles share vertices
+		LoadedMeshAsset::Meshlet meshlet{};
+		meshlet.homo_mat_tris_index = static_cast<uint32_t>(homo_mat_tris_index);
+		meshlet.vertex_offset = static_cast<uint32_t>(mesh_asset.meshlet_vertices.size());
+		meshlet.triangle_offset = static_cast<uint32_t>(mesh_asset.meshlet_triangles.size());
+		for ( uint32_t i = homo_mat_tris.start_index; i < homo_mat_tris.start_index + homo_mat_tris.count; i += 3 )
+		{
+			const std::array<uint32_t, 3> corners{ indices[i], indices[i + 1], indices[i + 2] };
+			uint32_t new_vertices = 0;
+			for ( size_t corner = 0; corner < 3; ++corner )
+			{
+				const bool repeated = std::find(corners.begin(), corners.begin() + corner, corners[corner]) != corners.begin() + corner;
+				new_vertices += local_indices[corners[corner]] == invalid_index && !repeated ? 1 : 0;
+			}
+
+			if ( meshlet.vertex_count + new_vertices > max_vertices || meshlet.triangle_count + 1 > max_triangles )
+			{
+				finish_meshlet(meshlet);
+				mesh_asset.meshlets.push_back(meshlet);
+				meshlet.vertex_offset = static_cast<uint32_t>(mesh_asset.meshlet_vertices.size());
+				meshlet.triangle_offset = static_cast<uint32_t>(mesh_asset.meshlet_triangles.size());
+				meshlet.vertex_count = 0;
+				meshlet.triangle_count = 0;
+			}
+
+			for ( const uint32_t v : corners )
+			{
+				if ( local_indices[v] == invalid_index )
+				{
+					local_indices[v] = meshlet.vertex_count++;
+					mesh_asset.meshlet_vertices.push_back(v);
+				}
+				mesh_asset.meshlet_triangles.push_back(static_cast<uint8_t>(local_indices[v]));
+			}
+			++meshlet.triangle_count;
+		}
+
+		if ( meshlet.triangle_count > 0 )
+		{
+			finish_meshlet(meshlet);
+			mesh_asset.meshlets.push_back(meshlet);
+		}
+	}
+}
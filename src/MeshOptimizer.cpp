@@ -0,0 +1,461 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+
+namespace
+{
+	using namespace Anni::ModelLoader;
+
+	constexpr uint32_t invalid_index = std::numeric_limits<uint32_t>::max();
+
+	// FNV-1a over the words of a LoadedVertex or LoadedSkinVertex, chained through hash
+	template <typename Vertex>
+	uint64_t HashVertex(const Vertex& vertex, uint64_t hash = 14695981039346656037ull)
+	{
+		static_assert(sizeof(Vertex) % sizeof(uint32_t) == 0);
+		std::array<uint32_t, sizeof(Vertex) / sizeof(uint32_t)> words;
+		memcpy(words.data(), &vertex, sizeof(Vertex));
+
+		for ( const uint32_t word : words )
+		{
+			hash = (hash ^ word) * 1099511628211ull;
+		}
+		return hash;
+	}
+
+	//> FORSYTH SCORING
+	// https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+	constexpr uint32_t forsyth_cache_size = 32;
+	constexpr uint32_t forsyth_max_valence = 32;
+
+	struct ForsythTables
+	{
+		std::array<float, forsyth_cache_size> cache_scores;
+		std::array<float, forsyth_max_valence + 1> valence_scores;
+
+		ForsythTables()
+		{
+			for ( uint32_t i = 0; i < forsyth_cache_size; ++i )
+			{
+				// the three vertices of the last triangle get a fixed score so the next triangle isn't biased towards one of them
+				cache_scores[i] = i < 3 ? 0.75f : std::pow(1.f - static_cast<float>(i - 3) / static_cast<float>(forsyth_cache_size - 3), 1.5f);
+			}
+			valence_scores[0] = 0.f;
+			for ( uint32_t i = 1; i <= forsyth_max_valence; ++i )
+			{
+				// vertices with few triangles left are finished first so they can leave the cache for good
+				valence_scores[i] = 2.f / std::sqrt(static_cast<float>(i));
+			}
+		}
+	};
+
+	float VertexScore(const int32_t cache_position, const uint32_t live_triangles)
+	{
+		static const ForsythTables tables;
+		if ( live_triangles == 0 )
+		{
+			return -1.f;
+		}
+
+		const float cache_score = cache_position < 0 ? 0.f : tables.cache_scores[cache_position];
+		return cache_score + tables.valence_scores[std::min(live_triangles, forsyth_max_valence)];
+	}
+}
+
+double Anni::ModelLoader::MeshOptimizationReport::GetAcmrBefore() const
+{
+	return triangle_count ? static_cast<double>(cache_misses_before) / static_cast<double>(triangle_count) : 0.;
+}
+
+double Anni::ModelLoader::MeshOptimizationReport::GetAcmrAfter() const
+{
+	return triangle_count ? static_cast<double>(cache_misses_after) / static_cast<double>(triangle_count) : 0.;
+}
+
+void Anni::ModelLoader::MeshOptimizationReport::Merge(const MeshOptimizationReport& other)
+{
+	triangle_count += other.triangle_count;
+	vertex_count_before += other.vertex_count_before;
+	vertex_count_after += other.vertex_count_after;
+	cache_misses_before += other.cache_misses_before;
+	cache_misses_after += other.cache_misses_after;
+}
+
+Anni::ModelLoader::MeshOptimizationReport Anni::ModelLoader::MeshOptimizer::Optimize(LoadedMeshAsset& mesh_asset)
+{
+	std::pmr::vector<LoadedVertex>& vertices = mesh_asset.buffer_in_one.vertices;
+	std::pmr::vector<LoadedSkinVertex>& skin_vertices = mesh_asset.buffer_in_one.skin_vertices;
+	std::pmr::vector<uint32_t>& indices = mesh_asset.buffer_in_one.indices;
+
+	MeshOptimizationReport report;
+	report.triangle_count = indices.size() / 3;
+	report.vertex_count_before = vertices.size();
+	report.cache_misses_before = SimulateVertexCache(indices, vertices.size());
+
+	const size_t vertex_count = DeduplicateVertices(vertices, skin_vertices, indices);
+
+	// every homo mat tris range is optimized on its own compact numbering, the scratch is sized once per mesh
+	std::vector<uint32_t> local_indices;
+	std::vector<uint32_t> local_to_mesh;
+	std::vector<glm::vec3> local_positions;
+	std::vector<uint32_t> mesh_to_local(vertex_count, invalid_index);
+	for ( const auto& homo_mat_tris : mesh_asset.homo_mat_tris_array )
+	{
+		if ( homo_mat_tris.count % 3 != 0 || homo_mat_tris.start_index + static_cast<size_t>(homo_mat_tris.count) > indices.size() )
+		{
+			// not a triangle list, leave it as it is
+			continue;
+		}
+		const std::span<uint32_t> range = std::span<uint32_t>(indices).subspan(homo_mat_tris.start_index, homo_mat_tris.count);
+
+		local_indices.clear();
+		local_to_mesh.clear();
+		local_positions.clear();
+		for ( const uint32_t index : range )
+		{
+			if ( mesh_to_local[index] == invalid_index )
+			{
+				mesh_to_local[index] = static_cast<uint32_t>(local_to_mesh.size());
+				local_to_mesh.push_back(index);
+				local_positions.push_back(vertices[index].position);
+			}
+			local_indices.push_back(mesh_to_local[index]);
+		}
+
+		OptimizeVertexCache(local_indices, local_to_mesh.size());
+		OptimizeOverdraw(local_indices, local_positions);
+
+		for ( size_t i = 0; i < range.size(); ++i )
+		{
+			range[i] = local_to_mesh[local_indices[i]];
+		}
+		for ( const uint32_t index : local_to_mesh )
+		{
+			mesh_to_local[index] = invalid_index;
+		}
+	}
+
+	OptimizeVertexFetch(vertices, skin_vertices, indices);
+
+	report.vertex_count_after = vertices.size();
+	report.cache_misses_after = SimulateVertexCache(indices, vertices.size());
+	return report;
+}
+
+size_t Anni::ModelLoader::MeshOptimizer::DeduplicateVertices(std::pmr::vector<LoadedVertex>& vertices, std::pmr::vector<LoadedSkinVertex>& skin_vertices, const std::span<uint32_t> indices)
+{
+	const size_t vertex_count = vertices.size();
+	const bool skinned = !skin_vertices.empty();
+
+	// open addressing, at most half full
+	const size_t table_size = std::bit_ceil(std::max<size_t>(vertex_count * 2, 16));
+	const size_t table_mask = table_size - 1;
+	std::vector<uint32_t> table(table_size, invalid_index);
+	std::vector<uint32_t> remap(vertex_count);
+
+	// unique vertices are compacted to the front as they are found, entries in the table always point below the current vertex
+	size_t unique_count = 0;
+	for ( size_t v = 0; v < vertex_count; ++v )
+	{
+		uint64_t hash = HashVertex(vertices[v]);
+		hash = skinned ? HashVertex(skin_vertices[v], hash) : hash;
+		for ( size_t slot = (hash ^ (hash >> 32)) & table_mask;; slot = (slot + 1) & table_mask )
+		{
+			const uint32_t entry = table[slot];
+			if ( entry == invalid_index )
+			{
+				table[slot] = static_cast<uint32_t>(unique_count);
+				vertices[unique_count] = vertices[v];
+				if ( skinned )
+				{
+					skin_vertices[unique_count] = skin_vertices[v];
+				}
+				remap[v] = static_cast<uint32_t>(unique_count++);
+				break;
+			}
+			if ( memcmp(&vertices[entry], &vertices[v], sizeof(LoadedVertex)) == 0 &&
+				(!skinned || memcmp(&skin_vertices[entry], &skin_vertices[v], sizeof(LoadedSkinVertex)) == 0) )
+			{
+				remap[v] = entry;
+				break;
+			}
+		}
+	}
+
+	vertices.resize(unique_count);
+	if ( skinned )
+	{
+		skin_vertices.resize(unique_count);
+	}
+	for ( uint32_t& index : indices )
+	{
+		index = remap[index];
+	}
+	return unique_count;
+}
+
+void Anni::ModelLoader::MeshOptimizer::OptimizeVertexCache(const std::span<uint32_t> indices, const size_t vertex_count)
+{
+	const size_t triangle_count = indices.size() / 3;
+	if ( triangle_count < 2 )
+	{
+		return;
+	}
+
+	//> ADJACENCY
+	// triangles of vertex v are adjacency[offsets[v], offsets[v] + live_triangles[v]), drawn ones are swapped out of the live part
+	std::vector<uint32_t> live_triangles(vertex_count, 0);
+	for ( const uint32_t index : indices )
+	{
+		++live_triangles[index];
+	}
+	std::vector<uint32_t> offsets(vertex_count + 1, 0);
+	std::inclusive_scan(live_triangles.begin(), live_triangles.end(), offsets.begin() + 1);
+	std::vector<uint32_t> adjacency(indices.size());
+	{
+		std::vector<uint32_t> cursors(offsets.begin(), offsets.end() - 1);
+		for ( size_t i = 0; i < indices.size(); ++i )
+		{
+			adjacency[cursors[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+	}
+
+	//> SCORES
+	std::vector<int32_t> cache_positions(vertex_count, -1);
+	std::vector<float> vertex_scores(vertex_count);
+	for ( size_t v = 0; v < vertex_count; ++v )
+	{
+		vertex_scores[v] = VertexScore(-1, live_triangles[v]);
+	}
+
+	std::vector<float> triangle_scores(triangle_count);
+	std::vector<uint8_t> drawn(triangle_count, 0);
+	uint32_t best_triangle = 0;
+	for ( size_t t = 0; t < triangle_count; ++t )
+	{
+		triangle_scores[t] = vertex_scores[indices[t * 3]] + vertex_scores[indices[t * 3 + 1]] + vertex_scores[indices[t * 3 + 2]];
+		if ( triangle_scores[t] > triangle_scores[best_triangle] )
+		{
+			best_triangle = static_cast<uint32_t>(t);
+		}
+	}
+
+	//> EMIT
+	std::vector<uint32_t> output;
+	output.reserve(indices.size());
+	std::array<uint32_t, forsyth_cache_size + 3> cache{};
+	std::array<uint32_t, forsyth_cache_size + 3> next_cache{};
+	size_t cache_count = 0;
+	size_t scan_cursor = 0;
+	for ( size_t emitted = 0; emitted < triangle_count; ++emitted )
+	{
+		if ( best_triangle == invalid_index )
+		{
+			// nothing around the cache is left, continue with the first triangle not drawn yet
+			while ( drawn[scan_cursor] )
+			{
+				++scan_cursor;
+			}
+			best_triangle = static_cast<uint32_t>(scan_cursor);
+		}
+
+		const uint32_t triangle = best_triangle;
+		drawn[triangle] = 1;
+		const std::array<uint32_t, 3> corners{ indices[triangle * 3], indices[triangle * 3 + 1], indices[triangle * 3 + 2] };
+		output.insert(output.end(), corners.begin(), corners.end());
+
+		for ( const uint32_t v : corners )
+		{
+			const auto live_begin = adjacency.begin() + offsets[v];
+			const auto live_end = live_begin + live_triangles[v];
+			const auto found = std::find(live_begin, live_end, triangle);
+			if ( found != live_end )
+			{
+				std::iter_swap(found, live_end - 1);
+				--live_triangles[v];
+			}
+		}
+
+		// the drawn triangle moves to the front, the rest of the cache shifts back
+		size_t next_count = 0;
+		for ( const uint32_t v : corners )
+		{
+			if ( std::find(next_cache.begin(), next_cache.begin() + next_count, v) == next_cache.begin() + next_count )
+			{
+				next_cache[next_count++] = v;
+			}
+		}
+		for ( size_t i = 0; i < cache_count; ++i )
+		{
+			const uint32_t v = cache[i];
+			if ( v != corners[0] && v != corners[1] && v != corners[2] )
+			{
+				next_cache[next_count++] = v;
+			}
+		}
+
+		// vertices pushed past the end are evicted, they are rescored here one last time
+		for ( size_t i = 0; i < next_count; ++i )
+		{
+			const uint32_t v = next_cache[i];
+			cache_positions[v] = i < forsyth_cache_size ? static_cast<int32_t>(i) : -1;
+			vertex_scores[v] = VertexScore(cache_positions[v], live_triangles[v]);
+		}
+
+		best_triangle = invalid_index;
+		float best_score = -1.f;
+		for ( size_t i = 0; i < next_count; ++i )
+		{
+			const uint32_t v = next_cache[i];
+			for ( uint32_t a = offsets[v]; a < offsets[v] + live_triangles[v]; ++a )
+			{
+				const uint32_t t = adjacency[a];
+				triangle_scores[t] = vertex_scores[indices[t * 3]] + vertex_scores[indices[t * 3 + 1]] + vertex_scores[indices[t * 3 + 2]];
+				if ( triangle_scores[t] > best_score )
+				{
+					best_score = triangle_scores[t];
+					best_triangle = t;
+				}
+			}
+		}
+
+		cache_count = std::min<size_t>(next_count, forsyth_cache_size);
+		std::copy_n(next_cache.begin(), cache_count, cache.begin());
+	}
+
+	std::ranges::copy(output, indices.begin());
+}
+
+void Anni::ModelLoader::MeshOptimizer::OptimizeOverdraw(const std::span<uint32_t> indices, const std::span<const glm::vec3> positions)
+{
+	const size_t triangle_count = indices.size() / 3;
+	if ( triangle_count < 2 )
+	{
+		return;
+	}
+
+	//> CLUSTERS
+	// a triangle that misses the cache with all three vertices starts a new strip anyway, reordering at those points costs no cache hits
+	std::vector<uint32_t> cluster_starts;
+	{
+		std::vector<uint32_t> timestamps(positions.size(), 0);
+		uint32_t time = simulated_cache_size + 1;
+		for ( size_t t = 0; t < triangle_count; ++t )
+		{
+			uint32_t misses = 0;
+			for ( size_t corner = 0; corner < 3; ++corner )
+			{
+				const uint32_t index = indices[t * 3 + corner];
+				if ( time - timestamps[index] > simulated_cache_size )
+				{
+					timestamps[index] = time++;
+					++misses;
+				}
+			}
+			if ( t == 0 || misses == 3 )
+			{
+				cluster_starts.push_back(static_cast<uint32_t>(t));
+			}
+		}
+	}
+	if ( cluster_starts.size() < 2 )
+	{
+		return;
+	}
+	cluster_starts.push_back(static_cast<uint32_t>(triangle_count));
+
+	//> SORT
+	// clusters facing away from the mesh center are likely in front of the rest, drawing them first lets depth testing reject more
+	const size_t cluster_count = cluster_starts.size() - 1;
+	std::vector<glm::vec3> cluster_centroids(cluster_count, glm::vec3{ 0.f });
+	std::vector<glm::vec3> cluster_normals(cluster_count, glm::vec3{ 0.f });
+	glm::vec3 mesh_centroid{ 0.f };
+	for ( size_t c = 0; c < cluster_count; ++c )
+	{
+		for ( uint32_t t = cluster_starts[c]; t < cluster_starts[c + 1]; ++t )
+		{
+			const glm::vec3& p0 = positions[indices[t * 3]];
+			const glm::vec3& p1 = positions[indices[t * 3 + 1]];
+			const glm::vec3& p2 = positions[indices[t * 3 + 2]];
+			const glm::vec3 centroid = (p0 + p1 + p2) / 3.f;
+			cluster_centroids[c] += centroid;
+			mesh_centroid += centroid;
+			// area weighted
+			cluster_normals[c] += glm::cross(p1 - p0, p2 - p0);
+		}
+		cluster_centroids[c] /= static_cast<float>(cluster_starts[c + 1] - cluster_starts[c]);
+	}
+	mesh_centroid /= static_cast<float>(triangle_count);
+
+	std::vector<float> cluster_keys(cluster_count);
+	for ( size_t c = 0; c < cluster_count; ++c )
+	{
+		const float normal_length = glm::length(cluster_normals[c]);
+		cluster_keys[c] = normal_length > 0.f ? glm::dot(cluster_centroids[c] - mesh_centroid, cluster_normals[c] / normal_length) : 0.f;
+	}
+
+	std::vector<uint32_t> cluster_order(cluster_count);
+	std::iota(cluster_order.begin(), cluster_order.end(), 0u);
+	std::ranges::stable_sort(cluster_order, [&cluster_keys](const uint32_t lhs, const uint32_t rhs)
+	{
+		return cluster_keys[lhs] > cluster_keys[rhs];
+	});
+
+	std::vector<uint32_t> output;
+	output.reserve(indices.size());
+	for ( const uint32_t c : cluster_order )
+	{
+		output.insert(output.end(), indices.begin() + cluster_starts[c] * 3, indices.begin() + cluster_starts[c + 1] * 3);
+	}
+	std::ranges::copy(output, indices.begin());
+}
+
+void Anni::ModelLoader::MeshOptimizer::OptimizeVertexFetch(std::pmr::vector<LoadedVertex>& vertices, std::pmr::vector<LoadedSkinVertex>& skin_vertices, const std::span<uint32_t> indices)
+{
+	const bool skinned = !skin_vertices.empty();
+	std::vector<uint32_t> remap(vertices.size(), invalid_index);
+	std::vector<LoadedVertex> reordered;
+	std::vector<LoadedSkinVertex> reordered_skin;
+	reordered.reserve(vertices.size());
+	reordered_skin.reserve(skin_vertices.size());
+	for ( uint32_t& index : indices )
+	{
+		if ( remap[index] == invalid_index )
+		{
+			remap[index] = static_cast<uint32_t>(reordered.size());
+			reordered.push_back(vertices[index]);
+			if ( skinned )
+			{
+				reordered_skin.push_back(skin_vertices[index]);
+			}
+		}
+		index = remap[index];
+	}
+	// copied back rather than moved, vertices keeps its allocation(and memory resource)
+	std::ranges::copy(reordered, vertices.begin());
+	vertices.resize(reordered.size());
+	std::ranges::copy(reordered_skin, skin_vertices.begin());
+	skin_vertices.resize(reordered_skin.size());
+}
+
+uint64_t Anni::ModelLoader::MeshOptimizer::SimulateVertexCache(const std::span<const uint32_t> indices, const size_t vertex_count, const uint32_t cache_size)
+{
+	// a vertex is still in the FIFO if fewer than cache_size misses happened since it was last loaded
+	std::vector<uint32_t> timestamps(vertex_count, 0);
+	uint32_t time = cache_size + 1;
+	uint64_t misses = 0;
+	for ( const uint32_t index : indices )
+	{
+		if ( time - timestamps[index] > cache_size )
+		{
+			timestamps[index] = time++;
+			++misses;
+		}
+	}
+	return misses;
+}
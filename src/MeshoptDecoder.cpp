@@ -0,0 +1,512 @@
+#include "MeshoptDecoder.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+
+namespace
+{
+	//> VERTEX CODEC
+	constexpr uint8_t vertex_header = 0xA0;
+	constexpr size_t vertex_block_size_bytes = 8192;
+	constexpr size_t vertex_block_max_size = 256;
+	constexpr size_t byte_group_size = 16;
+	// the most one byte group can take: 8 bytes of 4 bit codes plus 16 escaped bytes
+	constexpr size_t byte_group_decode_limit = 24;
+	constexpr size_t tail_max_size = 32;
+
+	size_t GetVertexBlockSize(const size_t stride)
+	{
+		// a block of transposed bytes fits the scratch buffer, in whole byte groups
+		const size_t block_size = (vertex_block_size_bytes / stride) & ~(byte_group_size - 1);
+		return std::min(block_size, vertex_block_max_size);
+	}
+
+	// 16 deltas at 0, 2, 4 or 8 bits each. the all ones code escapes to a full byte stored after the codes
+	const uint8_t* DecodeBytesGroup(const uint8_t* data, uint8_t* const output, const uint32_t bits_log2)
+	{
+		if ( bits_log2 == 0 )
+		{
+			memset(output, 0, byte_group_size);
+			return data;
+		}
+		if ( bits_log2 == 3 )
+		{
+			memcpy(output, data, byte_group_size);
+			return data + byte_group_size;
+		}
+
+		const uint32_t bits = 1u << bits_log2;
+		const uint32_t codes_per_byte = 8 / bits;
+		const uint8_t escape = static_cast<uint8_t>((1u << bits) - 1);
+		const uint8_t* escaped = data + byte_group_size / codes_per_byte;
+		for ( size_t i = 0; i < byte_group_size; i += codes_per_byte )
+		{
+			uint8_t packed = *data++;
+			for ( uint32_t k = 0; k < codes_per_byte; ++k )
+			{
+				// first value in the high bits
+				const uint8_t code = static_cast<uint8_t>(packed >> (8 - bits));
+				packed = static_cast<uint8_t>(packed << bits);
+				const bool is_escaped = code == escape;
+				output[i + k] = is_escaped ? *escaped : code;
+				escaped += is_escaped;
+			}
+		}
+		return escaped;
+	}
+
+	// one byte of every vertex in the block, group sizes come from a 2 bit header entry per group
+	const uint8_t* DecodeBytes(const uint8_t* data, const uint8_t* const data_end, uint8_t* const output, const size_t output_size)
+	{
+		const uint8_t* const header = data;
+		const size_t header_size = (output_size / byte_group_size + 3) / 4;
+		if ( static_cast<size_t>(data_end - data) < header_size )
+		{
+			return nullptr;
+		}
+		data += header_size;
+
+		for ( size_t i = 0; i < output_size; i += byte_group_size )
+		{
+			if ( static_cast<size_t>(data_end - data) < byte_group_decode_limit )
+			{
+				return nullptr;
+			}
+			const size_t group_index = i / byte_group_size;
+			const uint32_t bits_log2 = (header[group_index / 4] >> ((group_index % 4) * 2)) & 3;
+			data = DecodeBytesGroup(data, output + i, bits_log2);
+		}
+		return data;
+	}
+
+	uint8_t Unzigzag8(const uint8_t value)
+	{
+		return static_cast<uint8_t>(-(value & 1) ^ (value >> 1));
+	}
+
+	// bytes are stored transposed and delta coded against the same byte of the previous vertex
+	const uint8_t* DecodeVertexBlock(const uint8_t* data, const uint8_t* const data_end, uint8_t* const vertex_data, const size_t vertex_count, const size_t stride, std::array<uint8_t, 256>& last_vertex)
+	{
+		std::array<uint8_t, vertex_block_max_size> deltas;
+		std::array<uint8_t, vertex_block_size_bytes> transposed;
+		const size_t aligned_count = (vertex_count + byte_group_size - 1) & ~(byte_group_size - 1);
+		for ( size_t k = 0; k < stride; ++k )
+		{
+			data = DecodeBytes(data, data_end, deltas.data(), aligned_count);
+			if ( !data )
+			{
+				return nullptr;
+			}
+
+			uint8_t previous = last_vertex[k];
+			for ( size_t i = 0; i < vertex_count; ++i )
+			{
+				previous = static_cast<uint8_t>(Unzigzag8(deltas[i]) + previous);
+				transposed[i * stride + k] = previous;
+			}
+		}
+
+		memcpy(vertex_data, transposed.data(), vertex_count * stride);
+		memcpy(last_vertex.data(), transposed.data() + (vertex_count - 1) * stride, stride);
+		return data;
+	}
+
+	//> INDEX CODECS
+	constexpr uint8_t index_header = 0xE0;
+	constexpr uint8_t sequence_header = 0xD0;
+
+	uint32_t DecodeVByte(const uint8_t*& data)
+	{
+		const uint8_t lead = *data++;
+		if ( lead < 128 )
+		{
+			return lead;
+		}
+
+		// up to 5 groups of 7 bits, low bits first
+		uint32_t result = lead & 127;
+		uint32_t shift = 7;
+		for ( int i = 0; i < 4; ++i )
+		{
+			const uint8_t group = *data++;
+			result |= static_cast<uint32_t>(group & 127) << shift;
+			shift += 7;
+			if ( group < 128 )
+			{
+				break;
+			}
+		}
+		return result;
+	}
+
+	uint32_t DecodeIndex(const uint8_t*& data, const uint32_t last)
+	{
+		const uint32_t value = DecodeVByte(data);
+		return last + ((value >> 1) ^ (0u - (value & 1)));
+	}
+
+	void WriteIndex(uint8_t* const destination, const size_t index, const size_t index_size, const uint32_t value)
+	{
+		if ( index_size == 2 )
+		{
+			const auto short_value = static_cast<uint16_t>(value);
+			memcpy(destination + index * 2, &short_value, 2);
+		}
+		else
+		{
+			memcpy(destination + index * 4, &value, 4);
+		}
+	}
+
+	// the encoder's FIFOs of recent edges and vertices, both have to be updated exactly like it did
+	struct IndexFifos
+	{
+		std::array<std::array<uint32_t, 2>, 16> edges;
+		std::array<uint32_t, 16> vertices;
+		size_t edge_offset{ 0 };
+		size_t vertex_offset{ 0 };
+
+		IndexFifos()
+		{
+			for ( auto& edge : edges )
+			{
+				edge = { ~0u, ~0u };
+			}
+			vertices.fill(~0u);
+		}
+
+		void PushEdge(const uint32_t a, const uint32_t b)
+		{
+			edges[edge_offset] = { a, b };
+			edge_offset = (edge_offset + 1) & 15;
+		}
+
+		void PushVertex(const uint32_t v, const bool advance = true)
+		{
+			vertices[vertex_offset] = v;
+			vertex_offset = (vertex_offset + (advance ? 1 : 0)) & 15;
+		}
+	};
+
+	//> FILTERS
+	template <typename T>
+	void DecodeOctahedral(T* const data, const size_t count)
+	{
+		const float max = static_cast<float>((1 << (sizeof(T) * 8 - 1)) - 1);
+		for ( size_t i = 0; i < count; ++i )
+		{
+			// z is stored at the same scale as 1, for the lower hemisphere x and y are folded back over the diagonals
+			float x = static_cast<float>(data[i * 4 + 0]);
+			float y = static_cast<float>(data[i * 4 + 1]);
+			const float z = static_cast<float>(data[i * 4 + 2]) - std::abs(x) - std::abs(y);
+			const float t = z < 0.f ? z : 0.f;
+			x += x >= 0.f ? t : -t;
+			y += y >= 0.f ? t : -t;
+
+			const float scale = max / std::sqrt(x * x + y * y + z * z);
+			data[i * 4 + 0] = static_cast<T>(static_cast<int>(x * scale + (x >= 0.f ? 0.5f : -0.5f)));
+			data[i * 4 + 1] = static_cast<T>(static_cast<int>(y * scale + (y >= 0.f ? 0.5f : -0.5f)));
+			data[i * 4 + 2] = static_cast<T>(static_cast<int>(z * scale + (z >= 0.f ? 0.5f : -0.5f)));
+		}
+	}
+
+	void DecodeQuaternion(int16_t* const data, const size_t count)
+	{
+		const float one_over_sqrt2 = 1.f / std::sqrt(2.f);
+		for ( size_t i = 0; i < count; ++i )
+		{
+			// the low 2 bits of w say which component was dropped, the rest is the scale the other three were stored at
+			const int scale_bits = data[i * 4 + 3] | 3;
+			const float scale = one_over_sqrt2 / static_cast<float>(scale_bits);
+			const float x = static_cast<float>(data[i * 4 + 0]) * scale;
+			const float y = static_cast<float>(data[i * 4 + 1]) * scale;
+			const float z = static_cast<float>(data[i * 4 + 2]) * scale;
+			const float ww = 1.f - x * x - y * y - z * z;
+			const float w = std::sqrt(ww >= 0.f ? ww : 0.f);
+
+			const int dropped = data[i * 4 + 3] & 3;
+			data[i * 4 + ((dropped + 1) & 3)] = static_cast<int16_t>(static_cast<int>(x * 32767.f + (x >= 0.f ? 0.5f : -0.5f)));
+			data[i * 4 + ((dropped + 2) & 3)] = static_cast<int16_t>(static_cast<int>(y * 32767.f + (y >= 0.f ? 0.5f : -0.5f)));
+			data[i * 4 + ((dropped + 3) & 3)] = static_cast<int16_t>(static_cast<int>(z * 32767.f + (z >= 0.f ? 0.5f : -0.5f)));
+			data[i * 4 + dropped] = static_cast<int16_t>(static_cast<int>(w * 32767.f + 0.5f));
+		}
+	}
+
+	void DecodeExponential(uint32_t* const data, const size_t count)
+	{
+		for ( size_t i = 0; i < count; ++i )
+		{
+			// signed 24 bit mantissa, signed 8 bit exponent: ldexp(mantissa, exponent) without the libm call
+			const int32_t mantissa = static_cast<int32_t>(data[i] << 8) >> 8;
+			const int32_t exponent = static_cast<int32_t>(data[i]) >> 24;
+			const float power = std::bit_cast<float>(static_cast<uint32_t>(exponent + 127) << 23);
+			data[i] = std::bit_cast<uint32_t>(power * static_cast<float>(mantissa));
+		}
+	}
+}
+
+
+bool Anni::ModelLoader::MeshoptDecoder::Decode(const Mode mode, const Filter filter, const std::span<const uint8_t> source, const size_t count, const size_t stride, const std::span<uint8_t> destination)
+{
+	if ( destination.size() < count * stride )
+	{
+		return false;
+	}
+
+	switch ( mode )
+	{
+		case Mode::Attributes:
+		{
+			const bool valid_filter =
+				filter == Filter::None ||
+				(filter == Filter::Octahedral && (stride == 4 || stride == 8)) ||
+				(filter == Filter::Quaternion && stride == 8) ||
+				(filter == Filter::Exponential && stride % 4 == 0);
+			if ( !valid_filter || !DecodeVertexBuffer(source, count, stride, destination) )
+			{
+				return false;
+			}
+			ApplyFilter(filter, count, stride, destination);
+			return true;
+		}
+		case Mode::Triangles:
+			return filter == Filter::None && DecodeIndexBuffer(source, count, stride, destination);
+		case Mode::Indices:
+			return filter == Filter::None && DecodeIndexSequence(source, count, stride, destination);
+		default:
+			return false;
+	}
+}
+
+bool Anni::ModelLoader::MeshoptDecoder::DecodeVertexBuffer(const std::span<const uint8_t> source, const size_t count, const size_t stride, const std::span<uint8_t> destination)
+{
+	if ( stride == 0 || stride > 256 || stride % 4 != 0 || destination.size() < count * stride )
+	{
+		return false;
+	}
+
+	const uint8_t* data = source.data();
+	const uint8_t* const data_end = source.data() + source.size();
+	if ( source.size() < 1 + stride || (*data & 0xF0) != vertex_header || (*data & 0x0F) != 0 )
+	{
+		return false;
+	}
+	++data;
+
+	// the first block is delta coded against the vertex stored at the very end
+	std::array<uint8_t, 256> last_vertex{};
+	memcpy(last_vertex.data(), data_end - stride, stride);
+
+	const size_t block_size = GetVertexBlockSize(stride);
+	for ( size_t first_vertex = 0; first_vertex < count; first_vertex += block_size )
+	{
+		const size_t vertex_count = std::min(block_size, count - first_vertex);
+		data = DecodeVertexBlock(data, data_end, destination.data() + first_vertex * stride, vertex_count, stride, last_vertex);
+		if ( !data )
+		{
+			return false;
+		}
+	}
+
+	// only the padded tail may be left
+	return static_cast<size_t>(data_end - data) == std::max(stride, tail_max_size);
+}
+
+bool Anni::ModelLoader::MeshoptDecoder::DecodeIndexBuffer(const std::span<const uint8_t> source, const size_t count, const size_t index_size, const std::span<uint8_t> destination)
+{
+	if ( count % 3 != 0 || (index_size != 2 && index_size != 4) || destination.size() < count * index_size )
+	{
+		return false;
+	}
+	// header, one code byte per triangle and the 16 byte table of auxiliary codes at the end
+	if ( source.size() < 1 + count / 3 + 16 || (source[0] & 0xF0) != index_header )
+	{
+		return false;
+	}
+	const uint32_t version = source[0] & 0x0F;
+	if ( version > 1 )
+	{
+		return false;
+	}
+
+	IndexFifos fifos;
+	uint32_t next = 0;
+	uint32_t last = 0;
+	// version 1 spends codes 13 and 14 on free indices one below/above the last one
+	const uint32_t fec_max = version >= 1 ? 13 : 15;
+
+	const uint8_t* code = source.data() + 1;
+	const uint8_t* data = code + count / 3;
+	const uint8_t* const data_safe_end = source.data() + source.size() - 16;
+	const uint8_t* const codeaux_table = data_safe_end;
+	uint8_t* const output = destination.data();
+	for ( size_t i = 0; i < count; i += 3 )
+	{
+		// a triangle reads 16 bytes at most(one auxiliary code and three 5 byte indices), the table behind data_safe_end
+		// keeps that in bounds
+		if ( data > data_safe_end )
+		{
+			return false;
+		}
+
+		const uint8_t code_triangle = *code++;
+		if ( code_triangle < 0xF0 )
+		{
+			// an edge out of the FIFO plus a third vertex: the next new one, one from the FIFO or a free index
+			const uint32_t fe = code_triangle >> 4;
+			const auto& edge = fifos.edges[(fifos.edge_offset - 1 - fe) & 15];
+			const uint32_t a = edge[0];
+			const uint32_t b = edge[1];
+			const uint32_t fec = code_triangle & 15;
+
+			uint32_t c;
+			bool advance = true;
+			if ( fec < fec_max )
+			{
+				c = fec == 0 ? next : fifos.vertices[(fifos.vertex_offset - 1 - fec) & 15];
+				advance = fec == 0;
+				next += fec == 0 ? 1 : 0;
+			}
+			else
+			{
+				// 13 and 14 decode into -1 and +1
+				c = fec != 15 ? last + (fec - (fec ^ 3)) : DecodeIndex(data, last);
+				last = c;
+			}
+
+			WriteIndex(output, i + 0, index_size, a);
+			WriteIndex(output, i + 1, index_size, b);
+			WriteIndex(output, i + 2, index_size, c);
+			fifos.PushVertex(c, advance);
+			fifos.PushEdge(c, b);
+			fifos.PushEdge(a, c);
+		}
+		else if ( code_triangle < 0xFE )
+		{
+			// three vertices, the auxiliary code from the table says where b and c come from
+			const uint8_t codeaux = codeaux_table[code_triangle & 15];
+			const uint32_t feb = codeaux >> 4;
+			const uint32_t fec = codeaux & 15;
+
+			const uint32_t a = next++;
+			const uint32_t b = feb == 0 ? next : fifos.vertices[(fifos.vertex_offset - feb) & 15];
+			next += feb == 0 ? 1 : 0;
+			const uint32_t c = fec == 0 ? next : fifos.vertices[(fifos.vertex_offset - fec) & 15];
+			next += fec == 0 ? 1 : 0;
+
+			WriteIndex(output, i + 0, index_size, a);
+			WriteIndex(output, i + 1, index_size, b);
+			WriteIndex(output, i + 2, index_size, c);
+			fifos.PushVertex(a);
+			fifos.PushVertex(b, feb == 0);
+			fifos.PushVertex(c, fec == 0);
+			fifos.PushEdge(b, a);
+			fifos.PushEdge(c, b);
+			fifos.PushEdge(a, c);
+		}
+		else
+		{
+			// same with the auxiliary code in the data stream, 0xFF also makes a a free index
+			const uint8_t codeaux = *data++;
+			const uint32_t fea = code_triangle == 0xFE ? 0 : 15;
+			const uint32_t feb = codeaux >> 4;
+			const uint32_t fec = codeaux & 15;
+			if ( codeaux == 0 )
+			{
+				next = 0;
+			}
+
+			uint32_t a = fea == 0 ? next++ : 0;
+			uint32_t b = feb == 0 ? next++ : fifos.vertices[(fifos.vertex_offset - feb) & 15];
+			uint32_t c = fec == 0 ? next++ : fifos.vertices[(fifos.vertex_offset - fec) & 15];
+			if ( fea == 15 )
+			{
+				last = a = DecodeIndex(data, last);
+			}
+			if ( feb == 15 )
+			{
+				last = b = DecodeIndex(data, last);
+			}
+			if ( fec == 15 )
+			{
+				last = c = DecodeIndex(data, last);
+			}
+
+			WriteIndex(output, i + 0, index_size, a);
+			WriteIndex(output, i + 1, index_size, b);
+			WriteIndex(output, i + 2, index_size, c);
+			fifos.PushVertex(a);
+			fifos.PushVertex(b, feb == 0 || feb == 15);
+			fifos.PushVertex(c, fec == 0 || fec == 15);
+			fifos.PushEdge(b, a);
+			fifos.PushEdge(c, b);
+			fifos.PushEdge(a, c);
+		}
+	}
+
+	// everything up to the table has to be used
+	return data == data_safe_end;
+}
+
+bool Anni::ModelLoader::MeshoptDecoder::DecodeIndexSequence(const std::span<const uint8_t> source, const size_t count, const size_t index_size, const std::span<uint8_t> destination)
+{
+	if ( (index_size != 2 && index_size != 4) || destination.size() < count * index_size )
+	{
+		return false;
+	}
+	// header, at least one byte per index and a 4 byte tail
+	if ( source.size() < 1 + count + 4 || (source[0] & 0xF0) != sequence_header || (source[0] & 0x0F) > 1 )
+	{
+		return false;
+	}
+
+	const uint8_t* data = source.data() + 1;
+	const uint8_t* const data_safe_end = source.data() + source.size() - 4;
+	// two baselines, the low bit of every value picks one
+	std::array<uint32_t, 2> last{};
+	for ( size_t i = 0; i < count; ++i )
+	{
+		// an index reads 5 bytes at most, the tail keeps that in bounds
+		if ( data >= data_safe_end )
+		{
+			return false;
+		}
+
+		uint32_t value = DecodeVByte(data);
+		const uint32_t baseline = value & 1;
+		value >>= 1;
+		last[baseline] += (value >> 1) ^ (0u - (value & 1));
+		WriteIndex(destination.data(), i, index_size, last[baseline]);
+	}
+	return data == data_safe_end;
+}
+
+void Anni::ModelLoader::MeshoptDecoder::ApplyFilter(const Filter filter, const size_t count, const size_t stride, const std::span<uint8_t> data)
+{
+	// the filters work on naturally aligned components, decoded buffer views always start aligned
+	switch ( filter )
+	{
+		case Filter::Octahedral:
+			if ( stride == 4 )
+			{
+				DecodeOctahedral(reinterpret_cast<int8_t*>(data.data()), count);
+			}
+			else
+			{
+				DecodeOctahedral(reinterpret_cast<int16_t*>(data.data()), count);
+			}
+			break;
+		case Filter::Quaternion:
+			DecodeQuaternion(reinterpret_cast<int16_t*>(data.data()), count);
+			break;
+		case Filter::Exponential:
+			DecodeExponential(reinterpret_cast<uint32_t*>(data.data()), count * stride / 4);
+			break;
+		default:
+			break;
+	}
+}
@@ -1,45 +1,438 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "ModelsLoader.h"
+#include "ThreadPool.h"
+#include "MeshOptimizer.h"
+#include "MeshoptDecoder.h"
+#include "Ktx2Decoder.h"
+#include "TextureProcessor.h"
+#include "TextureCache.h"
+#include "MappedFile.h"
+#include "ProcessMemory.h"
 #include "stb_image.h"            //TODO: stb image need some marco to work
+#include "glm/gtc/packing.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <numeric>
+#include <unordered_map>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define ANNI_MODELS_LOADER_SSE 1
+#endif
 
 Anni::ModelLoader::LoadedModel::Factory  Anni::ModelLoader::LoadedModel::factory{};
+
+namespace
+{
+	//> VERTEX QUANTIZATION HELPERS
+	int16_t ToSnorm16(const float value)
+	{
+		return static_cast<int16_t>(std::round(std::clamp(value, -1.f, 1.f) * 32767.f));
+	}
+
+	float FromSnorm16(const int16_t value)
+	{
+		return std::max(static_cast<float>(value) / 32767.f, -1.f);
+	}
+
+	uint16_t ToUnorm16(const float value)
+	{
+		return static_cast<uint16_t>(std::round(std::clamp(value, 0.f, 1.f) * 65535.f));
+	}
+
+	uint8_t ToUnorm8(const float value)
+	{
+		return static_cast<uint8_t>(std::round(std::clamp(value, 0.f, 1.f) * 255.f));
+	}
+
+	glm::vec2 OctahedralEncode(glm::vec3 n)
+	{
+		n /= std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+		glm::vec2 p{ n.x, n.y };
+		if ( n.z < 0.f )
+		{
+			// fold the lower hemisphere over the diagonals
+			p = glm::vec2{
+				(1.f - std::abs(n.y)) * (n.x >= 0.f ? 1.f : -1.f),
+				(1.f - std::abs(n.x)) * (n.y >= 0.f ? 1.f : -1.f) };
+		}
+		return p;
+	}
+
+	glm::vec3 OctahedralDecode(const glm::vec2 p)
+	{
+		glm::vec3 n{ p.x, p.y, 1.f - std::abs(p.x) - std::abs(p.y) };
+		const float t = std::max(-n.z, 0.f);
+		n.x += n.x >= 0.f ? -t : t;
+		n.y += n.y >= 0.f ? -t : t;
+		return glm::normalize(n);
+	}
+
+	// column major a * b, four columns of b broadcast against the columns of a
+	glm::mat4 MultiplyTransforms(const glm::mat4& a, const glm::mat4& b)
+	{
+#if defined(ANNI_MODELS_LOADER_SSE)
+		const __m128 a0 = _mm_loadu_ps(&a[0][0]);
+		const __m128 a1 = _mm_loadu_ps(&a[1][0]);
+		const __m128 a2 = _mm_loadu_ps(&a[2][0]);
+		const __m128 a3 = _mm_loadu_ps(&a[3][0]);
+
+		glm::mat4 result;
+		for ( int column = 0; column < 4; ++column )
+		{
+			__m128 r = _mm_mul_ps(a0, _mm_set1_ps(b[column][0]));
+			r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(b[column][1])));
+			r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(b[column][2])));
+			r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(b[column][3])));
+			_mm_storeu_ps(&result[column][0], r);
+		}
+		return result;
+#else
+		return a * b;
+#endif
+	}
+
+	float AngleDegrees(const glm::vec3 a, const glm::vec3 b)
+	{
+		const float cos_angle = std::clamp(glm::dot(glm::normalize(a), glm::normalize(b)), -1.f, 1.f);
+		return glm::degrees(std::acos(cos_angle));
+	}
+
+	//> EMBEDDED DATA HELPERS
+	// bytes held by a parsed buffer or image, empty for sources that live outside of the asset(URIs etc.)
+	std::span<const std::byte> GetSourceBytes(const fastgltf::DataSource& source)
+	{
+		if ( const auto* array = std::get_if<fastgltf::sources::Array>(&source) )
+		{
+			return { array->bytes.data(), array->bytes.size() };
+		}
+		if ( const auto* vector = std::get_if<fastgltf::sources::Vector>(&source) )
+		{
+			return { vector->bytes.data(), vector->bytes.size() };
+		}
+		if ( const auto* byte_view = std::get_if<fastgltf::sources::ByteView>(&source) )
+		{
+			return byte_view->bytes;
+		}
+		return {};
+	}
+
+	// encoded bytes of an image embedded in the asset(GLB buffer view, base64 data URI), a view into the asset's own storage
+	std::span<const std::byte> GetEmbeddedImageBytes(const fastgltf::Asset& gltf_asset, const fastgltf::Image& image)
+	{
+		const auto* buffer_view_source = std::get_if<fastgltf::sources::BufferView>(&image.data);
+		if ( !buffer_view_source )
+		{
+			return GetSourceBytes(image.data);
+		}
+
+		if ( buffer_view_source->bufferViewIndex >= gltf_asset.bufferViews.size() )
+		{
+			return {};
+		}
+		const fastgltf::BufferView& buffer_view = gltf_asset.bufferViews[buffer_view_source->bufferViewIndex];
+		if ( buffer_view.bufferIndex >= gltf_asset.buffers.size() )
+		{
+			return {};
+		}
+		const std::span<const std::byte> buffer_bytes = GetSourceBytes(gltf_asset.buffers[buffer_view.bufferIndex].data);
+		if ( buffer_view.byteOffset > buffer_bytes.size() || buffer_view.byteLength > buffer_bytes.size() - buffer_view.byteOffset )
+		{
+			return {};
+		}
+		return buffer_bytes.subspan(buffer_view.byteOffset, buffer_view.byteLength);
+	}
+
+	// KHR_texture_basisu names a KTX2 image besides(or instead of) the png/jpeg one. the KTX2 image is only taken when this
+	// build can transcode it or there is no fallback. empty for textures without any source
+	std::optional<uint32_t> GetTextureImageIndex(const fastgltf::Texture& texture)
+	{
+		if ( texture.basisuImageIndex.has_value() && (Anni::ModelLoader::Ktx2Decoder::CanTranscodeBasis() || !texture.imageIndex.has_value()) )
+		{
+			return static_cast<uint32_t>(texture.basisuImageIndex.value());
+		}
+		if ( texture.imageIndex.has_value() )
+		{
+			return static_cast<uint32_t>(texture.imageIndex.value());
+		}
+		return std::nullopt;
+	}
+
+	// TextureDecodeFailed with message, LoadTextureImage adds which image it was
+	std::unexpected<Anni::ModelLoader::LoadError> TextureError(std::string message)
+	{
+		return std::unexpected(Anni::ModelLoader::LoadError{ Anni::ModelLoader::LoadError::Code::TextureDecodeFailed, std::move(message) });
+	}
+
+	// image and sampler of one material texture slot. a missing texture leaves both empty, a texture without a(valid)
+	// sampler only the sampler
+	void ResolveTextureSlot(const fastgltf::Asset& gltf_asset, const size_t texture_index, std::optional<uint32_t>& image_index, std::optional<uint32_t>& sampler_index)
+	{
+		if ( texture_index >= gltf_asset.textures.size() )
+		{
+			return;
+		}
+		const fastgltf::Texture& texture = gltf_asset.textures[texture_index];
+		image_index = GetTextureImageIndex(texture);
+		if ( texture.samplerIndex.has_value() && texture.samplerIndex.value() < gltf_asset.samplers.size() )
+		{
+			sampler_index = static_cast<uint32_t>(texture.samplerIndex.value());
+		}
+	}
+
+	//> ACCESSOR HELPERS
+	// one member of every vertex in a single strided copy, fastgltf takes care of the source stride, normalized integers and
+	// sparse accessors. Vertex is LoadedVertex or LoadedSkinVertex
+	template <typename Element, typename Vertex>
+	void CopyVertexAttribute(const fastgltf::Asset& gltf_asset, const fastgltf::Accessor& accessor, const std::span<Vertex> vertices, const size_t member_offset)
+	{
+		fastgltf::copyFromAccessor<Element, sizeof(Vertex)>(gltf_asset, accessor, reinterpret_cast<std::byte*>(vertices.data()) + member_offset);
+	}
+
+	//> BOUNDS HELPERS
+	static_assert(offsetof(Anni::ModelLoader::LoadedVertex, normal) == offsetof(Anni::ModelLoader::LoadedVertex, position) + sizeof(glm::vec3),
+		"the 16 byte position loads in ComputeBoundingBox run into normal.x");
+
+	// min/max over the positions, the fourth lane of every load is normal.x and never makes it into the result
+	Anni::ModelLoader::BoundingBox ComputeBoundingBox(const std::span<const Anni::ModelLoader::LoadedVertex> vertices)
+	{
+		Anni::ModelLoader::BoundingBox box;
+#if defined(ANNI_MODELS_LOADER_SSE)
+		if ( vertices.empty() )
+		{
+			return box;
+		}
+
+		__m128 lower = _mm_set1_ps(std::numeric_limits<float>::max());
+		__m128 upper = _mm_set1_ps(std::numeric_limits<float>::lowest());
+		for ( const auto& vertex : vertices )
+		{
+			const __m128 position = _mm_loadu_ps(&vertex.position.x);
+			lower = _mm_min_ps(lower, position);
+			upper = _mm_max_ps(upper, position);
+		}
+
+		alignas(16) float lower_lanes[4];
+		alignas(16) float upper_lanes[4];
+		_mm_store_ps(lower_lanes, lower);
+		_mm_store_ps(upper_lanes, upper);
+		box.min = glm::vec3(lower_lanes[0], lower_lanes[1], lower_lanes[2]);
+		box.max = glm::vec3(upper_lanes[0], upper_lanes[1], upper_lanes[2]);
+#else
+		for ( const auto& vertex : vertices )
+		{
+			box.min = glm::min(box.min, vertex.position);
+			box.max = glm::max(box.max, vertex.position);
+		}
+#endif
+		return box;
+	}
+
+	// centered on the box, the radius reaches the farthest vertex which is tighter than half of the box diagonal
+	Anni::ModelLoader::BoundingSphere ComputeBoundingSphere(const std::span<const Anni::ModelLoader::LoadedVertex> vertices, const Anni::ModelLoader::BoundingBox& box)
+	{
+		Anni::ModelLoader::BoundingSphere sphere;
+		if ( !box.IsValid() )
+		{
+			return sphere;
+		}
+
+		sphere.center = box.GetCenter();
+		float max_distance_squared = 0.f;
+		for ( const auto& vertex : vertices )
+		{
+			const glm::vec3 offset = vertex.position - sphere.center;
+			max_distance_squared = std::max(max_distance_squared, glm::dot(offset, offset));
+		}
+		sphere.radius = std::sqrt(max_distance_squared);
+		return sphere;
+	}
+
+	//> TRANSFORM HELPERS
+	// the inverse of translate * mat4_cast * scale, a mirroring matrix gets a negative x scale. shear is lost
+	void DecomposeTransform(const glm::mat4& matrix, glm::vec3& translation, glm::quat& rotation, glm::vec3& scale)
+	{
+		translation = glm::vec3(matrix[3]);
+		glm::mat3 basis(matrix);
+		scale = { glm::length(basis[0]), glm::length(basis[1]), glm::length(basis[2]) };
+		if ( glm::determinant(basis) < 0.f )
+		{
+			scale.x = -scale.x;
+		}
+
+		rotation = glm::quat(1.f, 0.f, 0.f, 0.f);
+		if ( scale.x != 0.f && scale.y != 0.f && scale.z != 0.f )
+		{
+			basis[0] /= scale.x;
+			basis[1] /= scale.y;
+			basis[2] /= scale.z;
+			rotation = glm::normalize(glm::quat_cast(basis));
+		}
+	}
+
+	//> LOAD STATS HELPERS
+	// adds the time until it goes out of scope to one stage of the load, and to the trace when there is one
+	class ScopedLoadStage
+	{
+	public:
+		ScopedLoadStage(Anni::ModelLoader::LoadStats& stats, const Anni::ModelLoader::LoadStats::Stage stage, Anni::ModelLoader::TraceRecorder* recorder) :
+			m_stats(stats),
+			m_stage(stage),
+			m_span(recorder, std::string(Anni::ModelLoader::LoadStats::GetStageName(stage))),
+			m_start(std::chrono::steady_clock::now())
+		{
+		}
+
+		~ScopedLoadStage()
+		{
+			m_stats.stage_milliseconds[static_cast<size_t>(m_stage)] += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+		}
+
+	private:
+		Anni::ModelLoader::LoadStats& m_stats;
+		const Anni::ModelLoader::LoadStats::Stage m_stage;
+		Anni::ModelLoader::TraceSpan m_span;
+		const std::chrono::steady_clock::time_point m_start;
+	};
+
+	uint64_t GetFileSize(const std::filesystem::path& file_path)
+	{
+		std::error_code error;
+		const uint64_t file_size = std::filesystem::file_size(file_path, error);
+		return error ? 0 : file_size;
+	}
+}
+
 namespace Anni::ModelLoader
 {
 
-	void LoadedModel::Factory::LoadGltf(const std::filesystem::path& file_path, fastgltf::Parser& gltf_parser, std::unique_ptr<LoadedModel>& loading_result)
+	LoadResult<void> LoadedModel::Factory::LoadGltf(const std::filesystem::path& file_path, fastgltf::Parser& gltf_parser, const LoadOptions& options, std::unique_ptr<LoadedModel>& loading_result)
 	{
+		// declared first so they are released last, buffers of gltf_asset may point into any of them
+		std::vector<std::shared_ptr<MappedFile>> source_mappings;
+		std::unique_ptr<fastgltf::GltfDataGetter> data;
 		fastgltf::Asset gltf_asset{};
-		fastgltf::GltfDataBuffer data{};
 
-		LoadRawGltf(data, gltf_asset, file_path, gltf_parser);
-		LoadSamplers(gltf_asset, loading_result);
-		LoadTextureImages(gltf_asset, file_path, loading_result);
-		LoadMaterials(gltf_asset, file_path, loading_result);
-		LoadMeshes(gltf_asset, loading_result);
-		LoadSceneNodes(gltf_asset, loading_result);
+		LoadStats& stats = loading_result->m_load_stats;
+		TraceRecorder* const recorder = options.trace_recorder;
+		{
+			ScopedLoadStage stage(stats, LoadStats::Stage::RawParse, recorder);
+			if ( LoadResult<void> result = LoadRawGltf(data, gltf_asset, file_path, gltf_parser, options); !result )
+			{
+				return result;
+			}
+			// before the buffers are loaded, that replaces their URIs
+			CollectSourceFiles(gltf_asset, file_path, loading_result);
+			if ( LoadResult<void> result = LoadExternalBuffers(gltf_asset, file_path, options, source_mappings); !result )
+			{
+				return result;
+			}
+		}
+
+		// the model file, its external buffers and its images. data URIs and the GLB binary chunk are part of the model file
+		for ( const auto& source_file : loading_result->m_source_files )
+		{
+			stats.bytes_read += GetFileSize(source_file);
+		}
+		{
+			ScopedLoadStage stage(stats, LoadStats::Stage::Decompress, recorder);
+			if ( LoadResult<void> result = DecodeCompressedBufferViews(gltf_asset); !result )
+			{
+				return result;
+			}
+		}
+
+		{
+			ScopedLoadStage stage(stats, LoadStats::Stage::Samplers, recorder);
+			LoadSamplers(gltf_asset, loading_result);
+		}
+		{
+			ScopedLoadStage stage(stats, LoadStats::Stage::Materials, recorder);
+			CreateTextureSlots(gltf_asset, loading_result);
+			// materials first, they tell the texture post process what every image is used for
+			LoadMaterials(gltf_asset, file_path, loading_result);
+		}
+
+		// image decoding runs in the background while the rest of the asset is converted
+		std::vector<std::future<LoadResult<void>>> pending_images;
+		{
+			ScopedLoadStage stage(stats, LoadStats::Stage::Textures, recorder);
+			pending_images = LoadTextureImages(gltf_asset, file_path, options, loading_result);
+		}
+		LoadResult<void> result;
+		{
+			ScopedLoadStage stage(stats, LoadStats::Stage::Meshes, recorder);
+			result = LoadMeshes(gltf_asset, options, loading_result);
+		}
+		if ( result )
+		{
+			ScopedLoadStage stage(stats, LoadStats::Stage::SceneNodes, recorder);
+			result = LoadSceneNodes(gltf_asset, loading_result);
+		}
+		if ( result )
+		{
+			ScopedLoadStage stage(stats, LoadStats::Stage::SceneGraph, recorder);
+			result = LoadSceneGraph(gltf_asset, loading_result);
+		}
+		if ( result )
+		{
+			ScopedLoadStage stage(stats, LoadStats::Stage::Animations, recorder);
+			result = LoadSkins(gltf_asset, loading_result);
+			if ( result )
+			{
+				result = LoadAnimations(gltf_asset, loading_result);
+			}
+		}
+
+		// the decode jobs reference gltf_asset, they must be done before it goes out of scope even when the load already failed
+		ScopedLoadStage stage(stats, LoadStats::Stage::Textures, recorder);
+		LoadResult<void> texture_result = WaitTextureImages(pending_images);
+		return result ? texture_result : result;
 	}
 
 
-	void LoadedModel::Factory::LoadRawGltf(fastgltf::GltfDataBuffer& data, fastgltf::Asset& gltf_asset, const std::filesystem::path& file_path, fastgltf::Parser& gltf_parser)
+	LoadResult<void> LoadedModel::Factory::LoadRawGltf(std::unique_ptr<fastgltf::GltfDataGetter>& data, fastgltf::Asset& gltf_asset, const std::filesystem::path& file_path, fastgltf::Parser& gltf_parser, const LoadOptions& options)
 	{
 
 
 		//> LOAD_RAW GLTF RAW FILE LOADING
-		constexpr auto gltf_loading_options = fastgltf::Options::DontRequireValidAssetMember | fastgltf::Options::AllowDouble | fastgltf::Options::LoadExternalBuffers;
+		// external buffers stay URIs, CollectSourceFiles records them before LoadExternalBuffers maps or reads them
+		constexpr auto gltf_loading_options = fastgltf::Options::DontRequireValidAssetMember | fastgltf::Options::AllowDouble;
 
-		auto result_buffer = fastgltf::GltfDataBuffer::FromPath(file_path);
+		if ( options.memory_mapped_input )
+		{
+#if defined(FASTGLTF_HAS_MEMORY_MAPPED_FILE) && FASTGLTF_HAS_MEMORY_MAPPED_FILE
+			// the GLB binary chunk can be handed out as a view into this mapping, it has to outlive gltf_asset
+			auto result_mapping = fastgltf::MappedGltfFile::FromPath(file_path);
+			if ( !result_mapping )
+			{
+				return std::unexpected(LoadError{ LoadError::Code::ReadFailed, "Failed to map the model file: " + file_path.string() });
+			}
+			data = std::make_unique<fastgltf::MappedGltfFile>(std::move(result_mapping.get()));
+#else
+			SPDLOG_WARN("fastgltf was built without memory mapped files, reading the model file into memory.");
+#endif
+		}
 
-		if ( !result_buffer )
+		if ( !data )
 		{
-			SPDLOG_ERROR("Failed to load data buffer from given file path.");
-			std::exit(EXIT_FAILURE); // or std::exit(1);
+			auto result_buffer = fastgltf::GltfDataBuffer::FromPath(file_path);
+
+			if ( !result_buffer )
+			{
+				return std::unexpected(LoadError{ LoadError::Code::ReadFailed, "Failed to load data buffer from given file path: " + file_path.string() });
+			}
+			data = std::make_unique<fastgltf::GltfDataBuffer>(std::move(result_buffer.get()));
 		}
-		data = std::move(result_buffer.get());
-		const fastgltf::GltfType gltf_type = determineGltfFileType(data);
+		const fastgltf::GltfType gltf_type = determineGltfFileType(*data);
 
 		if ( fastgltf::GltfType::glTF == gltf_type )
 		{
-			auto load = gltf_parser.loadGltf(data, file_path.parent_path(), gltf_loading_options);
+			auto load = gltf_parser.loadGltf(*data, file_path.parent_path(), gltf_loading_options);
 			SPDLOG_INFO("Parsing file from gltf directory: {}", file_path.parent_path().string());
 			if ( load )
 			{
@@ -47,13 +440,12 @@ namespace Anni::ModelLoader
 			}
 			else
 			{
-				SPDLOG_ERROR("Failed to load GLTF file.");
-				std::exit(EXIT_FAILURE); // or std::exit(1);
+				return std::unexpected(LoadError{ LoadError::Code::ParseFailed, "Failed to load GLTF file: " + std::string(fastgltf::getErrorMessage(load.error())) });
 			}
 		}
 		else if ( fastgltf::GltfType::GLB == gltf_type )
 		{
-			auto load = gltf_parser.loadGltfBinary(data, file_path.parent_path(), gltf_loading_options);
+			auto load = gltf_parser.loadGltfBinary(*data, file_path.parent_path(), gltf_loading_options);
 
 			if ( load )
 			{
@@ -61,14 +453,194 @@ namespace Anni::ModelLoader
 			}
 			else
 			{
-				SPDLOG_ERROR("Failed to load GLB file.");
-				std::exit(EXIT_FAILURE); // or std::exit(1);
+				return std::unexpected(LoadError{ LoadError::Code::ParseFailed, "Failed to load GLB file: " + std::string(fastgltf::getErrorMessage(load.error())) });
 			}
 		}
 		else
 		{
-			SPDLOG_ERROR("Unknown type of model file.");
-			std::exit(EXIT_FAILURE); // or std::exit(1);
+			return std::unexpected(LoadError{ LoadError::Code::UnsupportedFile, "Unknown type of model file." });
+		}
+		return {};
+	}
+
+	LoadResult<void> LoadedModel::Factory::LoadExternalBuffers(fastgltf::Asset& gltf_asset, const std::filesystem::path& file_path, const LoadOptions& options, std::vector<std::shared_ptr<MappedFile>>& source_mappings)
+	{
+		for ( fastgltf::Buffer& buffer : gltf_asset.buffers )
+		{
+			// the GLB chunk and data URIs are already in memory
+			const auto* buffer_uri = std::get_if<fastgltf::sources::URI>(&buffer.data);
+			if ( !buffer_uri )
+			{
+				continue;
+			}
+
+			if ( !buffer_uri->uri.isLocalPath() )
+			{
+				return std::unexpected(LoadError{ LoadError::Code::InvalidBuffer, "Only capable of loading local buffers." });
+			}
+
+			const std::filesystem::path buffer_path = file_path.parent_path() / std::string(buffer_uri->uri.path().begin(), buffer_uri->uri.path().end());
+			if ( !options.memory_mapped_input )
+			{
+				std::ifstream buffer_file(buffer_path, std::ios::binary);
+				if ( !buffer_file )
+				{
+					return std::unexpected(LoadError{ LoadError::Code::ReadFailed, "Failed to open buffer file: " + buffer_path.string() });
+				}
+				std::vector<std::byte> buffer_bytes(buffer.byteLength);
+				buffer_file.seekg(static_cast<std::streamoff>(buffer_uri->fileByteOffset));
+				buffer_file.read(reinterpret_cast<char*>(buffer_bytes.data()), static_cast<std::streamsize>(buffer_bytes.size()));
+				if ( !buffer_file )
+				{
+					return std::unexpected(LoadError{ LoadError::Code::InvalidBuffer, "Buffer file is smaller than the buffer: " + buffer_path.string() });
+				}
+				const fastgltf::MimeType mime_type = buffer_uri->mimeType;
+				buffer.data = fastgltf::sources::Vector{ std::move(buffer_bytes), mime_type };
+				continue;
+			}
+
+			std::shared_ptr<MappedFile> mapped_buffer = MappedFile::Open(buffer_path);
+			if ( !mapped_buffer )
+			{
+				return std::unexpected(LoadError{ LoadError::Code::ReadFailed, "Failed to map buffer file: " + buffer_path.string() });
+			}
+
+			const std::span<const uint8_t> file_bytes = mapped_buffer->GetBytes();
+			if ( buffer_uri->fileByteOffset > file_bytes.size() || buffer.byteLength > file_bytes.size() - buffer_uri->fileByteOffset )
+			{
+				return std::unexpected(LoadError{ LoadError::Code::InvalidBuffer, "Buffer file is smaller than the buffer: " + buffer_path.string() });
+			}
+
+			const auto* buffer_begin = reinterpret_cast<const std::byte*>(file_bytes.data()) + buffer_uri->fileByteOffset;
+			const fastgltf::MimeType mime_type = buffer_uri->mimeType;
+			buffer.data = fastgltf::sources::ByteView{ fastgltf::span<const std::byte>(buffer_begin, buffer.byteLength), mime_type };
+			source_mappings.push_back(std::move(mapped_buffer));
+		}
+		return {};
+	}
+
+	LoadResult<void> LoadedModel::Factory::DecodeCompressedBufferViews(fastgltf::Asset& gltf_asset)
+	{
+		// every decoded view gets a 16 byte aligned range of the new buffer, the filters and the accessors read aligned components
+		struct CompressedView
+		{
+			size_t view_index;
+			std::span<const uint8_t> source;
+			size_t decoded_offset;
+		};
+		std::vector<CompressedView> compressed_views;
+		size_t decoded_size = 0;
+		for ( size_t view_index = 0; view_index < gltf_asset.bufferViews.size(); ++view_index )
+		{
+			const fastgltf::BufferView& buffer_view = gltf_asset.bufferViews[view_index];
+			if ( !buffer_view.meshoptCompression )
+			{
+				continue;
+			}
+
+			const fastgltf::CompressedBufferView& compression = *buffer_view.meshoptCompression;
+			const std::span<const std::byte> buffer_bytes = compression.bufferIndex < gltf_asset.buffers.size() ? GetSourceBytes(gltf_asset.buffers[compression.bufferIndex].data) : std::span<const std::byte>{};
+			if ( compression.byteOffset > buffer_bytes.size() || compression.byteLength > buffer_bytes.size() - compression.byteOffset )
+			{
+				return std::unexpected(LoadError{ LoadError::Code::InvalidBuffer, "Compressed data of buffer view " + std::to_string(view_index) + " is outside of its buffer." });
+			}
+			if ( compression.count * compression.byteStride > buffer_view.byteLength )
+			{
+				return std::unexpected(LoadError{ LoadError::Code::InvalidBuffer, "Decoded size of buffer view " + std::to_string(view_index) + " exceeds its byte length." });
+			}
+
+			const std::span<const std::byte> source = buffer_bytes.subspan(compression.byteOffset, compression.byteLength);
+			compressed_views.push_back({ view_index, { reinterpret_cast<const uint8_t*>(source.data()), source.size() }, decoded_size });
+			decoded_size += (buffer_view.byteLength + 15) & ~size_t{ 15 };
+		}
+		if ( compressed_views.empty() )
+		{
+			return {};
+		}
+
+		std::vector<std::byte> decoded_bytes(decoded_size);
+		std::vector<uint8_t> decoded(compressed_views.size(), 0);
+		ThreadPool::Shared().ParallelFor(compressed_views.size(), [&](const size_t i)
+		{
+			const CompressedView& compressed_view = compressed_views[i];
+			const fastgltf::BufferView& buffer_view = gltf_asset.bufferViews[compressed_view.view_index];
+			const fastgltf::CompressedBufferView& compression = *buffer_view.meshoptCompression;
+
+			MeshoptDecoder::Mode mode = MeshoptDecoder::Mode::Attributes;
+			if ( compression.mode == fastgltf::MeshoptCompressionMode::Triangles )
+			{
+				mode = MeshoptDecoder::Mode::Triangles;
+			}
+			else if ( compression.mode == fastgltf::MeshoptCompressionMode::Indices )
+			{
+				mode = MeshoptDecoder::Mode::Indices;
+			}
+			MeshoptDecoder::Filter filter = MeshoptDecoder::Filter::None;
+			if ( compression.filter == fastgltf::MeshoptCompressionFilter::Octahedral )
+			{
+				filter = MeshoptDecoder::Filter::Octahedral;
+			}
+			else if ( compression.filter == fastgltf::MeshoptCompressionFilter::Quaternion )
+			{
+				filter = MeshoptDecoder::Filter::Quaternion;
+			}
+			else if ( compression.filter == fastgltf::MeshoptCompressionFilter::Exponential )
+			{
+				filter = MeshoptDecoder::Filter::Exponential;
+			}
+
+			const std::span<uint8_t> destination(reinterpret_cast<uint8_t*>(decoded_bytes.data()) + compressed_view.decoded_offset, buffer_view.byteLength);
+			decoded[i] = MeshoptDecoder::Decode(mode, filter, compressed_view.source, compression.count, compression.byteStride, destination) ? 1 : 0;
+		});
+
+		for ( size_t i = 0; i < compressed_views.size(); ++i )
+		{
+			if ( !decoded[i] )
+			{
+				return std::unexpected(LoadError{ LoadError::Code::InvalidBuffer, "Failed to decode the EXT_meshopt_compression data of buffer view " + std::to_string(compressed_views[i].view_index) });
+			}
+		}
+
+		const size_t decoded_buffer_index = gltf_asset.buffers.size();
+		fastgltf::Buffer& decoded_buffer = gltf_asset.buffers.emplace_back();
+		decoded_buffer.byteLength = decoded_bytes.size();
+		decoded_buffer.data = fastgltf::sources::Vector{ std::move(decoded_bytes), fastgltf::MimeType::None };
+		for ( const CompressedView& compressed_view : compressed_views )
+		{
+			fastgltf::BufferView& buffer_view = gltf_asset.bufferViews[compressed_view.view_index];
+			buffer_view.bufferIndex = decoded_buffer_index;
+			buffer_view.byteOffset = compressed_view.decoded_offset;
+			buffer_view.meshoptCompression.reset();
+		}
+		return {};
+	}
+
+	void LoadedModel::Factory::CollectSourceFiles(const fastgltf::Asset& gltf_asset, const std::filesystem::path& file_path, std::unique_ptr<LoadedModel>& loading_result)
+	{
+		// several buffers or images can share one file, every file is listed once
+		const auto add_source_file = [&](const fastgltf::sources::URI& uri)
+		{
+			std::filesystem::path source_file = file_path.parent_path() / std::string(uri.uri.path().begin(), uri.uri.path().end());
+			if ( std::ranges::find(loading_result->m_source_files, source_file) == loading_result->m_source_files.end() )
+			{
+				loading_result->m_source_files.push_back(std::move(source_file));
+			}
+		};
+
+		loading_result->m_source_files.push_back(file_path);
+		for ( const auto& buffer : gltf_asset.buffers )
+		{
+			if ( const auto* buffer_uri = std::get_if<fastgltf::sources::URI>(&buffer.data); buffer_uri && buffer_uri->uri.isLocalPath() )
+			{
+				add_source_file(*buffer_uri);
+			}
+		}
+		for ( const auto& image : gltf_asset.images )
+		{
+			if ( const auto* image_uri = std::get_if<fastgltf::sources::URI>(&image.data); image_uri && image_uri->uri.isLocalPath() )
+			{
+				add_source_file(*image_uri);
+			}
 		}
 	}
 
@@ -149,77 +721,293 @@ namespace Anni::ModelLoader
 		}
 	}
 
-	void LoadedModel::Factory::LoadTextureImages(const fastgltf::Asset& gltf_asset, const std::filesystem::path& file_path, std::unique_ptr<LoadedModel>& loading_result)
+	void LoadedModel::Factory::CreateTextureSlots(const fastgltf::Asset& gltf_asset, std::unique_ptr<LoadedModel>& loading_result)
 	{
 		loading_result->m_textures.reserve(gltf_asset.images.size());
-		//> LOAD ALL TEXTURES
 		for ( const auto& image : gltf_asset.images )
 		{
-			const std::string img_name = image.name.c_str();
-			loading_result->m_textures.emplace_back(img_name);
-			LoadedImage& loaded_image = loading_result->m_textures.back();
+			loading_result->m_textures.emplace_back(std::string(image.name.c_str()));
+		}
+	}
 
-			int width = 0, height = 0, num_channels = 0;
+	std::vector<std::future<LoadResult<void>>> LoadedModel::Factory::LoadTextureImages(const fastgltf::Asset& gltf_asset, const std::filesystem::path& file_path, const LoadOptions& options, std::unique_ptr<LoadedModel>& loading_result)
+	{
+		//> LOAD ALL TEXTURES
+		std::vector<std::future<LoadResult<void>>> pending_images;
+		pending_images.reserve(gltf_asset.images.size());
+		const std::vector<uint8_t> unused_basisu_images = FindUnusedBasisuImages(gltf_asset);
+		for ( size_t image_index = 0; image_index < gltf_asset.images.size(); ++image_index )
+		{
+			if ( unused_basisu_images[image_index] )
 			{
-				if ( std::get_if<fastgltf::sources::URI>(&image.data) )
-				{
-					const fastgltf::sources::URI* p_img_loca_Path_URI = std::get_if<fastgltf::sources::URI>(&image.data);
-					const auto& img_loca_path_URI = *p_img_loca_Path_URI;
-
-					const std::string img_local_uri = img_loca_path_URI.uri.string().data();
-					loading_result->m_textures.back().file_name.value().append(img_local_uri);
-
+				// its slot stays empty
+				continue;
+			}
+			const fastgltf::Image& image = gltf_asset.images[image_index];
+			LoadedImage& loaded_image = loading_result->m_textures[image_index];
+			LoadedModel* const model = loading_result.get();
+			auto decode_job = [&gltf_asset, &image, file_path, &options, &loaded_image, model]() -> LoadResult<void>
+			{
+				const auto start = std::chrono::steady_clock::now();
+				uint64_t decoded_texels = 0;
+				LoadResult<void> loaded = LoadTextureImage(gltf_asset, image, file_path, options, loaded_image, &decoded_texels);
+				const auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+				model->m_decoded_texels.fetch_add(decoded_texels, std::memory_order_relaxed);
+				model->m_texture_decode_nanoseconds.fetch_add(static_cast<uint64_t>(duration.count()), std::memory_order_relaxed);
+				return loaded;
+			};
+
+			if ( options.parallel_texture_decoding )
+			{
+				pending_images.push_back(ThreadPool::Shared().Submit(std::move(decode_job)));
+			}
+			else
+			{
+				// deferred jobs run on the calling thread once WaitTextureImages asks for them
+				pending_images.push_back(std::async(std::launch::deferred, std::move(decode_job)));
+			}
+		}
+		return pending_images;
+	}
 
-					if ( img_loca_path_URI.fileByteOffset != 0 ) // We don't support offsets with stbi.
-					{
-						SPDLOG_ERROR("Don't support offsets with stbi.");
-						std::exit(EXIT_FAILURE); // or std::exit(1);
-					}
+	LoadResult<void> LoadedModel::Factory::WaitTextureImages(std::vector<std::future<LoadResult<void>>>& pending_images)
+	{
+		// wait for all of them before bailing out, the jobs still reference the gltf asset. the first failure in image order wins
+		LoadResult<void> result;
+		for ( auto& pending_image : pending_images )
+		{
+			LoadResult<void> decoded = pending_image.get();
+			if ( result && !decoded )
+			{
+				result = std::move(decoded);
+			}
+		}
+		pending_images.clear();
+		return result;
+	}
 
-					if ( !img_loca_path_URI.uri.isLocalPath() ) // We're only capable of loading local files.
-					{
-						SPDLOG_ERROR("Only capable of loading local files.");
-						std::exit(EXIT_FAILURE); // or std::exit(1);
-					}
+	LoadResult<void> LoadedModel::Factory::LoadTextureImage(const fastgltf::Asset& gltf_asset, const fastgltf::Image& image, const std::filesystem::path& file_path, const LoadOptions& options, LoadedImage& loaded_image, uint64_t* const decoded_texels)
+	{
+		const auto decode = [&gltf_asset, &image, &file_path, &options, decoded_texels](LoadedImage& decoded_image) -> LoadResult<void>
+		{
+			TraceSpan span(options.trace_recorder, "decode_image " + std::string(image.name.c_str()), "texture");
+			if ( LoadResult<void> decoded = DecodeTextureImage(gltf_asset, image, file_path, options.memory_mapped_input, options.texture_compression, decoded_image); !decoded )
+			{
+				// keeps the code, an unsupported texture stays distinguishable from a broken one
+				return std::unexpected(LoadError{ decoded.error().code, "Failed to decode image '" + std::string(image.name.c_str()) + "': " + decoded.error().message });
+			}
+			if ( decoded_texels )
+			{
+				*decoded_texels = static_cast<uint64_t>(decoded_image.width.value_or(0)) * decoded_image.height.value_or(0);
+			}
+			// KTX2 images already have their levels
+			if ( decoded_image.mip_levels.empty() )
+			{
+				TextureProcessor::Process(decoded_image, options.generate_mipmaps, options.texture_compression);
+			}
+			return {};
+		};
+		if ( !options.use_texture_cache )
+		{
+			return decode(loaded_image);
+		}
 
-					const std::string img_local_path(
-						img_loca_path_URI.uri.path().begin(),
-						img_loca_path_URI.uri.path().end()); // Thanks C++.
+		// the key needs the encoded bytes: a mapping of the file for URIs, the asset's own buffers for embedded images
+		TextureCache::Key key{};
+		std::shared_ptr<MappedFile> mapped_image;
+		std::span<const uint8_t> encoded_image;
+		if ( const auto* image_uri = std::get_if<fastgltf::sources::URI>(&image.data) )
+		{
+			if ( !image_uri->uri.isLocalPath() )
+			{
+				// DecodeTextureImage reports it
+				return decode(loaded_image);
+			}
+			loaded_image.file_name.value().append(image_uri->uri.string());
 
-					const std::filesystem::path absolute_path = file_path.parent_path().append(img_local_path);
+			const std::filesystem::path absolute_path = file_path.parent_path() / std::string(image_uri->uri.path().begin(), image_uri->uri.path().end());
+			std::error_code canonical_error;
+			const std::filesystem::path canonical_path = std::filesystem::weakly_canonical(absolute_path, canonical_error);
+			key.canonical_path = (canonical_error ? absolute_path : canonical_path).generic_string();
 
-					constexpr int desired_components = 4;
-					unsigned char* const temp_tex_data = stbi_load(absolute_path.generic_string().c_str(), &width,
-																   &height, &num_channels, desired_components);
+			mapped_image = MappedFile::Open(absolute_path);
+			if ( !mapped_image )
+			{
+				return TextureError("Failed to map image file: " + absolute_path.string());
+			}
+			encoded_image = mapped_image->GetBytes();
+		}
+		else
+		{
+			const std::span<const std::byte> embedded_image = GetEmbeddedImageBytes(gltf_asset, image);
+			encoded_image = { reinterpret_cast<const uint8_t*>(embedded_image.data()), embedded_image.size() };
+		}
+		key.content_hash = TextureCache::HashContent(encoded_image);
+		key.settings = static_cast<uint64_t>(loaded_image.usage) | static_cast<uint64_t>(options.generate_mipmaps ? 1 : 0) << 32 | static_cast<uint64_t>(options.texture_compression) << 40;
+
+		// the usage decides the format TextureProcessor picks, a miss needs it on the cached image too. when another load's
+		// decode of the same key failed, only the generic error is known here
+		const uint32_t usage = loaded_image.usage;
+		LoadResult<void> decoded = TextureError("Failed to decode image '" + std::string(image.name.c_str()) + "'.");
+		std::shared_ptr<const LoadedImage> cached_image = TextureCache::Shared().GetOrDecode(key, [&decode, &decoded, usage](LoadedImage& decoded_image)
+		{
+			decoded_image.usage = usage;
+			decoded = decode(decoded_image);
+			return decoded.has_value();
+		});
+		if ( !cached_image )
+		{
+			return decoded;
+		}
 
-					if ( !(num_channels == 4 || num_channels == 3) )
-					{
-						SPDLOG_ERROR("Unsupported number of channels.");
-						std::exit(EXIT_FAILURE); // or std::exit(1);
-					}
-					loaded_image.num_channels = num_channels;
-					loaded_image.mipmap_size = 1;
-					loaded_image.array_size = 1;
-					if ( temp_tex_data )
-					{
-						const uint64_t tex_width = width;
-						const uint64_t tex_height = height;
-						constexpr uint16_t depth_or_array_size = 1;
+		loaded_image.width = cached_image->width;
+		loaded_image.height = cached_image->height;
+		loaded_image.array_size = cached_image->array_size;
+		loaded_image.mipmap_size = cached_image->mipmap_size;
+		loaded_image.num_channels = cached_image->num_channels;
+		loaded_image.format = cached_image->format;
+		loaded_image.mip_levels = cached_image->mip_levels;
+		loaded_image.external_data = cached_image->GetData();
+		loaded_image.external_owner = std::move(cached_image);
+		return {};
+	}
 
-						loaded_image.raw_data.resize(tex_height * tex_height * desired_components);
-						// Copy data from temp_tex_data to raw_data
-						memcpy(loaded_image.raw_data.data(), temp_tex_data, width * height * desired_components);
-					}
-					//free the image
-					stbi_image_free(temp_tex_data);
+	std::vector<uint8_t> LoadedModel::Factory::FindUnusedBasisuImages(const fastgltf::Asset& gltf_asset)
+	{
+		// 1 for a basisu source, 2 once any texture actually uses the image
+		std::vector<uint8_t> image_states(gltf_asset.images.size(), 0);
+		for ( const fastgltf::Texture& texture : gltf_asset.textures )
+		{
+			if ( texture.basisuImageIndex.has_value() && texture.basisuImageIndex.value() < image_states.size() )
+			{
+				image_states[texture.basisuImageIndex.value()] |= 1;
+			}
+			if ( const std::optional<uint32_t> image_index = GetTextureImageIndex(texture); image_index.has_value() && image_index.value() < image_states.size() )
+			{
+				image_states[image_index.value()] |= 2;
+			}
+		}
+		for ( uint8_t& image_state : image_states )
+		{
+			image_state = image_state == 1;
+		}
+		return image_states;
+	}
+
+	LoadResult<void> LoadedModel::Factory::DecodeTextureImage(const fastgltf::Asset& gltf_asset, const fastgltf::Image& image, const std::filesystem::path& file_path, const bool memory_mapped_input, const TextureCompression compression, LoadedImage& loaded_image)
+	{
+		// runs on worker threads: failures come back as values, nothing is logged
+		int width = 0, height = 0, num_channels = 0;
+		constexpr int desired_components = 4;
+		unsigned char* temp_tex_data = nullptr;
+		if ( std::get_if<fastgltf::sources::URI>(&image.data) )
+		{
+			const fastgltf::sources::URI* p_img_loca_Path_URI = std::get_if<fastgltf::sources::URI>(&image.data);
+			const auto& img_loca_path_URI = *p_img_loca_Path_URI;
+
+			const std::string img_local_uri = img_loca_path_URI.uri.string().data();
+			loaded_image.file_name.value().append(img_local_uri);
+
+
+			if ( !img_loca_path_URI.uri.isLocalPath() ) // We're only capable of loading local files.
+			{
+				return TextureError("Only local image files can be loaded.");
+			}
+
+			const std::string img_local_path(
+				img_loca_path_URI.uri.path().begin(),
+				img_loca_path_URI.uri.path().end()); // Thanks C++.
+
+			const std::filesystem::path absolute_path = file_path.parent_path().append(img_local_path);
+
+			// KTX2 files are always mapped, their levels are copied or transcoded straight out of the mapping
+			const bool ktx2_file = fastgltf::MimeType::KTX2 == img_loca_path_URI.mimeType || absolute_path.extension() == ".ktx2";
+			if ( memory_mapped_input || ktx2_file )
+			{
+				// the mapping only has to live until stbi is done with it
+				const std::shared_ptr<MappedFile> mapped_image = MappedFile::Open(absolute_path);
+				if ( !mapped_image )
+				{
+					return TextureError("Failed to map image file: " + absolute_path.string());
 				}
-				else
+
+				const std::span<const uint8_t> file_bytes = mapped_image->GetBytes();
+				if ( img_loca_path_URI.fileByteOffset > file_bytes.size() )
+				{
+					return TextureError("Image offset is past the end of the file.");
+				}
+				const std::span<const uint8_t> encoded_image = file_bytes.subspan(img_loca_path_URI.fileByteOffset);
+				if ( Ktx2Decoder::IsKtx2(encoded_image) )
+				{
+					return Ktx2Decoder::Decode(encoded_image, compression, loaded_image);
+				}
+				if ( encoded_image.size() > static_cast<size_t>(std::numeric_limits<int>::max()) )
+				{
+					return TextureError("Image file is too large for stbi.");
+				}
+
+				temp_tex_data = stbi_load_from_memory(encoded_image.data(), static_cast<int>(encoded_image.size()),
+													  &width, &height, &num_channels, desired_components);
+			}
+			else
+			{
+				if ( img_loca_path_URI.fileByteOffset != 0 ) // We don't support offsets with stbi.
 				{
-					SPDLOG_ERROR("Haven't implemented.");
-					std::exit(EXIT_FAILURE); // or std::exit(1);
+					return TextureError("Image offsets aren't supported by stbi.");
 				}
+
+				temp_tex_data = stbi_load(absolute_path.generic_string().c_str(), &width,
+										  &height, &num_channels, desired_components);
+			}
+		}
+		else
+		{
+			// embedded images(GLB buffer views, data URIs) are decoded straight out of the parsed buffers, no copy is made first
+			const std::span<const std::byte> encoded_image = GetEmbeddedImageBytes(gltf_asset, image);
+			if ( encoded_image.empty() )
+			{
+				return TextureError("Unsupported image data source.");
+			}
+			const std::span<const uint8_t> encoded_bytes(reinterpret_cast<const uint8_t*>(encoded_image.data()), encoded_image.size());
+			if ( Ktx2Decoder::IsKtx2(encoded_bytes) )
+			{
+				return Ktx2Decoder::Decode(encoded_bytes, compression, loaded_image);
 			}
+			if ( encoded_image.size() > static_cast<size_t>(std::numeric_limits<int>::max()) )
+			{
+				return TextureError("Embedded image is too large for stbi.");
+			}
+
+			temp_tex_data = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(encoded_image.data()), static_cast<int>(encoded_image.size()),
+												  &width, &height, &num_channels, desired_components);
+		}
+
+		if ( !temp_tex_data )
+		{
+			return TextureError(std::string("stbi failed: ") + stbi_failure_reason());
+		}
+		if ( !(num_channels == 4 || num_channels == 3) )
+		{
+			stbi_image_free(temp_tex_data);
+			return TextureError("Unsupported number of channels: " + std::to_string(num_channels) + ".");
 		}
+		loaded_image.num_channels = num_channels;
+		loaded_image.mipmap_size = 1;
+		loaded_image.array_size = 1;
+		if ( temp_tex_data )
+		{
+			const uint64_t tex_width = width;
+			const uint64_t tex_height = height;
+			loaded_image.width = static_cast< uint32_t >(tex_width);
+			loaded_image.height = static_cast< uint32_t >(tex_height);
+
+			loaded_image.raw_data.resize(tex_width * tex_height * desired_components);
+			// Copy data from temp_tex_data to raw_data
+			memcpy(loaded_image.raw_data.data(), temp_tex_data, tex_width * tex_height * desired_components);
+		}
+		//free the image
+		stbi_image_free(temp_tex_data);
+		return {};
 	}
 
 	void LoadedModel::Factory::LoadMaterials(const fastgltf::Asset& gltf_asset, const std::filesystem::path& file_path, std::unique_ptr<LoadedModel>& loading_result)
@@ -240,285 +1028,1313 @@ namespace Anni::ModelLoader
 			{
 				case fastgltf::AlphaMode::Opaque:
 					constants.alpha_mode = LoadedMaterialConstant::AlphaMode::Opaque;
+					break;
 				case fastgltf::AlphaMode::Blend:
 					constants.alpha_mode = LoadedMaterialConstant::AlphaMode::Blend;
+					break;
 				case fastgltf::AlphaMode::Mask:
 					constants.alpha_mode = LoadedMaterialConstant::AlphaMode::Mask;
 					constants.alpha_cutoff = mat.alphaCutoff;
+					break;
 			}
 
 			// install m_textures index
 			if ( mat.pbrData.baseColorTexture.has_value() )
 			{
-				constants.albedo_index = gltf_asset.textures[mat.pbrData.baseColorTexture.value().textureIndex].imageIndex.value();
-				constants.albedo_sampler_index = gltf_asset.textures[mat.pbrData.baseColorTexture.value().textureIndex].samplerIndex.value();
+				ResolveTextureSlot(gltf_asset, mat.pbrData.baseColorTexture.value().textureIndex, constants.albedo_index, constants.albedo_sampler_index);
 			}
 
 			if ( mat.pbrData.metallicRoughnessTexture.has_value() )
 			{
-				constants.metal_roughness_index = gltf_asset.textures[mat.pbrData.metallicRoughnessTexture.value().textureIndex].imageIndex.value();
-				constants.metal_roughness_sampler_index = gltf_asset.textures[mat.pbrData.metallicRoughnessTexture.value().textureIndex].samplerIndex.value();
+				ResolveTextureSlot(gltf_asset, mat.pbrData.metallicRoughnessTexture.value().textureIndex, constants.metal_roughness_index, constants.metal_roughness_sampler_index);
 			}
 
 			if ( mat.normalTexture.has_value() )
 			{
-				constants.normal_index = gltf_asset.textures[mat.normalTexture.value().textureIndex].imageIndex.value();
-				constants.normal_sampler_index = gltf_asset.textures[mat.normalTexture.value().textureIndex].samplerIndex.value();
+				ResolveTextureSlot(gltf_asset, mat.normalTexture.value().textureIndex, constants.normal_index, constants.normal_sampler_index);
 			}
 
 			if ( mat.emissiveTexture.has_value() )
 			{
-				constants.emissive_index = gltf_asset.textures[mat.emissiveTexture.value().textureIndex]
-					.imageIndex.value();
-				constants.emissive_sampler_index = gltf_asset.textures[mat.emissiveTexture.value().textureIndex]
-					.samplerIndex.value();
+				ResolveTextureSlot(gltf_asset, mat.emissiveTexture.value().textureIndex, constants.emissive_index, constants.emissive_sampler_index);
 			}
 
 			if ( mat.occlusionTexture.has_value() )
 			{
-				constants.occlusion_index = gltf_asset.textures[mat.occlusionTexture.value().textureIndex]
-					.imageIndex.value();
-				constants.occlusion_sampler_index = gltf_asset.textures[mat.occlusionTexture.value().textureIndex]
-					.samplerIndex.value();
+				ResolveTextureSlot(gltf_asset, mat.occlusionTexture.value().textureIndex, constants.occlusion_index, constants.occlusion_sampler_index);
 			}
 			loading_result->m_materials.push_back(constants);
 		}
+
+		// the texture slots exist already, TextureProcessor picks every image's format from these
+		const auto mark_usage = [&loading_result](const std::optional<uint32_t>& image_index, const LoadedImage::UsageBits usage)
+		{
+			if ( image_index.has_value() && image_index.value() < loading_result->m_textures.size() )
+			{
+				loading_result->m_textures[image_index.value()].usage |= usage;
+			}
+		};
+		for ( const auto& constants : loading_result->m_materials )
+		{
+			mark_usage(constants.albedo_index, LoadedImage::Albedo);
+			mark_usage(constants.metal_roughness_index, LoadedImage::MetalRoughness);
+			mark_usage(constants.normal_index, LoadedImage::Normal);
+			mark_usage(constants.emissive_index, LoadedImage::Emissive);
+			mark_usage(constants.occlusion_index, LoadedImage::Occlusion);
+		}
 	}
 
-	void LoadedModel::Factory::LoadMeshes(const fastgltf::Asset& gltf_asset, std::unique_ptr<LoadedModel>& loading_result)
+	LoadResult<void> LoadedModel::Factory::LoadMeshes(const fastgltf::Asset& gltf_asset, const LoadOptions& options, std::unique_ptr<LoadedModel>& loading_result)
 	{
-		// use the same vectors for all meshes so that the memory doesn't reallocate  as often
-		std::vector<uint32_t> indices;
-		std::vector<LoadedVertex> vertices;
-
-		loading_result->m_mesh_assets.resize(gltf_asset.meshes.size());
+		// every mesh's arrays come out of the model's arena, sized up front so each of them is a single allocation
+		// packed streams replace the interleaved vertices and merging replaces both arrays later on, whatever gets replaced
+		// stays off the arena so freeing it gives the memory back
+		std::pmr::memory_resource* const arena = &loading_result->m_arena;
+		std::pmr::memory_resource* const index_resource = options.merge_mesh_buffers ? std::pmr::get_default_resource() : arena;
+		std::pmr::memory_resource* const vertex_resource = options.merge_mesh_buffers || options.vertex_layout.has_value() ? std::pmr::get_default_resource() : arena;
+		loading_result->m_mesh_assets.reserve(gltf_asset.meshes.size());
+		for ( size_t mesh_index = 0; mesh_index < gltf_asset.meshes.size(); ++mesh_index )
+		{
+			loading_result->m_mesh_assets.emplace_back(arena, index_resource, vertex_resource);
+		}
 
+		//> VALIDATE AND RESERVE
+		// sizes and errors are settled here in mesh order, so the arena hands out the same blocks on every load and the
+		// extraction jobs below neither allocate nor fail
+		const auto vertex_count_matches = [&gltf_asset](const fastgltf::Primitive& primitive, const std::string_view attribute_name, const size_t vertex_count)
+		{
+			const auto attribute = primitive.findAttribute(attribute_name);
+			return attribute == primitive.attributes.end() || gltf_asset.accessors[attribute->accessorIndex].count == vertex_count;
+		};
+		std::vector<std::pair<size_t, size_t>> mesh_sizes(gltf_asset.meshes.size());
+		// meshes with at least one primitive that has both JOINTS_0 and WEIGHTS_0 get a skin vertex per vertex
+		std::vector<uint8_t> skinned_meshes(gltf_asset.meshes.size(), 0);
 		for ( auto [mesh_index, mesh] : std::ranges::views::enumerate(gltf_asset.meshes) )
 		{
+			LoadedMeshAsset& mesh_asset = loading_result->m_mesh_assets[mesh_index];
 			std::string mesh_name{ mesh.name };
-			loading_result->m_mesh_assets[mesh_index].name = mesh_name.append(std::to_string(mesh_index));
+			mesh_asset.name = mesh_name.append(std::to_string(mesh_index));
+
+			auto& [index_count, vertex_count] = mesh_sizes[mesh_index];
+			for ( auto&& primitive : mesh.primitives )
+			{
+				const auto positions = primitive.findAttribute("POSITION");
+				if ( !primitive.indicesAccessor.has_value() || positions == primitive.attributes.end() )
+				{
+					return std::unexpected(LoadError{ LoadError::Code::InvalidMesh, "Indices or positions are missing from the homo-material triangles of mesh " + mesh_asset.name });
+				}
+				if ( !primitive.materialIndex.has_value() )
+				{
+					return std::unexpected(LoadError{ LoadError::Code::InvalidMesh, "No material index is specified for the homo-material triangles of mesh " + mesh_asset.name });
+				}
+				// the draw list indexes the loaded materials with it
+				if ( primitive.materialIndex.value() >= gltf_asset.materials.size() )
+				{
+					return std::unexpected(LoadError{ LoadError::Code::InvalidMesh, "Material index " + std::to_string(primitive.materialIndex.value()) + " is out of range in mesh " + mesh_asset.name });
+				}
 
-			// clear the mesh_asset arrays each mesh_asset, we don't want to merge them by error
-			indices.clear();
-			vertices.clear();
+				const size_t primitive_vertex_count = gltf_asset.accessors[positions->accessorIndex].count;
+				for ( const std::string_view attribute_name : { "NORMAL", "TEXCOORD_0", "COLOR_0", "TANGENT", "JOINTS_0", "WEIGHTS_0" } )
+				{
+					if ( !vertex_count_matches(primitive, attribute_name, primitive_vertex_count) )
+					{
+						return std::unexpected(LoadError{ LoadError::Code::InvalidMesh, std::string(attribute_name) + " and POSITION counts differ in mesh " + mesh_asset.name });
+					}
+				}
+				index_count += gltf_asset.accessors[primitive.indicesAccessor.value()].count;
+				vertex_count += primitive_vertex_count;
+				if ( primitive.findAttribute("JOINTS_0") != primitive.attributes.end() && primitive.findAttribute("WEIGHTS_0") != primitive.attributes.end() )
+				{
+					skinned_meshes[mesh_index] = 1;
+				}
+			}
+			mesh_asset.buffer_in_one.indices.reserve(index_count);
+			mesh_asset.buffer_in_one.vertices.reserve(vertex_count);
+			if ( skinned_meshes[mesh_index] )
+			{
+				mesh_asset.buffer_in_one.skin_vertices.reserve(vertex_count);
+			}
+			mesh_asset.homo_mat_tris_array.reserve(mesh.primitives.size());
+		}
 
-			// process homo mat tris
+		//> EXTRACT
+		// every attribute is converted with one strided copy straight into its LoadedVertex(or LoadedSkinVertex) member, defaults
+		// are only written for the attributes a primitive doesn't have(uv, weights and joints default to the zeros resize leaves behind)
+		// a mesh with indices past its primitive's vertices is flagged here and rejected once every job is done
+		std::vector<uint8_t> index_out_of_range(gltf_asset.meshes.size(), 0);
+		const auto extract_mesh = [&](const size_t mesh_index)
+		{
+			const fastgltf::Mesh& mesh = gltf_asset.meshes[mesh_index];
+			LoadedMeshAsset& mesh_asset = loading_result->m_mesh_assets[mesh_index];
+			TraceSpan span(options.trace_recorder, "extract_mesh " + mesh_asset.name, "mesh");
+
+			// within the reserved capacity, neither of them allocates
+			std::pmr::vector<uint32_t>& indices = mesh_asset.buffer_in_one.indices;
+			std::pmr::vector<LoadedVertex>& vertices = mesh_asset.buffer_in_one.vertices;
+			std::pmr::vector<LoadedSkinVertex>& skin_vertices = mesh_asset.buffer_in_one.skin_vertices;
+			indices.resize(mesh_sizes[mesh_index].first);
+			vertices.resize(mesh_sizes[mesh_index].second);
+			skin_vertices.resize(skinned_meshes[mesh_index] ? mesh_sizes[mesh_index].second : 0);
+
+			uint32_t present_attributes = VertexLayout::Position;
+			BoundingBox mesh_bounds;
+			size_t first_index = 0;
+			size_t first_vertex = 0;
 			for ( auto&& primitive : mesh.primitives )
 			{
-				LoadedMeshAsset::HomoMatTris homo_mat_tris;
-				homo_mat_tris.start_index = static_cast< uint32_t >(indices.size());
-				homo_mat_tris.count = static_cast< uint32_t >(gltf_asset.accessors[primitive.indicesAccessor.value()].count);
+				const fastgltf::Accessor& index_accessor = gltf_asset.accessors[primitive.indicesAccessor.value()];
+				const fastgltf::Accessor& position_accessor = gltf_asset.accessors[primitive.findAttribute("POSITION")->accessorIndex];
+				const std::span<uint32_t> primitive_indices = std::span<uint32_t>(indices).subspan(first_index, index_accessor.count);
+				const std::span<LoadedVertex> primitive_vertices = std::span<LoadedVertex>(vertices).subspan(first_vertex, position_accessor.count);
 
-				size_t initial_vtx = vertices.size();
+				LoadedMeshAsset::HomoMatTris homo_mat_tris;
+				homo_mat_tris.start_index = static_cast< uint32_t >(first_index);
+				homo_mat_tris.count = static_cast< uint32_t >(index_accessor.count);
+				homo_mat_tris.material_index = primitive.materialIndex.value();
 
 				// load indexes
+				fastgltf::copyFromAccessor<uint32_t>(gltf_asset, index_accessor, primitive_indices.data());
+				const auto primitive_vertex_count = static_cast<uint32_t>(position_accessor.count);
+				bool out_of_range = false;
+				for ( uint32_t& index : primitive_indices )
 				{
-					const fastgltf::Accessor& indexaccessor = gltf_asset.accessors[primitive.indicesAccessor.value()];
-					indices.reserve(indices.size() + indexaccessor.count);
-
-					fastgltf::iterateAccessor<std::uint32_t>(
-						gltf_asset, indexaccessor,
-						[&](std::uint32_t idx)
-						{
-							indices.push_back(idx + initial_vtx);
-						});
+					out_of_range |= index >= primitive_vertex_count;
+					index += static_cast<uint32_t>(first_vertex);
 				}
-
-				// load vertex positions
+				if ( out_of_range )
 				{
-					const fastgltf::Accessor& posAccessor = gltf_asset.accessors[primitive.findAttribute("POSITION")->accessorIndex];
-					vertices.resize(vertices.size() + posAccessor.count);
-
-					fastgltf::iterateAccessorWithIndex<fastgltf::math::vec<float, 3>>(
-						gltf_asset, posAccessor,
-						[&](fastgltf::math::vec<float, 3> v, size_t index) -> void
-						{
-							LoadedVertex newvtx;
-							newvtx.position = glm::vec3(v[0], v[1], v[2]);
-							newvtx.normal = { 0, 1, 0 };
-							newvtx.color = glm::vec4{ 1.f };
-							newvtx.uv = glm::vec2{ 0.f, 0.f };
-							newvtx.tangent = { 1, 0, 0, 0 };
-							vertices[initial_vtx + index] = newvtx;
-						});
+					index_out_of_range[mesh_index] = 1;
+					return;
 				}
 
+				// load vertex positions
+				CopyVertexAttribute<fastgltf::math::fvec3>(gltf_asset, position_accessor, primitive_vertices, offsetof(LoadedVertex, position));
+
 				// load vertex normals
-				const auto normals = primitive.findAttribute("NORMAL");
-				if ( normals != primitive.attributes.end() )
+				if ( const auto normals = primitive.findAttribute("NORMAL"); normals != primitive.attributes.end() )
+				{
+					present_attributes |= VertexLayout::Normal;
+					CopyVertexAttribute<fastgltf::math::fvec3>(gltf_asset, gltf_asset.accessors[normals->accessorIndex], primitive_vertices, offsetof(LoadedVertex, normal));
+				}
+				else
 				{
-					fastgltf::iterateAccessorWithIndex<fastgltf::math::vec<float, 3>>
-						(
-							gltf_asset, gltf_asset.accessors[normals->accessorIndex],
-							[&](fastgltf::math::vec<float, 3> v, size_t index)
-							{
-								vertices[initial_vtx + index].normal = glm::vec3(v[0], v[1], v[2]);
-							}
-						);
+					for ( LoadedVertex& vertex : primitive_vertices )
+					{
+						vertex.normal = { 0, 1, 0 };
+					}
 				}
 
 				// load UVs
-				const auto uv = primitive.findAttribute("TEXCOORD_0");
-				if ( uv != primitive.attributes.end() )
+				if ( const auto uv = primitive.findAttribute("TEXCOORD_0"); uv != primitive.attributes.end() )
 				{
-					fastgltf::iterateAccessorWithIndex<fastgltf::math::vec<float, 2>>(
-						gltf_asset, gltf_asset.accessors[uv->accessorIndex],
-						[&](fastgltf::math::vec<float, 2> v, size_t index)
-						{
-							vertices[initial_vtx + index].uv.x = v[0];
-							vertices[initial_vtx + index].uv.y = v[1];
-						});
+					present_attributes |= VertexLayout::Uv;
+					CopyVertexAttribute<fastgltf::math::fvec2>(gltf_asset, gltf_asset.accessors[uv->accessorIndex], primitive_vertices, offsetof(LoadedVertex, uv));
 				}
 
-				// load vertex colors
-				const auto colors = primitive.findAttribute("COLOR_0");
-				if ( colors != primitive.attributes.end() )
+				// load vertex colors, rgb ones get an opaque alpha
+				if ( const auto colors = primitive.findAttribute("COLOR_0"); colors != primitive.attributes.end() )
 				{
-					fastgltf::iterateAccessorWithIndex<fastgltf::math::vec<float, 4>>(
-						gltf_asset, gltf_asset.accessors[colors->accessorIndex],
-						[&](fastgltf::math::vec<float, 4> v, size_t index)
+					present_attributes |= VertexLayout::Color;
+					const fastgltf::Accessor& color_accessor = gltf_asset.accessors[colors->accessorIndex];
+					if ( color_accessor.type == fastgltf::AccessorType::Vec3 )
+					{
+						CopyVertexAttribute<fastgltf::math::fvec3>(gltf_asset, color_accessor, primitive_vertices, offsetof(LoadedVertex, color));
+						for ( LoadedVertex& vertex : primitive_vertices )
 						{
-							vertices[initial_vtx + index].color = glm::vec4(v[0], v[1], v[2], v[3]);
-						});
+							vertex.color.a = 1.f;
+						}
+					}
+					else
+					{
+						CopyVertexAttribute<fastgltf::math::fvec4>(gltf_asset, color_accessor, primitive_vertices, offsetof(LoadedVertex, color));
+					}
 				}
-
-				// load tangent
-				const auto tangent = primitive.findAttribute("TANGENT");
-				if ( tangent != primitive.attributes.end() )
+				else
 				{
-					fastgltf::iterateAccessorWithIndex<fastgltf::math::vec<float, 4>>(
-						gltf_asset, gltf_asset.accessors[tangent->accessorIndex],
-						[&](fastgltf::math::vec<float, 4> v, size_t index)
-						{
-							vertices[initial_vtx + index].tangent = glm::vec4(v[0], v[1], v[2], v[3]);
-						});
+					for ( LoadedVertex& vertex : primitive_vertices )
+					{
+						vertex.color = glm::vec4{ 1.f };
+					}
 				}
 
-				// load material index
-				if ( primitive.materialIndex.has_value() )
+				// load tangent
+				if ( const auto tangent = primitive.findAttribute("TANGENT"); tangent != primitive.attributes.end() )
 				{
-					homo_mat_tris.material_index = primitive.materialIndex.value();
+					present_attributes |= VertexLayout::Tangent;
+					CopyVertexAttribute<fastgltf::math::fvec4>(gltf_asset, gltf_asset.accessors[tangent->accessorIndex], primitive_vertices, offsetof(LoadedVertex, tangent));
 				}
 				else
 				{
-					//SPD log here
-					SPDLOG_ERROR("No material index is specified for the current homo-material triangles.");
-					std::exit(EXIT_FAILURE); // or std::exit(1);
+					for ( LoadedVertex& vertex : primitive_vertices )
+					{
+						vertex.tangent = { 1, 0, 0, 0 };
+					}
+				}
+
+				// load joints and weights, one without the other can't skin anything
+				const auto joints = primitive.findAttribute("JOINTS_0");
+				const auto weights = primitive.findAttribute("WEIGHTS_0");
+				if ( joints != primitive.attributes.end() && weights != primitive.attributes.end() )
+				{
+					present_attributes |= VertexLayout::Skin;
+					const std::span<LoadedSkinVertex> primitive_skin_vertices = std::span<LoadedSkinVertex>(skin_vertices).subspan(first_vertex, position_accessor.count);
+					CopyVertexAttribute<fastgltf::math::vec<uint16_t, 4>>(gltf_asset, gltf_asset.accessors[joints->accessorIndex], primitive_skin_vertices, offsetof(LoadedSkinVertex, joints));
+					CopyVertexAttribute<fastgltf::math::fvec4>(gltf_asset, gltf_asset.accessors[weights->accessorIndex], primitive_skin_vertices, offsetof(LoadedSkinVertex, weights));
+					// normalized integer weights rarely add up to exactly 1
+					for ( LoadedSkinVertex& skin_vertex : primitive_skin_vertices )
+					{
+						const glm::vec4 vertex_weights = skin_vertex.weights;
+						const float weight_sum = vertex_weights.x + vertex_weights.y + vertex_weights.z + vertex_weights.w;
+						skin_vertex.weights = weight_sum > 0.f ? vertex_weights / weight_sum : vertex_weights;
+					}
 				}
 
-				loading_result->m_mesh_assets[mesh_index].homo_mat_tris_array.push_back(homo_mat_tris);
+				// bounds, computed from the positions since accessor min/max is optional and may be stale
+				homo_mat_tris.bounds = ComputeBoundingBox(primitive_vertices);
+				homo_mat_tris.bounding_sphere = ComputeBoundingSphere(primitive_vertices, homo_mat_tris.bounds);
+				mesh_bounds.Merge(homo_mat_tris.bounds);
+
+				mesh_asset.homo_mat_tris_array.push_back(homo_mat_tris);
+				first_index += index_accessor.count;
+				first_vertex += position_accessor.count;
 			}
-			loading_result->m_mesh_assets[mesh_index].buffer_in_one.indices = std::move(indices);
-			loading_result->m_mesh_assets[mesh_index].buffer_in_one.vertices = std::move(vertices);
-		}
-	}
+			mesh_asset.present_attributes = present_attributes;
+			mesh_asset.bounds = mesh_bounds;
+			mesh_asset.bounding_sphere = ComputeBoundingSphere(vertices, mesh_bounds);
+		};
 
-	void LoadedModel::Factory::LoadSceneNodes(const fastgltf::Asset& gltf_asset, std::unique_ptr<LoadedModel>& loading_result)
-	{
-		// LOAD ALL NODES AND THEIR MESHES
-		for ( auto [node_index, node] : std::ranges::views::enumerate(gltf_asset.nodes) )
+		// each job only writes its own mesh, the result is the same bytes either way
+		if ( options.parallel_mesh_extraction )
 		{
-			std::shared_ptr<Node> new_node;
-
-			// find if the node has a mesh_asset, and if it does then hook it to the mesh_asset
-			// pointer and allocate it with the meshnode class
-			if ( node.meshIndex.has_value() )
+			ThreadPool::Shared().ParallelFor(gltf_asset.meshes.size(), extract_mesh);
+		}
+		else
+		{
+			for ( size_t mesh_index = 0; mesh_index < gltf_asset.meshes.size(); ++mesh_index )
 			{
-				new_node = std::make_shared<MeshNode>(&loading_result->m_mesh_assets[node.meshIndex.value()]);
+				extract_mesh(mesh_index);
 			}
-			else
+		}
+		// MeshOptimizer, MeshLod, the meshlet builder and skinning all index the vertices without checking
+		for ( size_t mesh_index = 0; mesh_index < index_out_of_range.size(); ++mesh_index )
+		{
+			if ( index_out_of_range[mesh_index] )
 			{
-				//SPD log here
-				SPDLOG_ERROR("The given mesh node doesn't have a mesh asset associated with it.");
-				std::exit(EXIT_FAILURE); // or std::exit(1);
+				return std::unexpected(LoadError{ LoadError::Code::InvalidMesh, "Indices point past the vertices of their primitive in mesh " + loading_result->m_mesh_assets[mesh_index].name });
 			}
+		}
 
-			loading_result->m_scene_nodes.push_back(new_node);
-
-			std::visit
-			(
-				fastgltf::visitor
+		//> POST PROCESS
+		// meshes are independent from here on, reports are merged afterwards in mesh order so the totals don't depend on scheduling
+		if ( options.optimize_meshes || !options.lod_ratios.empty() || options.build_meshlets || options.vertex_layout.has_value() )
+		{
+			const size_t mesh_count = loading_result->m_mesh_assets.size();
+			std::vector<MeshOptimizationReport> optimization_reports(mesh_count);
+			std::vector<VertexQuantizationReport> quantization_reports(mesh_count);
+			// merged meshes have to share their streams, they get every attribute any of them has
+			uint32_t merged_attributes = 0;
+			for ( const LoadedMeshAsset& mesh_asset : loading_result->m_mesh_assets )
+			{
+				merged_attributes |= mesh_asset.present_attributes;
+			}
+			ThreadPool::Shared().ParallelFor(mesh_count, [&](const size_t mesh_index)
+			{
+				LoadedMeshAsset& mesh_asset = loading_result->m_mesh_assets[mesh_index];
+				if ( options.optimize_meshes )
 				{
-					[&](const fastgltf::math::fmat4x4& matrix)
-					{
-						memcpy(&new_node->local_transform, matrix.data(), sizeof(matrix));
-					},
+					optimization_reports[mesh_index] = MeshOptimizer::Optimize(mesh_asset);
+				}
+				if ( !options.lod_ratios.empty() )
+				{
+					MeshOptimizer::BuildLodChain(mesh_asset, options.lod_ratios);
+				}
+				if ( options.build_meshlets )
+				{
+					MeshOptimizer::BuildMeshlets(mesh_asset, options.meshlet_max_vertices, options.meshlet_max_triangles);
+				}
+				// packing drops the LoadedVertex array, it has to come last
+				if ( options.vertex_layout.has_value() )
+				{
+					quantization_reports[mesh_index] = PackVertexStreams(options.vertex_layout.value(), options.merge_mesh_buffers ? merged_attributes : mesh_asset.present_attributes, mesh_asset);
+				}
+			});
 
-					[&](const fastgltf::TRS& transform)
-					{
-						const glm::vec3 tl(
-							transform.translation[0],
-							transform.translation[1],
-							transform.translation[2]);
-						const glm::quat rot(
-							transform.rotation[3],
-							transform.rotation[0],
-							transform.rotation[1],
-							transform.rotation[2]);
-						const glm::vec3 sc(
-							transform.scale[0],
-							transform.scale[1],
-							transform.scale[2]);
+			for ( size_t mesh_index = 0; mesh_index < mesh_count; ++mesh_index )
+			{
+				loading_result->m_optimization_report.Merge(optimization_reports[mesh_index]);
+				loading_result->m_quantization_report.Merge(quantization_reports[mesh_index]);
+			}
+		}
+		if ( LoadResult<void> result = SetMeshBufferRanges(options, loading_result); !result )
+		{
+			return result;
+		}
 
-						const glm::mat4 tm = translate(glm::mat4(1.f), tl);
-						const glm::mat4 rm = mat4_cast(rot);
-						const glm::mat4 sm = scale(glm::mat4(1.f), sc);
-						new_node->local_transform = tm * rm * sm;
-					}
-				},
-				node.transform
-			);
+		if ( options.optimize_meshes )
+		{
+			const MeshOptimizationReport& report = loading_result->m_optimization_report;
+			SPDLOG_INFO("Optimized {} triangles: vertices {} -> {}, ACMR {:.3f} -> {:.3f}",
+						report.triangle_count, report.vertex_count_before, report.vertex_count_after, report.GetAcmrBefore(), report.GetAcmrAfter());
 		}
-	}
 
+		if ( options.vertex_layout.has_value() && options.vertex_layout->quantization.IsEnabled() )
+		{
+			const VertexQuantizationReport& report = loading_result->m_quantization_report;
+			SPDLOG_INFO("Quantized {} vertices: {} -> {} bytes, max error position {}, normal {} deg, tangent {} deg, uv {}, color {}, weight {}",
+						report.vertex_count, report.float_bytes, report.packed_bytes, report.max_position_error,
+						report.max_normal_error_degrees, report.max_tangent_error_degrees, report.max_uv_error, report.max_color_error, report.max_weight_error);
+		}
+		return {};
+	}
 
-	void LoadedModel::Factory::LoadSceneGraph(const fastgltf::Asset& gltf_asset, std::unique_ptr<LoadedModel>& loading_result)
+	VertexQuantizationReport LoadedModel::Factory::PackVertexStreams(const VertexLayout& layout, const uint32_t packed_attributes, LoadedMeshAsset& mesh_asset)
 	{
-		//> LOAD_SCENE_GRAPH
-		// run loop again to setup scene graph hierarchy and refresh transform
-		for ( auto [node_index, node_from_gltf] : std::ranges::views::enumerate(gltf_asset.nodes) )
-		{
-			const std::shared_ptr<Node>& already_loaded_node = loading_result->m_scene_nodes[node_index];
+		const std::pmr::vector<LoadedVertex>& vertices = mesh_asset.buffer_in_one.vertices;
+		const std::pmr::vector<LoadedSkinVertex>& skin_vertices = mesh_asset.buffer_in_one.skin_vertices;
+		const VertexLayout::Quantization& quantization = layout.quantization;
 
-			for ( auto& c : node_from_gltf.children )
+		//> DEQUANTIZATION RANGES
+		LoadedMeshAsset::Dequantization dequantization{};
+		if ( !vertices.empty() && (quantization.positions || quantization.uvs == VertexLayout::Quantization::UvFormat::Unorm16) )
+		{
+			glm::vec3 position_min{ std::numeric_limits<float>::max() };
+			glm::vec3 position_max{ std::numeric_limits<float>::lowest() };
+			glm::vec2 uv_min{ std::numeric_limits<float>::max() };
+			glm::vec2 uv_max{ std::numeric_limits<float>::lowest() };
+			for ( const LoadedVertex& vertex : vertices )
 			{
-				already_loaded_node->children.push_back(loading_result->m_scene_nodes[c]);
-				loading_result->m_scene_nodes[c]->parent = already_loaded_node;
+				position_min = glm::min(position_min, vertex.position);
+				position_max = glm::max(position_max, vertex.position);
+				uv_min = glm::min(uv_min, vertex.uv);
+				uv_max = glm::max(uv_max, vertex.uv);
+			}
+			if ( quantization.positions )
+			{
+				dequantization.position_offset = position_min;
+				dequantization.position_scale = (position_max - position_min) / 65535.f;
+			}
+			if ( quantization.uvs == VertexLayout::Quantization::UvFormat::Unorm16 )
+			{
+				dequantization.uv_offset = uv_min;
+				dequantization.uv_scale = (uv_max - uv_min) / 65535.f;
 			}
 		}
+		mesh_asset.quantization = quantization;
+		mesh_asset.dequantization = dequantization;
 
-		// find the top nodes, with no parents
-		for ( auto& node : loading_result->m_scene_nodes )
+		const auto quantize_range = [](const float value, const float offset, const float scale) -> uint16_t
 		{
-			if ( !node->parent.lock() )
+			// a flat axis has scale 0, everything maps onto the offset
+			return scale > 0.f ? ToUnorm16((value - offset) / (scale * 65535.f)) : 0;
+		};
+
+		VertexQuantizationReport report{};
+		report.vertex_count = vertices.size();
+		report.float_bytes = vertices.size() * sizeof(LoadedVertex) + skin_vertices.size() * sizeof(LoadedSkinVertex);
+
+		mesh_asset.buffer_in_one.streams.clear();
+		for ( uint32_t stream_index = 0; stream_index < layout.stream_count; ++stream_index )
+		{
+			// attributes the source doesn't have are dropped instead of being filled with defaults, unless every mesh must look the same
+			const uint32_t attributes = layout.stream_attributes[stream_index] & packed_attributes;
+			if ( !attributes )
 			{
-				loading_result->m_top_nodes.push_back(node);
-				node->RefreshTransform(glm::mat4{ 1.f });
+				continue;
 			}
-		}
-		//< load_scene_graph
-	}
-}
 
+			LoadedMeshAsset::VertexStream stream;
+			stream.attributes = attributes;
+			stream.stride = layout.GetStride(attributes);
+			stream.data.resize(static_cast<size_t>(stream.stride) * vertices.size());
 
-Anni::ModelLoader::LoadedImage::LoadedImage(std::string file_name_) :
-	file_name(std::move(file_name_))
-{
-}
+			// one pass per attribute keeps the inner loop a fixed size strided write
+			const auto pack_attribute = [&](const VertexLayout::AttributeBits attribute, auto encode)
+			{
+				if ( !(attributes & attribute) )
+				{
+					return;
+				}
+				uint8_t* destination = stream.data.data() + layout.GetAttributeOffset(attributes, attribute);
+				for ( const LoadedVertex& vertex : vertices )
+				{
+					encode(vertex, destination);
+					destination += stream.stride;
+				}
+			};
+			// a mesh without skin vertices keeps the zeros resize wrote, like an unskinned primitive
+			const auto pack_skin_attribute = [&](const VertexLayout::AttributeBits attribute, auto encode)
+			{
+				if ( !(attributes & attribute) )
+				{
+					return;
+				}
+				uint8_t* destination = stream.data.data() + layout.GetAttributeOffset(attributes, attribute);
+				for ( const LoadedSkinVertex& skin_vertex : skin_vertices )
+				{
+					encode(skin_vertex, destination);
+					destination += stream.stride;
+				}
+			};
 
-Anni::ModelLoader::Node::Node() : IRenderable(), local_transform(), world_transform()
+			pack_attribute(VertexLayout::Position, [&](const LoadedVertex& vertex, uint8_t* destination)
+			{
+				if ( !quantization.positions )
+				{
+					memcpy(destination, &vertex.position, sizeof(vertex.position));
+					return;
+				}
+				const std::array<uint16_t, 4> packed{
+					quantize_range(vertex.position.x, dequantization.position_offset.x, dequantization.position_scale.x),
+					quantize_range(vertex.position.y, dequantization.position_offset.y, dequantization.position_scale.y),
+					quantize_range(vertex.position.z, dequantization.position_offset.z, dequantization.position_scale.z),
+					0 };
+				memcpy(destination, packed.data(), sizeof(packed));
+
+				const glm::vec3 decoded = glm::vec3(packed[0], packed[1], packed[2]) * dequantization.position_scale + dequantization.position_offset;
+				report.max_position_error = std::max(report.max_position_error, glm::compMax(glm::abs(decoded - vertex.position)));
+			});
+
+			pack_attribute(VertexLayout::Normal, [&](const LoadedVertex& vertex, uint8_t* destination)
+			{
+				if ( !quantization.octahedral_normals )
+				{
+					memcpy(destination, &vertex.normal, sizeof(vertex.normal));
+					return;
+				}
+				const glm::vec2 encoded = OctahedralEncode(vertex.normal);
+				const std::array<int16_t, 2> packed{ ToSnorm16(encoded.x), ToSnorm16(encoded.y) };
+				memcpy(destination, packed.data(), sizeof(packed));
+
+				const glm::vec3 decoded = OctahedralDecode({ FromSnorm16(packed[0]), FromSnorm16(packed[1]) });
+				report.max_normal_error_degrees = std::max(report.max_normal_error_degrees, AngleDegrees(decoded, vertex.normal));
+			});
+
+			pack_attribute(VertexLayout::Tangent, [&](const LoadedVertex& vertex, uint8_t* destination)
+			{
+				if ( !quantization.octahedral_normals )
+				{
+					memcpy(destination, &vertex.tangent, sizeof(vertex.tangent));
+					return;
+				}
+				const glm::vec3 tangent{ vertex.tangent.x, vertex.tangent.y, vertex.tangent.z };
+				const glm::vec2 encoded = OctahedralEncode(tangent);
+				std::array<int16_t, 2> packed{ ToSnorm16(encoded.x), ToSnorm16(encoded.y) };
+				// handedness goes into the lowest bit, costs one bit of precision on y
+				const uint16_t y_bits = static_cast<uint16_t>((static_cast<uint16_t>(packed[1]) & ~1u) | (vertex.tangent.w < 0.f ? 1u : 0u));
+				packed[1] = static_cast<int16_t>(y_bits);
+				memcpy(destination, packed.data(), sizeof(packed));
+
+				const glm::vec3 decoded = OctahedralDecode({ FromSnorm16(packed[0]), FromSnorm16(packed[1]) });
+				report.max_tangent_error_degrees = std::max(report.max_tangent_error_degrees, AngleDegrees(decoded, tangent));
+			});
+
+			pack_attribute(VertexLayout::Uv, [&](const LoadedVertex& vertex, uint8_t* destination)
+			{
+				glm::vec2 decoded{};
+				switch ( quantization.uvs )
+				{
+					case VertexLayout::Quantization::UvFormat::Float:
+						memcpy(destination, &vertex.uv, sizeof(vertex.uv));
+						return;
+					case VertexLayout::Quantization::UvFormat::Half:
+					{
+						const std::array<uint16_t, 2> packed{ glm::packHalf1x16(vertex.uv.x), glm::packHalf1x16(vertex.uv.y) };
+						memcpy(destination, packed.data(), sizeof(packed));
+						decoded = { glm::unpackHalf1x16(packed[0]), glm::unpackHalf1x16(packed[1]) };
+						break;
+					}
+					case VertexLayout::Quantization::UvFormat::Unorm16:
+					{
+						const std::array<uint16_t, 2> packed{
+							quantize_range(vertex.uv.x, dequantization.uv_offset.x, dequantization.uv_scale.x),
+							quantize_range(vertex.uv.y, dequantization.uv_offset.y, dequantization.uv_scale.y) };
+						memcpy(destination, packed.data(), sizeof(packed));
+						decoded = glm::vec2(packed[0], packed[1]) * dequantization.uv_scale + dequantization.uv_offset;
+						break;
+					}
+				}
+				report.max_uv_error = std::max(report.max_uv_error, glm::compMax(glm::abs(decoded - vertex.uv)));
+			});
+
+			pack_attribute(VertexLayout::Color, [&](const LoadedVertex& vertex, uint8_t* destination)
+			{
+				if ( !quantization.unorm8_colors )
+				{
+					memcpy(destination, &vertex.color, sizeof(vertex.color));
+					return;
+				}
+				const std::array<uint8_t, 4> packed{ ToUnorm8(vertex.color.r), ToUnorm8(vertex.color.g), ToUnorm8(vertex.color.b), ToUnorm8(vertex.color.a) };
+				memcpy(destination, packed.data(), sizeof(packed));
+
+				const glm::vec4 decoded = glm::vec4(packed[0], packed[1], packed[2], packed[3]) / 255.f;
+				report.max_color_error = std::max(report.max_color_error, glm::compMax(glm::abs(decoded - vertex.color)));
+			});
+
+			pack_skin_attribute(VertexLayout::Joints, [&](const LoadedSkinVertex& skin_vertex, uint8_t* destination)
+			{
+				memcpy(destination, skin_vertex.joints.data(), sizeof(skin_vertex.joints));
+			});
+
+			pack_skin_attribute(VertexLayout::Weights, [&](const LoadedSkinVertex& skin_vertex, uint8_t* destination)
+			{
+				if ( !quantization.unorm16_weights )
+				{
+					memcpy(destination, &skin_vertex.weights, sizeof(skin_vertex.weights));
+					return;
+				}
+				std::array<uint16_t, 4> packed{ ToUnorm16(skin_vertex.weights.x), ToUnorm16(skin_vertex.weights.y), ToUnorm16(skin_vertex.weights.z), ToUnorm16(skin_vertex.weights.w) };
+				// the rounding error goes to the largest weight, where it matters least
+				const int32_t packed_sum = packed[0] + packed[1] + packed[2] + packed[3];
+				if ( packed_sum > 0 )
+				{
+					const auto largest = std::ranges::max_element(packed);
+					*largest = static_cast<uint16_t>(std::clamp<int32_t>(*largest + 65535 - packed_sum, 0, 65535));
+				}
+				memcpy(destination, packed.data(), sizeof(packed));
+
+				const glm::vec4 decoded = glm::vec4(packed[0], packed[1], packed[2], packed[3]) / 65535.f;
+				report.max_weight_error = std::max(report.max_weight_error, glm::compMax(glm::abs(decoded - skin_vertex.weights)));
+			});
+
+			report.packed_bytes += stream.data.size();
+			mesh_asset.buffer_in_one.streams.push_back(std::move(stream));
+		}
+
+		// the interleaved copy is what the layout is meant to save
+		mesh_asset.buffer_in_one.vertices.clear();
+		mesh_asset.buffer_in_one.vertices.shrink_to_fit();
+		mesh_asset.buffer_in_one.skin_vertices.clear();
+		mesh_asset.buffer_in_one.skin_vertices.shrink_to_fit();
+		return report;
+	}
+
+	LoadResult<void> LoadedModel::Factory::SetMeshBufferRanges(const LoadOptions& options, std::unique_ptr<LoadedModel>& loading_result)
+	{
+		for ( LoadedMeshAsset& mesh_asset : loading_result->m_mesh_assets )
+		{
+			mesh_asset.first_index = 0;
+			mesh_asset.index_count = static_cast<uint32_t>(mesh_asset.buffer_in_one.indices.size());
+			mesh_asset.vertex_offset = 0;
+			mesh_asset.vertex_count = static_cast<uint32_t>(mesh_asset.buffer_in_one.GetVertexCount());
+		}
+		if ( !options.merge_mesh_buffers || loading_result->m_mesh_assets.empty() )
+		{
+			return {};
+		}
+
+		// every mesh starts on a multiple of step elements, which puts its byte offset on the alignment in every array at once
+		const size_t alignment = std::bit_ceil(std::max(options.merged_buffer_alignment, 1u));
+		const auto element_step = [alignment](const size_t stride) -> size_t
+		{
+			return alignment / std::gcd(alignment, stride);
+		};
+		const auto align_up = [](const size_t count, const size_t step) -> size_t
+		{
+			return (count + step - 1) / step * step;
+		};
+
+		// streams are packed with every attribute when merging, so any mesh tells the layout
+		const std::vector<LoadedMeshAsset::VertexStream>& stream_layout = loading_result->m_mesh_assets.front().buffer_in_one.streams;
+		const bool interleaved = stream_layout.empty();
+		const bool any_skinned = std::ranges::any_of(loading_result->m_mesh_assets, [](const LoadedMeshAsset& mesh_asset) { return !mesh_asset.buffer_in_one.skin_vertices.empty(); });
+		size_t vertex_step = interleaved ? element_step(sizeof(LoadedVertex)) : 1;
+		if ( interleaved && any_skinned )
+		{
+			vertex_step = std::lcm(vertex_step, element_step(sizeof(LoadedSkinVertex)));
+		}
+		for ( const auto& stream : stream_layout )
+		{
+			vertex_step = std::lcm(vertex_step, element_step(stream.stride));
+		}
+		const size_t index_step = element_step(sizeof(uint32_t));
+
+		size_t index_total = 0;
+		size_t vertex_total = 0;
+		for ( LoadedMeshAsset& mesh_asset : loading_result->m_mesh_assets )
+		{
+			const auto& streams = mesh_asset.buffer_in_one.streams;
+			if ( streams.size() != stream_layout.size() ||
+				!std::ranges::equal(streams, stream_layout, [](const auto& lhs, const auto& rhs) { return lhs.attributes == rhs.attributes && lhs.stride == rhs.stride; }) )
+			{
+				return std::unexpected(LoadError{ LoadError::Code::InvalidMesh, "Meshes with different vertex streams can't share a merged buffer." });
+			}
+
+			index_total = align_up(index_total, index_step);
+			vertex_total = align_up(vertex_total, vertex_step);
+			mesh_asset.first_index = static_cast<uint32_t>(index_total);
+			mesh_asset.vertex_offset = static_cast<int32_t>(vertex_total);
+			index_total += mesh_asset.index_count;
+			vertex_total += mesh_asset.vertex_count;
+		}
+		if ( index_total > std::numeric_limits<uint32_t>::max() || vertex_total > static_cast<size_t>(std::numeric_limits<int32_t>::max()) )
+		{
+			return std::unexpected(LoadError{ LoadError::Code::InvalidMesh, "The merged buffer is too large for 32 bit draw offsets." });
+		}
+
+		// sized once, the padding between meshes is zeroed
+		LoadedMeshAsset::MeshBuffer& merged_buffer = loading_result->m_merged_buffer;
+		merged_buffer.indices.assign(index_total, 0);
+		merged_buffer.vertices.assign(interleaved ? vertex_total : 0, LoadedVertex{});
+		// unskinned meshes get zero weights in the merged skin array
+		merged_buffer.skin_vertices.assign(interleaved && any_skinned ? vertex_total : 0, LoadedSkinVertex{});
+		merged_buffer.streams.clear();
+		for ( const auto& stream : stream_layout )
+		{
+			merged_buffer.streams.push_back({ stream.attributes, stream.stride, std::vector<uint8_t>(vertex_total * stream.stride, 0) });
+		}
+
+		for ( LoadedMeshAsset& mesh_asset : loading_result->m_mesh_assets )
+		{
+			LoadedMeshAsset::MeshBuffer& mesh_buffer = mesh_asset.buffer_in_one;
+			std::ranges::copy(mesh_buffer.indices, merged_buffer.indices.begin() + mesh_asset.first_index);
+			std::ranges::copy(mesh_buffer.vertices, merged_buffer.vertices.begin() + mesh_asset.vertex_offset);
+			std::ranges::copy(mesh_buffer.skin_vertices, merged_buffer.skin_vertices.begin() + mesh_asset.vertex_offset);
+			for ( auto [stream_index, stream] : std::ranges::views::enumerate(mesh_buffer.streams) )
+			{
+				std::ranges::copy(stream.data, merged_buffer.streams[stream_index].data.begin() + static_cast<size_t>(mesh_asset.vertex_offset) * stream.stride);
+			}
+			// cleared in place, the mesh's buffers keep their(default) memory resource
+			mesh_buffer.indices.clear();
+			mesh_buffer.indices.shrink_to_fit();
+			mesh_buffer.vertices.clear();
+			mesh_buffer.vertices.shrink_to_fit();
+			mesh_buffer.skin_vertices.clear();
+			mesh_buffer.skin_vertices.shrink_to_fit();
+			mesh_buffer.streams = {};
+		}
+		return {};
+	}
+
+	LoadResult<void> LoadedModel::Factory::LoadSceneNodes(const fastgltf::Asset& gltf_asset, std::unique_ptr<LoadedModel>& loading_result)
+	{
+		const size_t node_count = gltf_asset.nodes.size();
+		AnimationPose& rest_pose = loading_result->m_rest_pose;
+		rest_pose.translations.resize(node_count);
+		rest_pose.rotations.resize(node_count);
+		rest_pose.scales.resize(node_count);
+		rest_pose.first_morph_weights.reserve(node_count + 1);
+
+		// LOAD ALL NODES AND THEIR MESHES
+		for ( auto [node_index, node] : std::ranges::views::enumerate(gltf_asset.nodes) )
+		{
+			std::shared_ptr<Node> new_node;
+
+			// find if the node has a mesh_asset, and if it does then hook it to the mesh_asset
+			// pointer and allocate it with the meshnode class. nodes without one(e.g. skeleton joints) only carry a transform
+			if ( node.meshIndex.has_value() )
+			{
+				// the node and its control block share one allocation in the model's arena
+				if ( node.meshIndex.value() >= loading_result->m_mesh_assets.size() )
+				{
+					return std::unexpected(LoadError{ LoadError::Code::InvalidScene, "Node " + std::to_string(node_index) + " references a missing mesh." });
+				}
+				new_node = std::allocate_shared<MeshNode>(std::pmr::polymorphic_allocator<MeshNode>(&loading_result->m_arena), &loading_result->m_mesh_assets[node.meshIndex.value()]);
+			}
+			else
+			{
+				new_node = std::allocate_shared<Node>(std::pmr::polymorphic_allocator<Node>(&loading_result->m_arena));
+			}
+
+			if ( node.skinIndex.has_value() )
+			{
+				if ( node.skinIndex.value() >= gltf_asset.skins.size() )
+				{
+					return std::unexpected(LoadError{ LoadError::Code::InvalidScene, "Node " + std::to_string(node_index) + " references a missing skin." });
+				}
+				new_node->skin_index = static_cast<uint32_t>(node.skinIndex.value());
+			}
+
+			// the node's own weights override the defaults of its mesh
+			rest_pose.first_morph_weights.push_back(static_cast<uint32_t>(rest_pose.morph_weights.size()));
+			if ( !node.weights.empty() )
+			{
+				rest_pose.morph_weights.insert(rest_pose.morph_weights.end(), node.weights.begin(), node.weights.end());
+			}
+			else if ( node.meshIndex.has_value() )
+			{
+				const auto& mesh_weights = gltf_asset.meshes[node.meshIndex.value()].weights;
+				rest_pose.morph_weights.insert(rest_pose.morph_weights.end(), mesh_weights.begin(), mesh_weights.end());
+			}
+
+			loading_result->m_scene_nodes.push_back(new_node);
+
+			std::visit
+			(
+				fastgltf::visitor
+				{
+					[&](const fastgltf::math::fmat4x4& matrix)
+					{
+						memcpy(&new_node->local_transform, matrix.data(), sizeof(matrix));
+						DecomposeTransform(new_node->local_transform, rest_pose.translations[node_index], rest_pose.rotations[node_index], rest_pose.scales[node_index]);
+					},
+
+					[&](const fastgltf::TRS& transform)
+					{
+						const glm::vec3 tl(
+							transform.translation[0],
+							transform.translation[1],
+							transform.translation[2]);
+						const glm::quat rot(
+							transform.rotation[3],
+							transform.rotation[0],
+							transform.rotation[1],
+							transform.rotation[2]);
+						const glm::vec3 sc(
+							transform.scale[0],
+							transform.scale[1],
+							transform.scale[2]);
+
+						const glm::mat4 tm = translate(glm::mat4(1.f), tl);
+						const glm::mat4 rm = mat4_cast(rot);
+						const glm::mat4 sm = scale(glm::mat4(1.f), sc);
+						new_node->local_transform = tm * rm * sm;
+
+						rest_pose.translations[node_index] = tl;
+						rest_pose.rotations[node_index] = rot;
+						rest_pose.scales[node_index] = sc;
+					}
+				},
+				node.transform
+			);
+		}
+		rest_pose.first_morph_weights.push_back(static_cast<uint32_t>(rest_pose.morph_weights.size()));
+		return {};
+	}
+
+
+	LoadResult<void> LoadedModel::Factory::ValidateHierarchy(const size_t node_count, const std::span<const std::pair<size_t, size_t>> links)
+	{
+		// RefreshTransform and the flat scene expect a forest: every child exists and has exactly one parent, no cycles
+		std::vector<uint32_t> parent_indices(node_count, FlatScene::no_parent);
+		for ( const auto& [parent_index, child_index] : links )
+		{
+			if ( child_index >= node_count )
+			{
+				return std::unexpected(LoadError{ LoadError::Code::InvalidScene, "Node " + std::to_string(parent_index) + " references a missing child." });
+			}
+			if ( parent_indices[child_index] != FlatScene::no_parent )
+			{
+				return std::unexpected(LoadError{ LoadError::Code::InvalidScene, "Node " + std::to_string(child_index) + " has more than one parent." });
+			}
+			parent_indices[child_index] = static_cast<uint32_t>(parent_index);
+		}
+		// with one parent each, a node is on a cycle when walking up from it never reaches a root.
+		// 0 unvisited, 1 on the walk in progress, 2 known to reach a root
+		std::vector<uint8_t> walk_states(node_count, 0);
+		for ( size_t start = 0; start < node_count; ++start )
+		{
+			uint32_t current = static_cast<uint32_t>(start);
+			while ( current != FlatScene::no_parent && 0 == walk_states[current] )
+			{
+				walk_states[current] = 1;
+				current = parent_indices[current];
+			}
+			if ( current != FlatScene::no_parent && 1 == walk_states[current] )
+			{
+				return std::unexpected(LoadError{ LoadError::Code::InvalidScene, "Node " + std::to_string(current) + " is its own ancestor." });
+			}
+			for ( current = static_cast<uint32_t>(start); current != FlatScene::no_parent && 1 == walk_states[current]; current = parent_indices[current] )
+			{
+				walk_states[current] = 2;
+			}
+		}
+		return {};
+	}
+
+	LoadResult<void> LoadedModel::Factory::LoadSceneGraph(const fastgltf::Asset& gltf_asset, std::unique_ptr<LoadedModel>& loading_result)
+	{
+		//> VALIDATE HIERARCHY
+		std::vector<std::pair<size_t, size_t>> links;
+		for ( auto [node_index, node_from_gltf] : std::ranges::views::enumerate(gltf_asset.nodes) )
+		{
+			for ( const size_t child_index : node_from_gltf.children )
+			{
+				links.emplace_back(static_cast<size_t>(node_index), child_index);
+			}
+		}
+		if ( LoadResult<void> result = ValidateHierarchy(gltf_asset.nodes.size(), links); !result )
+		{
+			return result;
+		}
+
+		//> LOAD_SCENE_GRAPH
+		// run loop again to setup scene graph hierarchy and refresh transform
+		for ( auto [node_index, node_from_gltf] : std::ranges::views::enumerate(gltf_asset.nodes) )
+		{
+			const std::shared_ptr<Node>& already_loaded_node = loading_result->m_scene_nodes[node_index];
+
+			already_loaded_node->children.reserve(node_from_gltf.children.size());
+			for ( auto& c : node_from_gltf.children )
+			{
+				already_loaded_node->children.push_back(loading_result->m_scene_nodes[c]);
+				loading_result->m_scene_nodes[c]->parent = already_loaded_node;
+			}
+		}
+
+		// find the top nodes, with no parents
+		for ( auto& node : loading_result->m_scene_nodes )
+		{
+			if ( !node->parent.lock() )
+			{
+				loading_result->m_top_nodes.push_back(node);
+				node->RefreshTransform(glm::mat4{ 1.f });
+			}
+		}
+
+		BuildFlatScene(loading_result);
+		//< load_scene_graph
+		return {};
+	}
+
+	void LoadedModel::Factory::BuildFlatScene(std::unique_ptr<LoadedModel>& loading_result)
+	{
+		const size_t node_count = loading_result->m_scene_nodes.size();
+
+		std::unordered_map<const Node*, uint32_t> source_indices;
+		source_indices.reserve(node_count);
+		for ( auto [node_index, node] : std::ranges::views::enumerate(loading_result->m_scene_nodes) )
+		{
+			source_indices.emplace(node.get(), static_cast<uint32_t>(node_index));
+		}
+
+		FlatScene scene;
+		scene.local_transforms.reserve(node_count);
+		scene.parent_indices.reserve(node_count);
+		scene.subtree_sizes.reserve(node_count);
+		scene.mesh_indices.reserve(node_count);
+		scene.source_node_indices.reserve(node_count);
+		scene.skin_indices.reserve(node_count);
+		scene.local_bounds.reserve(node_count);
+
+		// depth first walk from every top node, children are pushed in reverse to keep their file order
+		struct PendingNode
+		{
+			const Node* node;
+			uint32_t parent_index;
+		};
+		std::vector<PendingNode> pending;
+		for ( const auto& top_node : loading_result->m_top_nodes )
+		{
+			pending.push_back({ top_node.get(), FlatScene::no_parent });
+			while ( !pending.empty() )
+			{
+				const PendingNode current = pending.back();
+				pending.pop_back();
+
+				const auto flat_index = static_cast<uint32_t>(scene.local_transforms.size());
+				scene.local_transforms.push_back(current.node->local_transform);
+				scene.parent_indices.push_back(current.parent_index);
+				scene.subtree_sizes.push_back(1);
+				scene.source_node_indices.push_back(source_indices.at(current.node));
+
+				uint32_t mesh_index = FlatScene::no_mesh;
+				if ( const auto* mesh_node = dynamic_cast<const MeshNode*>(current.node) )
+				{
+					mesh_index = static_cast<uint32_t>(mesh_node->GetMeshAsset() - loading_result->m_mesh_assets.data());
+				}
+				scene.mesh_indices.push_back(mesh_index);
+				scene.skin_indices.push_back(current.node->skin_index.value_or(FlatScene::no_skin));
+				scene.local_bounds.push_back(current.node->GetLocalBounds());
+
+				for ( const auto& child : std::ranges::views::reverse(current.node->children) )
+				{
+					pending.push_back({ child.get(), flat_index });
+				}
+			}
+		}
+
+		// accumulate subtree sizes bottom up, children always sit after their parent
+		for ( size_t i = scene.parent_indices.size(); i-- > 0; )
+		{
+			if ( scene.parent_indices[i] != FlatScene::no_parent )
+			{
+				scene.subtree_sizes[scene.parent_indices[i]] += scene.subtree_sizes[i];
+			}
+		}
+
+		scene.flat_node_indices.resize(node_count);
+		for ( auto [flat_index, source_index] : std::ranges::views::enumerate(scene.source_node_indices) )
+		{
+			scene.flat_node_indices[source_index] = static_cast<uint32_t>(flat_index);
+		}
+
+		scene.UpdateWorldTransforms();
+		loading_result->m_scene = std::move(scene);
+	}
+}
+
+
+Anni::ModelLoader::LoadedImage::LoadedImage(std::string file_name_) :
+	file_name(std::move(file_name_))
+{
+}
+
+std::span<const uint8_t> Anni::ModelLoader::LoadedImage::GetData() const
+{
+	if ( external_owner )
+	{
+		return external_data;
+	}
+	return raw_data;
+}
+
+void Anni::ModelLoader::VertexQuantizationReport::Merge(const VertexQuantizationReport& other)
+{
+	vertex_count += other.vertex_count;
+	float_bytes += other.float_bytes;
+	packed_bytes += other.packed_bytes;
+	max_position_error = std::max(max_position_error, other.max_position_error);
+	max_normal_error_degrees = std::max(max_normal_error_degrees, other.max_normal_error_degrees);
+	max_tangent_error_degrees = std::max(max_tangent_error_degrees, other.max_tangent_error_degrees);
+	max_uv_error = std::max(max_uv_error, other.max_uv_error);
+	max_color_error = std::max(max_color_error, other.max_color_error);
+	max_weight_error = std::max(max_weight_error, other.max_weight_error);
+}
+
+Anni::ModelLoader::LoadedMeshAsset::MeshBuffer::MeshBuffer(std::pmr::memory_resource* index_resource, std::pmr::memory_resource* vertex_resource) :
+	indices(index_resource),
+	vertices(vertex_resource),
+	skin_vertices(vertex_resource)
+{
+}
+
+Anni::ModelLoader::LoadedMeshAsset::LoadedMeshAsset(std::pmr::memory_resource* resource, std::pmr::memory_resource* index_resource, std::pmr::memory_resource* vertex_resource) :
+	homo_mat_tris_array(resource),
+	buffer_in_one(index_resource ? index_resource : resource, vertex_resource ? vertex_resource : resource)
+{
+}
+
+size_t Anni::ModelLoader::LoadedMeshAsset::MeshBuffer::GetVertexCount() const
+{
+	if ( !streams.empty() )
+	{
+		return streams.front().stride ? streams.front().data.size() / streams.front().stride : 0;
+	}
+	return vertices.size();
+}
+
+bool Anni::ModelLoader::BoundingBox::IsValid() const
+{
+	return min.x <= max.x && min.y <= max.y && min.z <= max.z;
+}
+
+glm::vec3 Anni::ModelLoader::BoundingBox::GetCenter() const
+{
+	return (min + max) * 0.5f;
+}
+
+glm::vec3 Anni::ModelLoader::BoundingBox::GetExtent() const
+{
+	return (max - min) * 0.5f;
+}
+
+void Anni::ModelLoader::BoundingBox::Merge(const BoundingBox& other)
+{
+	min = glm::min(min, other.min);
+	max = glm::max(max, other.max);
+}
+
+Anni::ModelLoader::BoundingBox Anni::ModelLoader::BoundingBox::Transform(const glm::mat4& matrix) const
+{
+	if ( !IsValid() )
+	{
+		return {};
+	}
+
+	// the transformed extent along each world axis is the sum of the extents projected by the absolute basis vectors
+	const glm::vec3 center = glm::vec3(matrix * glm::vec4(GetCenter(), 1.f));
+	const glm::vec3 extent = GetExtent();
+	const glm::vec3 transformed_extent =
+		glm::abs(glm::vec3(matrix[0])) * extent.x +
+		glm::abs(glm::vec3(matrix[1])) * extent.y +
+		glm::abs(glm::vec3(matrix[2])) * extent.z;
+
+	BoundingBox result;
+	result.min = center - transformed_extent;
+	result.max = center + transformed_extent;
+	return result;
+}
+
+Anni::ModelLoader::Frustum Anni::ModelLoader::Frustum::FromMatrix(const glm::mat4& clip_matrix)
+{
+	// glm is column major, row i of the matrix is the i-th component of every column
+	const auto row = [&clip_matrix](const int i)
+	{
+		return glm::vec4(clip_matrix[0][i], clip_matrix[1][i], clip_matrix[2][i], clip_matrix[3][i]);
+	};
+
+	Frustum frustum{};
+	frustum.planes[0] = row(3) + row(0);
+	frustum.planes[1] = row(3) - row(0);
+	frustum.planes[2] = row(3) + row(1);
+	frustum.planes[3] = row(3) - row(1);
+	frustum.planes[4] = row(2);
+	frustum.planes[5] = row(3) - row(2);
+
+	for ( auto& plane : frustum.planes )
+	{
+		plane /= glm::length(glm::vec3(plane));
+	}
+	return frustum;
+}
+
+bool Anni::ModelLoader::Frustum::Intersects(const BoundingBox& box) const
+{
+	if ( !box.IsValid() )
+	{
+		return false;
+	}
+
+	const glm::vec3 center = box.GetCenter();
+	const glm::vec3 extent = box.GetExtent();
+	for ( const auto& plane : planes )
+	{
+		// the box is outside once even its corner furthest along the plane normal is behind the plane
+		const glm::vec3 normal{ plane };
+		if ( glm::dot(normal, center) + plane.w + glm::dot(extent, glm::abs(normal)) < 0.f )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Anni::ModelLoader::Frustum::Intersects(const BoundingSphere& sphere) const
+{
+	for ( const auto& plane : planes )
+	{
+		if ( glm::dot(glm::vec3(plane), sphere.center) + plane.w < -sphere.radius )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+Anni::ModelLoader::DrawList::SortKey Anni::ModelLoader::DrawList::MakeSortKey(const LoadedMaterialConstant::AlphaMode alpha_mode, const std::optional<uint32_t>& material_index, const uint32_t mesh_index, const uint32_t homo_mat_tris_index)
+{
+	// opaque < mask < blend, so the blended draws come last
+	uint64_t alpha_bits = 0;
+	switch ( alpha_mode )
+	{
+		case LoadedMaterialConstant::AlphaMode::Opaque:
+			alpha_bits = 0;
+			break;
+		case LoadedMaterialConstant::AlphaMode::Mask:
+			alpha_bits = 1;
+			break;
+		case LoadedMaterialConstant::AlphaMode::Blend:
+			alpha_bits = 2;
+			break;
+	}
+	// draws without a material sort after every material of the same alpha mode
+	const uint64_t material_bits = material_index.has_value() ? material_index.value() : no_material_key;
+
+	SortKey sort_key;
+	sort_key.state = alpha_bits << alpha_key_shift | material_bits;
+	sort_key.draw = static_cast<uint64_t>(mesh_index) << mesh_key_shift | homo_mat_tris_index;
+	return sort_key;
+}
+
+uint32_t Anni::ModelLoader::DrawList::GetHomoMatTrisIndex(const SortKey& sort_key)
+{
+	return static_cast<uint32_t>(sort_key.draw & homo_mat_tris_key_mask);
+}
+
+void Anni::ModelLoader::DrawList::Clear()
+{
+	// keep the capacity, the list is meant to be rebuilt every frame
+	commands.clear();
+	batches.clear();
+	instance_transforms.clear();
+	m_items.clear();
+}
+
+size_t Anni::ModelLoader::FlatScene::GetNodeCount() const
+{
+	return local_transforms.size();
+}
+
+void Anni::ModelLoader::FlatScene::UpdateWorldTransforms(const glm::mat4& root_matrix)
+{
+	const size_t node_count = local_transforms.size();
+	world_transforms.resize(node_count);
+	world_bounds.resize(node_count);
+	subtree_bounds.resize(node_count);
+	for ( size_t i = 0; i < node_count; ++i )
+	{
+		const uint32_t parent_index = parent_indices[i];
+		const glm::mat4& parent_matrix = parent_index == no_parent ? root_matrix : world_transforms[parent_index];
+		world_transforms[i] = MultiplyTransforms(parent_matrix, local_transforms[i]);
+		world_bounds[i] = local_bounds[i].Transform(world_transforms[i]);
+		subtree_bounds[i] = world_bounds[i];
+	}
+
+	for ( size_t i = node_count; i-- > 0; )
+	{
+		if ( parent_indices[i] != no_parent )
+		{
+			subtree_bounds[parent_indices[i]].Merge(subtree_bounds[i]);
+		}
+	}
+
+	root_transform = root_matrix;
+	for ( const uint32_t node_index : dirty_nodes )
+	{
+		dirty_flags[node_index] = 0;
+	}
+	dirty_nodes.clear();
+}
+
+void Anni::ModelLoader::FlatScene::SetLocalTransform(const uint32_t node_index, const glm::mat4& transform)
+{
+	local_transforms[node_index] = transform;
+	dirty_flags.resize(local_transforms.size(), 0);
+	if ( !dirty_flags[node_index] )
+	{
+		dirty_flags[node_index] = 1;
+		dirty_nodes.push_back(node_index);
+	}
+}
+
+size_t Anni::ModelLoader::FlatScene::UpdateDirtyTransforms()
+{
+	if ( dirty_nodes.empty() )
+	{
+		return 0;
+	}
+
+	// in index order a subtree's range starts at its root, so every dirty node inside an updated range is skipped
+	std::ranges::sort(dirty_nodes);
+	size_t touched_count = 0;
+	size_t covered_end = 0;
+	std::vector<uint32_t> ancestors;
+	for ( const uint32_t dirty_index : dirty_nodes )
+	{
+		dirty_flags[dirty_index] = 0;
+		if ( dirty_index < covered_end )
+		{
+			continue;
+		}
+
+		const size_t range_begin = dirty_index;
+		const size_t range_end = range_begin + subtree_sizes[range_begin];
+		for ( size_t i = range_begin; i < range_end; ++i )
+		{
+			const uint32_t parent_index = parent_indices[i];
+			const glm::mat4& parent_matrix = parent_index == no_parent ? root_transform : world_transforms[parent_index];
+			world_transforms[i] = MultiplyTransforms(parent_matrix, local_transforms[i]);
+			world_bounds[i] = local_bounds[i].Transform(world_transforms[i]);
+			subtree_bounds[i] = world_bounds[i];
+		}
+		for ( size_t i = range_end; i-- > range_begin + 1; )
+		{
+			subtree_bounds[parent_indices[i]].Merge(subtree_bounds[i]);
+		}
+
+		touched_count += range_end - range_begin;
+		covered_end = range_end;
+		if ( parent_indices[range_begin] != no_parent )
+		{
+			ancestors.push_back(parent_indices[range_begin]);
+		}
+	}
+	dirty_nodes.clear();
+
+	// children come after their parents, so going from the highest index down every ancestor sees its children's final bounds.
+	// only the direct children are merged, stepping from one to the next by subtree size
+	std::ranges::sort(ancestors, std::greater{});
+	ancestors.erase(std::ranges::unique(ancestors).begin(), ancestors.end());
+	for ( size_t a = 0; a < ancestors.size(); ++a )
+	{
+		const uint32_t node_index = ancestors[a];
+		subtree_bounds[node_index] = world_bounds[node_index];
+		const size_t subtree_end = node_index + subtree_sizes[node_index];
+		for ( size_t child = node_index + 1; child < subtree_end; child += subtree_sizes[child] )
+		{
+			subtree_bounds[node_index].Merge(subtree_bounds[child]);
+		}
+
+		if ( parent_indices[node_index] != no_parent )
+		{
+			const uint32_t parent_index = parent_indices[node_index];
+			const auto position = std::lower_bound(ancestors.begin() + a + 1, ancestors.end(), parent_index, std::greater{});
+			if ( position == ancestors.end() || *position != parent_index )
+			{
+				ancestors.insert(position, parent_index);
+			}
+		}
+	}
+
+	return touched_count;
+}
+
+void Anni::ModelLoader::FlatScene::PreDrawToContext(const glm::mat4& top_matrix, const std::vector<LoadedMeshAsset>& mesh_assets, DrawContext& ctx, const Frustum* const frustum, const LodSelection* const lod_selection) const
+{
+	size_t record_count = 0;
+	for ( const uint32_t mesh_index : mesh_indices )
+	{
+		record_count += mesh_index == no_mesh ? 0 : mesh_assets[mesh_index].homo_mat_tris_array.size();
+	}
+	ctx.homo_mat_tris_record.reserve(ctx.homo_mat_tris_record.size() + record_count);
+
+	for ( size_t i = 0; i < mesh_indices.size(); )
+	{
+		if ( frustum && !frustum->Intersects(subtree_bounds[i]) )
+		{
+			i += subtree_sizes[i];
+			continue;
+		}
+
+		const size_t node_index = i++;
+		if ( mesh_indices[node_index] == no_mesh || (frustum && !frustum->Intersects(world_bounds[node_index])) )
+		{
+			continue;
+		}
+
+		const LoadedMeshAsset& mesh_asset = mesh_assets[mesh_indices[node_index]];
+		const uint32_t lod_level = lod_selection ? lod_selection->SelectLevel(mesh_asset, world_transforms[node_index]) : 0;
+		const glm::mat4 node_matrix = MultiplyTransforms(top_matrix, world_transforms[node_index]);
+		for ( const auto& homo_mat_tris : mesh_asset.GetLodHomoMatTris(lod_level) )
+		{
+			if ( frustum && !frustum->Intersects(homo_mat_tris.bounds.Transform(world_transforms[node_index])) )
+			{
+				continue;
+			}
+
+			RenderRecord def;
+			def.index_count = homo_mat_tris.count;
+			def.first_index = mesh_asset.first_index + homo_mat_tris.start_index;
+			def.vertex_offset = mesh_asset.vertex_offset;
+			def.material_index = homo_mat_tris.material_index;
+			def.final_transform = node_matrix;
+
+			ctx.homo_mat_tris_record.push_back(def);
+		}
+	}
+}
+
+Anni::ModelLoader::Node::Node() : IRenderable(), local_transform(), world_transform()
 {
 }
 
 void Anni::ModelLoader::Node::RefreshTransform(const glm::mat4& parent_matrix)
 {
 	world_transform = parent_matrix * local_transform;
+	world_bounds = GetLocalBounds().Transform(world_transform);
+	subtree_bounds = world_bounds;
 	for ( const auto& c : children )
 	{
 		c->RefreshTransform(world_transform);
+		subtree_bounds.Merge(c->subtree_bounds);
 	}
 }
 
+Anni::ModelLoader::BoundingBox Anni::ModelLoader::Node::GetLocalBounds() const
+{
+	return {};
+}
+
 void Anni::ModelLoader::Node::PreDrawToContext(const glm::mat4& top_matrix, DrawContext& ctx)
 {
 	// draw children
@@ -528,12 +2344,35 @@ void Anni::ModelLoader::Node::PreDrawToContext(const glm::mat4& top_matrix, Draw
 	}
 }
 
+void Anni::ModelLoader::Node::PreDrawToContext(const glm::mat4& top_matrix, const Frustum& frustum, DrawContext& ctx)
+{
+	if ( !frustum.Intersects(subtree_bounds) )
+	{
+		return;
+	}
+
+	for ( const auto& c : children )
+	{
+		c->PreDrawToContext(top_matrix, frustum, ctx);
+	}
+}
+
 Anni::ModelLoader::MeshNode::MeshNode(const LoadedMeshAsset* const mesh_asset_) :
 	Node(),
 	mesh_asset(mesh_asset_)
 {
 }
 
+const Anni::ModelLoader::LoadedMeshAsset* Anni::ModelLoader::MeshNode::GetMeshAsset() const
+{
+	return mesh_asset;
+}
+
+Anni::ModelLoader::BoundingBox Anni::ModelLoader::MeshNode::GetLocalBounds() const
+{
+	return mesh_asset->bounds;
+}
+
 void Anni::ModelLoader::MeshNode::PreDrawToContext(const glm::mat4& top_matrix, DrawContext& ctx)
 {
 	const glm::mat4 node_matrix = top_matrix * world_transform;
@@ -541,7 +2380,8 @@ void Anni::ModelLoader::MeshNode::PreDrawToContext(const glm::mat4& top_matrix,
 	{
 		RenderRecord def;
 		def.index_count = homo_mat_tris.count;
-		def.first_index = homo_mat_tris.start_index;
+		def.first_index = mesh_asset->first_index + homo_mat_tris.start_index;
+		def.vertex_offset = mesh_asset->vertex_offset;
 		def.material_index = homo_mat_tris.material_index;
 		def.final_transform = node_matrix;
 
@@ -552,32 +2392,422 @@ void Anni::ModelLoader::MeshNode::PreDrawToContext(const glm::mat4& top_matrix,
 	Node::PreDrawToContext(top_matrix, ctx);
 }
 
-Anni::ModelLoader::LoadedModel::LoadedModel(std::filesystem::path file_path) : m_file_path(std::move(file_path))
+void Anni::ModelLoader::MeshNode::PreDrawToContext(const glm::mat4& top_matrix, const Frustum& frustum, DrawContext& ctx)
+{
+	if ( !frustum.Intersects(subtree_bounds) )
+	{
+		return;
+	}
+
+	if ( frustum.Intersects(world_bounds) )
+	{
+		const glm::mat4 node_matrix = top_matrix * world_transform;
+		for ( auto& homo_mat_tris : mesh_asset->homo_mat_tris_array )
+		{
+			if ( !frustum.Intersects(homo_mat_tris.bounds.Transform(world_transform)) )
+			{
+				continue;
+			}
+
+			RenderRecord def;
+			def.index_count = homo_mat_tris.count;
+			def.first_index = mesh_asset->first_index + homo_mat_tris.start_index;
+			def.vertex_offset = mesh_asset->vertex_offset;
+			def.material_index = homo_mat_tris.material_index;
+			def.final_transform = node_matrix;
+
+			ctx.homo_mat_tris_record.push_back(def);
+		}
+	}
+
+	Node::PreDrawToContext(top_matrix, frustum, ctx);
+}
+
+Anni::ModelLoader::LoadedModel::LoadedModel(std::filesystem::path file_path, std::pmr::memory_resource* upstream) :
+	m_arena(upstream),
+	m_file_path(std::move(file_path)),
+	m_merged_buffer(&m_arena, &m_arena)
+{
+}
+
+const Anni::ModelLoader::FlatScene& Anni::ModelLoader::LoadedModel::GetScene() const
 {
+	return m_scene;
 }
 
+Anni::ModelLoader::FlatScene& Anni::ModelLoader::LoadedModel::GetScene()
+{
+	return m_scene;
+}
 
-std::unique_ptr<Anni::ModelLoader::LoadedModel> Anni::ModelLoader::LoadedModel::Factory::LoadFromFile(const std::filesystem::path file_path)
+std::span<const Anni::ModelLoader::LoadedSampler> Anni::ModelLoader::LoadedModel::GetSamplers() const
 {
-	if ( !file_path.has_extension() )
+	return m_samplers;
+}
+
+std::span<const Anni::ModelLoader::LoadedImage> Anni::ModelLoader::LoadedModel::GetTextures() const
+{
+	return m_textures;
+}
+
+std::span<const Anni::ModelLoader::LoadedMaterialConstant> Anni::ModelLoader::LoadedModel::GetMaterials() const
+{
+	return m_materials;
+}
+
+std::span<const Anni::ModelLoader::LoadedMeshAsset> Anni::ModelLoader::LoadedModel::GetMeshAssets() const
+{
+	return m_mesh_assets;
+}
+
+std::span<const std::filesystem::path> Anni::ModelLoader::LoadedModel::GetSourceFiles() const
+{
+	return m_source_files;
+}
+
+const Anni::ModelLoader::LoadedMeshAsset::MeshBuffer& Anni::ModelLoader::LoadedModel::GetMergedBuffer() const
+{
+	return m_merged_buffer;
+}
+
+std::span<const Anni::ModelLoader::LoadedSkin> Anni::ModelLoader::LoadedModel::GetSkins() const
+{
+	return m_skins;
+}
+
+std::span<const Anni::ModelLoader::LoadedAnimation> Anni::ModelLoader::LoadedModel::GetAnimations() const
+{
+	return m_animations;
+}
+
+const Anni::ModelLoader::AnimationPose& Anni::ModelLoader::LoadedModel::GetRestPose() const
+{
+	return m_rest_pose;
+}
+
+uint64_t Anni::ModelLoader::ModelMemoryUsage::GetOwnedBytes() const
+{
+	return texture_bytes + vertex_bytes + index_bytes + meshlet_bytes + scene_bytes + animation_bytes;
+}
+
+Anni::ModelLoader::ModelMemoryUsage Anni::ModelLoader::LoadedModel::GetMemoryUsage() const
+{
+	const auto vector_bytes = []<typename T, typename Allocator>(const std::vector<T, Allocator>& elements) -> uint64_t
+	{
+		return elements.size() * sizeof(T);
+	};
+
+	ModelMemoryUsage usage;
+	for ( const auto& texture : m_textures )
+	{
+		if ( texture.external_owner )
+		{
+			usage.shared_texture_bytes += texture.external_data.size();
+		}
+		else
+		{
+			usage.texture_bytes += texture.raw_data.size();
+		}
+	}
+
+	for ( const auto& mesh_asset : m_mesh_assets )
+	{
+		usage.vertex_bytes += vector_bytes(mesh_asset.buffer_in_one.vertices) + vector_bytes(mesh_asset.buffer_in_one.skin_vertices);
+		for ( const auto& stream : mesh_asset.buffer_in_one.streams )
+		{
+			usage.vertex_bytes += stream.data.size();
+		}
+		usage.index_bytes += vector_bytes(mesh_asset.buffer_in_one.indices) + vector_bytes(mesh_asset.homo_mat_tris_array);
+		for ( const auto& lod : mesh_asset.lods )
+		{
+			usage.index_bytes += vector_bytes(lod.homo_mat_tris_array);
+		}
+		usage.meshlet_bytes += vector_bytes(mesh_asset.meshlets) + vector_bytes(mesh_asset.meshlet_vertices) + vector_bytes(mesh_asset.meshlet_triangles);
+	}
+	usage.vertex_bytes += vector_bytes(m_merged_buffer.vertices) + vector_bytes(m_merged_buffer.skin_vertices);
+	for ( const auto& stream : m_merged_buffer.streams )
+	{
+		usage.vertex_bytes += stream.data.size();
+	}
+	usage.index_bytes += vector_bytes(m_merged_buffer.indices);
+
+	usage.scene_bytes = vector_bytes(m_scene.local_transforms) + vector_bytes(m_scene.world_transforms) + vector_bytes(m_scene.parent_indices) +
+		vector_bytes(m_scene.subtree_sizes) + vector_bytes(m_scene.mesh_indices) + vector_bytes(m_scene.source_node_indices) +
+		vector_bytes(m_scene.flat_node_indices) + vector_bytes(m_scene.skin_indices) +
+		vector_bytes(m_scene.local_bounds) + vector_bytes(m_scene.world_bounds) + vector_bytes(m_scene.subtree_bounds) +
+		vector_bytes(m_scene.dirty_nodes) + vector_bytes(m_scene.dirty_flags);
+	for ( const auto& node : m_scene_nodes )
+	{
+		usage.scene_bytes += sizeof(*node) + vector_bytes(node->children);
+	}
+
+	for ( const auto& skin : m_skins )
+	{
+		usage.animation_bytes += vector_bytes(skin.joint_nodes) + vector_bytes(skin.inverse_bind_matrices);
+	}
+	for ( const auto& animation : m_animations )
+	{
+		usage.animation_bytes += vector_bytes(animation.channels) + vector_bytes(animation.target_nodes) + vector_bytes(animation.times) + vector_bytes(animation.values);
+	}
+	usage.animation_bytes += vector_bytes(m_rest_pose.translations) + vector_bytes(m_rest_pose.rotations) + vector_bytes(m_rest_pose.scales) +
+		vector_bytes(m_rest_pose.first_morph_weights) + vector_bytes(m_rest_pose.morph_weights);
+	usage.arena_bytes = m_arena.GetReservedBytes();
+	return usage;
+}
+
+void Anni::ModelLoader::LoadedModel::PreDrawToContext(const glm::mat4& top_matrix, DrawContext& ctx, const Frustum* const frustum, const LodSelection* const lod_selection) const
+{
+	m_scene.PreDrawToContext(top_matrix, m_mesh_assets, ctx, frustum, lod_selection);
+}
+
+void Anni::ModelLoader::LoadedModel::BuildDrawList(const glm::mat4& top_matrix, DrawList& draw_list, const Frustum* const frustum) const
+{
+	draw_list.Clear();
+
+	//> COUNT
+	size_t item_count = 0;
+	for ( const uint32_t mesh_index : m_scene.mesh_indices )
+	{
+		item_count += mesh_index == FlatScene::no_mesh ? 0 : m_mesh_assets[mesh_index].homo_mat_tris_array.size();
+	}
+	draw_list.m_items.reserve(item_count);
+	draw_list.instance_transforms.reserve(item_count);
+
+	//> KEY
+	for ( size_t i = 0; i < m_scene.mesh_indices.size(); )
+	{
+		if ( frustum && !frustum->Intersects(m_scene.subtree_bounds[i]) )
+		{
+			i += m_scene.subtree_sizes[i];
+			continue;
+		}
+
+		const size_t node_index = i++;
+		const uint32_t mesh_index = m_scene.mesh_indices[node_index];
+		if ( mesh_index == FlatScene::no_mesh || (frustum && !frustum->Intersects(m_scene.world_bounds[node_index])) )
+		{
+			continue;
+		}
+
+		for ( auto [homo_mat_tris_index, homo_mat_tris] : std::ranges::views::enumerate(m_mesh_assets[mesh_index].homo_mat_tris_array) )
+		{
+			if ( frustum && !frustum->Intersects(homo_mat_tris.bounds.Transform(m_scene.world_transforms[node_index])) )
+			{
+				continue;
+			}
+
+			auto alpha_mode = LoadedMaterialConstant::AlphaMode::Opaque;
+			if ( homo_mat_tris.material_index.has_value() )
+			{
+				alpha_mode = m_materials[homo_mat_tris.material_index.value()].alpha_mode;
+			}
+			const DrawList::SortKey sort_key = DrawList::MakeSortKey(alpha_mode, homo_mat_tris.material_index, mesh_index, static_cast<uint32_t>(homo_mat_tris_index));
+			draw_list.m_items.push_back({ sort_key, static_cast<uint32_t>(node_index) });
+		}
+	}
+
+	//> SORT
+	// node index breaks ties, the output is the same from frame to frame
+	std::ranges::sort(draw_list.m_items, [](const DrawList::DrawItem& lhs, const DrawList::DrawItem& rhs)
+	{
+		return lhs.sort_key != rhs.sort_key ? lhs.sort_key < rhs.sort_key : lhs.node_index < rhs.node_index;
+	});
+
+	//> MERGE
+	// every run of equal keys is the same mesh part with the same material: one instanced command
+	for ( size_t run_begin = 0; run_begin < draw_list.m_items.size(); )
+	{
+		const DrawList::SortKey sort_key = draw_list.m_items[run_begin].sort_key;
+		size_t run_end = run_begin + 1;
+		while ( run_end < draw_list.m_items.size() && draw_list.m_items[run_end].sort_key == sort_key )
+		{
+			++run_end;
+		}
+
+		const uint32_t node_index = draw_list.m_items[run_begin].node_index;
+		const uint32_t mesh_index = m_scene.mesh_indices[node_index];
+		const uint32_t homo_mat_tris_index = DrawList::GetHomoMatTrisIndex(sort_key);
+		const LoadedMeshAsset& mesh_asset = m_mesh_assets[mesh_index];
+		const LoadedMeshAsset::HomoMatTris& homo_mat_tris = mesh_asset.homo_mat_tris_array[homo_mat_tris_index];
+
+		DrawIndexedIndirectCommand command{};
+		command.index_count = homo_mat_tris.count;
+		command.instance_count = static_cast<uint32_t>(run_end - run_begin);
+		command.first_index = mesh_asset.first_index + homo_mat_tris.start_index;
+		command.vertex_offset = mesh_asset.vertex_offset;
+		command.first_instance = static_cast<uint32_t>(draw_list.instance_transforms.size());
+		draw_list.commands.push_back(command);
+		draw_list.batches.push_back({ sort_key, mesh_index, homo_mat_tris.material_index });
+
+		for ( size_t i = run_begin; i < run_end; ++i )
+		{
+			draw_list.instance_transforms.push_back(MultiplyTransforms(top_matrix, m_scene.world_transforms[draw_list.m_items[i].node_index]));
+		}
+		run_begin = run_end;
+	}
+}
+
+const Anni::ModelLoader::VertexQuantizationReport& Anni::ModelLoader::LoadedModel::GetQuantizationReport() const
+{
+	return m_quantization_report;
+}
+
+const Anni::ModelLoader::MeshOptimizationReport& Anni::ModelLoader::LoadedModel::GetOptimizationReport() const
+{
+	return m_optimization_report;
+}
+
+const Anni::ModelLoader::LoadStats& Anni::ModelLoader::LoadedModel::GetLoadStats() const
+{
+	return m_load_stats;
+}
+
+std::string_view Anni::ModelLoader::LoadStats::GetStageName(const Stage stage)
+{
+	switch ( stage )
+	{
+		case Stage::RawParse:
+			return "raw_parse";
+		case Stage::Decompress:
+			return "decompress";
+		case Stage::Samplers:
+			return "samplers";
+		case Stage::Materials:
+			return "materials";
+		case Stage::Textures:
+			return "textures";
+		case Stage::Meshes:
+			return "meshes";
+		case Stage::SceneNodes:
+			return "scene_nodes";
+		case Stage::SceneGraph:
+			return "scene_graph";
+		case Stage::Animations:
+			return "animations";
+		case Stage::CookedRead:
+			return "cooked_read";
+		case Stage::CookedWrite:
+			return "cooked_write";
+		default:
+			return "unknown";
+	}
+}
+
+double Anni::ModelLoader::LoadStats::GetStageMilliseconds(const Stage stage) const
+{
+	return stage < Stage::Count ? stage_milliseconds[static_cast<size_t>(stage)] : 0.0;
+}
+
+void Anni::ModelLoader::LoadedModel::Factory::FinishLoadStats(std::unique_ptr<LoadedModel>& loading_result)
+{
+	LoadStats& stats = loading_result->m_load_stats;
+	stats.decoded_texels = loading_result->m_decoded_texels.load(std::memory_order_relaxed);
+	stats.texture_decode_milliseconds = static_cast<double>(loading_result->m_texture_decode_nanoseconds.load(std::memory_order_relaxed)) / 1e6;
+	stats.vertex_count = 0;
+	stats.index_count = 0;
+	for ( const LoadedMeshAsset& mesh_asset : loading_result->m_mesh_assets )
+	{
+		stats.vertex_count += mesh_asset.vertex_count;
+		stats.index_count += mesh_asset.index_count;
+	}
+	stats.allocated_bytes = loading_result->m_arena.GetUsedBytes() + loading_result->GetMemoryUsage().texture_bytes;
+	stats.peak_resident_bytes = GetPeakResidentBytes();
+}
+
+
+std::unique_ptr<Anni::ModelLoader::LoadedModel> Anni::ModelLoader::LoadedModel::Factory::LoadFromFile(std::filesystem::path file_path, const LoadOptions& options)
+{
+	LoadResult<std::unique_ptr<LoadedModel>> loading_result = TryLoadFromFile(std::move(file_path), options);
+	if ( !loading_result )
 	{
-		SPDLOG_ERROR("Provided file path doesn't have a file extension!");
+		SPDLOG_ERROR("{}", loading_result.error().message);
 		std::exit(EXIT_FAILURE); // or std::exit(1);
 	}
+	return std::move(loading_result.value());
+}
+
+Anni::ModelLoader::LoadResult<std::unique_ptr<Anni::ModelLoader::LoadedModel>> Anni::ModelLoader::LoadedModel::Factory::TryLoadFromFile(const std::filesystem::path file_path, const LoadOptions& options)
+{
+	if ( !file_path.has_extension() )
+	{
+		return std::unexpected(LoadError{ LoadError::Code::UnsupportedFile, "Provided file path doesn't have a file extension: " + file_path.string() });
+	}
+
+	// LoadRawGltf tells the two apart by the file content
+	std::string extension = file_path.extension().string();
+	std::ranges::transform(extension, extension.begin(), [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+	if ( ".gltf" != extension && ".glb" != extension )
+	{
+		return std::unexpected(LoadError{ LoadError::Code::UnsupportedFile, "Unsupported model file extension: " + extension });
+	}
 
 	SPDLOG_INFO("Loading file from the file path: {}", file_path.string());
 
-	const auto raw_ptr_loading_result = new LoadedModel(file_path);
+	const auto load_start = std::chrono::steady_clock::now();
+	TraceSpan load_span(options.trace_recorder, "LoadFromFile " + file_path.filename().string());
+	// the high water mark never goes down, the difference is what this load added on top of everything before it
+	const uint64_t peak_resident_before = GetPeakResidentBytes();
+
+	std::filesystem::path cooked_path;
+	if ( options.cooked_cache_directory.has_value() )
+	{
+		cooked_path = GetCookedModelPath(options.cooked_cache_directory.value(), file_path);
+		LoadStats cooked_stats;
+		std::unique_ptr<LoadedModel> cooked_result;
+		{
+			ScopedLoadStage stage(cooked_stats, LoadStats::Stage::CookedRead, options.trace_recorder);
+			cooked_result = LoadCookedModel(cooked_path, file_path, options);
+		}
+		if ( cooked_result )
+		{
+			SPDLOG_INFO("Loaded cooked model from: {}", cooked_path.string());
+			cooked_stats.from_cooked_cache = true;
+			cooked_stats.bytes_read = GetFileSize(cooked_path);
+			cooked_stats.peak_resident_bytes_before = peak_resident_before;
+			cooked_result->m_load_stats = cooked_stats;
+			FinishLoadStats(cooked_result);
+			cooked_result->m_load_stats.total_milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - load_start).count();
+			return cooked_result;
+		}
+	}
+
+	const auto raw_ptr_loading_result = new LoadedModel(file_path, options.memory_resource);
 	std::unique_ptr<LoadedModel> loading_result(raw_ptr_loading_result);
+	loading_result->m_load_stats.peak_resident_bytes_before = peak_resident_before;
+
 
+	fastgltf::Parser gltf_parser{ supported_extensions };
+
+	if ( LoadResult<void> result = LoadGltf(file_path, gltf_parser, options, loading_result); !result )
+	{
+		return std::unexpected(std::move(result.error()));
+	}
 
-	fastgltf::Parser gltf_parser{};
+	constexpr double bytes_per_mib = 1024.0 * 1024.0;
+	const uint64_t peak_resident_after = GetPeakResidentBytes();
+	SPDLOG_INFO("Peak resident memory {:.1f} MiB -> {:.1f} MiB({} input).",
+		static_cast<double>(peak_resident_before) / bytes_per_mib, static_cast<double>(peak_resident_after) / bytes_per_mib,
+		options.memory_mapped_input ? "memory mapped" : "buffered");
+	SPDLOG_INFO("Model arena: {} blocks, {:.1f} MiB reserved, {:.1f} MiB used.", loading_result->m_arena.GetBlockCount(),
+		static_cast<double>(loading_result->m_arena.GetReservedBytes()) / bytes_per_mib, static_cast<double>(loading_result->m_arena.GetUsedBytes()) / bytes_per_mib);
 
-	const std::string extension = file_path.extension().string();
-	if ( ".gltf" == extension )
+	if ( !cooked_path.empty() )
 	{
-		LoadGltf(file_path, gltf_parser, loading_result);
+		ScopedLoadStage stage(loading_result->m_load_stats, LoadStats::Stage::CookedWrite, options.trace_recorder);
+		loading_result->m_load_stats.saved_to_cooked_cache = SaveCookedModel(*loading_result, cooked_path, options);
+		if ( !loading_result->m_load_stats.saved_to_cooked_cache )
+		{
+			SPDLOG_WARN("Failed to write cooked model to: {}", cooked_path.string());
+		}
 	}
 
+	FinishLoadStats(loading_result);
+	LoadStats& stats = loading_result->m_load_stats;
+	stats.total_milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - load_start).count();
+	SPDLOG_INFO("Loaded in {:.2f} ms: parse {:.2f}, materials {:.2f}, textures {:.2f}(decode {:.2f} on the pool), meshes {:.2f}, scene {:.2f}.",
+		stats.total_milliseconds, stats.GetStageMilliseconds(LoadStats::Stage::RawParse), stats.GetStageMilliseconds(LoadStats::Stage::Materials),
+		stats.GetStageMilliseconds(LoadStats::Stage::Textures), stats.texture_decode_milliseconds, stats.GetStageMilliseconds(LoadStats::Stage::Meshes),
+		stats.GetStageMilliseconds(LoadStats::Stage::SceneNodes) + stats.GetStageMilliseconds(LoadStats::Stage::SceneGraph));
+
 	return loading_result;
 }
@@ -0,0 +1,35 @@
+#include "ProcessMemory.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+
+uint64_t Anni::ModelLoader::GetPeakResidentBytes()
+{
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters{};
+	if ( !GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) )
+	{
+		return 0;
+	}
+	return static_cast<uint64_t>(counters.PeakWorkingSetSize);
+#else
+	rusage usage{};
+	if ( getrusage(RUSAGE_SELF, &usage) != 0 )
+	{
+		return 0;
+	}
+#if defined(__APPLE__)
+	// bytes on macOS
+	return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+	// kilobytes on Linux and the BSDs
+	return static_cast<uint64_t>(usage.ru_maxrss) * 1024u;
+#endif
+#endif
+}
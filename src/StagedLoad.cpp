@@ -0,0 +1,70 @@
+#include "StagedLoad.h"
+#include "MappedFile.h"
+
+
+namespace Anni::ModelLoader
+{
+	LoadedModel::Factory::StagedLoad::StagedLoad(std::filesystem::path file_path, const LoadOptions& options) :
+		m_file_path(std::move(file_path)),
+		m_options(options),
+		m_model(new LoadedModel(m_file_path, options.memory_resource))
+	{
+	}
+
+	LoadResult<void> LoadedModel::Factory::StagedLoad::RunStage(const LoadStats::Stage stage)
+	{
+		// same calls and order as LoadGltf, minus the overlap of texture decoding with the meshes
+		switch ( stage )
+		{
+			case LoadStats::Stage::RawParse:
+			{
+				if ( LoadResult<void> result = LoadRawGltf(m_data, m_gltf_asset, m_file_path, m_gltf_parser, m_options); !result )
+				{
+					return result;
+				}
+				CollectSourceFiles(m_gltf_asset, m_file_path, m_model);
+				return LoadExternalBuffers(m_gltf_asset, m_file_path, m_options, m_source_mappings);
+			}
+			case LoadStats::Stage::Decompress:
+				return DecodeCompressedBufferViews(m_gltf_asset);
+			case LoadStats::Stage::Samplers:
+				LoadSamplers(m_gltf_asset, m_model);
+				return {};
+			case LoadStats::Stage::Materials:
+				CreateTextureSlots(m_gltf_asset, m_model);
+				LoadMaterials(m_gltf_asset, m_file_path, m_model);
+				return {};
+			case LoadStats::Stage::Textures:
+			{
+				std::vector<std::future<LoadResult<void>>> pending_images = LoadTextureImages(m_gltf_asset, m_file_path, m_options, m_model);
+				return WaitTextureImages(pending_images);
+			}
+			case LoadStats::Stage::Meshes:
+				return LoadMeshes(m_gltf_asset, m_options, m_model);
+			case LoadStats::Stage::SceneNodes:
+				return LoadSceneNodes(m_gltf_asset, m_model);
+			case LoadStats::Stage::SceneGraph:
+				return LoadSceneGraph(m_gltf_asset, m_model);
+			case LoadStats::Stage::Animations:
+			{
+				if ( LoadResult<void> result = LoadSkins(m_gltf_asset, m_model); !result )
+				{
+					return result;
+				}
+				return LoadAnimations(m_gltf_asset, m_model);
+			}
+			default:
+				return std::unexpected(LoadError{ LoadError::Code::UnsupportedFile, "Stage " + std::string(LoadStats::GetStageName(stage)) + " isn't part of a glTF load." });
+		}
+	}
+
+	const LoadedModel& LoadedModel::Factory::StagedLoad::GetModel() const
+	{
+		return *m_model;
+	}
+
+	uint32_t LoadedModel::Factory::StagedLoad::GetArenaBlockCount() const
+	{
+		return m_model->m_arena.GetBlockCount();
+	}
+}
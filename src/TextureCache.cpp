@@ -0,0 +1,161 @@
+#include "TextureCache.h"
+
+#include <cstring>
+
+
+Anni::ModelLoader::TextureCache::TextureCache(const uint64_t budget_bytes) :
+	m_budget_bytes(budget_bytes)
+{
+}
+
+Anni::ModelLoader::TextureCache& Anni::ModelLoader::TextureCache::Shared()
+{
+	static TextureCache shared_cache(1ull << 30);
+	return shared_cache;
+}
+
+std::shared_ptr<const Anni::ModelLoader::LoadedImage> Anni::ModelLoader::TextureCache::GetOrDecode(const Key& key, const std::function<bool(LoadedImage&)>& decode)
+{
+	std::promise<std::shared_ptr<const LoadedImage>> decoded_promise;
+	{
+		std::unique_lock lock(m_mutex);
+		if ( const auto entry = m_entries.find(key); entry != m_entries.end() )
+		{
+			++m_stats.hits;
+			m_lru.splice(m_lru.begin(), m_lru, entry->second.recency);
+			return entry->second.image;
+		}
+		if ( const auto pending = m_pending.find(key); pending != m_pending.end() )
+		{
+			// somebody is decoding it right now, which is as good as a hit
+			++m_stats.hits;
+			std::shared_future<std::shared_ptr<const LoadedImage>> pending_image = pending->second;
+			lock.unlock();
+			return pending_image.get();
+		}
+		++m_stats.misses;
+		m_pending.emplace(key, decoded_promise.get_future().share());
+	}
+
+	std::shared_ptr<const LoadedImage> result;
+	try
+	{
+		auto decoded_image = std::make_shared<LoadedImage>(std::string{});
+		if ( decode(*decoded_image) )
+		{
+			result = std::move(decoded_image);
+		}
+	}
+	catch ( ... )
+	{
+		// the callers waiting on this decode get the exception as well, the next call decodes again
+		{
+			std::scoped_lock lock(m_mutex);
+			m_pending.erase(key);
+		}
+		decoded_promise.set_exception(std::current_exception());
+		throw;
+	}
+
+	{
+		std::scoped_lock lock(m_mutex);
+		m_pending.erase(key);
+		if ( result )
+		{
+			const uint64_t byte_size = result->GetData().size();
+			m_lru.push_front(key);
+			m_entries.emplace(key, Entry{ result, byte_size, m_lru.begin() });
+			m_cached_bytes += byte_size;
+			EvictOverBudget();
+		}
+	}
+	decoded_promise.set_value(result);
+	return result;
+}
+
+void Anni::ModelLoader::TextureCache::SetBudget(const uint64_t budget_bytes)
+{
+	std::scoped_lock lock(m_mutex);
+	m_budget_bytes = budget_bytes;
+	EvictOverBudget();
+}
+
+uint64_t Anni::ModelLoader::TextureCache::GetBudget() const
+{
+	std::scoped_lock lock(m_mutex);
+	return m_budget_bytes;
+}
+
+uint64_t Anni::ModelLoader::TextureCache::GetCachedBytes() const
+{
+	std::scoped_lock lock(m_mutex);
+	return m_cached_bytes;
+}
+
+size_t Anni::ModelLoader::TextureCache::GetEntryCount() const
+{
+	std::scoped_lock lock(m_mutex);
+	return m_entries.size();
+}
+
+Anni::ModelLoader::TextureCache::Stats Anni::ModelLoader::TextureCache::GetStats() const
+{
+	std::scoped_lock lock(m_mutex);
+	return m_stats;
+}
+
+void Anni::ModelLoader::TextureCache::Clear()
+{
+	std::scoped_lock lock(m_mutex);
+	m_entries.clear();
+	m_lru.clear();
+	m_cached_bytes = 0;
+}
+
+uint64_t Anni::ModelLoader::TextureCache::HashContent(const std::span<const uint8_t> bytes)
+{
+	// eight bytes per step, images are megabytes and hashing them must stay far cheaper than decoding
+	constexpr uint64_t multiplier = 0x9e3779b97f4a7c15ull;
+	uint64_t hash = 14695981039346656037ull ^ bytes.size();
+	size_t offset = 0;
+	for ( ; offset + sizeof(uint64_t) <= bytes.size(); offset += sizeof(uint64_t) )
+	{
+		uint64_t word;
+		memcpy(&word, bytes.data() + offset, sizeof(word));
+		hash = (hash ^ word) * multiplier;
+		hash ^= hash >> 29;
+	}
+	for ( ; offset < bytes.size(); ++offset )
+	{
+		hash = (hash ^ bytes[offset]) * 1099511628211ull;
+	}
+	// murmur3 finalizer, a one byte change has to reach every bit
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdull;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ull;
+	return hash ^ hash >> 33;
+}
+
+size_t Anni::ModelLoader::TextureCache::KeyHash::operator()(const Key& key) const
+{
+	const size_t path_hash = std::hash<std::string>{}(key.canonical_path);
+	return path_hash ^ (key.content_hash + 0x9e3779b97f4a7c15ull + (path_hash << 6) + (path_hash >> 2)) ^ key.settings * 31;
+}
+
+void Anni::ModelLoader::TextureCache::EvictOverBudget()
+{
+	for ( auto recency = m_lru.end(); m_cached_bytes > m_budget_bytes && recency != m_lru.begin(); )
+	{
+		--recency;
+		const auto entry = m_entries.find(*recency);
+		if ( entry->second.image.use_count() > 1 )
+		{
+			continue;
+		}
+		m_cached_bytes -= entry->second.byte_size;
+		m_entries.erase(entry);
+		recency = m_lru.erase(recency);
+		++m_stats.evictions;
+	}
+}
@@ -0,0 +1,796 @@
+#include "TextureProcessor.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ANNI_MODELS_LOADER_SSE2 1
+#endif
+
+
+namespace
+{
+	using namespace Anni::ModelLoader;
+
+	constexpr uint32_t texels_per_block = 16;
+	// destination rows per ParallelFor item while downsampling
+	constexpr uint32_t rows_per_band = 32;
+
+	//> SRGB CONVERSION
+	float SrgbToLinear(const float value)
+	{
+		return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+	}
+
+	float LinearToSrgb(const float value)
+	{
+		return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.f / 2.4f) - 0.055f;
+	}
+
+	struct SrgbTables
+	{
+		// indexed by round(linear * (to_srgb_size - 1)), fine enough for every 8 bit value to survive a round trip
+		static constexpr uint32_t to_srgb_size = 4096;
+
+		std::array<float, 256> to_linear;
+		std::array<uint8_t, to_srgb_size> to_srgb;
+	};
+
+	const SrgbTables& GetSrgbTables()
+	{
+		static const SrgbTables tables = []()
+		{
+			SrgbTables built{};
+			for ( uint32_t i = 0; i < 256; ++i )
+			{
+				built.to_linear[i] = SrgbToLinear(static_cast<float>(i) / 255.f);
+			}
+			for ( uint32_t i = 0; i < SrgbTables::to_srgb_size; ++i )
+			{
+				const float srgb = LinearToSrgb(static_cast<float>(i) / static_cast<float>(SrgbTables::to_srgb_size - 1));
+				built.to_srgb[i] = static_cast<uint8_t>(std::lround(std::clamp(srgb, 0.f, 1.f) * 255.f));
+			}
+			return built;
+		}();
+		return tables;
+	}
+
+	//> DOWNSAMPLING
+	// averages four RGBA8 texels. alpha is always linear
+	void AverageTexels(const std::array<const uint8_t*, 4>& texels, const bool srgb, const bool normal_map, const SrgbTables& tables, uint8_t* output)
+	{
+#if defined(ANNI_MODELS_LOADER_SSE2)
+		const __m128i zero = _mm_setzero_si128();
+		const __m128 inv_255 = _mm_set1_ps(1.f / 255.f);
+		__m128 sum = _mm_setzero_ps();
+		for ( const uint8_t* texel : texels )
+		{
+			if ( srgb )
+			{
+				sum = _mm_add_ps(sum, _mm_setr_ps(tables.to_linear[texel[0]], tables.to_linear[texel[1]], tables.to_linear[texel[2]], static_cast<float>(texel[3]) * (1.f / 255.f)));
+			}
+			else
+			{
+				int32_t packed;
+				memcpy(&packed, texel, sizeof(packed));
+				const __m128i widened = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_cvtepi32_ps(widened), inv_255));
+			}
+		}
+		__m128 average = _mm_mul_ps(sum, _mm_set1_ps(0.25f));
+
+		if ( normal_map )
+		{
+			// xyz back to [-1, 1], renormalize and back to [0, 1]
+			const __m128 vector = _mm_sub_ps(_mm_add_ps(average, average), _mm_set1_ps(1.f));
+			alignas(16) float lanes[4];
+			_mm_store_ps(lanes, _mm_mul_ps(vector, vector));
+			const float length_squared = lanes[0] + lanes[1] + lanes[2];
+			if ( length_squared > 1e-12f )
+			{
+				const __m128 xyz_mask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+				const __m128 normalized = _mm_add_ps(_mm_mul_ps(vector, _mm_set1_ps(0.5f / std::sqrt(length_squared))), _mm_set1_ps(0.5f));
+				average = _mm_or_ps(_mm_and_ps(xyz_mask, normalized), _mm_andnot_ps(xyz_mask, average));
+			}
+		}
+
+		const __m128 clamped = _mm_min_ps(_mm_max_ps(average, _mm_setzero_ps()), _mm_set1_ps(1.f));
+		if ( srgb )
+		{
+			constexpr auto table_scale = static_cast<float>(SrgbTables::to_srgb_size - 1);
+			alignas(16) int32_t scaled[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(scaled), _mm_cvtps_epi32(_mm_mul_ps(clamped, _mm_setr_ps(table_scale, table_scale, table_scale, 255.f))));
+			output[0] = tables.to_srgb[scaled[0]];
+			output[1] = tables.to_srgb[scaled[1]];
+			output[2] = tables.to_srgb[scaled[2]];
+			output[3] = static_cast<uint8_t>(scaled[3]);
+		}
+		else
+		{
+			const __m128i scaled = _mm_cvtps_epi32(_mm_mul_ps(clamped, _mm_set1_ps(255.f)));
+			const int32_t packed = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(scaled, zero), zero));
+			memcpy(output, &packed, sizeof(packed));
+		}
+#else
+		std::array<float, 4> average{};
+		for ( const uint8_t* texel : texels )
+		{
+			for ( uint32_t channel = 0; channel < 4; ++channel )
+			{
+				average[channel] += srgb && channel < 3 ? tables.to_linear[texel[channel]] : static_cast<float>(texel[channel]) / 255.f;
+			}
+		}
+		for ( float& value : average )
+		{
+			value *= 0.25f;
+		}
+
+		if ( normal_map )
+		{
+			std::array<float, 3> vector{ average[0] * 2.f - 1.f, average[1] * 2.f - 1.f, average[2] * 2.f - 1.f };
+			const float length_squared = vector[0] * vector[0] + vector[1] * vector[1] + vector[2] * vector[2];
+			if ( length_squared > 1e-12f )
+			{
+				const float scale = 0.5f / std::sqrt(length_squared);
+				for ( uint32_t channel = 0; channel < 3; ++channel )
+				{
+					average[channel] = vector[channel] * scale + 0.5f;
+				}
+			}
+		}
+
+		for ( uint32_t channel = 0; channel < 4; ++channel )
+		{
+			const float value = std::clamp(average[channel], 0.f, 1.f);
+			output[channel] = srgb && channel < 3
+				? tables.to_srgb[static_cast<uint32_t>(std::lround(value * static_cast<float>(SrgbTables::to_srgb_size - 1)))]
+				: static_cast<uint8_t>(std::lround(value * 255.f));
+		}
+#endif
+	}
+
+	//> ENDPOINT FITTING
+	using BlockPoints = std::array<std::array<float, 4>, texels_per_block>;
+	using Endpoint = std::array<float, 4>;
+
+	float Dot(const Endpoint& a, const Endpoint& b)
+	{
+		return a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+	}
+
+	float DistanceSquared(const Endpoint& a, const Endpoint& b)
+	{
+		const Endpoint difference{ a[0] - b[0], a[1] - b[1], a[2] - b[2], a[3] - b[3] };
+		return Dot(difference, difference);
+	}
+
+	BlockPoints LoadBlockPoints(const uint8_t* texels, const uint32_t channel_count)
+	{
+		BlockPoints points{};
+		for ( uint32_t i = 0; i < texels_per_block; ++i )
+		{
+			for ( uint32_t channel = 0; channel < channel_count; ++channel )
+			{
+				points[i][channel] = texels[i * 4 + channel];
+			}
+		}
+		return points;
+	}
+
+	// the two ends of the block's extent along its principal axis
+	std::pair<Endpoint, Endpoint> FitPrincipalAxis(const BlockPoints& points)
+	{
+		Endpoint mean{};
+		Endpoint lower{ 255.f, 255.f, 255.f, 255.f };
+		Endpoint upper{};
+		for ( const auto& point : points )
+		{
+			for ( uint32_t channel = 0; channel < 4; ++channel )
+			{
+				mean[channel] += point[channel] / static_cast<float>(texels_per_block);
+				lower[channel] = std::min(lower[channel], point[channel]);
+				upper[channel] = std::max(upper[channel], point[channel]);
+			}
+		}
+
+		std::array<std::array<float, 4>, 4> covariance{};
+		for ( const auto& point : points )
+		{
+			const Endpoint delta{ point[0] - mean[0], point[1] - mean[1], point[2] - mean[2], point[3] - mean[3] };
+			for ( uint32_t row = 0; row < 4; ++row )
+			{
+				for ( uint32_t column = 0; column < 4; ++column )
+				{
+					covariance[row][column] += delta[row] * delta[column];
+				}
+			}
+		}
+
+		// power iteration, started from the bounding box diagonal
+		Endpoint axis{ upper[0] - lower[0], upper[1] - lower[1], upper[2] - lower[2], upper[3] - lower[3] };
+		for ( uint32_t iteration = 0; iteration < 8; ++iteration )
+		{
+			Endpoint next{};
+			for ( uint32_t row = 0; row < 4; ++row )
+			{
+				next[row] = Dot(covariance[row], axis);
+			}
+			const float largest = std::max({ std::abs(next[0]), std::abs(next[1]), std::abs(next[2]), std::abs(next[3]) });
+			if ( largest < 1e-6f )
+			{
+				break;
+			}
+			for ( uint32_t channel = 0; channel < 4; ++channel )
+			{
+				axis[channel] = next[channel] / largest;
+			}
+		}
+
+		const float axis_length_squared = Dot(axis, axis);
+		if ( axis_length_squared < 1e-12f )
+		{
+			return { mean, mean };
+		}
+
+		float t_min = std::numeric_limits<float>::max();
+		float t_max = std::numeric_limits<float>::lowest();
+		for ( const auto& point : points )
+		{
+			const Endpoint delta{ point[0] - mean[0], point[1] - mean[1], point[2] - mean[2], point[3] - mean[3] };
+			const float t = Dot(delta, axis) / axis_length_squared;
+			t_min = std::min(t_min, t);
+			t_max = std::max(t_max, t);
+		}
+
+		Endpoint first{};
+		Endpoint second{};
+		for ( uint32_t channel = 0; channel < 4; ++channel )
+		{
+			first[channel] = std::clamp(mean[channel] + axis[channel] * t_min, 0.f, 255.f);
+			second[channel] = std::clamp(mean[channel] + axis[channel] * t_max, 0.f, 255.f);
+		}
+		return { first, second };
+	}
+
+	// least squares endpoints for fixed interpolation weights, weights[i] is the share of the first endpoint in texel i
+	bool FitEndpoints(const BlockPoints& points, const std::array<float, texels_per_block>& weights, Endpoint& first, Endpoint& second)
+	{
+		float aa = 0.f, ab = 0.f, bb = 0.f;
+		Endpoint a_point{}, b_point{};
+		for ( uint32_t i = 0; i < texels_per_block; ++i )
+		{
+			const float a = weights[i];
+			const float b = 1.f - a;
+			aa += a * a;
+			ab += a * b;
+			bb += b * b;
+			for ( uint32_t channel = 0; channel < 4; ++channel )
+			{
+				a_point[channel] += a * points[i][channel];
+				b_point[channel] += b * points[i][channel];
+			}
+		}
+
+		const float determinant = aa * bb - ab * ab;
+		if ( std::abs(determinant) < 1e-6f )
+		{
+			return false;
+		}
+		for ( uint32_t channel = 0; channel < 4; ++channel )
+		{
+			first[channel] = std::clamp((bb * a_point[channel] - ab * b_point[channel]) / determinant, 0.f, 255.f);
+			second[channel] = std::clamp((aa * b_point[channel] - ab * a_point[channel]) / determinant, 0.f, 255.f);
+		}
+		return true;
+	}
+
+	//> BC1 COLOR BLOCK
+	uint16_t PackRgb565(const Endpoint& color)
+	{
+		const auto r = static_cast<uint16_t>(std::lround(color[0] * 31.f / 255.f));
+		const auto g = static_cast<uint16_t>(std::lround(color[1] * 63.f / 255.f));
+		const auto b = static_cast<uint16_t>(std::lround(color[2] * 31.f / 255.f));
+		return static_cast<uint16_t>(r << 11 | g << 5 | b);
+	}
+
+	Endpoint UnpackRgb565(const uint16_t packed)
+	{
+		const uint32_t r = packed >> 11 & 31u;
+		const uint32_t g = packed >> 5 & 63u;
+		const uint32_t b = packed & 31u;
+		return { static_cast<float>(r << 3 | r >> 2), static_cast<float>(g << 2 | g >> 4), static_cast<float>(b << 3 | b >> 2), 0.f };
+	}
+
+	struct ColorBlock
+	{
+		uint16_t color0;
+		uint16_t color1;
+		uint32_t selectors;
+		float error;
+	};
+
+	// four color mode: selector 0 is color0, 1 is color1, 2 and 3 the thirds in between
+	ColorBlock SelectColors(const BlockPoints& points, const Endpoint& first, const Endpoint& second)
+	{
+		ColorBlock block{ PackRgb565(first), PackRgb565(second), 0, 0.f };
+		if ( block.color0 < block.color1 )
+		{
+			std::swap(block.color0, block.color1);
+		}
+		const Endpoint color0 = UnpackRgb565(block.color0);
+		const Endpoint color1 = UnpackRgb565(block.color1);
+
+		std::array<Endpoint, 4> palette{ color0, color1 };
+		for ( uint32_t channel = 0; channel < 3; ++channel )
+		{
+			palette[2][channel] = (2.f * color0[channel] + color1[channel]) / 3.f;
+			palette[3][channel] = (color0[channel] + 2.f * color1[channel]) / 3.f;
+		}
+
+		for ( uint32_t i = 0; i < texels_per_block; ++i )
+		{
+			uint32_t best_selector = 0;
+			float best_error = std::numeric_limits<float>::max();
+			// equal endpoints mean three color mode in BC1, selector 0 is right in both modes
+			const uint32_t selector_count = block.color0 == block.color1 ? 1 : 4;
+			for ( uint32_t selector = 0; selector < selector_count; ++selector )
+			{
+				const float error = DistanceSquared(points[i], palette[selector]);
+				if ( error < best_error )
+				{
+					best_error = error;
+					best_selector = selector;
+				}
+			}
+			block.selectors |= best_selector << (i * 2);
+			block.error += best_error;
+		}
+		return block;
+	}
+
+	void EncodeColorBlock(const uint8_t* texels, uint8_t* output)
+	{
+		const BlockPoints points = LoadBlockPoints(texels, 3);
+		const auto [first, second] = FitPrincipalAxis(points);
+		ColorBlock best = SelectColors(points, second, first);
+
+		// one least squares pass on the selectors the axis fit picked
+		constexpr std::array<float, 4> selector_weights{ 1.f, 0.f, 2.f / 3.f, 1.f / 3.f };
+		std::array<float, texels_per_block> weights{};
+		for ( uint32_t i = 0; i < texels_per_block; ++i )
+		{
+			weights[i] = selector_weights[best.selectors >> (i * 2) & 3u];
+		}
+		Endpoint refined_first{}, refined_second{};
+		if ( FitEndpoints(points, weights, refined_first, refined_second) )
+		{
+			const ColorBlock refined = SelectColors(points, refined_first, refined_second);
+			if ( refined.error < best.error )
+			{
+				best = refined;
+			}
+		}
+
+		memcpy(output, &best.color0, sizeof(uint16_t));
+		memcpy(output + 2, &best.color1, sizeof(uint16_t));
+		memcpy(output + 4, &best.selectors, sizeof(uint32_t));
+	}
+
+	//> BC7 MODE 6
+	constexpr std::array<uint32_t, 16> bc7_weights{ 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	struct Bc7Endpoint
+	{
+		std::array<uint32_t, 4> quantized;
+		uint32_t p_bit;
+
+		[[nodiscard]] uint32_t Expand(const uint32_t channel) const
+		{
+			return quantized[channel] << 1 | p_bit;
+		}
+	};
+
+	// 7 bits per channel plus a shared low bit, whichever p bit lands closer wins
+	Bc7Endpoint QuantizeBc7Endpoint(const Endpoint& endpoint)
+	{
+		Bc7Endpoint best{};
+		float best_error = std::numeric_limits<float>::max();
+		for ( uint32_t p_bit = 0; p_bit < 2; ++p_bit )
+		{
+			Bc7Endpoint candidate{ {}, p_bit };
+			float error = 0.f;
+			for ( uint32_t channel = 0; channel < 4; ++channel )
+			{
+				candidate.quantized[channel] = static_cast<uint32_t>(std::clamp(std::lround((endpoint[channel] - static_cast<float>(p_bit)) * 0.5f), 0l, 127l));
+				const float difference = static_cast<float>(candidate.Expand(channel)) - endpoint[channel];
+				error += difference * difference;
+			}
+			if ( error < best_error )
+			{
+				best_error = error;
+				best = candidate;
+			}
+		}
+		return best;
+	}
+
+	struct Bc7Block
+	{
+		Bc7Endpoint endpoint0;
+		Bc7Endpoint endpoint1;
+		std::array<uint32_t, texels_per_block> indices;
+		float error;
+	};
+
+	Bc7Block SelectBc7Indices(const BlockPoints& points, const Endpoint& first, const Endpoint& second)
+	{
+		Bc7Block block{ QuantizeBc7Endpoint(first), QuantizeBc7Endpoint(second), {}, 0.f };
+
+		std::array<Endpoint, 16> palette{};
+		for ( uint32_t index = 0; index < 16; ++index )
+		{
+			for ( uint32_t channel = 0; channel < 4; ++channel )
+			{
+				const uint32_t value = ((64 - bc7_weights[index]) * block.endpoint0.Expand(channel) + bc7_weights[index] * block.endpoint1.Expand(channel) + 32) >> 6;
+				palette[index][channel] = static_cast<float>(value);
+			}
+		}
+
+		for ( uint32_t i = 0; i < texels_per_block; ++i )
+		{
+			float best_error = std::numeric_limits<float>::max();
+			for ( uint32_t index = 0; index < 16; ++index )
+			{
+				const float error = DistanceSquared(points[i], palette[index]);
+				if ( error < best_error )
+				{
+					best_error = error;
+					block.indices[i] = index;
+				}
+			}
+			block.error += best_error;
+		}
+		return block;
+	}
+
+	// bits are written from the least significant bit of the block up
+	class BlockBitWriter
+	{
+	public:
+		void Write(const uint32_t value, const uint32_t bit_count)
+		{
+			for ( uint32_t bit = 0; bit < bit_count; ++bit, ++m_position )
+			{
+				m_words[m_position / 64] |= static_cast<uint64_t>(value >> bit & 1u) << (m_position % 64);
+			}
+		}
+
+		void CopyTo(uint8_t* output) const
+		{
+			memcpy(output, m_words.data(), sizeof(m_words));
+		}
+
+	private:
+		std::array<uint64_t, 2> m_words{};
+		uint32_t m_position{ 0 };
+	};
+}
+
+
+Anni::ModelLoader::LoadedImage::Format Anni::ModelLoader::TextureProcessor::ChooseFormat(const uint32_t usage, const bool has_alpha, const TextureCompression compression)
+{
+	const bool color = usage & (LoadedImage::Albedo | LoadedImage::Emissive);
+	if ( TextureCompression::None == compression )
+	{
+		return color ? LoadedImage::Format::Rgba8Srgb : LoadedImage::Format::Rgba8Unorm;
+	}
+
+	const bool bc7 = TextureCompression::Bc7 == compression;
+	if ( color )
+	{
+		if ( bc7 )
+		{
+			return LoadedImage::Format::Bc7Srgb;
+		}
+		return has_alpha ? LoadedImage::Format::Bc3Srgb : LoadedImage::Format::Bc1Srgb;
+	}
+	if ( LoadedImage::Normal == usage )
+	{
+		// z is rebuilt from xy in the shader
+		return LoadedImage::Format::Bc5Unorm;
+	}
+	if ( LoadedImage::Occlusion == usage )
+	{
+		return LoadedImage::Format::Bc4Unorm;
+	}
+	if ( usage & (LoadedImage::MetalRoughness | LoadedImage::Occlusion) )
+	{
+		return bc7 ? LoadedImage::Format::Bc7Unorm : LoadedImage::Format::Bc1Unorm;
+	}
+	// unreferenced images and normal maps shared with other slots stay lossless
+	return LoadedImage::Format::Rgba8Unorm;
+}
+
+bool Anni::ModelLoader::TextureProcessor::IsSrgb(const LoadedImage::Format format)
+{
+	return LoadedImage::Format::Rgba8Srgb == format || LoadedImage::Format::Bc1Srgb == format || LoadedImage::Format::Bc3Srgb == format || LoadedImage::Format::Bc7Srgb == format;
+}
+
+uint32_t Anni::ModelLoader::TextureProcessor::GetBlockSize(const LoadedImage::Format format)
+{
+	switch ( format )
+	{
+		case LoadedImage::Format::Bc1Unorm:
+		case LoadedImage::Format::Bc1Srgb:
+		case LoadedImage::Format::Bc4Unorm:
+			return 8;
+		case LoadedImage::Format::Bc3Unorm:
+		case LoadedImage::Format::Bc3Srgb:
+		case LoadedImage::Format::Bc5Unorm:
+		case LoadedImage::Format::Bc7Unorm:
+		case LoadedImage::Format::Bc7Srgb:
+			return 16;
+		default:
+			return 0;
+	}
+}
+
+uint64_t Anni::ModelLoader::TextureProcessor::GetLevelSize(const LoadedImage::Format format, const uint32_t width, const uint32_t height)
+{
+	const uint32_t block_size = GetBlockSize(format);
+	if ( 0 == block_size )
+	{
+		return static_cast<uint64_t>(width) * height * 4;
+	}
+	return static_cast<uint64_t>((width + 3) / 4) * ((height + 3) / 4) * block_size;
+}
+
+void Anni::ModelLoader::TextureProcessor::Process(LoadedImage& image, const bool generate_mipmaps, const TextureCompression compression)
+{
+	if ( image.raw_data.empty() || !image.width.has_value() || !image.height.has_value() )
+	{
+		return;
+	}
+	const uint32_t width = image.width.value();
+	const uint32_t height = image.height.value();
+
+	bool has_alpha = false;
+	if ( TextureCompression::Bc == compression && (image.usage & LoadedImage::Albedo) )
+	{
+		for ( size_t alpha_offset = 3; alpha_offset < image.raw_data.size() && !has_alpha; alpha_offset += 4 )
+		{
+			has_alpha = image.raw_data[alpha_offset] != 255;
+		}
+	}
+	const LoadedImage::Format format = ChooseFormat(image.usage, has_alpha, compression);
+	const bool srgb = IsSrgb(format);
+	const bool normal_map = LoadedImage::Normal == image.usage;
+
+	//> MIP CHAIN
+	std::vector<LoadedImage::MipLevel> rgba_levels{ { width, height, 0, GetLevelSize(LoadedImage::Format::Rgba8Unorm, width, height) } };
+	while ( generate_mipmaps && (rgba_levels.back().width > 1 || rgba_levels.back().height > 1) )
+	{
+		const LoadedImage::MipLevel& previous = rgba_levels.back();
+		const uint32_t level_width = std::max(1u, previous.width / 2);
+		const uint32_t level_height = std::max(1u, previous.height / 2);
+		rgba_levels.push_back({ level_width, level_height, previous.offset + previous.size, GetLevelSize(LoadedImage::Format::Rgba8Unorm, level_width, level_height) });
+	}
+
+	std::vector<uint8_t> rgba_data = std::move(image.raw_data);
+	rgba_data.resize(rgba_levels.back().offset + rgba_levels.back().size);
+	for ( size_t level = 1; level < rgba_levels.size(); ++level )
+	{
+		const LoadedImage::MipLevel& source = rgba_levels[level - 1];
+		const LoadedImage::MipLevel& destination = rgba_levels[level];
+		DownsampleLevel(std::span<const uint8_t>(rgba_data).subspan(source.offset, source.size), source.width, source.height,
+			std::span<uint8_t>(rgba_data).subspan(destination.offset, destination.size), srgb, normal_map);
+	}
+
+	image.format = format;
+	image.mipmap_size = static_cast<uint32_t>(rgba_levels.size());
+	const uint32_t block_size = GetBlockSize(format);
+	if ( 0 == block_size )
+	{
+		image.raw_data = std::move(rgba_data);
+		image.mip_levels = std::move(rgba_levels);
+		return;
+	}
+
+	//> BLOCK COMPRESSION
+	std::vector<LoadedImage::MipLevel> compressed_levels;
+	compressed_levels.reserve(rgba_levels.size());
+	// every block row of every level is one work item
+	std::vector<std::pair<uint32_t, uint32_t>> block_rows;
+	uint64_t compressed_size = 0;
+	for ( const auto [level_index, level] : std::ranges::views::enumerate(rgba_levels) )
+	{
+		compressed_levels.push_back({ level.width, level.height, compressed_size, GetLevelSize(format, level.width, level.height) });
+		compressed_size += compressed_levels.back().size;
+		for ( uint32_t block_row = 0; block_row < (level.height + 3) / 4; ++block_row )
+		{
+			block_rows.emplace_back(static_cast<uint32_t>(level_index), block_row);
+		}
+	}
+
+	std::vector<uint8_t> compressed_data(compressed_size);
+	ThreadPool::Shared().ParallelFor(block_rows.size(), [&](const size_t item)
+	{
+		const auto [level_index, block_row] = block_rows[item];
+		const LoadedImage::MipLevel& source = rgba_levels[level_index];
+		const uint32_t blocks_per_row = (source.width + 3) / 4;
+		uint8_t* output = compressed_data.data() + compressed_levels[level_index].offset + static_cast<uint64_t>(block_row) * blocks_per_row * block_size;
+
+		std::array<uint8_t, texels_per_block * 4> texels{};
+		for ( uint32_t block_column = 0; block_column < blocks_per_row; ++block_column, output += block_size )
+		{
+			// partial blocks at the right and bottom edges repeat the last texel
+			for ( uint32_t y = 0; y < 4; ++y )
+			{
+				const uint32_t source_y = std::min(block_row * 4 + y, source.height - 1);
+				for ( uint32_t x = 0; x < 4; ++x )
+				{
+					const uint32_t source_x = std::min(block_column * 4 + x, source.width - 1);
+					memcpy(texels.data() + (y * 4 + x) * 4, rgba_data.data() + source.offset + (static_cast<uint64_t>(source_y) * source.width + source_x) * 4, 4);
+				}
+			}
+
+			switch ( format )
+			{
+				case LoadedImage::Format::Bc1Unorm:
+				case LoadedImage::Format::Bc1Srgb:
+					EncodeBc1Block(texels.data(), output);
+					break;
+				case LoadedImage::Format::Bc3Unorm:
+				case LoadedImage::Format::Bc3Srgb:
+					EncodeBc3Block(texels.data(), output);
+					break;
+				case LoadedImage::Format::Bc4Unorm:
+					EncodeBc4Block(texels.data(), 0, output);
+					break;
+				case LoadedImage::Format::Bc5Unorm:
+					EncodeBc5Block(texels.data(), output);
+					break;
+				default:
+					EncodeBc7Block(texels.data(), output);
+					break;
+			}
+		}
+	});
+
+	image.raw_data = std::move(compressed_data);
+	image.mip_levels = std::move(compressed_levels);
+}
+
+void Anni::ModelLoader::TextureProcessor::DownsampleLevel(const std::span<const uint8_t> source, const uint32_t source_width, const uint32_t source_height, const std::span<uint8_t> destination, const bool srgb, const bool normal_map)
+{
+	const uint32_t width = std::max(1u, source_width / 2);
+	const uint32_t height = std::max(1u, source_height / 2);
+	const SrgbTables& tables = GetSrgbTables();
+
+	const auto downsample_band = [&](const size_t band)
+	{
+		const auto row_begin = static_cast<uint32_t>(band * rows_per_band);
+		const uint32_t row_end = std::min(height, row_begin + rows_per_band);
+		for ( uint32_t y = row_begin; y < row_end; ++y )
+		{
+			const uint8_t* row0 = source.data() + static_cast<size_t>(std::min(y * 2, source_height - 1)) * source_width * 4;
+			const uint8_t* row1 = source.data() + static_cast<size_t>(std::min(y * 2 + 1, source_height - 1)) * source_width * 4;
+			uint8_t* output = destination.data() + static_cast<size_t>(y) * width * 4;
+			for ( uint32_t x = 0; x < width; ++x )
+			{
+				const size_t x0 = static_cast<size_t>(std::min(x * 2, source_width - 1)) * 4;
+				const size_t x1 = static_cast<size_t>(std::min(x * 2 + 1, source_width - 1)) * 4;
+				AverageTexels({ row0 + x0, row0 + x1, row1 + x0, row1 + x1 }, srgb, normal_map, tables, output + static_cast<size_t>(x) * 4);
+			}
+		}
+	};
+
+	const size_t band_count = (height + rows_per_band - 1) / rows_per_band;
+	if ( band_count > 1 )
+	{
+		ThreadPool::Shared().ParallelFor(band_count, downsample_band);
+	}
+	else
+	{
+		downsample_band(0);
+	}
+}
+
+void Anni::ModelLoader::TextureProcessor::EncodeBc1Block(const uint8_t* texels, uint8_t* output)
+{
+	EncodeColorBlock(texels, output);
+}
+
+void Anni::ModelLoader::TextureProcessor::EncodeBc3Block(const uint8_t* texels, uint8_t* output)
+{
+	EncodeBc4Block(texels, 3, output);
+	EncodeColorBlock(texels, output + 8);
+}
+
+void Anni::ModelLoader::TextureProcessor::EncodeBc4Block(const uint8_t* texels, const uint32_t channel, uint8_t* output)
+{
+	uint8_t lower = 255;
+	uint8_t upper = 0;
+	for ( uint32_t i = 0; i < texels_per_block; ++i )
+	{
+		lower = std::min(lower, texels[i * 4 + channel]);
+		upper = std::max(upper, texels[i * 4 + channel]);
+	}
+
+	// eight value mode: index 0 is the upper end, 1 the lower end, 2..7 step from upper to lower
+	output[0] = upper;
+	output[1] = lower;
+	uint64_t indices = 0;
+	if ( upper != lower )
+	{
+		const float steps_per_value = 7.f / static_cast<float>(upper - lower);
+		for ( uint32_t i = 0; i < texels_per_block; ++i )
+		{
+			const auto step = static_cast<uint64_t>(std::lround(static_cast<float>(upper - texels[i * 4 + channel]) * steps_per_value));
+			const uint64_t index = 0 == step ? 0 : 7 == step ? 1 : step + 1;
+			indices |= index << (i * 3);
+		}
+	}
+	for ( uint32_t byte = 0; byte < 6; ++byte )
+	{
+		output[2 + byte] = static_cast<uint8_t>(indices >> (byte * 8));
+	}
+}
+
+void Anni::ModelLoader::TextureProcessor::EncodeBc5Block(const uint8_t* texels, uint8_t* output)
+{
+	EncodeBc4Block(texels, 0, output);
+	EncodeBc4Block(texels, 1, output + 8);
+}
+
+void Anni::ModelLoader::TextureProcessor::EncodeBc7Block(const uint8_t* texels, uint8_t* output)
+{
+	const BlockPoints points = LoadBlockPoints(texels, 4);
+	const auto [first, second] = FitPrincipalAxis(points);
+	Bc7Block best = SelectBc7Indices(points, first, second);
+
+	std::array<float, texels_per_block> weights{};
+	for ( uint32_t i = 0; i < texels_per_block; ++i )
+	{
+		weights[i] = 1.f - static_cast<float>(bc7_weights[best.indices[i]]) / 64.f;
+	}
+	Endpoint refined_first{}, refined_second{};
+	if ( FitEndpoints(points, weights, refined_first, refined_second) )
+	{
+		const Bc7Block refined = SelectBc7Indices(points, refined_first, refined_second);
+		if ( refined.error < best.error )
+		{
+			best = refined;
+		}
+	}
+
+	// the anchor index drops its top bit, so it has to be in the first half
+	if ( best.indices[0] >= 8 )
+	{
+		std::swap(best.endpoint0, best.endpoint1);
+		for ( uint32_t& index : best.indices )
+		{
+			index = 15 - index;
+		}
+	}
+
+	BlockBitWriter writer;
+	writer.Write(1u << 6, 7);
+	for ( uint32_t channel = 0; channel < 4; ++channel )
+	{
+		writer.Write(best.endpoint0.quantized[channel], 7);
+		writer.Write(best.endpoint1.quantized[channel], 7);
+	}
+	writer.Write(best.endpoint0.p_bit, 1);
+	writer.Write(best.endpoint1.p_bit, 1);
+	writer.Write(best.indices[0], 3);
+	for ( uint32_t i = 1; i < texels_per_block; ++i )
+	{
+		writer.Write(best.indices[i], 4);
+	}
+	writer.CopyTo(output);
+}
@@ -0,0 +1,66 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+
+Anni::ModelLoader::ThreadPool::ThreadPool(const uint32_t num_workers)
+{
+	m_workers.reserve(num_workers);
+	for ( uint32_t i = 0; i < num_workers; ++i )
+	{
+		m_workers.emplace_back([this](std::stop_token stop_token) { WorkerLoop(stop_token); });
+	}
+}
+
+Anni::ModelLoader::ThreadPool::~ThreadPool()
+{
+	for ( auto& worker : m_workers )
+	{
+		worker.request_stop();
+	}
+	m_queue_cv.notify_all();
+	// jthread joins on destruction, queued jobs are drained before the workers leave
+	m_workers.clear();
+}
+
+uint32_t Anni::ModelLoader::ThreadPool::GetWorkerCount() const
+{
+	return static_cast<uint32_t>(m_workers.size());
+}
+
+Anni::ModelLoader::ThreadPool& Anni::ModelLoader::ThreadPool::Shared()
+{
+	static ThreadPool shared_pool(std::max(1u, std::thread::hardware_concurrency()));
+	return shared_pool;
+}
+
+void Anni::ModelLoader::ThreadPool::Enqueue(std::function<void()> job, const Priority priority)
+{
+	{
+		std::scoped_lock lock(m_queue_mutex);
+		m_jobs[static_cast<size_t>(priority)].push_back(std::move(job));
+	}
+	m_queue_cv.notify_one();
+}
+
+void Anni::ModelLoader::ThreadPool::WorkerLoop(const std::stop_token stop_token)
+{
+	while ( true )
+	{
+		std::function<void()> job;
+		{
+			std::unique_lock lock(m_queue_mutex);
+			const auto has_job = [this]() { return std::ranges::any_of(m_jobs, [](const auto& jobs) { return !jobs.empty(); }); };
+			m_queue_cv.wait(lock, stop_token, has_job);
+			if ( !has_job() )
+			{
+				// woken by a stop request with nothing left to do
+				return;
+			}
+			auto& jobs = *std::ranges::find_if(m_jobs, [](const auto& queued_jobs) { return !queued_jobs.empty(); });
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+		job();
+	}
+}
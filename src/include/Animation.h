@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <span>
+
+#include "ModelsLoader.h"
+
+
+namespace Anni::ModelLoader
+{
+	// evaluates LoadedAnimation channels into an AnimationPose. translation, scale and rotation channels are gathered into groups
+	// of four and interpolated together in SSE registers, rotations with an nlerp whose parameter is corrected to follow slerp
+	// (within 0.1 degrees of it, plain nlerp is off by up to 8)
+	class AnimationSampler
+	{
+	public:
+		AnimationSampler() = delete;
+
+		// channels interpolated at once
+		static constexpr uint32_t batch_size = 4;
+
+		// every channel of animation at time into pose, which starts out as a copy of LoadedModel::GetRestPose() or an earlier
+		// sample. time is clamped to each channel's keys, looping is up to the caller
+		static void Sample(const LoadedAnimation& animation, float time, AnimationPose& pose);
+		// one channel with an exact slerp, the reference the batched path is checked against. output takes component_count floats
+		static void SampleChannel(const LoadedAnimation& animation, const AnimationChannel& channel, float time, std::span<float> output);
+		// local transforms of the nodes the animation targets, marked dirty for FlatScene::UpdateDirtyTransforms
+		static void ApplyPose(const LoadedAnimation& animation, const AnimationPose& pose, FlatScene& scene);
+	};
+
+	// linear blend skinning on the CPU, to validate a GPU skinning pass against or for CPU side queries on animated meshes
+	class Skinning
+	{
+	public:
+		Skinning() = delete;
+
+		// joint j's matrix takes the bind pose mesh into where the joints moved it, still relative to the node that draws the mesh
+		// (flat_node_index), so the skinned mesh is drawn with that node's world transform like any other
+		static void ComputeJointMatrices(const LoadedSkin& skin, const FlatScene& scene, uint32_t flat_node_index, std::span<glm::mat4> joint_matrices);
+		// positions, normals and tangents weighted by up to four joint matrices, other attributes are copied.
+		// expects the interleaved LoadedVertex array and its MeshBuffer::skin_vertices(no LoadOptions::vertex_layout)
+		static void SkinVertices(std::span<const LoadedVertex> vertices, std::span<const LoadedSkinVertex> skin_vertices, std::span<const glm::mat4> joint_matrices, std::span<LoadedVertex> skinned_vertices);
+	};
+}
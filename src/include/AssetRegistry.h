@@ -0,0 +1,85 @@
+#pragma once
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ModelsLoader.h"
+
+
+namespace Anni::ModelLoader
+{
+	// one placement of a shared model. copies are cheap, they only add a reference to the model
+	class ModelInstance
+	{
+	public:
+		ModelInstance() = default;
+		ModelInstance(std::shared_ptr<const LoadedModel> model, const glm::mat4& transform);
+
+		[[nodiscard]] bool IsValid() const;
+		[[nodiscard]] const LoadedModel* GetModel() const;
+		[[nodiscard]] const glm::mat4& GetTransform() const;
+		void SetTransform(const glm::mat4& transform);
+
+		// with a view projection matrix everything outside of the view is left out
+		void PreDrawToContext(DrawContext& ctx, const glm::mat4* view_projection = nullptr) const;
+
+	private:
+		std::shared_ptr<const LoadedModel> m_model;
+		glm::mat4 m_transform{ 1.f };
+	};
+
+	// loads every file once and hands the same immutable model to all of its users. models stay registered until
+	// ReleaseUnused finds nobody outside the registry holding them
+	class AssetRegistry
+	{
+	public:
+		struct AssetInfo
+		{
+			std::filesystem::path file_path;
+			// instances and other shared_ptr holders, the registry's own reference not included
+			size_t holder_count;
+			ModelMemoryUsage memory;
+		};
+
+		explicit AssetRegistry(LoadOptions options = {});
+
+		AssetRegistry(const AssetRegistry&) = delete;
+		AssetRegistry(AssetRegistry&&) = delete;
+		AssetRegistry& operator=(const AssetRegistry&) = delete;
+		AssetRegistry& operator=(AssetRegistry&&) = delete;
+
+		// the first call for a file loads it(with the registry's options), later and concurrent calls share that model.
+		// a failed load isn't registered, the concurrent calls get the same error and the next call tries again
+		LoadResult<std::shared_ptr<const LoadedModel>> Acquire(const std::filesystem::path& file_path);
+		// an invalid instance if the model failed to load
+		ModelInstance Instantiate(const std::filesystem::path& file_path, const glm::mat4& transform = glm::mat4{ 1.f });
+		[[nodiscard]] bool Contains(const std::filesystem::path& file_path) const;
+
+		// unloads the models nobody holds anymore, returns how many went
+		size_t ReleaseUnused();
+
+		[[nodiscard]] std::vector<AssetInfo> GetAssets() const;
+		// every loaded model once, pixels shared between models(texture cache entries) once as well
+		[[nodiscard]] ModelMemoryUsage GetMemoryUsage() const;
+
+	private:
+		struct Asset
+		{
+			std::filesystem::path file_path;
+			// only ever holds a loaded model once it is ready, failed loads are erased before their promise is set
+			std::shared_future<LoadResult<std::shared_ptr<const LoadedModel>>> model;
+			ModelMemoryUsage memory;
+		};
+
+		// canonical path, so different spellings of one file end up in the same asset
+		static std::string GetAssetKey(const std::filesystem::path& file_path);
+
+		LoadOptions m_options;
+		mutable std::mutex m_mutex;
+		std::unordered_map<std::string, Asset> m_assets;
+	};
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <span>
+
+#include "ModelsLoader.h"
+
+
+namespace Anni::ModelLoader
+{
+	// KTX2 textures, plain or KHR_texture_basisu. block compressed and RGBA8 levels are copied as they are stored(after zlib or
+	// zstd supercompression), Basis Universal payloads(ETC1S/BasisLZ and UASTC) are transcoded when the library is built with
+	// MODELS_LOADER_WITH_BASISU. either way the file's mip chain and array layers are kept, nothing goes through RGBA8 first
+	class Ktx2Decoder
+	{
+	public:
+		Ktx2Decoder() = delete;
+
+		// checks the 12 byte identifier
+		static bool IsKtx2(std::span<const uint8_t> bytes);
+		// whether Basis Universal payloads and zstd supercompression can be decoded in this build
+		static bool CanTranscodeBasis();
+
+		// sets width, height, array_size, mipmap_size, num_channels, format, raw_data and mip_levels. Basis payloads become the
+		// format TextureProcessor::ChooseFormat picks for image.usage and compression(RGBA8 for TextureCompression::None), every
+		// level and layer a job on the shared pool. stored levels keep their format whatever compression asks for, so without
+		// MODELS_LOADER_WITH_BASISU compression isn't used at all.
+		// what isn't supported comes back as UnsupportedTexture: cube maps, volumes, VkFormats LoadedImage has no format for,
+		// BasisLZ on stored levels, and Basis payloads or zstd supercompression without MODELS_LOADER_WITH_BASISU. broken files
+		// are TextureDecodeFailed, nothing is logged either way
+		static LoadResult<void> Decode(std::span<const uint8_t> bytes, TextureCompression compression, LoadedImage& image);
+	};
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+
+namespace Anni::ModelLoader
+{
+	// collects timed spans from any thread, e.g. as LoadOptions::trace_recorder. the result opens in chrome://tracing or Perfetto
+	class TraceRecorder
+	{
+	public:
+		struct Event
+		{
+			std::string name;
+			std::string_view category;
+			// microseconds since the recorder was created
+			uint64_t start_us{ 0 };
+			uint64_t duration_us{ 0 };
+			// small ids in order of first appearance, not the OS thread ids
+			uint32_t thread_id{ 0 };
+		};
+
+		TraceRecorder();
+
+		TraceRecorder(const TraceRecorder&) = delete;
+		TraceRecorder(TraceRecorder&&) = delete;
+		TraceRecorder& operator=(const TraceRecorder&) = delete;
+		TraceRecorder& operator=(TraceRecorder&&) = delete;
+
+		// category has to be a literal(or outlive the recorder)
+		void Record(std::string name, std::string_view category, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+		void Clear();
+
+		[[nodiscard]] std::vector<Event> GetEvents() const;
+		// trace event format, complete("X") events only
+		[[nodiscard]] std::string ToChromeJson() const;
+		bool WriteChromeJson(const std::filesystem::path& file_path) const;
+
+	private:
+		mutable std::mutex m_mutex;
+		const std::chrono::steady_clock::time_point m_epoch;
+		std::vector<Event> m_events;
+		std::unordered_map<std::thread::id, uint32_t> m_thread_ids;
+	};
+
+	// records the time between construction and destruction, does nothing without a recorder
+	class TraceSpan
+	{
+	public:
+		TraceSpan(TraceRecorder* recorder, std::string name, std::string_view category = "load");
+		~TraceSpan();
+
+		TraceSpan(const TraceSpan&) = delete;
+		TraceSpan(TraceSpan&&) = delete;
+		TraceSpan& operator=(const TraceSpan&) = delete;
+		TraceSpan& operator=(TraceSpan&&) = delete;
+
+	private:
+		TraceRecorder* const m_recorder;
+		std::string m_name;
+		const std::string_view m_category;
+		std::chrono::steady_clock::time_point m_start;
+	};
+}
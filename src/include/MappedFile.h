@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+
+
+namespace Anni::ModelLoader
+{
+	// read only memory mapping of a whole file, the bytes stay valid for the lifetime of the object
+	class MappedFile
+	{
+	public:
+		~MappedFile();
+		MappedFile(const MappedFile&) = delete;
+		MappedFile(MappedFile&&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile& operator=(MappedFile&&) = delete;
+
+		// returns nullptr if the file can't be opened or mapped
+		static std::shared_ptr<MappedFile> Open(const std::filesystem::path& file_path);
+
+		[[nodiscard]] std::span<const uint8_t> GetBytes() const;
+
+	private:
+		MappedFile() = default;
+
+		const uint8_t* m_data{ nullptr };
+		size_t m_size{ 0 };
+#if defined(_WIN32)
+		void* m_file_handle{ nullptr };
+		void* m_mapping_handle{ nullptr };
+#endif
+	};
+}
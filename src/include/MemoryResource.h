@@ -0,0 +1,100 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+
+
+namespace Anni::ModelLoader
+{
+	// monotonic arena that can be shared between threads. memory is taken from upstream in blocks and only given back all at
+	// once, by Release or the destructor. deallocating the latest allocation rolls it back, short lived temporaries don't pile up
+	class ArenaMemoryResource final : public std::pmr::memory_resource
+	{
+	public:
+		static constexpr size_t default_block_size = 1 << 20;
+
+		explicit ArenaMemoryResource(std::pmr::memory_resource* upstream = nullptr, size_t block_size = default_block_size);
+		~ArenaMemoryResource() override;
+
+		ArenaMemoryResource(const ArenaMemoryResource&) = delete;
+		ArenaMemoryResource(ArenaMemoryResource&&) = delete;
+		ArenaMemoryResource& operator=(const ArenaMemoryResource&) = delete;
+		ArenaMemoryResource& operator=(ArenaMemoryResource&&) = delete;
+
+		// everything allocated from the arena is gone afterwards
+		void Release();
+
+		[[nodiscard]] std::pmr::memory_resource* GetUpstream() const;
+		// bytes taken from upstream, block headers included
+		[[nodiscard]] uint64_t GetReservedBytes() const;
+		[[nodiscard]] uint64_t GetUsedBytes() const;
+		[[nodiscard]] uint32_t GetBlockCount() const;
+
+	private:
+		// at the start of every upstream allocation
+		struct Block
+		{
+			Block* previous;
+			size_t size;
+			size_t alignment;
+		};
+
+		void* do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+		[[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+		Block* AllocateBlock(size_t size, size_t alignment);
+
+		mutable std::mutex m_mutex;
+		std::pmr::memory_resource* const m_upstream;
+		const size_t m_block_size;
+		Block* m_blocks{ nullptr };
+		// free part of the current block
+		std::byte* m_cursor{ nullptr };
+		std::byte* m_end{ nullptr };
+		// the latest allocation, the only one a deallocate can roll back
+		std::byte* m_last_allocation{ nullptr };
+		uint64_t m_reserved_bytes{ 0 };
+		uint64_t m_used_bytes{ 0 };
+		uint32_t m_block_count{ 0 };
+	};
+
+	// forwards to upstream and counts what goes through, e.g. as LoadOptions::memory_resource to see what a load allocates
+	class CountingMemoryResource final : public std::pmr::memory_resource
+	{
+	public:
+		struct Stats
+		{
+			uint64_t allocation_count{ 0 };
+			uint64_t deallocation_count{ 0 };
+			uint64_t allocated_bytes{ 0 };
+			uint64_t live_bytes{ 0 };
+			uint64_t peak_live_bytes{ 0 };
+		};
+
+		explicit CountingMemoryResource(std::pmr::memory_resource* upstream = nullptr);
+
+		CountingMemoryResource(const CountingMemoryResource&) = delete;
+		CountingMemoryResource(CountingMemoryResource&&) = delete;
+		CountingMemoryResource& operator=(const CountingMemoryResource&) = delete;
+		CountingMemoryResource& operator=(CountingMemoryResource&&) = delete;
+
+		[[nodiscard]] Stats GetStats() const;
+		// live bytes are kept, they are still owed to upstream
+		void ResetStats();
+
+	private:
+		void* do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+		[[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+		std::pmr::memory_resource* const m_upstream;
+		std::atomic<uint64_t> m_allocation_count{ 0 };
+		std::atomic<uint64_t> m_deallocation_count{ 0 };
+		std::atomic<uint64_t> m_allocated_bytes{ 0 };
+		std::atomic<uint64_t> m_live_bytes{ 0 };
+		std::atomic<uint64_t> m_peak_live_bytes{ 0 };
+	};
+}
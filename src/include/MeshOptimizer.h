@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+#include "ModelsLoader.h"
+
+
+namespace Anni::ModelLoader
+{
+	// load time index/vertex reordering. triangles never leave their HomoMatTris range, so draw ranges and bounds stay valid.
+	class MeshOptimizer
+	{
+	public:
+		MeshOptimizer() = delete;
+
+		// size of the FIFO cache used to measure ACMR, close to what current hardware effectively gets
+		static constexpr uint32_t simulated_cache_size = 16;
+
+		// deduplicate, vertex cache order, overdraw order, vertex fetch order. expects the interleaved LoadedVertex array
+		static MeshOptimizationReport Optimize(LoadedMeshAsset& mesh_asset);
+
+		// merges bitwise identical vertices and rewrites the indices, returns the new vertex count. skin_vertices is either
+		// empty or one per vertex, it is compacted along with vertices
+		static size_t DeduplicateVertices(std::pmr::vector<LoadedVertex>& vertices, std::pmr::vector<LoadedSkinVertex>& skin_vertices, std::span<uint32_t> indices);
+		// Forsyth's linear speed vertex cache optimization of one triangle list
+		static void OptimizeVertexCache(std::span<uint32_t> indices, size_t vertex_count);
+		// splits a cache ordered triangle list into clusters at cold cache restarts and draws the outward facing clusters first
+		static void OptimizeOverdraw(std::span<uint32_t> indices, std::span<const glm::vec3> positions);
+		// renumbers vertices in first use order and drops unreferenced ones
+		static void OptimizeVertexFetch(std::pmr::vector<LoadedVertex>& vertices, std::pmr::vector<LoadedSkinVertex>& skin_vertices, std::span<uint32_t> indices);
+		static uint64_t SimulateVertexCache(std::span<const uint32_t> indices, size_t vertex_count, uint32_t cache_size = simulated_cache_size);
+
+		//> LEVEL OF DETAIL(see MeshLod.cpp)
+		// meshlet triangles store local vertex indices in one byte
+		static constexpr uint32_t meshlet_vertex_limit = 256;
+
+		// one simplified level per ratio(sorted coarser and coarser), appended to the mesh's index buffer
+		static void BuildLodChain(LoadedMeshAsset& mesh_asset, std::span<const float> lod_ratios);
+		// quadric error edge collapse of one triangle list, simplified lists are written to output_levels[i] once at most
+		// target_index_counts[i] indices are left. returns the error reached for every level, a level that can't get to its target
+		// gets the best result. border and attribute seam vertices never move.
+		static std::vector<float> SimplifyIndices(std::span<const uint32_t> indices, std::span<const LoadedVertex> vertices, std::span<const size_t> target_index_counts, std::vector<std::vector<uint32_t>>& output_levels);
+		static void BuildMeshlets(LoadedMeshAsset& mesh_asset, uint32_t max_vertices, uint32_t max_triangles);
+	};
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+
+namespace Anni::ModelLoader
+{
+	// EXT_meshopt_compression bitstreams: meshoptimizer's vertex codec(version 0), index codec(versions 0 and 1), index sequence
+	// codec and the three filters. malformed data makes a decode return false, nothing is read past the source
+	class MeshoptDecoder
+	{
+	public:
+		MeshoptDecoder() = delete;
+
+		enum class Mode : uint8_t
+		{
+			Attributes,
+			// triangle list indices
+			Triangles,
+			// any other index sequence
+			Indices,
+		};
+
+		// turn the decoded attributes back into what the accessors expect, after the codec and in place
+		enum class Filter : uint8_t
+		{
+			None,
+			// snorm8/snorm16 xyz(w untouched) from two octahedral coordinates
+			Octahedral,
+			// snorm16 xyzw from the three smallest components and the index of the largest
+			Quaternion,
+			// 32 bit floats from a 24 bit mantissa and an 8 bit exponent
+			Exponential,
+		};
+
+		// count elements of stride bytes, destination takes count * stride bytes. checks the stride/filter combinations the
+		// extension allows
+		static bool Decode(Mode mode, Filter filter, std::span<const uint8_t> source, size_t count, size_t stride, std::span<uint8_t> destination);
+
+		// stride is a multiple of 4 up to 256
+		static bool DecodeVertexBuffer(std::span<const uint8_t> source, size_t count, size_t stride, std::span<uint8_t> destination);
+		// index_size is 2 or 4, count a multiple of 3
+		static bool DecodeIndexBuffer(std::span<const uint8_t> source, size_t count, size_t index_size, std::span<uint8_t> destination);
+		static bool DecodeIndexSequence(std::span<const uint8_t> source, size_t count, size_t index_size, std::span<uint8_t> destination);
+		static void ApplyFilter(Filter filter, size_t count, size_t stride, std::span<uint8_t> data);
+	};
+}
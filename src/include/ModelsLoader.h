@@ -1,6 +1,22 @@
 ﻿#pragma once
+#include <array>
+#include <atomic>
+#include <compare>
+#include <condition_variable>
+#include <expected>
 #include <filesystem>
+#include <functional>
+#include <future>
+#include <memory_resource>
+#include <mutex>
 #include <ranges>
+#include <span>
+#include <stop_token>
+#include <string_view>
+
+#include "LoadTrace.h"
+#include "MemoryResource.h"
+#include "ThreadPool.h"
 
 #include "fastgltf/core.hpp"
 #include "fastgltf/types.hpp"
@@ -16,6 +32,9 @@
 
 namespace Anni::ModelLoader
 {
+	class MappedFile;
+	class AsyncModelLoad;
+
 	struct LoadedSampler
 	{
 		enum class SamplerType : std::uint16_t
@@ -42,12 +61,58 @@ namespace Anni::ModelLoader
 
 	struct LoadedImage
 	{
+		enum class Format : uint8_t
+		{
+			Rgba8Unorm,
+			Rgba8Srgb,
+			Bc1Unorm,
+			Bc1Srgb,
+			Bc3Unorm,
+			Bc3Srgb,
+			Bc4Unorm,
+			Bc5Unorm,
+			Bc7Unorm,
+			Bc7Srgb,
+		};
+
+		// material slots that sample the image, filled by LoadMaterials
+		enum UsageBits : uint32_t
+		{
+			Albedo = 1u << 0,
+			MetalRoughness = 1u << 1,
+			Normal = 1u << 2,
+			Emissive = 1u << 3,
+			Occlusion = 1u << 4,
+		};
+
+		// byte range of one level inside GetData()
+		struct MipLevel
+		{
+			uint32_t width;
+			uint32_t height;
+			uint64_t offset;
+			uint64_t size;
+		};
+
 		LoadedImage(std::string file_name_);
 		std::optional<std::string> file_name;
+		std::optional<uint32_t> width;
+		std::optional<uint32_t> height;
 		std::optional<uint32_t> array_size;
 		std::optional<uint32_t> mipmap_size;
 		std::optional<uint32_t> num_channels;
 		std::vector<uint8_t> raw_data;
+
+		uint32_t usage{ 0 };
+		Format format{ Format::Rgba8Unorm };
+		// level 0 first, empty until the image is decoded
+		std::vector<MipLevel> mip_levels;
+
+		// pixels that live outside of raw_data(e.g. inside a mapped cooked file), the owner keeps them alive
+		std::shared_ptr<const void> external_owner;
+		std::span<const uint8_t> external_data;
+
+		[[nodiscard]] std::span<const uint8_t> GetData() const;
 	};
 
 	struct LoadedMaterialConstant
@@ -65,6 +130,8 @@ namespace Anni::ModelLoader
 		std::optional<float> alpha_cutoff;
 		std::array<float, 4> base_color_factors;
 
+		// a texture without a sampler leaves its sampler index empty, which means glTF's default sampler(repeat, filtering up
+		// to the renderer)
 		std::optional<uint32_t> albedo_index;
 		std::optional<uint32_t> albedo_sampler_index;
 
@@ -90,6 +157,212 @@ namespace Anni::ModelLoader
 		glm::vec3 normal;
 		glm::vec2 uv;
 	};
+	static_assert(sizeof(LoadedVertex) == 64, "skinning attributes live in LoadedSkinVertex, keep the common vertex at one cache line");
+
+	// JOINTS_0/WEIGHTS_0 of one vertex, kept next to the LoadedVertex array only by meshes that have them.
+	// joints index into the skin of the node drawing the mesh, all weights are 0 on vertices of unskinned primitives
+	struct LoadedSkinVertex
+	{
+		glm::vec4 weights;
+		std::array<uint16_t, 4> joints;
+	};
+
+	// describes how vertices are packed into one or more streams, attributes inside a stream are interleaved in AttributeBits order.
+	// presets are constexpr so a renderer can pin its layout at compile time, e.g. constexpr auto shadow_layout = VertexLayout::PositionOnly();
+	struct VertexLayout
+	{
+		enum AttributeBits : uint32_t
+		{
+			Position = 1u << 0,
+			Normal = 1u << 1,
+			Tangent = 1u << 2,
+			Uv = 1u << 3,
+			Color = 1u << 4,
+			Joints = 1u << 5,
+			Weights = 1u << 6,
+			Skin = Joints | Weights,
+			All = Position | Normal | Tangent | Uv | Color | Joints | Weights,
+		};
+
+		// opt-in compact encodings, applied while packing streams
+		struct Quantization
+		{
+			enum class UvFormat : std::uint16_t
+			{
+				Float,
+				Half,
+				Unorm16, // dequantized with LoadedMeshAsset::Dequantization::uv_scale/uv_offset
+			};
+
+			// unorm16 xyz + one padding short, dequantized with LoadedMeshAsset::Dequantization::position_scale/position_offset
+			bool positions{ false };
+			// snorm16x2 octahedral normal and tangent, the tangent handedness is the lowest bit of its second component
+			bool octahedral_normals{ false };
+			UvFormat uvs{ UvFormat::Float };
+			bool unorm8_colors{ false };
+			// unorm16x4 weights, rounded so every vertex's weights still add up to exactly 65535
+			bool unorm16_weights{ false };
+
+			[[nodiscard]] constexpr bool IsEnabled() const
+			{
+				return positions || octahedral_normals || uvs != UvFormat::Float || unorm8_colors || unorm16_weights;
+			}
+		};
+
+		static constexpr uint32_t max_streams = 4;
+
+		uint32_t stream_count{ 0 };
+		std::array<uint32_t, max_streams> stream_attributes{};
+		Quantization quantization{};
+
+		static constexpr VertexLayout Interleaved(const uint32_t attributes = All)
+		{
+			VertexLayout layout;
+			layout.stream_count = 1;
+			layout.stream_attributes[0] = attributes;
+			return layout;
+		}
+
+		static constexpr VertexLayout PositionOnly()
+		{
+			return Interleaved(Position);
+		}
+
+		// position in its own stream for depth/shadow passes, the rest interleaved in a second stream
+		static constexpr VertexLayout SplitPosition(const uint32_t attributes = All)
+		{
+			VertexLayout layout;
+			layout.stream_count = 2;
+			layout.stream_attributes[0] = Position;
+			layout.stream_attributes[1] = attributes & ~Position;
+			return layout;
+		}
+
+		// joints and weights in a stream of their own, read only by skinning
+		static constexpr VertexLayout SplitSkin(const uint32_t attributes = All)
+		{
+			VertexLayout layout;
+			layout.stream_count = 2;
+			layout.stream_attributes[0] = attributes & ~Skin;
+			layout.stream_attributes[1] = attributes & Skin;
+			return layout;
+		}
+
+		// every attribute in its most compact encoding, 24 bytes per vertex instead of 64(40 instead of 88 with joints and weights)
+		static constexpr VertexLayout Quantized(VertexLayout layout)
+		{
+			layout.quantization.positions = true;
+			layout.quantization.octahedral_normals = true;
+			layout.quantization.uvs = Quantization::UvFormat::Unorm16;
+			layout.quantization.unorm8_colors = true;
+			layout.quantization.unorm16_weights = true;
+			return layout;
+		}
+
+		[[nodiscard]] constexpr uint32_t GetAttributeSize(const AttributeBits attribute) const
+		{
+			switch ( attribute )
+			{
+				case Position:
+					return quantization.positions ? 4 * sizeof(uint16_t) : sizeof(glm::vec3);
+				case Normal:
+					return quantization.octahedral_normals ? 2 * sizeof(int16_t) : sizeof(glm::vec3);
+				case Tangent:
+					return quantization.octahedral_normals ? 2 * sizeof(int16_t) : sizeof(glm::vec4);
+				case Uv:
+					return quantization.uvs == Quantization::UvFormat::Float ? sizeof(glm::vec2) : 2 * sizeof(uint16_t);
+				case Color:
+					return quantization.unorm8_colors ? 4 * sizeof(uint8_t) : sizeof(glm::vec4);
+				case Joints:
+					return 4 * sizeof(uint16_t);
+				case Weights:
+					return quantization.unorm16_weights ? 4 * sizeof(uint16_t) : sizeof(glm::vec4);
+				default:
+					return 0;
+			}
+		}
+
+		[[nodiscard]] constexpr uint32_t GetAttributeOffset(const uint32_t attributes, const AttributeBits attribute) const
+		{
+			uint32_t offset = 0;
+			for ( uint32_t bit = Position; bit < attribute; bit <<= 1 )
+			{
+				if ( attributes & bit )
+				{
+					offset += GetAttributeSize(static_cast<AttributeBits>(bit));
+				}
+			}
+			return offset;
+		}
+
+		[[nodiscard]] constexpr uint32_t GetStride(const uint32_t attributes) const
+		{
+			return GetAttributeOffset(attributes, static_cast<AttributeBits>(All + 1));
+		}
+	};
+
+	// size saving and worst case error of a quantized load, next to the float LoadedVertex data it replaced
+	struct VertexQuantizationReport
+	{
+		uint64_t vertex_count{ 0 };
+		uint64_t float_bytes{ 0 };
+		uint64_t packed_bytes{ 0 };
+		float max_position_error{ 0.f };
+		float max_normal_error_degrees{ 0.f };
+		float max_tangent_error_degrees{ 0.f };
+		float max_uv_error{ 0.f };
+		float max_color_error{ 0.f };
+		float max_weight_error{ 0.f };
+
+		void Merge(const VertexQuantizationReport& other);
+	};
+
+	// vertex counts and simulated post-transform cache misses before and after MeshOptimizer::Optimize
+	struct MeshOptimizationReport
+	{
+		uint64_t triangle_count{ 0 };
+		uint64_t vertex_count_before{ 0 };
+		uint64_t vertex_count_after{ 0 };
+		uint64_t cache_misses_before{ 0 };
+		uint64_t cache_misses_after{ 0 };
+
+		// average cache miss ratio, transformed vertices per triangle
+		[[nodiscard]] double GetAcmrBefore() const;
+		[[nodiscard]] double GetAcmrAfter() const;
+		void Merge(const MeshOptimizationReport& other);
+	};
+
+	struct BoundingBox
+	{
+		glm::vec3 min{ std::numeric_limits<float>::max() };
+		glm::vec3 max{ std::numeric_limits<float>::lowest() };
+
+		// a default constructed box is empty(e.g. the bounds of a node without geometry) until something is merged into it
+		[[nodiscard]] bool IsValid() const;
+		[[nodiscard]] glm::vec3 GetCenter() const;
+		[[nodiscard]] glm::vec3 GetExtent() const;
+		void Merge(const BoundingBox& other);
+		// box around the transformed corners
+		[[nodiscard]] BoundingBox Transform(const glm::mat4& matrix) const;
+	};
+
+	struct BoundingSphere
+	{
+		glm::vec3 center{ 0.f };
+		float radius{ 0.f };
+	};
+
+	// inward facing planes(xyz normal, w distance): left, right, bottom, top, near, far
+	struct Frustum
+	{
+		std::array<glm::vec4, 6> planes;
+
+		// extracts the planes from a clip matrix with a [0, 1] depth range(Vulkan/D3D). the planes end up in the space the matrix
+		// transforms from, so view_projection * top_matrix gives a frustum that can be tested against world bounds directly.
+		static Frustum FromMatrix(const glm::mat4& clip_matrix);
+		[[nodiscard]] bool Intersects(const BoundingBox& box) const;
+		[[nodiscard]] bool Intersects(const BoundingSphere& sphere) const;
+	};
 
 	struct LoadedMeshAsset
 	{
@@ -98,17 +371,113 @@ namespace Anni::ModelLoader
 			uint32_t start_index;
 			uint32_t count;
 			std::optional<uint32_t> material_index;
+			// mesh space
+			BoundingBox bounds;
+			BoundingSphere bounding_sphere;
+		};
+
+		struct VertexStream
+		{
+			uint32_t attributes; // VertexLayout::AttributeBits packed in this stream
+			uint32_t stride;
+			std::vector<uint8_t> data;
 		};
 
 		struct MeshBuffer //all buffers in one 
 		{
-			std::vector<uint32_t> indices;
-			std::vector<LoadedVertex> vertices;
+			MeshBuffer() = default;
+			MeshBuffer(std::pmr::memory_resource* index_resource, std::pmr::memory_resource* vertex_resource);
+
+			std::pmr::vector<uint32_t> indices;
+			// LoadedVertex array, left empty when LoadOptions::vertex_layout asks for packed streams instead
+			std::pmr::vector<LoadedVertex> vertices;
+			// one per vertex when the mesh(or a mesh merged into the buffer) has JOINTS_0 and WEIGHTS_0, empty otherwise.
+			// packed streams replace it like they replace vertices
+			std::pmr::vector<LoadedSkinVertex> skin_vertices;
+			std::vector<VertexStream> streams;
+
+			[[nodiscard]] size_t GetVertexCount() const;
+		};
+
+		// simplified version of the whole mesh, see MeshOptimizer::BuildLodChain
+		struct LodLevel
+		{
+			// mesh space deviation from the full detail surface
+			float error;
+			// same order as the full detail homo_mat_tris_array, ranges point into buffer_in_one.indices past the full detail ones
+			std::vector<HomoMatTris> homo_mat_tris_array;
+		};
+
+		// up to max_vertices vertices and max_triangles triangles of one homo mat tris, see MeshOptimizer::BuildMeshlets
+		struct Meshlet
+		{
+			uint32_t homo_mat_tris_index;
+			// into meshlet_vertices
+			uint32_t vertex_offset;
+			uint32_t vertex_count;
+			// into meshlet_triangles, three local vertex indices per triangle
+			uint32_t triangle_offset;
+			uint32_t triangle_count;
+			BoundingSphere bounding_sphere;
+			// the meshlet is back facing for every viewer with dot(normalize(cone_apex - viewer), cone_axis) >= cone_cutoff
+			glm::vec3 cone_apex;
+			glm::vec3 cone_axis;
+			float cone_cutoff;
 		};
 
+		// quantized value * scale + offset gives back the original attribute
+		struct Dequantization
+		{
+			glm::vec3 position_scale{ 1.f };
+			glm::vec3 position_offset{ 0.f };
+			glm::vec2 uv_scale{ 1.f };
+			glm::vec2 uv_offset{ 0.f };
+		};
+
+		LoadedMeshAsset() = default;
+		// the homo mat tris, index and vertex arrays allocate from resource unless the index or vertex one is given, see LoadedModel's arena
+		explicit LoadedMeshAsset(std::pmr::memory_resource* resource, std::pmr::memory_resource* index_resource = nullptr, std::pmr::memory_resource* vertex_resource = nullptr);
+
 		std::string name;
-		std::vector<HomoMatTris> homo_mat_tris_array;
+		// VertexLayout::AttributeBits the source provided, absent attributes are left out of packed streams
+		uint32_t present_attributes{ VertexLayout::Position };
+		// encodings used by buffer_in_one.streams
+		VertexLayout::Quantization quantization{};
+		Dequantization dequantization{};
+		// mesh space, covers every homo mat tris
+		BoundingBox bounds;
+		BoundingSphere bounding_sphere;
+		std::pmr::vector<HomoMatTris> homo_mat_tris_array;
 		MeshBuffer buffer_in_one;
+		// the mesh's part of the index and vertex buffers. with LoadOptions::merge_mesh_buffers it is a range of
+		// LoadedModel::GetMergedBuffer() and buffer_in_one is left empty, otherwise the offsets are 0.
+		// indices(and HomoMatTris::start_index) stay relative to the mesh, draw with first_index and vertex_offset added
+		uint32_t first_index{ 0 };
+		uint32_t index_count{ 0 };
+		int32_t vertex_offset{ 0 };
+		uint32_t vertex_count{ 0 };
+
+		// coarser and coarser levels, the full detail homo_mat_tris_array is level 0
+		std::vector<LodLevel> lods;
+		std::vector<Meshlet> meshlets;
+		// mesh vertex indices
+		std::vector<uint32_t> meshlet_vertices;
+		std::vector<uint8_t> meshlet_triangles;
+
+		[[nodiscard]] std::span<const HomoMatTris> GetLodHomoMatTris(uint32_t lod_level) const;
+	};
+
+	// picks a level of detail from the projected size of its simplification error
+	struct LodSelection
+	{
+		// in the space of the world transforms
+		glm::vec3 camera_position{ 0.f };
+		// viewport height / (2 * tan(vertical fov / 2)), turns size / distance into pixels
+		float projection_scale{ 1.f };
+		// the coarsest level whose error stays under this many pixels is used
+		float max_pixel_error{ 1.f };
+
+		[[nodiscard]] uint32_t SelectLevel(const LoadedMeshAsset& mesh_asset, const glm::mat4& world_transform) const;
 	};
 
 
@@ -116,6 +485,8 @@ namespace Anni::ModelLoader
 	{
 		uint32_t index_count;
 		uint32_t first_index;
+		// base vertex, added to every index fetched
+		int32_t vertex_offset;
 		std::optional<uint32_t> material_index;
 		glm::mat4 final_transform;
 	};
@@ -125,12 +496,73 @@ namespace Anni::ModelLoader
 		std::vector<RenderRecord> homo_mat_tris_record;
 	};
 
+	// same memory layout as VkDrawIndexedIndirectCommand and D3D12_DRAW_INDEXED_ARGUMENTS
+	struct DrawIndexedIndirectCommand
+	{
+		uint32_t index_count;
+		uint32_t instance_count;
+		uint32_t first_index;
+		int32_t vertex_offset;
+		uint32_t first_instance;
+	};
+	static_assert(sizeof(DrawIndexedIndirectCommand) == 20);
+
+	// sorted, instanced alternative to DrawContext. commands can be uploaded as an indirect buffer as is,
+	// command i draws instance_transforms[first_instance, first_instance + instance_count) and is described by batches[i].
+	class DrawList
+	{
+	public:
+		// state:[alpha mode:2][material:33], draw:[mesh:32][homo mat tris:32]. every index keeps all of its bits, the material
+		// field has one more so the draws without a material get a value no index reaches and sort after every material
+		struct SortKey
+		{
+			uint64_t state;
+			uint64_t draw;
+
+			auto operator<=>(const SortKey&) const = default;
+		};
+
+		struct Batch
+		{
+			SortKey sort_key;
+			uint32_t mesh_index;
+			std::optional<uint32_t> material_index;
+		};
+
+		std::vector<DrawIndexedIndirectCommand> commands;
+		std::vector<Batch> batches;
+		std::vector<glm::mat4> instance_transforms;
+
+		// draws sort by state first, the fields that change pipeline state the most are on top
+		static SortKey MakeSortKey(LoadedMaterialConstant::AlphaMode alpha_mode, const std::optional<uint32_t>& material_index, uint32_t mesh_index, uint32_t homo_mat_tris_index);
+		static uint32_t GetHomoMatTrisIndex(const SortKey& sort_key);
+		void Clear();
+
+	private:
+		friend class LoadedModel;
+
+		static constexpr uint32_t alpha_key_shift = 33;
+		static constexpr uint64_t no_material_key = 1ull << 32;
+		static constexpr uint32_t mesh_key_shift = 32;
+		static constexpr uint64_t homo_mat_tris_key_mask = (1ull << 32) - 1;
+
+		struct DrawItem
+		{
+			SortKey sort_key;
+			uint32_t node_index;
+		};
+		// scratch kept between builds so the per frame rebuild doesn't allocate
+		std::vector<DrawItem> m_items;
+	};
+
 	class IRenderable
 	{
 	public:
 		IRenderable() = default;
 
 		virtual void PreDrawToContext(const glm::mat4& top_matrix, DrawContext& ctx) = 0;
+		// same as above but leaves out everything outside of the frustum, see Frustum::FromMatrix for the space it is expected in
+		virtual void PreDrawToContext(const glm::mat4& top_matrix, const Frustum& frustum, DrawContext& ctx) = 0;
 		virtual ~IRenderable() = default;
 	};
 
@@ -146,9 +578,18 @@ namespace Anni::ModelLoader
 
 		glm::mat4 local_transform;
 		glm::mat4 world_transform;
+		// index into the model's skins when the node's mesh is skinned
+		std::optional<uint32_t> skin_index;
+
+		// bounds of the node's own geometry and of its whole subtree in the space of world_transform, updated by RefreshTransform
+		BoundingBox world_bounds;
+		BoundingBox subtree_bounds;
 
 		void RefreshTransform(const glm::mat4& parent_matrix);
+		[[nodiscard]] virtual BoundingBox GetLocalBounds() const;
 		void PreDrawToContext(const glm::mat4& top_matrix, DrawContext& ctx) override;
+		// a subtree whose bounds are outside of the frustum is skipped as a whole
+		void PreDrawToContext(const glm::mat4& top_matrix, const Frustum& frustum, DrawContext& ctx) override;
 	};
 
 	struct MeshNode : public Node
@@ -158,7 +599,10 @@ namespace Anni::ModelLoader
 
 		MeshNode() = delete;
 		~MeshNode() override = default;
+		[[nodiscard]] BoundingBox GetLocalBounds() const override;
 		void PreDrawToContext(const glm::mat4& top_matrix, DrawContext& ctx) override;
+		void PreDrawToContext(const glm::mat4& top_matrix, const Frustum& frustum, DrawContext& ctx) override;
+		[[nodiscard]] const LoadedMeshAsset* GetMeshAsset() const;
 
 	private:
 		// OBSERVER POINTER
@@ -166,6 +610,301 @@ namespace Anni::ModelLoader
 	};
 
 
+	// data oriented copy of the node hierarchy. nodes are stored depth first, so every parent comes before its children
+	// and the subtree of node i is the contiguous range [i, i + subtree_sizes[i]).
+	struct FlatScene
+	{
+		static constexpr uint32_t no_parent = std::numeric_limits<uint32_t>::max();
+		static constexpr uint32_t no_mesh = std::numeric_limits<uint32_t>::max();
+		static constexpr uint32_t no_skin = std::numeric_limits<uint32_t>::max();
+
+		std::vector<glm::mat4> local_transforms;
+		std::vector<glm::mat4> world_transforms;
+		std::vector<uint32_t> parent_indices;
+		std::vector<uint32_t> subtree_sizes;
+		// index into the model's mesh assets, no_mesh for pure transform nodes
+		std::vector<uint32_t> mesh_indices;
+		// index of the node in the source file(and in LoadedModel's scene nodes)
+		std::vector<uint32_t> source_node_indices;
+		// the other way around, flat index of every source node(e.g. of a skin's joints)
+		std::vector<uint32_t> flat_node_indices;
+		// index into the model's skins, no_skin for nodes without a skinned mesh
+		std::vector<uint32_t> skin_indices;
+		// mesh bounds of the node, empty for pure transform nodes
+		std::vector<BoundingBox> local_bounds;
+		// in the space of world_transforms, updated together with them
+		std::vector<BoundingBox> world_bounds;
+		std::vector<BoundingBox> subtree_bounds;
+		// nodes moved by SetLocalTransform since the last update, each listed once(dirty_flags[i] is set while i is listed)
+		std::vector<uint32_t> dirty_nodes;
+		std::vector<uint8_t> dirty_flags;
+		// what UpdateWorldTransforms was last called with, UpdateDirtyTransforms keeps using it
+		glm::mat4 root_transform{ 1.f };
+
+		[[nodiscard]] size_t GetNodeCount() const;
+
+		// one linear pass, parents are always resolved before their children. subtree bounds are gathered in a second, backwards pass
+		void UpdateWorldTransforms(const glm::mat4& root_matrix = glm::mat4{ 1.f });
+		// the world transforms stay as they are until the next update
+		void SetLocalTransform(uint32_t node_index, const glm::mat4& transform);
+		// recomputes only the subtrees below dirty nodes, in one pass over their index ranges(a dirty node inside an earlier one's
+		// subtree is covered by it), then the subtree bounds of their ancestors. returns the number of world transforms recomputed
+		size_t UpdateDirtyTransforms();
+		// with a frustum every subtree outside of it is skipped in one step, with a lod selection every mesh draws the level it picks
+		void PreDrawToContext(const glm::mat4& top_matrix, const std::vector<LoadedMeshAsset>& mesh_assets, DrawContext& ctx, const Frustum* frustum = nullptr, const LodSelection* lod_selection = nullptr) const;
+	};
+
+	// joints are source node indices(like FlatScene::source_node_indices), see Skinning for how they are used
+	struct LoadedSkin
+	{
+		std::string name;
+		std::vector<uint32_t> joint_nodes;
+		// one per joint, identity when the file leaves them out
+		std::vector<glm::mat4> inverse_bind_matrices;
+		std::optional<uint32_t> skeleton_node;
+	};
+
+	// one animated property of one node. the keys and values of every channel live in its animation's shared arrays
+	struct AnimationChannel
+	{
+		enum class Path : uint8_t
+		{
+			Translation,
+			Rotation,
+			Scale,
+			// morph target weights
+			Weights,
+		};
+
+		// cubic splines are resampled into linear keys at load time
+		enum class Interpolation : uint8_t
+		{
+			Step,
+			Linear,
+		};
+
+		// source node index
+		uint32_t target_node;
+		Path path;
+		Interpolation interpolation;
+		// floats per key: 3 for translation and scale, 4 for rotation(xyzw quaternion), the morph target count for weights
+		uint16_t component_count;
+		// into LoadedAnimation::times, channels driven by the same glTF input accessor share their keys
+		uint32_t first_key;
+		uint32_t key_count;
+		// key_count * component_count floats in LoadedAnimation::values
+		uint32_t first_value;
+	};
+
+	struct LoadedAnimation
+	{
+		std::string name;
+		// seconds, the last key of any channel
+		float duration{ 0.f };
+		// sorted by path then node, so the sampler finds rotations next to each other
+		std::vector<AnimationChannel> channels;
+		// every node a channel writes to, once
+		std::vector<uint32_t> target_nodes;
+		std::vector<float> times;
+		std::vector<float> values;
+	};
+
+	// local transform of every node as translation, rotation and scale, indexed like the source file's nodes.
+	// animations are sampled into a copy of LoadedModel::GetRestPose(), see AnimationSampler
+	struct AnimationPose
+	{
+		std::vector<glm::vec3> translations;
+		std::vector<glm::quat> rotations;
+		std::vector<glm::vec3> scales;
+		// the morph target weights of node i are morph_weights[first_morph_weights[i], first_morph_weights[i + 1])
+		std::vector<uint32_t> first_morph_weights;
+		std::vector<float> morph_weights;
+
+		[[nodiscard]] size_t GetNodeCount() const;
+		[[nodiscard]] glm::mat4 GetLocalTransform(uint32_t node_index) const;
+	};
+
+	// bytes held by one model. shared_texture_bytes are pixels the model only references(texture cache entries, a mapped cooked file)
+	struct ModelMemoryUsage
+	{
+		uint64_t texture_bytes{ 0 };
+		uint64_t shared_texture_bytes{ 0 };
+		// interleaved vertices and packed streams
+		uint64_t vertex_bytes{ 0 };
+		// index buffers and the draw ranges(HomoMatTris, LOD levels) into them
+		uint64_t index_bytes{ 0 };
+		uint64_t meshlet_bytes{ 0 };
+		// flat scene and node hierarchy
+		uint64_t scene_bytes{ 0 };
+		// skins, animation keys and the rest pose
+		uint64_t animation_bytes{ 0 };
+		// blocks the model's arena took from LoadOptions::memory_resource. most vertex, index and scene bytes live inside them,
+		// so they are not added up again by GetOwnedBytes
+		uint64_t arena_bytes{ 0 };
+
+		[[nodiscard]] uint64_t GetOwnedBytes() const;
+	};
+
+	// where the time and memory of one LoadFromFile went(see LoadedModel::GetLoadStats)
+	struct LoadStats
+	{
+		enum class Stage : uint8_t
+		{
+			// reading or mapping the file and its external buffers, parsing the glTF
+			RawParse,
+			// EXT_meshopt_compression buffer views
+			Decompress,
+			Samplers,
+			// texture slots and materials
+			Materials,
+			// starting the decode jobs, plus waiting for the ones still running once the scene is built
+			Textures,
+			Meshes,
+			SceneNodes,
+			SceneGraph,
+			// skins and animation channels
+			Animations,
+			// a cooked model is read instead of all of the above
+			CookedRead,
+			CookedWrite,
+			Count,
+		};
+		static constexpr size_t stage_count = static_cast<size_t>(Stage::Count);
+
+		// wall time on the loading thread
+		std::array<double, stage_count> stage_milliseconds{};
+		double total_milliseconds{ 0.0 };
+		// summed over the decode jobs, with parallel_texture_decoding most of it overlaps the other stages
+		double texture_decode_milliseconds{ 0.0 };
+		bool from_cooked_cache{ false };
+		// this load wrote the cooked model, a file left at the cooked path by an earlier load doesn't count
+		bool saved_to_cooked_cache{ false };
+
+		// model file, external buffers and image files, or the cooked file. data URIs count at their decoded size
+		uint64_t bytes_read{ 0 };
+		// handed out by the model's arena, plus the decoded texture data the model owns
+		uint64_t allocated_bytes{ 0 };
+		// images served by TextureCache::Shared() weren't decoded by this load and don't count
+		uint64_t decoded_texels{ 0 };
+		uint64_t vertex_count{ 0 };
+		uint64_t index_count{ 0 };
+		// process high water mark before and after the load(see GetPeakResidentBytes)
+		uint64_t peak_resident_bytes_before{ 0 };
+		uint64_t peak_resident_bytes{ 0 };
+
+		[[nodiscard]] static std::string_view GetStageName(Stage stage);
+		[[nodiscard]] double GetStageMilliseconds(Stage stage) const;
+	};
+
+	enum class TextureCompression : uint8_t
+	{
+		None,
+		// BC1 color and metal-roughness, BC3 color with alpha, BC4 occlusion only, BC5 normals
+		Bc,
+		// like Bc, but BC7 for color and metal-roughness
+		Bc7,
+	};
+
+	struct LoadOptions
+	{
+		// decode images on the shared worker pool, overlapping with material/mesh/node loading
+		bool parallel_texture_decoding{ true };
+		// extract the meshes' indices and vertices on the shared worker pool, one job per mesh. the output doesn't depend on it
+		bool parallel_mesh_extraction{ true };
+
+		// map the glTF/GLB file, its external buffers and its image files instead of reading them into heap copies.
+		// accessors and image decoders then read straight out of the page cache
+		bool memory_mapped_input{ false };
+
+		// when set, LoadFromFile first tries a cooked binary of the model in this directory and writes one after a cold load
+		std::optional<std::filesystem::path> cooked_cache_directory;
+
+		// when set, meshes are packed into these vertex streams instead of the interleaved LoadedVertex array
+		std::optional<VertexLayout> vertex_layout;
+
+		// deduplicate vertices and reorder indices/vertices for the post-transform cache, overdraw and fetch locality(see MeshOptimizer)
+		bool optimize_meshes{ false };
+
+		// fraction of the triangles every simplified level keeps, e.g. { 0.5f, 0.25f, 0.125f }. empty means no LOD chain
+		std::vector<float> lod_ratios;
+
+		// partition every mesh into meshlets for cluster culling
+		bool build_meshlets{ false };
+		uint32_t meshlet_max_vertices{ 64 };
+		uint32_t meshlet_max_triangles{ 124 };
+
+		// full mip chain for every texture, averaged in linear space for color textures and renormalized for normal maps.
+		// KTX2 textures keep the levels they were stored with
+		bool generate_mipmaps{ false };
+		// block compression picked per texture from its material usage(see TextureProcessor). Basis Universal KTX2 textures
+		// are transcoded to the same formats, block compressed KTX2 textures keep theirs. Basis payloads and zstd
+		// supercompression need MODELS_LOADER_WITH_BASISU, without it such textures fail with LoadError::Code::UnsupportedTexture
+		TextureCompression texture_compression{ TextureCompression::None };
+		// share decoded textures with every other load through TextureCache::Shared(), keyed by canonical path and content hash
+		bool use_texture_cache{ false };
+
+		// pack the index and vertex buffers of every mesh into one of each(see LoadedModel::GetMergedBuffer), so the whole
+		// model can be drawn from a single bind with multi draw indirect. packed streams then keep absent attributes with
+		// default values, every mesh has to share the same streams
+		bool merge_mesh_buffers{ false };
+		// byte alignment of every mesh's range in each merged array, a power of two. 1 packs the meshes back to back
+		uint32_t merged_buffer_alignment{ 1 };
+
+		// upstream of the model's arena, which holds its index/vertex buffers, draw ranges and scene nodes and frees them at once
+		// with the model. nullptr means std::pmr::get_default_resource(), anything else has to outlive the model
+		std::pmr::memory_resource* memory_resource{ nullptr };
+
+		// every Factory stage and texture decode becomes a span on it, it has to outlive the load. not part of the cooked fingerprint
+		TraceRecorder* trace_recorder{ nullptr };
+	};
+
+	// why a load failed, what TryLoadFromFile returns instead of exiting the process
+	struct LoadError
+	{
+		enum class Code : uint8_t
+		{
+			// no or unknown extension, or content that is neither glTF nor GLB
+			UnsupportedFile,
+			// the model file or one of its buffers couldn't be read or mapped
+			ReadFailed,
+			ParseFailed,
+			// non local or truncated buffers
+			InvalidBuffer,
+			TextureDecodeFailed,
+			// a valid texture this build can't decode, e.g. a zstd supercompressed KTX2 file without MODELS_LOADER_WITH_BASISU
+			UnsupportedTexture,
+			InvalidMesh,
+			InvalidScene,
+			// skins or animation channels pointing at missing nodes, or with mismatching key and value counts
+			InvalidAnimation,
+		};
+
+		Code code{ Code::UnsupportedFile };
+		std::string message;
+	};
+
+	template <typename T>
+	using LoadResult = std::expected<T, LoadError>;
+
+	enum class LoadStage : uint8_t
+	{
+		// queued, parsing or converting
+		Pending,
+		// scene, meshes, materials and samplers can be used, textures arrive one by one
+		GeometryReady,
+		// the ending stages come last, waiting for any stage returns once one of them is reached
+		Complete,
+		Cancelled,
+		Failed,
+	};
+
+	struct AsyncLoadCallbacks
+	{
+		// both are called from worker threads
+		std::function<void(LoadStage stage)> on_stage_changed;
+		std::function<void(uint32_t texture_index)> on_texture_ready;
+	};
+
 	class LoadedModel
 	{
 	public:
@@ -176,23 +915,88 @@ namespace Anni::ModelLoader
 		LoadedModel& operator=(const LoadedModel&) = delete;
 		LoadedModel& operator=(LoadedModel&&) = delete;
 	private:
-		LoadedModel(std::filesystem::path file_path);
+		LoadedModel(std::filesystem::path file_path, std::pmr::memory_resource* upstream = nullptr);
 
 	private:
 		class Factory
 		{
 		public:
-			std::unique_ptr<LoadedModel> LoadFromFile(std::filesystem::path file_path);
+			// the stages of a glTF load one call at a time, see StagedLoad.h
+			class StagedLoad;
+
+			// logs and exits the process on failure, see TryLoadFromFile
+			std::unique_ptr<LoadedModel> LoadFromFile(std::filesystem::path file_path, const LoadOptions& options = {});
+			// a broken file only fails its own load, nothing is logged at error level and the process keeps going
+			LoadResult<std::unique_ptr<LoadedModel>> TryLoadFromFile(std::filesystem::path file_path, const LoadOptions& options = {});
+			// returns right away, the model is built on the shared pool and its textures are decoded one by one after the geometry
+			std::shared_ptr<AsyncModelLoad> LoadFromFileAsync(std::filesystem::path file_path, const LoadOptions& options = {}, AsyncLoadCallbacks callbacks = {}, ThreadPool::Priority priority = ThreadPool::Priority::Normal);
+
+			// where LoadOptions::cooked_cache_directory keeps the cooked model of file_path
+			static std::filesystem::path GetCookedModelPath(const std::filesystem::path& cache_directory, const std::filesystem::path& file_path);
 
 		private:
-			static void LoadGltf(const std::filesystem::path& file_path, fastgltf::Parser& gltf_parser, std::unique_ptr<LoadedModel>& loading_result);
-			static void LoadRawGltf(fastgltf::GltfDataBuffer& data, fastgltf::Asset& gltf_asset, const std::filesystem::path& file_path, fastgltf::Parser& gltf_parser);
+			// what the parsers accept on top of the core spec. quantized attributes need nothing beyond fastgltf's accessor conversion,
+			// meshopt compressed views are decoded by DecodeCompressedBufferViews, KTX2 images by Ktx2Decoder
+			static constexpr fastgltf::Extensions supported_extensions = fastgltf::Extensions::KHR_mesh_quantization | fastgltf::Extensions::EXT_meshopt_compression |
+				fastgltf::Extensions::KHR_texture_basisu;
+
+			static LoadResult<void> LoadGltf(const std::filesystem::path& file_path, fastgltf::Parser& gltf_parser, const LoadOptions& options, std::unique_ptr<LoadedModel>& loading_result);
+			static LoadResult<void> LoadRawGltf(std::unique_ptr<fastgltf::GltfDataGetter>& data, fastgltf::Asset& gltf_asset, const std::filesystem::path& file_path, fastgltf::Parser& gltf_parser, const LoadOptions& options);
+			// points every external buffer at a mapping of its file(memory_mapped_input, the mappings have to outlive gltf_asset)
+			// or at a copy of its bytes
+			static LoadResult<void> LoadExternalBuffers(fastgltf::Asset& gltf_asset, const std::filesystem::path& file_path, const LoadOptions& options, std::vector<std::shared_ptr<MappedFile>>& source_mappings);
+			// decodes every EXT_meshopt_compression view into one new buffer and points the view at it, everything afterwards
+			// reads them like any other view
+			static LoadResult<void> DecodeCompressedBufferViews(fastgltf::Asset& gltf_asset);
+			// has to run before LoadExternalBuffers, which replaces the buffer URIs
+			static void CollectSourceFiles(const fastgltf::Asset& gltf_asset, const std::filesystem::path& file_path, std::unique_ptr<LoadedModel>& loading_result);
 			static void LoadSamplers(const fastgltf::Asset& gltf_asset, std::unique_ptr<LoadedModel>& loading_result);
-			static void LoadTextureImages(const fastgltf::Asset& gltf_asset, const std::filesystem::path& file_path, std::unique_ptr<LoadedModel>& loading_result);
+			// one empty slot per image, m_textures must not reallocate once decode jobs write into it
+			static void CreateTextureSlots(const fastgltf::Asset& gltf_asset, std::unique_ptr<LoadedModel>& loading_result);
+			// kicks off decoding of every image into the slots made by CreateTextureSlots, each job owns one slot
+			static std::vector<std::future<LoadResult<void>>> LoadTextureImages(const fastgltf::Asset& gltf_asset, const std::filesystem::path& file_path, const LoadOptions& options, std::unique_ptr<LoadedModel>& loading_result);
+			// waits for every job, even after a failure, and returns the first failure in image order
+			static LoadResult<void> WaitTextureImages(std::vector<std::future<LoadResult<void>>>& pending_images);
+			// decode and post process one image, or take it from TextureCache::Shared(). runs on worker threads
+			// decoded_texels is only set when the pixels were decoded here rather than taken from the cache
+			static LoadResult<void> LoadTextureImage(const fastgltf::Asset& gltf_asset, const fastgltf::Image& image, const std::filesystem::path& file_path, const LoadOptions& options, LoadedImage& loaded_image, uint64_t* decoded_texels = nullptr);
+			// KTX2 images come out with their final format and levels, everything else as RGBA8 for TextureProcessor. failures
+			// come back as TextureDecodeFailed, nothing is logged
+			static LoadResult<void> DecodeTextureImage(const fastgltf::Asset& gltf_asset, const fastgltf::Image& image, const std::filesystem::path& file_path, bool memory_mapped_input, TextureCompression compression, LoadedImage& loaded_image);
+			// one flag per image, set for the KTX2 image of a KHR_texture_basisu texture whose fallback image is used instead.
+			// nothing samples those, one pass over the textures
+			static std::vector<uint8_t> FindUnusedBasisuImages(const fastgltf::Asset& gltf_asset);
 			static void LoadMaterials(const fastgltf::Asset& gltf_asset, const std::filesystem::path& file_path, std::unique_ptr<LoadedModel>& loading_result);
-			static void LoadMeshes(const fastgltf::Asset& gltf_asset, std::unique_ptr<LoadedModel>& loading_result);
-			static void LoadSceneNodes(const fastgltf::Asset& gltf_asset, std::unique_ptr<LoadedModel>& loading_result);
-			static void LoadSceneGraph(const fastgltf::Asset& gltf_asset, std::unique_ptr<LoadedModel>& loading_result);
+			static LoadResult<void> LoadMeshes(const fastgltf::Asset& gltf_asset, const LoadOptions& options, std::unique_ptr<LoadedModel>& loading_result);
+			// streams keep the attributes of packed_attributes only, the ones the mesh doesn't have are filled with defaults
+			static VertexQuantizationReport PackVertexStreams(const VertexLayout& layout, uint32_t packed_attributes, LoadedMeshAsset& mesh_asset);
+			// fills in the index/vertex range of every mesh, with LoadOptions::merge_mesh_buffers their buffers are moved into m_merged_buffer first
+			static LoadResult<void> SetMeshBufferRanges(const LoadOptions& options, std::unique_ptr<LoadedModel>& loading_result);
+			static LoadResult<void> LoadSceneNodes(const fastgltf::Asset& gltf_asset, std::unique_ptr<LoadedModel>& loading_result);
+			// InvalidScene unless the (parent, child) links form a forest: every child exists and has exactly one parent, no cycles.
+			// shared by LoadSceneGraph and LoadCookedModel, both check before linking anything
+			static LoadResult<void> ValidateHierarchy(size_t node_count, std::span<const std::pair<size_t, size_t>> links);
+			static LoadResult<void> LoadSceneGraph(const fastgltf::Asset& gltf_asset, std::unique_ptr<LoadedModel>& loading_result);
+			static void BuildFlatScene(std::unique_ptr<LoadedModel>& loading_result);
+
+			//> SKINS AND ANIMATIONS(see Animation.cpp)
+			static LoadResult<void> LoadSkins(const fastgltf::Asset& gltf_asset, std::unique_ptr<LoadedModel>& loading_result);
+			static LoadResult<void> LoadAnimations(const fastgltf::Asset& gltf_asset, std::unique_ptr<LoadedModel>& loading_result);
+			// the counters of m_load_stats that can be read off the finished model
+			static void FinishLoadStats(std::unique_ptr<LoadedModel>& loading_result);
+
+			//> COOKED MODEL CACHE(see CookedModel.cpp)
+			static std::unique_ptr<LoadedModel> LoadCookedModel(const std::filesystem::path& cooked_path, const std::filesystem::path& file_path, const LoadOptions& options);
+			static bool SaveCookedModel(const LoadedModel& model, const std::filesystem::path& cooked_path, const LoadOptions& options);
+			static uint64_t ComputeOptionsFingerprint(const LoadOptions& options);
+
+			//> ASYNC LOADING(see AsyncLoad.cpp)
+			// what the texture jobs of one async load share, it keeps the parsed asset alive until the last of them is done
+			struct AsyncTextureFeed;
+			static void RunAsyncLoad(const std::shared_ptr<AsyncModelLoad>& async_load, const std::filesystem::path& file_path, const LoadOptions& options);
+			// tops the pool up to a few texture jobs at the load's current priority, the caller that sees the last one return ends the load
+			static void FeedTextureJobs(const std::shared_ptr<AsyncTextureFeed>& feed);
+			static void FinishAsyncLoad(AsyncTextureFeed& feed);
 
 			static LoadedSampler::AddressMode ExtractAddressMode(fastgltf::Wrap warp);
 			static LoadedSampler::SamplerType ExtractMagSamplerType(fastgltf::Filter filter);
@@ -200,16 +1004,115 @@ namespace Anni::ModelLoader
 			static LoadedSampler::SamplerType ExtractMipMapSamplerType(fastgltf::Filter filter);
 		};
 
+		// declared first so it is released last, the mesh buffers and nodes below allocate from it
+		ArenaMemoryResource m_arena;
 		std::filesystem::path m_file_path;
+		// every file the model was built from, a cooked model is stale once any of them changes
+		std::vector<std::filesystem::path> m_source_files;
 		std::vector<LoadedSampler> m_samplers;
 		std::vector<LoadedImage> m_textures;
 		std::vector<LoadedMaterialConstant> m_materials;
 		std::vector<LoadedMeshAsset> m_mesh_assets;
+		LoadedMeshAsset::MeshBuffer m_merged_buffer;
 		std::vector<std::shared_ptr<Node>> m_scene_nodes;
 		std::vector<std::shared_ptr<Node>> m_top_nodes;
+		FlatScene m_scene;
+		std::vector<LoadedSkin> m_skins;
+		std::vector<LoadedAnimation> m_animations;
+		// node transforms as the file has them, what animations are sampled on top of
+		AnimationPose m_rest_pose;
+		VertexQuantizationReport m_quantization_report;
+		MeshOptimizationReport m_optimization_report;
+		LoadStats m_load_stats;
+		// added to by the texture jobs, folded into m_load_stats once they are done
+		std::atomic<uint64_t> m_decoded_texels{ 0 };
+		std::atomic<uint64_t> m_texture_decode_nanoseconds{ 0 };
 
 	public:
+		[[nodiscard]] const FlatScene& GetScene() const;
+		[[nodiscard]] FlatScene& GetScene();
+		[[nodiscard]] std::span<const LoadedSampler> GetSamplers() const;
+		// during an async load only the slots reported by AsyncModelLoad::IsTextureReady hold pixels
+		[[nodiscard]] std::span<const LoadedImage> GetTextures() const;
+		[[nodiscard]] std::span<const LoadedMaterialConstant> GetMaterials() const;
+		[[nodiscard]] std::span<const LoadedMeshAsset> GetMeshAssets() const;
+		// the model file and every local buffer and image file it references, each once. what a cooked model is checked against
+		// and the same list for a model loaded from one
+		[[nodiscard]] std::span<const std::filesystem::path> GetSourceFiles() const;
+		// every mesh's indices and vertices with LoadOptions::merge_mesh_buffers, empty otherwise
+		[[nodiscard]] const LoadedMeshAsset::MeshBuffer& GetMergedBuffer() const;
+		[[nodiscard]] std::span<const LoadedSkin> GetSkins() const;
+		[[nodiscard]] std::span<const LoadedAnimation> GetAnimations() const;
+		[[nodiscard]] const AnimationPose& GetRestPose() const;
+		void PreDrawToContext(const glm::mat4& top_matrix, DrawContext& ctx, const Frustum* frustum = nullptr, const LodSelection* lod_selection = nullptr) const;
+		// material sorted, instance merged output of the whole scene(or of the part inside the frustum), rebuilt in place
+		void BuildDrawList(const glm::mat4& top_matrix, DrawList& draw_list, const Frustum* frustum = nullptr) const;
+		[[nodiscard]] const VertexQuantizationReport& GetQuantizationReport() const;
+		// only filled by cold loads with LoadOptions::optimize_meshes
+		[[nodiscard]] const MeshOptimizationReport& GetOptimizationReport() const;
+		// walks every container, not meant for per frame use
+		[[nodiscard]] ModelMemoryUsage GetMemoryUsage() const;
+		// filled by LoadFromFile, async loads leave it empty
+		[[nodiscard]] const LoadStats& GetLoadStats() const;
+
 		static Factory factory;
+		using StagedLoad = Factory::StagedLoad;
+	};
+
+	// handle of one LoadFromFileAsync call, the caller and the loading jobs share it
+	class AsyncModelLoad
+	{
+	public:
+		~AsyncModelLoad() = default;
+		AsyncModelLoad() = delete;
+		AsyncModelLoad(const AsyncModelLoad&) = delete;
+		AsyncModelLoad(AsyncModelLoad&&) = delete;
+		AsyncModelLoad& operator=(const AsyncModelLoad&) = delete;
+		AsyncModelLoad& operator=(AsyncModelLoad&&) = delete;
+
+		[[nodiscard]] LoadStage GetStage() const;
+		// blocks until the load gets to stage(or ends before it) and returns the stage it is at
+		LoadStage Wait(LoadStage stage = LoadStage::Complete) const;
+
+		// nullptr before GeometryReady and after TakeModel
+		[[nodiscard]] const LoadedModel* GetModel() const;
+		// ownership of the model, only once the load is Complete
+		std::unique_ptr<LoadedModel> TakeModel();
+
+		[[nodiscard]] uint32_t GetTextureCount() const;
+		[[nodiscard]] uint32_t GetReadyTextureCount() const;
+		[[nodiscard]] bool IsTextureReady(uint32_t texture_index) const;
+
+		// textures that haven't started decoding are dropped, the load ends as Cancelled once the running jobs return
+		void Cancel();
+		[[nodiscard]] bool IsCancelled() const;
+		// applies to every job submitted from now on. textures are only submitted a few at a time, so it takes effect quickly
+		void SetPriority(ThreadPool::Priority priority);
+		[[nodiscard]] ThreadPool::Priority GetPriority() const;
+
+	private:
+		friend class LoadedModel;
+		AsyncModelLoad(AsyncLoadCallbacks callbacks, ThreadPool::Priority priority);
+
+		// ending stages are final, later changes are dropped
+		void SetStage(LoadStage stage);
+		// hands the model over and sizes the ready flags for its textures
+		void SetModel(std::unique_ptr<LoadedModel> model);
+		void MarkTextureReady(uint32_t texture_index);
+
+		mutable std::mutex m_mutex;
+		mutable std::condition_variable m_stage_cv;
+		LoadStage m_stage{ LoadStage::Pending };
+		std::unique_ptr<LoadedModel> m_model;
+
+		// published before GeometryReady, the count is stored last
+		std::unique_ptr<std::atomic<bool>[]> m_texture_ready;
+		std::atomic<uint32_t> m_texture_count{ 0 };
+		std::atomic<uint32_t> m_ready_texture_count{ 0 };
+
+		std::stop_source m_stop_source;
+		std::atomic<ThreadPool::Priority> m_priority;
+		AsyncLoadCallbacks m_callbacks;
 	};
 }
 
@@ -0,0 +1,10 @@
+#pragma once
+#include <cstdint>
+
+
+namespace Anni::ModelLoader
+{
+	// high water mark of the process' resident set(working set on Windows) in bytes, 0 where the platform can't tell.
+	// it never goes down, compare the values before and after a load to see what the load itself cost
+	uint64_t GetPeakResidentBytes();
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "ModelsLoader.h"
+
+
+namespace Anni::ModelLoader
+{
+	// the stages of a glTF/GLB LoadFromFile one call at a time, so each of them can be measured on its own(see bench/).
+	// textures are decoded in full by the Textures stage instead of next to the meshes, there is no cooked cache and no
+	// LoadStats. stages run in LoadStats::Stage order, each one expects the ones before it to have succeeded
+	class LoadedModel::Factory::StagedLoad
+	{
+	public:
+		StagedLoad(std::filesystem::path file_path, const LoadOptions& options);
+		StagedLoad(const StagedLoad&) = delete;
+		StagedLoad& operator=(const StagedLoad&) = delete;
+
+		// RawParse through Animations, the cooked stages aren't part of a glTF load and fail with UnsupportedFile
+		LoadResult<void> RunStage(LoadStats::Stage stage);
+
+		[[nodiscard]] const LoadedModel& GetModel() const;
+		// blocks the model's arena holds so far
+		[[nodiscard]] uint32_t GetArenaBlockCount() const;
+
+	private:
+		std::filesystem::path m_file_path;
+		LoadOptions m_options;
+		// declared first so they are released last, buffers of m_gltf_asset may point into any of them
+		std::vector<std::shared_ptr<MappedFile>> m_source_mappings;
+		std::unique_ptr<fastgltf::GltfDataGetter> m_data;
+		fastgltf::Asset m_gltf_asset{};
+		fastgltf::Parser m_gltf_parser{ supported_extensions };
+		std::unique_ptr<LoadedModel> m_model;
+	};
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+
+#include "ModelsLoader.h"
+
+
+namespace Anni::ModelLoader
+{
+	// process wide cache of decoded(and post processed) images, shared by every load with LoadOptions::use_texture_cache.
+	// entries are immutable and reference counted, a LoadedImage served from here points at the entry's pixels instead of copying them
+	class TextureCache
+	{
+	public:
+		struct Key
+		{
+			// empty for images embedded in a model file, those are matched on content alone
+			std::string canonical_path;
+			uint64_t content_hash;
+			// everything else that changes the cached pixels(usage, mip and compression settings)
+			uint64_t settings;
+
+			bool operator==(const Key& other) const = default;
+		};
+
+		struct Stats
+		{
+			uint64_t hits{ 0 };
+			uint64_t misses{ 0 };
+			uint64_t evictions{ 0 };
+		};
+
+		explicit TextureCache(uint64_t budget_bytes);
+
+		TextureCache() = delete;
+		TextureCache(const TextureCache&) = delete;
+		TextureCache(TextureCache&&) = delete;
+		TextureCache& operator=(const TextureCache&) = delete;
+		TextureCache& operator=(TextureCache&&) = delete;
+
+		// 1 GiB budget until told otherwise
+		static TextureCache& Shared();
+
+		// the cached image for key, otherwise decode runs once while concurrent callers with the same key wait for it.
+		// nullptr if decode fails, failures are not cached. an exception from decode reaches every waiting caller
+		std::shared_ptr<const LoadedImage> GetOrDecode(const Key& key, const std::function<bool(LoadedImage&)>& decode);
+
+		// least recently used entries nobody else holds are dropped until the cache fits. entries still held by a LoadedImage
+		// count against the budget but are never evicted, dropping them would free nothing
+		void SetBudget(uint64_t budget_bytes);
+		[[nodiscard]] uint64_t GetBudget() const;
+		[[nodiscard]] uint64_t GetCachedBytes() const;
+		[[nodiscard]] size_t GetEntryCount() const;
+		[[nodiscard]] Stats GetStats() const;
+		// forgets every entry, images that hold one keep it alive
+		void Clear();
+
+		static uint64_t HashContent(std::span<const uint8_t> bytes);
+
+	private:
+		struct KeyHash
+		{
+			size_t operator()(const Key& key) const;
+		};
+
+		struct Entry
+		{
+			std::shared_ptr<const LoadedImage> image;
+			uint64_t byte_size;
+			// position in m_lru
+			std::list<Key>::iterator recency;
+		};
+
+		void EvictOverBudget();
+
+		mutable std::mutex m_mutex;
+		std::unordered_map<Key, Entry, KeyHash> m_entries;
+		// most recently used first
+		std::list<Key> m_lru;
+		std::unordered_map<Key, std::shared_future<std::shared_ptr<const LoadedImage>>, KeyHash> m_pending;
+		uint64_t m_budget_bytes;
+		uint64_t m_cached_bytes{ 0 };
+		Stats m_stats;
+	};
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <span>
+
+#include "ModelsLoader.h"
+
+
+namespace Anni::ModelLoader
+{
+	// load time texture post process: mip chain and block compression of decoded RGBA8 images
+	class TextureProcessor
+	{
+	public:
+		TextureProcessor() = delete;
+
+		// replaces raw_data with the processed levels, sets format and mip_levels. images that aren't processed still get
+		// their uncompressed format and one level
+		static void Process(LoadedImage& image, bool generate_mipmaps, TextureCompression compression);
+		static LoadedImage::Format ChooseFormat(uint32_t usage, bool has_alpha, TextureCompression compression);
+		static bool IsSrgb(LoadedImage::Format format);
+		// bytes of one 4x4 block, 0 for the uncompressed formats
+		static uint32_t GetBlockSize(LoadedImage::Format format);
+		static uint64_t GetLevelSize(LoadedImage::Format format, uint32_t width, uint32_t height);
+
+		// 2x2 box filter of one RGBA8 level into the next, clamped at odd edges. srgb averages color in linear space,
+		// normal_map renormalizes the averaged vectors
+		static void DownsampleLevel(std::span<const uint8_t> source, uint32_t source_width, uint32_t source_height, std::span<uint8_t> destination, bool srgb, bool normal_map);
+
+		//> BLOCK ENCODERS, every input block is 16 RGBA8 texels in row order
+		static void EncodeBc1Block(const uint8_t* texels, uint8_t* output);
+		static void EncodeBc3Block(const uint8_t* texels, uint8_t* output);
+		// one channel of the texels(0 red ... 3 alpha)
+		static void EncodeBc4Block(const uint8_t* texels, uint32_t channel, uint8_t* output);
+		static void EncodeBc5Block(const uint8_t* texels, uint8_t* output);
+		// mode 6 only: one subset, 7777.1 RGBA endpoints and 4 bit indices
+		static void EncodeBc7Block(const uint8_t* texels, uint8_t* output);
+	};
+}
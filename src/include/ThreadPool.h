@@ -0,0 +1,106 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+namespace Anni::ModelLoader
+{
+	// fixed size worker pool, the loader uses it to fan out independent work(image decoding etc.)
+	class ThreadPool
+	{
+	public:
+		// workers always take the oldest job of the highest non empty priority
+		enum class Priority : uint8_t
+		{
+			High,
+			Normal,
+			Low,
+		};
+
+		explicit ThreadPool(uint32_t num_workers);
+		~ThreadPool();
+
+		ThreadPool() = delete;
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool(ThreadPool&&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+		ThreadPool& operator=(ThreadPool&&) = delete;
+
+		template <typename F>
+		auto Submit(F&& task, const Priority priority = Priority::Normal) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+		{
+			using ResultType = std::invoke_result_t<std::decay_t<F>>;
+			// packaged_task is move only, std::function wants copyable callables
+			auto packaged = std::make_shared<std::packaged_task<ResultType()>>(std::forward<F>(task));
+			std::future<ResultType> result = packaged->get_future();
+			Enqueue([packaged]() { (*packaged)(); }, priority);
+			return result;
+		}
+
+		// runs task(i) for every i in [0, count) and returns once all of them are done. the caller works through the range as well
+		// and only waits for items already running, so this is safe to call from inside a pool job. the helpers jump the queue
+		// since somebody is blocked on them
+		template <typename F>
+		void ParallelFor(const size_t count, F&& task)
+		{
+			struct Progress
+			{
+				std::atomic<size_t> next{ 0 };
+				std::atomic<size_t> done{ 0 };
+				std::mutex mutex;
+				std::condition_variable cv;
+			};
+			auto progress = std::make_shared<Progress>();
+
+			// helpers that start after the range is drained return without touching task
+			auto work = [progress, count, &task]()
+			{
+				for ( size_t i = progress->next.fetch_add(1); i < count; i = progress->next.fetch_add(1) )
+				{
+					task(i);
+					if ( progress->done.fetch_add(1) + 1 == count )
+					{
+						std::scoped_lock lock(progress->mutex);
+						progress->cv.notify_all();
+					}
+				}
+			};
+
+			const size_t helper_count = std::min<size_t>(GetWorkerCount(), count > 0 ? count - 1 : 0);
+			for ( size_t i = 0; i < helper_count; ++i )
+			{
+				Enqueue(work, Priority::High);
+			}
+			work();
+
+			std::unique_lock lock(progress->mutex);
+			progress->cv.wait(lock, [&progress, count]() { return progress->done.load() == count; });
+		}
+
+		[[nodiscard]] uint32_t GetWorkerCount() const;
+
+		// process-wide pool sized to the hardware, created on first use
+		static ThreadPool& Shared();
+
+	private:
+		void Enqueue(std::function<void()> job, Priority priority);
+		void WorkerLoop(std::stop_token stop_token);
+
+		std::mutex m_queue_mutex;
+		std::condition_variable_any m_queue_cv;
+		// one queue per Priority
+		std::array<std::deque<std::function<void()>>, 3> m_jobs;
+		std::vector<std::jthread> m_workers;
+	};
+}
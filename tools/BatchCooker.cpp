@@ -0,0 +1,331 @@
+#include "ModelsLoader.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+// ModelsBatchCooker <input directory> <cache directory> [options]
+//
+// loads every .gltf/.glb below the input directory on a few threads at once and writes its cooked model into the cache
+// directory, the same place LoadOptions::cooked_cache_directory looks at runtime. models whose cooked file is still
+// current are skipped. a file that fails to load is reported and the rest carry on, the exit code tells if any did
+
+namespace
+{
+	using namespace Anni::ModelLoader;
+
+	enum class CookStatus : uint8_t
+	{
+		Cooked,
+		UpToDate,
+		Failed,
+	};
+
+	struct CookResult
+	{
+		CookStatus status{ CookStatus::Failed };
+		std::string message;
+		double milliseconds{ 0.0 };
+	};
+
+	struct CookerSettings
+	{
+		std::filesystem::path input_directory;
+		std::filesystem::path cache_directory;
+		uint32_t jobs{ std::max(1u, std::thread::hardware_concurrency() / 2) };
+		// cooks again even when the cooked file is current
+		bool force{ false };
+		LoadOptions options;
+	};
+
+	void PrintUsage(const char* executable)
+	{
+		std::cerr << "usage: " << executable << " <input directory> <cache directory> [options]\n"
+			"  --jobs N                  models loaded at once\n"
+			"  --force                   cook models whose cooked file is current as well\n"
+			"  --optimize                LoadOptions::optimize_meshes\n"
+			"  --lods 0.5,0.25           LoadOptions::lod_ratios\n"
+			"  --meshlets                LoadOptions::build_meshlets\n"
+			"  --merge                   LoadOptions::merge_mesh_buffers\n"
+			"  --layout NAME             interleaved, position_only, split_position, split_skin or quantized\n"
+			"  --mipmaps                 LoadOptions::generate_mipmaps\n"
+			"  --bc                      TextureCompression::Bc\n"
+			"  --verbose                 keep the loader's info logs\n";
+	}
+
+	bool ParseLodRatios(const std::string_view text, std::vector<float>& lod_ratios)
+	{
+		lod_ratios.clear();
+		size_t begin = 0;
+		while ( begin <= text.size() )
+		{
+			const size_t end = std::min(text.find(',', begin), text.size());
+			const std::string ratio_text(text.substr(begin, end - begin));
+			char* parse_end = nullptr;
+			const float ratio = std::strtof(ratio_text.c_str(), &parse_end);
+			if ( ratio_text.empty() || *parse_end != '\0' || !(ratio > 0.f && ratio < 1.f) )
+			{
+				return false;
+			}
+			lod_ratios.push_back(ratio);
+			begin = end + 1;
+		}
+		return !lod_ratios.empty();
+	}
+
+	bool ParseLayout(const std::string_view name, LoadOptions& options)
+	{
+		if ( name == "interleaved" )
+		{
+			options.vertex_layout.reset();
+		}
+		else if ( name == "position_only" )
+		{
+			options.vertex_layout = VertexLayout::PositionOnly();
+		}
+		else if ( name == "split_position" )
+		{
+			options.vertex_layout = VertexLayout::SplitPosition();
+		}
+		else if ( name == "split_skin" )
+		{
+			options.vertex_layout = VertexLayout::SplitSkin();
+		}
+		else if ( name == "quantized" )
+		{
+			options.vertex_layout = VertexLayout::Quantized(VertexLayout::SplitPosition());
+		}
+		else
+		{
+			return false;
+		}
+		return true;
+	}
+
+	bool ParseArguments(const int argc, char** argv, CookerSettings& settings)
+	{
+		std::vector<std::string_view> positional;
+		for ( int i = 1; i < argc; ++i )
+		{
+			const std::string_view argument = argv[i];
+			const bool has_value = i + 1 < argc;
+			if ( argument == "--jobs" && has_value )
+			{
+				const long jobs = std::strtol(argv[++i], nullptr, 10);
+				if ( jobs <= 0 )
+				{
+					return false;
+				}
+				settings.jobs = static_cast<uint32_t>(jobs);
+			}
+			else if ( argument == "--force" )
+			{
+				settings.force = true;
+			}
+			else if ( argument == "--optimize" )
+			{
+				settings.options.optimize_meshes = true;
+			}
+			else if ( argument == "--lods" && has_value )
+			{
+				if ( !ParseLodRatios(argv[++i], settings.options.lod_ratios) )
+				{
+					return false;
+				}
+			}
+			else if ( argument == "--meshlets" )
+			{
+				settings.options.build_meshlets = true;
+			}
+			else if ( argument == "--merge" )
+			{
+				settings.options.merge_mesh_buffers = true;
+			}
+			else if ( argument == "--layout" && has_value )
+			{
+				if ( !ParseLayout(argv[++i], settings.options) )
+				{
+					return false;
+				}
+			}
+			else if ( argument == "--mipmaps" )
+			{
+				settings.options.generate_mipmaps = true;
+			}
+			else if ( argument == "--bc" )
+			{
+				settings.options.texture_compression = TextureCompression::Bc;
+			}
+			else if ( argument == "--verbose" )
+			{
+				spdlog::set_level(spdlog::level::info);
+			}
+			else if ( argument.starts_with("--") )
+			{
+				return false;
+			}
+			else
+			{
+				positional.push_back(argument);
+			}
+		}
+
+		if ( positional.size() != 2 )
+		{
+			return false;
+		}
+		settings.input_directory = positional[0];
+		settings.cache_directory = positional[1];
+		settings.options.cooked_cache_directory = settings.cache_directory;
+		return true;
+	}
+
+	// sorted, so runs over the same tree report in the same order
+	std::vector<std::filesystem::path> CollectModelFiles(const std::filesystem::path& input_directory)
+	{
+		std::vector<std::filesystem::path> model_files;
+		std::error_code error;
+		auto iterator = std::filesystem::recursive_directory_iterator(input_directory, std::filesystem::directory_options::skip_permission_denied, error);
+		for ( ; !error && iterator != std::filesystem::recursive_directory_iterator(); iterator.increment(error) )
+		{
+			if ( !iterator->is_regular_file(error) )
+			{
+				continue;
+			}
+			std::string extension = iterator->path().extension().string();
+			std::ranges::transform(extension, extension.begin(), [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+			if ( ".gltf" == extension || ".glb" == extension )
+			{
+				model_files.push_back(iterator->path());
+			}
+		}
+		if ( error )
+		{
+			SPDLOG_WARN("Stopped walking {} early: {}", input_directory.string(), error.message());
+		}
+		std::ranges::sort(model_files);
+		return model_files;
+	}
+
+	CookResult CookModel(const std::filesystem::path& model_file, const CookerSettings& settings)
+	{
+		CookResult result;
+		const auto start = std::chrono::steady_clock::now();
+		const std::filesystem::path cooked_path = LoadedModel::factory.GetCookedModelPath(settings.cache_directory, model_file);
+		if ( settings.force )
+		{
+			std::error_code remove_error;
+			std::filesystem::remove(cooked_path, remove_error);
+		}
+
+		// the loader reports bad input as values, an exception is a loader bug but it still only costs this one file
+		try
+		{
+			LoadResult<std::unique_ptr<LoadedModel>> loaded = LoadedModel::factory.TryLoadFromFile(model_file, settings.options);
+			if ( !loaded )
+			{
+				result.message = loaded.error().message;
+			}
+			else if ( loaded.value()->GetLoadStats().from_cooked_cache )
+			{
+				result.status = CookStatus::UpToDate;
+			}
+			else if ( !loaded.value()->GetLoadStats().saved_to_cooked_cache )
+			{
+				result.message = "Failed to write cooked model to: " + cooked_path.string();
+			}
+			else
+			{
+				result.status = CookStatus::Cooked;
+			}
+		}
+		catch ( const std::exception& exception )
+		{
+			result.message = std::string("Exception while loading: ") + exception.what();
+		}
+		result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		return result;
+	}
+}
+
+
+int main(int argc, char** argv)
+{
+	// the loader's info logs drown the report once thousands of files go through
+	spdlog::set_level(spdlog::level::warn);
+
+	CookerSettings settings;
+	if ( !ParseArguments(argc, argv, settings) )
+	{
+		PrintUsage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(settings.cache_directory, error);
+	if ( error )
+	{
+		SPDLOG_ERROR("Can't create the cache directory {}: {}", settings.cache_directory.string(), error.message());
+		return EXIT_FAILURE;
+	}
+
+	const std::vector<std::filesystem::path> model_files = CollectModelFiles(settings.input_directory);
+	std::vector<CookResult> results(model_files.size());
+
+	// each loader thread runs one model at a time, their texture and mesh jobs share ThreadPool::Shared()
+	std::atomic<size_t> next_file{ 0 };
+	std::atomic<size_t> finished_files{ 0 };
+	std::mutex output_mutex;
+	const auto cook_files = [&]()
+	{
+		for ( size_t file_index = next_file.fetch_add(1); file_index < model_files.size(); file_index = next_file.fetch_add(1) )
+		{
+			results[file_index] = CookModel(model_files[file_index], settings);
+			const size_t finished = finished_files.fetch_add(1) + 1;
+			if ( results[file_index].status == CookStatus::Failed )
+			{
+				std::scoped_lock lock(output_mutex);
+				std::cerr << "[" << finished << "/" << model_files.size() << "] failed " << model_files[file_index].string() << ": " << results[file_index].message << '\n';
+			}
+		}
+	};
+	{
+		std::vector<std::jthread> loader_threads;
+		const size_t thread_count = std::min<size_t>(settings.jobs, std::max<size_t>(model_files.size(), 1));
+		for ( size_t i = 0; i < thread_count; ++i )
+		{
+			loader_threads.emplace_back(cook_files);
+		}
+	}
+
+	size_t cooked = 0, up_to_date = 0, failed = 0;
+	double total_milliseconds = 0.0;
+	for ( const CookResult& result : results )
+	{
+		cooked += result.status == CookStatus::Cooked ? 1 : 0;
+		up_to_date += result.status == CookStatus::UpToDate ? 1 : 0;
+		failed += result.status == CookStatus::Failed ? 1 : 0;
+		total_milliseconds += result.milliseconds;
+	}
+	std::cout << model_files.size() << " models: " << cooked << " cooked, " << up_to_date << " up to date, " << failed << " failed("
+		<< static_cast<uint64_t>(total_milliseconds) << " ms of loading on " << settings.jobs << " threads)\n";
+	for ( size_t file_index = 0; file_index < model_files.size(); ++file_index )
+	{
+		if ( results[file_index].status == CookStatus::Failed )
+		{
+			std::cout << "failed " << model_files[file_index].string() << ": " << results[file_index].message << '\n';
+		}
+	}
+	return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}